@@ -0,0 +1,138 @@
+/**********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2018 Antoine Beauchamp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+
+#ifndef LIBVARIANT_AGGREGATE_H
+#define LIBVARIANT_AGGREGATE_H
+
+//---------------
+// Include Files
+//---------------
+#include "libvariant/variant.h"
+#include "libvariant/variant_array.h"
+#include "libvariant/thread_pool.h"
+#include "libvariant/config.h"
+#include "libvariant/version.h"
+
+//-----------
+// Namespace
+//-----------
+
+namespace libVariant
+{
+  //------------------------
+  // Class Declarations
+  //------------------------
+
+  /// <summary>
+  /// Aggregate functions over a range of Variant values or over the values of a VariantArray.
+  /// </summary>
+  /// <remarks>
+  /// Values are split in chunks of CHUNK_SIZE values which are processed by the threads of a ThreadPool.
+  /// Each chunk is aggregated in order, then the partial result of each chunk is merged in order.
+  /// The size of the chunks does not depend on the number of threads which means that results are identical for any number of threads.
+  /// Numeric values are processed without creating Variant instances. String values are processed with the Variant class.
+  /// </remarks>
+  class LIBVARIANT_EXPORT Aggregate
+  {
+  public:
+    /// <summary>
+    /// Number of consecutive values aggregated by a single thread.
+    /// </summary>
+    static const size_t CHUNK_SIZE = 64*1024;
+
+    //----------------------
+    // ranges of values
+    //----------------------
+
+    /// <summary>
+    /// Returns the sum of a range of values. The sum of a chunk is identical to adding each value to the first value
+    /// with Variant::operator += which includes all internal type promotion rules. The sums of the chunks are also added with Variant::operator +=.
+    /// </summary>
+    /// <param name="iValues">The first value of the range.</param>
+    /// <param name="iSize">The number of values of the range.</param>
+    /// <param name="iPool">The threads processing the chunks of values.</param>
+    /// <returns>Returns the sum of the values. Returns a default Variant (0) if the range is empty.</returns>
+    static Variant sum(const Variant * iValues, size_t iSize, ThreadPool & iPool = ThreadPool::getDefault());
+
+    /// <summary>
+    /// Returns the smallest value of a range of values according to Variant::compare().
+    /// The first of equal values is returned.
+    /// </summary>
+    /// <remarks>
+    /// Variant::compare() is not transitive when mixing signed values with unsigned values or numbers with strings.
+    /// In such a case, the result depends on the order of the values (and on the chunks) but not on the number of threads.
+    /// </remarks>
+    /// <returns>Returns the smallest value. Returns a default Variant (0) if the range is empty.</returns>
+    static Variant minimum(const Variant * iValues, size_t iSize, ThreadPool & iPool = ThreadPool::getDefault());
+
+    /// <summary>
+    /// Returns the largest value of a range of values according to Variant::compare().
+    /// The first of equal values is returned. See minimum().
+    /// </summary>
+    /// <returns>Returns the largest value. Returns a default Variant (0) if the range is empty.</returns>
+    static Variant maximum(const Variant * iValues, size_t iSize, ThreadPool & iPool = ThreadPool::getDefault());
+
+    /// <summary>
+    /// Returns the mean of a range of values. The mean is the sum() divided by the number of values with Variant::operator /=.
+    /// The mean of integers is an integer if the division is exact and a float64 otherwise.
+    /// </summary>
+    /// <returns>Returns the mean of the values. Returns a default Variant (0) if the range is empty.</returns>
+    static Variant mean(const Variant * iValues, size_t iSize, ThreadPool & iPool = ThreadPool::getDefault());
+
+    /// <summary>
+    /// Returns the number of distinct values of a range of values.
+    /// Numbers are distinct if their values are different regardless of their format (ie: 1, 1.0 and "1" are the same value).
+    /// Strings which are not numbers are distinct if Variant::operator == returns false.
+    /// </summary>
+    static size_t countDistinct(const Variant * iValues, size_t iSize, ThreadPool & iPool = ThreadPool::getDefault());
+
+    //----------------------
+    // arrays of values
+    //----------------------
+
+    /// <summary>
+    /// Returns the sum of the selected values of an array. See sum().
+    /// </summary>
+    /// <param name="iValues">The array of values.</param>
+    /// <param name="iSelection">The values to aggregate (see VariantArray::select()). NULL selects all values.</param>
+    /// <param name="iPool">The threads processing the chunks of values.</param>
+    static Variant sum(const VariantArray & iValues, const VariantArray::Bitmap * iSelection = NULL, ThreadPool & iPool = ThreadPool::getDefault());
+    static Variant minimum(const VariantArray & iValues, const VariantArray::Bitmap * iSelection = NULL, ThreadPool & iPool = ThreadPool::getDefault());
+    static Variant maximum(const VariantArray & iValues, const VariantArray::Bitmap * iSelection = NULL, ThreadPool & iPool = ThreadPool::getDefault());
+    static Variant mean(const VariantArray & iValues, const VariantArray::Bitmap * iSelection = NULL, ThreadPool & iPool = ThreadPool::getDefault());
+    static size_t countDistinct(const VariantArray & iValues, const VariantArray::Bitmap * iSelection = NULL, ThreadPool & iPool = ThreadPool::getDefault());
+
+    /// <summary>
+    /// Returns the number of selected values of an array.
+    /// </summary>
+    static size_t count(const VariantArray & iValues, const VariantArray::Bitmap * iSelection = NULL);
+
+  private:
+    struct Kernels;
+  };
+
+} // End namespace
+
+#endif //LIBVARIANT_AGGREGATE_H
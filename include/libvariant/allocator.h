@@ -0,0 +1,159 @@
+/**********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2018 Antoine Beauchamp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+
+#ifndef LIBVARIANT_ALLOCATOR_H
+#define LIBVARIANT_ALLOCATOR_H
+
+//---------------
+// Include Files
+//---------------
+#include "libvariant/config.h"
+#include "libvariant/version.h"
+#include <stddef.h> // size_t
+
+//-----------
+// Namespace
+//-----------
+
+namespace libVariant
+{
+  //------------------------
+  // Class Declarations
+  //------------------------
+
+  /// <summary>
+  /// Allocates the memory of the string values of Variant instances.
+  /// Each thread has a current allocator which is used by all memory allocations of the thread.
+  /// Memory is always released by the allocator which allocated it.
+  /// </summary>
+  class LIBVARIANT_EXPORT Allocator
+  {
+  public:
+    virtual ~Allocator();
+
+    /// <summary>
+    /// Allocates a buffer of the given size. The buffer is suitably aligned for any type.
+    /// </summary>
+    /// <param name="iSize">The size of the buffer in bytes.</param>
+    /// <returns>Returns a pointer to the new buffer. Throws std::bad_alloc if the memory cannot be allocated.</returns>
+    virtual void * allocate(size_t iSize) = 0;
+
+    /// <summary>
+    /// Releases a buffer returned by allocate().
+    /// </summary>
+    /// <param name="iBuffer">The buffer to release.</param>
+    /// <param name="iSize">The size of the buffer in bytes, as given to allocate().</param>
+    virtual void deallocate(void * iBuffer, size_t iSize) = 0;
+
+    //----------------
+    // static methods
+    //----------------
+
+    /// <summary>
+    /// Returns the default allocator which uses the global operator new and operator delete.
+    /// </summary>
+    static Allocator & getDefault();
+
+    /// <summary>
+    /// Returns the current allocator of the calling thread. Returns the default allocator if none was set.
+    /// </summary>
+    static Allocator & getCurrent();
+
+    /// <summary>
+    /// Sets the current allocator of the calling thread.
+    /// </summary>
+    /// <param name="iAllocator">The new allocator of the calling thread. Use NULL to restore the default allocator.</param>
+    static void setCurrent(Allocator * iAllocator);
+  };
+
+  /// <summary>
+  /// A bump-pointer allocator which releases all its memory at once.
+  /// Allocating is a pointer increment and deallocate() does nothing. The memory is released by reset() or by the destructor.
+  /// </summary>
+  /// <remarks>
+  /// An ArenaAllocator is not thread safe and must only be the current allocator of a single thread.
+  /// Variants which allocated memory from an arena must be destroyed (or cleared) before the arena is reset or destroyed.
+  /// Copies of these Variants made while another allocator is current do not share the arena memory and may outlive the arena.
+  /// Copies made while the arena is current, and Variants moved out of the arena scope, must follow the rule above.
+  /// </remarks>
+  class LIBVARIANT_EXPORT ArenaAllocator : public Allocator
+  {
+  public:
+    /// <summary>
+    /// Default size of the memory blocks requested by the arena.
+    /// </summary>
+    static const size_t DEFAULT_BLOCK_SIZE = 64*1024;
+
+    ArenaAllocator();
+    ArenaAllocator(size_t iBlockSize);
+    virtual ~ArenaAllocator();
+
+    virtual void * allocate(size_t iSize);
+    virtual void deallocate(void * iBuffer, size_t iSize);
+
+    /// <summary>
+    /// Releases all the memory allocated by the arena.
+    /// Every Variant which still uses the arena memory (see remarks above) becomes invalid.
+    /// </summary>
+    void reset();
+
+    /// <summary>
+    /// Returns the total number of bytes returned by allocate() since the arena was created or reset.
+    /// </summary>
+    size_t getAllocatedSize() const;
+
+  private:
+    ArenaAllocator(const ArenaAllocator &);
+    ArenaAllocator & operator = (const ArenaAllocator &);
+
+    struct Block;
+
+    Block * mBlocks;      //most recent block first
+    char * mCursor;       //next free byte of the most recent block
+    char * mEnd;          //end of the most recent block
+    size_t mBlockSize;
+    size_t mAllocatedSize;
+  };
+
+  /// <summary>
+  /// Sets the current allocator of the calling thread for the lifetime of the instance.
+  /// The previous allocator is restored when the instance is destroyed.
+  /// </summary>
+  class LIBVARIANT_EXPORT AllocatorScope
+  {
+  public:
+    AllocatorScope(Allocator & iAllocator);
+    ~AllocatorScope();
+
+  private:
+    AllocatorScope(const AllocatorScope &);
+    AllocatorScope & operator = (const AllocatorScope &);
+
+    Allocator * mPrevious;
+  };
+
+} // End namespace
+
+#endif //LIBVARIANT_ALLOCATOR_H
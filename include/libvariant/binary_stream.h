@@ -0,0 +1,170 @@
+/**********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2018 Antoine Beauchamp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#ifndef LIBVARIANT_BINARYSTREAM_H
+#define LIBVARIANT_BINARYSTREAM_H
+
+//---------------
+// Include Files
+//---------------
+#include "libvariant/variant.h"
+#include "libvariant/variant_array.h"
+#include "libvariant/config.h"
+#include "libvariant/version.h"
+
+//-----------
+// Namespace
+//-----------
+
+namespace libVariant
+{
+  //------------------------
+  // Class Declarations
+  //------------------------
+
+  /// <summary>
+  /// Writes Variant values into a caller buffer with a compact binary encoding which keeps the internal format of the values.
+  /// </summary>
+  /// <remarks>
+  /// Each value is encoded as a tag byte (the VariantFormat of the value) followed by:
+  ///  BOOL:                  a single byte, 0 or 1.
+  ///  UINT8 to UINT64:       the value as an unsigned LEB128 varint.
+  ///  SINT8 to SINT64:       the zigzag encoding of the value as an unsigned LEB128 varint.
+  ///  FLOAT32 and FLOAT64:   the IEEE 754 bits of the value, little endian.
+  ///  STRING:                the number of characters as an unsigned LEB128 varint, followed by the characters.
+  /// A value is written completely or not at all. When the buffer is full, the caller flushes the written bytes and calls reset() with an empty buffer.
+  /// </remarks>
+  class LIBVARIANT_EXPORT BinaryWriter
+  {
+  public:
+    /// <summary>
+    /// Maximum size of an encoded value which is not a string: a tag and a 10 bytes varint.
+    /// </summary>
+    static const size_t MAX_NUMBER_SIZE = 11;
+
+    BinaryWriter(char * iBuffer, size_t iSize);
+
+    /// <summary>
+    /// Continues writing into a new buffer. The number of written bytes is reset to 0.
+    /// </summary>
+    void reset(char * iBuffer, size_t iSize);
+
+    /// <summary>
+    /// Writes a value at the end of the written bytes.
+    /// </summary>
+    /// <returns>Returns true if the value is written. Returns false if the remaining space of the buffer is too small. Then, nothing is written.</returns>
+    bool write(const Variant & iValue);
+
+    /// <summary>
+    /// Writes the value at the given index of an array without creating a Variant.
+    /// </summary>
+    bool write(const VariantArray & iValues, size_t iIndex);
+
+    /// <summary>
+    /// Returns the number of bytes written into the buffer.
+    /// </summary>
+    size_t getSize() const { return mPosition; }
+
+    /// <summary>
+    /// Returns the number of bytes required to encode a value.
+    /// </summary>
+    static size_t getEncodedSize(const Variant & iValue);
+
+  private:
+    BinaryWriter(const BinaryWriter &);
+    BinaryWriter & operator = (const BinaryWriter &);
+
+    bool writeNative(uint8 iFormat, const Variant::VariantUnion & iValue);
+    bool writeString(const char * iValue, size_t iLength);
+
+    char * mBuffer;
+    size_t mSize;
+    size_t mPosition;
+  };
+
+  /// <summary>
+  /// Reads Variant values encoded by BinaryWriter from a caller buffer.
+  /// </summary>
+  /// <remarks>
+  /// A value is read completely or not at all. When a read fails because the buffer ends in the middle of a value,
+  /// the caller moves the unread bytes (from getPosition()) to the beginning of its buffer, appends more data and calls reset().
+  /// Invalid data (unknown tag, value out of the range of its format) stops the reader: see hasError().
+  /// </remarks>
+  class LIBVARIANT_EXPORT BinaryReader
+  {
+  public:
+    BinaryReader(const char * iBuffer, size_t iSize);
+
+    /// <summary>
+    /// Continues reading from a new buffer. The position is reset to 0. Errors are cleared.
+    /// </summary>
+    void reset(const char * iBuffer, size_t iSize);
+
+    /// <summary>
+    /// Reads the next value. The characters of a string value are copied.
+    /// </summary>
+    /// <returns>Returns true if a value is read. Returns false if the buffer does not contain a complete value or if the data is invalid.</returns>
+    bool read(Variant & oValue);
+
+    /// <summary>
+    /// Reads the next value. A string value references the characters of the buffer (see Variant::setStringView())
+    /// and is valid until the buffer is modified or released.
+    /// </summary>
+    bool readView(Variant & oValue);
+
+    /// <summary>
+    /// Reads the next value and appends it to an array.
+    /// </summary>
+    bool read(VariantArray & ioValues);
+
+    /// <summary>
+    /// Returns the number of bytes read from the buffer.
+    /// </summary>
+    size_t getPosition() const { return mPosition; }
+
+    /// <summary>
+    /// Returns true if all bytes of the buffer were read.
+    /// </summary>
+    bool isEnd() const { return mPosition == mSize; }
+
+    /// <summary>
+    /// Returns true if the buffer contains invalid data at the current position.
+    /// </summary>
+    bool hasError() const { return mError; }
+
+  private:
+    BinaryReader(const BinaryReader &);
+    BinaryReader & operator = (const BinaryReader &);
+
+    bool readValue(Variant & oValue);
+
+    const char * mBuffer;
+    size_t mSize;
+    size_t mPosition;
+    bool mError;
+  };
+
+} // End namespace
+
+#endif //LIBVARIANT_BINARYSTREAM_H
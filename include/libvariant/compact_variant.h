@@ -0,0 +1,444 @@
+/**********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2018 Antoine Beauchamp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#ifndef LIBVARIANT_COMPACT_VARIANT_H
+#define LIBVARIANT_COMPACT_VARIANT_H
+
+//---------------
+// Include Files
+//---------------
+#include "libvariant/variant.h"
+#include "libvariant/config.h"
+#include "libvariant/version.h"
+
+//-----------
+// Namespace
+//-----------
+
+namespace libVariant
+{
+  //------------------------
+  // Class Declarations
+  //------------------------
+
+  /// <summary>
+  /// A non-polymorphic variant value with the same conversion, promotion and comparison rules as the Variant class.
+  /// CompactVariant has no virtual methods which makes each instance as small as an internal format and a VariantUnion.
+  /// Numeric getters and setters are inlined. String values are always allocated on the heap.
+  /// Use CompactVariant when storing large amount of values and Variant when polymorphism is required.
+  /// </summary>
+  class LIBVARIANT_EXPORT CompactVariant final
+  {
+  public:
+    //----------------------
+    // constructors methods
+    //----------------------
+    CompactVariant()                                  : mFormat(Variant::UINT8  ) { mData.as_bits = 0; }
+    CompactVariant(const CompactVariant   & iValue)   : mFormat(Variant::UINT8  ) { mData.as_bits = 0; (*this) = iValue; } //copy ctor
+    CompactVariant(CompactVariant        && iValue) noexcept : mFormat(iValue.mFormat) { mData = iValue.mData; iValue.mFormat = Variant::UINT8; iValue.mData.as_bits = 0; } //move ctor
+    CompactVariant(const Variant          & iValue);
+    CompactVariant(const CStr             & iValue)   : mFormat(Variant::UINT8  ) { mData.as_bits = 0; setString(iValue); }
+    CompactVariant(const Str              & iValue)   : mFormat(Variant::UINT8  ) { mData.as_bits = 0; setString(iValue); }
+    CompactVariant(const bool             & iValue)   : mFormat(Variant::BOOL   ) { mData.as_uint64 = iValue; }
+    CompactVariant(const sint8            & iValue)   : mFormat(Variant::SINT8  ) { mData.as_sint64 = iValue; }
+    CompactVariant(const sint16           & iValue)   : mFormat(Variant::SINT16 ) { mData.as_sint64 = iValue; }
+    CompactVariant(const sint32           & iValue)   : mFormat(Variant::SINT32 ) { mData.as_sint64 = iValue; }
+    CompactVariant(const sint64           & iValue)   : mFormat(Variant::SINT64 ) { mData.as_sint64 = iValue; }
+    CompactVariant(const uint8            & iValue)   : mFormat(Variant::UINT8  ) { mData.as_uint64 = iValue; }
+    CompactVariant(const uint16           & iValue)   : mFormat(Variant::UINT16 ) { mData.as_uint64 = iValue; }
+    CompactVariant(const uint32           & iValue)   : mFormat(Variant::UINT32 ) { mData.as_uint64 = iValue; }
+    CompactVariant(const uint64           & iValue)   : mFormat(Variant::UINT64 ) { mData.as_uint64 = iValue; }
+    CompactVariant(const float32          & iValue)   : mFormat(Variant::FLOAT32) { mData.as_bits = 0; mData.as_float32 = iValue; }
+    CompactVariant(const float64          & iValue)   : mFormat(Variant::FLOAT64) { mData.as_float64 = iValue; }
+
+    ~CompactVariant() { clear(); }
+
+    //----------------
+    // public methods
+    //----------------
+
+    /// <summary>
+    /// Converts the CompactVariant to a Variant with the same internal format and value.
+    /// </summary>
+    /// <returns>Returns a Variant matching the CompactVariant.</returns>
+    Variant toVariant() const;
+    operator Variant() const { return toVariant(); }
+
+    /// <summary>
+    /// Exchanges the internal format and value of the CompactVariant instance with the given CompactVariant.
+    /// </summary>
+    /// <param name="iValue">The CompactVariant to exchange values with.</param>
+    void swap(CompactVariant & iValue) noexcept
+    {
+      Variant::VariantFormat format = mFormat;
+      Variant::VariantUnion data = mData;
+      mFormat = iValue.mFormat;
+      mData = iValue.mData;
+      iValue.mFormat = format;
+      iValue.mData = data;
+    }
+
+    //getters
+    bool     getBool()    const { return (isNativeInteger() ? mData.as_uint8 != 0 : convertBool()); }
+    uint8    getUInt8()   const { uint8   value; if (isNativeInteger()) value = mData.as_uint8;  else convert(value); return value; }
+    uint16   getUInt16()  const { uint16  value; if (isNativeInteger()) value = mData.as_uint16; else convert(value); return value; }
+    uint32   getUInt32()  const { uint32  value; if (isNativeInteger()) value = mData.as_uint32; else convert(value); return value; }
+    uint64   getUInt64()  const { uint64  value; if (isNativeInteger()) value = mData.as_uint64; else convert(value); return value; }
+    sint8    getSInt8()   const { sint8   value; if (isNativeInteger()) value = mData.as_sint8;  else convert(value); return value; }
+    sint16   getSInt16()  const { sint16  value; if (isNativeInteger()) value = mData.as_sint16; else convert(value); return value; }
+    sint32   getSInt32()  const { sint32  value; if (isNativeInteger()) value = mData.as_sint32; else convert(value); return value; }
+    sint64   getSInt64()  const { sint64  value; if (isNativeInteger()) value = mData.as_sint64; else convert(value); return value; }
+    float32  getFloat32() const { float32 value; if (mFormat == Variant::FLOAT32) value = mData.as_float32; else convert(value); return value; }
+    float64  getFloat64() const { float64 value; if (mFormat == Variant::FLOAT64) value = mData.as_float64; else convert(value); return value; }
+    Str      getString()  const;
+    size_t   getString(char * oBuffer, size_t iSize) const; //see Variant::getString(char *, size_t)
+
+    //setters
+    void setBool   (const bool         & iValue) { clear(); mFormat = Variant::BOOL   ; mData.as_uint64 = iValue; }
+    void setSInt8  (const sint8        & iValue) { clear(); mFormat = Variant::SINT8  ; mData.as_sint64 = iValue; }
+    void setUInt8  (const uint8        & iValue) { clear(); mFormat = Variant::UINT8  ; mData.as_uint64 = iValue; }
+    void setSInt16 (const sint16       & iValue) { clear(); mFormat = Variant::SINT16 ; mData.as_sint64 = iValue; }
+    void setUInt16 (const uint16       & iValue) { clear(); mFormat = Variant::UINT16 ; mData.as_uint64 = iValue; }
+    void setSInt32 (const sint32       & iValue) { clear(); mFormat = Variant::SINT32 ; mData.as_sint64 = iValue; }
+    void setUInt32 (const uint32       & iValue) { clear(); mFormat = Variant::UINT32 ; mData.as_uint64 = iValue; }
+    void setSInt64 (const sint64       & iValue) { clear(); mFormat = Variant::SINT64 ; mData.as_sint64 = iValue; }
+    void setUInt64 (const uint64       & iValue) { clear(); mFormat = Variant::UINT64 ; mData.as_uint64 = iValue; }
+    void setFloat32(const float32      & iValue) { clear(); mFormat = Variant::FLOAT32; mData.as_float32 = iValue; }
+    void setFloat64(const float64      & iValue) { clear(); mFormat = Variant::FLOAT64; mData.as_float64 = iValue; }
+    void setString (const Str          & iValue) { setString(iValue.c_str()); }
+    void setString (const CStr         & iValue);
+
+    //------------------------
+    // convenience functions
+    //------------------------
+    void set(const bool         & iValue) { setBool      (iValue); }
+    void set(const uint8        & iValue) { setUInt8     (iValue); }
+    void set(const uint16       & iValue) { setUInt16    (iValue); }
+    void set(const uint32       & iValue) { setUInt32    (iValue); }
+    void set(const uint64       & iValue) { setUInt64    (iValue); }
+    void set(const sint8        & iValue) { setSInt8     (iValue); }
+    void set(const sint16       & iValue) { setSInt16    (iValue); }
+    void set(const sint32       & iValue) { setSInt32    (iValue); }
+    void set(const sint64       & iValue) { setSInt64    (iValue); }
+    void set(const float32      & iValue) { setFloat32   (iValue); }
+    void set(const float64      & iValue) { setFloat64   (iValue); }
+    void set(const CStr         & iValue) { setString    (iValue); }
+    void set(const Str          & iValue) { setString    (iValue); }
+
+    void get(bool         & iValue) const { iValue = getBool   (); }
+    void get(uint8        & iValue) const { iValue = getUInt8  (); }
+    void get(uint16       & iValue) const { iValue = getUInt16 (); }
+    void get(uint32       & iValue) const { iValue = getUInt32 (); }
+    void get(uint64       & iValue) const { iValue = getUInt64 (); }
+    void get(sint8        & iValue) const { iValue = getSInt8  (); }
+    void get(sint16       & iValue) const { iValue = getSInt16 (); }
+    void get(sint32       & iValue) const { iValue = getSInt32 (); }
+    void get(sint64       & iValue) const { iValue = getSInt64 (); }
+    void get(float32      & iValue) const { iValue = getFloat32(); }
+    void get(float64      & iValue) const { iValue = getFloat64(); }
+    void get(Str          & iValue) const { iValue = getString (); }
+
+    /// <summary>
+    /// Returns the internal type of the CompactVariant.
+    /// </summary>
+    /// <returns>Returns the internal type of the CompactVariant.</returns>
+    const Variant::VariantFormat & getFormat() const { return mFormat; }
+
+    /// <summary>
+    /// Converts the internal type of the CompactVariant to the smallest internal type that can hold the same value.
+    /// See Variant::simplify() for details.
+    /// </summary>
+    /// <returns>Returns true if the CompactVariant internal type was changed. Returns false otherwise.</returns>
+    bool simplify();
+
+    /// <summary>
+    /// Converts the internal type of the CompactVariant to the given type.
+    /// See Variant::promote() for details.
+    /// </summary>
+    /// <param name="iFormat">The new internal type of the CompactVariant.</param>
+    void promote(const Variant::VariantFormat & iFormat);
+
+    bool isSigned() const   { return (mFormat == Variant::SINT8 || mFormat == Variant::SINT16 || mFormat == Variant::SINT32 || mFormat == Variant::SINT64); }
+    bool isUnsigned() const { return (mFormat == Variant::BOOL || mFormat == Variant::UINT8 || mFormat == Variant::UINT16 || mFormat == Variant::UINT32 || mFormat == Variant::UINT64); }
+    bool isFloating() const { return (mFormat == Variant::FLOAT32 || mFormat == Variant::FLOAT64); }
+    bool isPositive() const;
+    bool isNegative() const;
+
+    //----------------------
+    //   operators
+    //----------------------
+    const CompactVariant & operator = (const bool         & iValue) { setBool   (iValue); return (*this); }
+    const CompactVariant & operator = (const uint8        & iValue) { setUInt8  (iValue); return (*this); }
+    const CompactVariant & operator = (const uint16       & iValue) { setUInt16 (iValue); return (*this); }
+    const CompactVariant & operator = (const uint32       & iValue) { setUInt32 (iValue); return (*this); }
+    const CompactVariant & operator = (const uint64       & iValue) { setUInt64 (iValue); return (*this); }
+    const CompactVariant & operator = (const sint8        & iValue) { setSInt8  (iValue); return (*this); }
+    const CompactVariant & operator = (const sint16       & iValue) { setSInt16 (iValue); return (*this); }
+    const CompactVariant & operator = (const sint32       & iValue) { setSInt32 (iValue); return (*this); }
+    const CompactVariant & operator = (const sint64       & iValue) { setSInt64 (iValue); return (*this); }
+    const CompactVariant & operator = (const float32      & iValue) { setFloat32(iValue); return (*this); }
+    const CompactVariant & operator = (const float64      & iValue) { setFloat64(iValue); return (*this); }
+    const CompactVariant & operator = (const CStr         & iValue) { setString (iValue); return (*this); }
+    const CompactVariant & operator = (const Str          & iValue) { setString (iValue); return (*this); }
+    const CompactVariant & operator = (const CompactVariant & iValue)
+    {
+      if (iValue.mFormat == Variant::STRING)
+      {
+        if (this != &iValue)
+          setString(iValue.mData.as_str->c_str());
+        return (*this);
+      }
+      clear();
+      mFormat = iValue.mFormat;
+      mData = iValue.mData;
+      return (*this);
+    }
+    const CompactVariant & operator = (CompactVariant && iValue) noexcept
+    {
+      if (this != &iValue)
+      {
+        clear();
+        swap(iValue);
+      }
+      return (*this);
+    }
+
+    //arithmetic operators. Native types are matched exactly like the Variant class so that literals are not converted to bool. Boolean values are processed as integers.
+    CompactVariant operator + (const CompactVariant & iValue) const { CompactVariant tmpCopy(*this); tmpCopy += iValue; return tmpCopy; }
+    CompactVariant operator - (const CompactVariant & iValue) const { CompactVariant tmpCopy(*this); tmpCopy -= iValue; return tmpCopy; }
+    CompactVariant operator * (const CompactVariant & iValue) const { CompactVariant tmpCopy(*this); tmpCopy *= iValue; return tmpCopy; }
+    CompactVariant operator / (const CompactVariant & iValue) const { CompactVariant tmpCopy(*this); tmpCopy /= iValue; return tmpCopy; }
+    CompactVariant operator + (const bool           & iValue) const { CompactVariant tmpCopy(*this); tmpCopy += iValue; return tmpCopy; }
+    CompactVariant operator + (const uint8          & iValue) const { CompactVariant tmpCopy(*this); tmpCopy += iValue; return tmpCopy; }
+    CompactVariant operator + (const uint16         & iValue) const { CompactVariant tmpCopy(*this); tmpCopy += iValue; return tmpCopy; }
+    CompactVariant operator + (const uint32         & iValue) const { CompactVariant tmpCopy(*this); tmpCopy += iValue; return tmpCopy; }
+    CompactVariant operator + (const uint64         & iValue) const { CompactVariant tmpCopy(*this); tmpCopy += iValue; return tmpCopy; }
+    CompactVariant operator + (const sint8          & iValue) const { CompactVariant tmpCopy(*this); tmpCopy += iValue; return tmpCopy; }
+    CompactVariant operator + (const sint16         & iValue) const { CompactVariant tmpCopy(*this); tmpCopy += iValue; return tmpCopy; }
+    CompactVariant operator + (const sint32         & iValue) const { CompactVariant tmpCopy(*this); tmpCopy += iValue; return tmpCopy; }
+    CompactVariant operator + (const sint64         & iValue) const { CompactVariant tmpCopy(*this); tmpCopy += iValue; return tmpCopy; }
+    CompactVariant operator + (const float32        & iValue) const { CompactVariant tmpCopy(*this); tmpCopy += iValue; return tmpCopy; }
+    CompactVariant operator + (const float64        & iValue) const { CompactVariant tmpCopy(*this); tmpCopy += iValue; return tmpCopy; }
+    CompactVariant operator + (const CStr           & iValue) const { CompactVariant tmpCopy(*this); tmpCopy += iValue; return tmpCopy; }
+    CompactVariant operator + (const Str            & iValue) const { CompactVariant tmpCopy(*this); tmpCopy += iValue; return tmpCopy; }
+    CompactVariant operator - (const bool           & iValue) const { CompactVariant tmpCopy(*this); tmpCopy -= iValue; return tmpCopy; }
+    CompactVariant operator - (const uint8          & iValue) const { CompactVariant tmpCopy(*this); tmpCopy -= iValue; return tmpCopy; }
+    CompactVariant operator - (const uint16         & iValue) const { CompactVariant tmpCopy(*this); tmpCopy -= iValue; return tmpCopy; }
+    CompactVariant operator - (const uint32         & iValue) const { CompactVariant tmpCopy(*this); tmpCopy -= iValue; return tmpCopy; }
+    CompactVariant operator - (const uint64         & iValue) const { CompactVariant tmpCopy(*this); tmpCopy -= iValue; return tmpCopy; }
+    CompactVariant operator - (const sint8          & iValue) const { CompactVariant tmpCopy(*this); tmpCopy -= iValue; return tmpCopy; }
+    CompactVariant operator - (const sint16         & iValue) const { CompactVariant tmpCopy(*this); tmpCopy -= iValue; return tmpCopy; }
+    CompactVariant operator - (const sint32         & iValue) const { CompactVariant tmpCopy(*this); tmpCopy -= iValue; return tmpCopy; }
+    CompactVariant operator - (const sint64         & iValue) const { CompactVariant tmpCopy(*this); tmpCopy -= iValue; return tmpCopy; }
+    CompactVariant operator - (const float32        & iValue) const { CompactVariant tmpCopy(*this); tmpCopy -= iValue; return tmpCopy; }
+    CompactVariant operator - (const float64        & iValue) const { CompactVariant tmpCopy(*this); tmpCopy -= iValue; return tmpCopy; }
+    CompactVariant operator - (const CStr           & iValue) const { CompactVariant tmpCopy(*this); tmpCopy -= iValue; return tmpCopy; }
+    CompactVariant operator - (const Str            & iValue) const { CompactVariant tmpCopy(*this); tmpCopy -= iValue; return tmpCopy; }
+    CompactVariant operator * (const bool           & iValue) const { CompactVariant tmpCopy(*this); tmpCopy *= iValue; return tmpCopy; }
+    CompactVariant operator * (const uint8          & iValue) const { CompactVariant tmpCopy(*this); tmpCopy *= iValue; return tmpCopy; }
+    CompactVariant operator * (const uint16         & iValue) const { CompactVariant tmpCopy(*this); tmpCopy *= iValue; return tmpCopy; }
+    CompactVariant operator * (const uint32         & iValue) const { CompactVariant tmpCopy(*this); tmpCopy *= iValue; return tmpCopy; }
+    CompactVariant operator * (const uint64         & iValue) const { CompactVariant tmpCopy(*this); tmpCopy *= iValue; return tmpCopy; }
+    CompactVariant operator * (const sint8          & iValue) const { CompactVariant tmpCopy(*this); tmpCopy *= iValue; return tmpCopy; }
+    CompactVariant operator * (const sint16         & iValue) const { CompactVariant tmpCopy(*this); tmpCopy *= iValue; return tmpCopy; }
+    CompactVariant operator * (const sint32         & iValue) const { CompactVariant tmpCopy(*this); tmpCopy *= iValue; return tmpCopy; }
+    CompactVariant operator * (const sint64         & iValue) const { CompactVariant tmpCopy(*this); tmpCopy *= iValue; return tmpCopy; }
+    CompactVariant operator * (const float32        & iValue) const { CompactVariant tmpCopy(*this); tmpCopy *= iValue; return tmpCopy; }
+    CompactVariant operator * (const float64        & iValue) const { CompactVariant tmpCopy(*this); tmpCopy *= iValue; return tmpCopy; }
+    CompactVariant operator * (const CStr           & iValue) const { CompactVariant tmpCopy(*this); tmpCopy *= iValue; return tmpCopy; }
+    CompactVariant operator * (const Str            & iValue) const { CompactVariant tmpCopy(*this); tmpCopy *= iValue; return tmpCopy; }
+    CompactVariant operator / (const bool           & iValue) const { CompactVariant tmpCopy(*this); tmpCopy /= iValue; return tmpCopy; }
+    CompactVariant operator / (const uint8          & iValue) const { CompactVariant tmpCopy(*this); tmpCopy /= iValue; return tmpCopy; }
+    CompactVariant operator / (const uint16         & iValue) const { CompactVariant tmpCopy(*this); tmpCopy /= iValue; return tmpCopy; }
+    CompactVariant operator / (const uint32         & iValue) const { CompactVariant tmpCopy(*this); tmpCopy /= iValue; return tmpCopy; }
+    CompactVariant operator / (const uint64         & iValue) const { CompactVariant tmpCopy(*this); tmpCopy /= iValue; return tmpCopy; }
+    CompactVariant operator / (const sint8          & iValue) const { CompactVariant tmpCopy(*this); tmpCopy /= iValue; return tmpCopy; }
+    CompactVariant operator / (const sint16         & iValue) const { CompactVariant tmpCopy(*this); tmpCopy /= iValue; return tmpCopy; }
+    CompactVariant operator / (const sint32         & iValue) const { CompactVariant tmpCopy(*this); tmpCopy /= iValue; return tmpCopy; }
+    CompactVariant operator / (const sint64         & iValue) const { CompactVariant tmpCopy(*this); tmpCopy /= iValue; return tmpCopy; }
+    CompactVariant operator / (const float32        & iValue) const { CompactVariant tmpCopy(*this); tmpCopy /= iValue; return tmpCopy; }
+    CompactVariant operator / (const float64        & iValue) const { CompactVariant tmpCopy(*this); tmpCopy /= iValue; return tmpCopy; }
+    CompactVariant operator / (const CStr           & iValue) const { CompactVariant tmpCopy(*this); tmpCopy /= iValue; return tmpCopy; }
+    CompactVariant operator / (const Str            & iValue) const { CompactVariant tmpCopy(*this); tmpCopy /= iValue; return tmpCopy; }
+    const CompactVariant & operator += (const CompactVariant & iValue);
+    const CompactVariant & operator -= (const CompactVariant & iValue);
+    const CompactVariant & operator *= (const CompactVariant & iValue);
+    const CompactVariant & operator /= (const CompactVariant & iValue);
+    const CompactVariant & operator += (const bool           & iValue) { return (*this) += CompactVariant(static_cast<sint32>(iValue)); }
+    const CompactVariant & operator += (const uint8          & iValue) { return (*this) += CompactVariant(iValue); }
+    const CompactVariant & operator += (const uint16         & iValue) { return (*this) += CompactVariant(iValue); }
+    const CompactVariant & operator += (const uint32         & iValue) { return (*this) += CompactVariant(iValue); }
+    const CompactVariant & operator += (const uint64         & iValue) { return (*this) += CompactVariant(iValue); }
+    const CompactVariant & operator += (const sint8          & iValue) { return (*this) += CompactVariant(iValue); }
+    const CompactVariant & operator += (const sint16         & iValue) { return (*this) += CompactVariant(iValue); }
+    const CompactVariant & operator += (const sint32         & iValue) { return (*this) += CompactVariant(iValue); }
+    const CompactVariant & operator += (const sint64         & iValue) { return (*this) += CompactVariant(iValue); }
+    const CompactVariant & operator += (const float32        & iValue) { return (*this) += CompactVariant(iValue); }
+    const CompactVariant & operator += (const float64        & iValue) { return (*this) += CompactVariant(iValue); }
+    const CompactVariant & operator += (const CStr           & iValue) { return (*this) += CompactVariant(iValue); }
+    const CompactVariant & operator += (const Str            & iValue) { return (*this) += CompactVariant(iValue); }
+    const CompactVariant & operator -= (const bool           & iValue) { return (*this) -= CompactVariant(static_cast<sint32>(iValue)); }
+    const CompactVariant & operator -= (const uint8          & iValue) { return (*this) -= CompactVariant(iValue); }
+    const CompactVariant & operator -= (const uint16         & iValue) { return (*this) -= CompactVariant(iValue); }
+    const CompactVariant & operator -= (const uint32         & iValue) { return (*this) -= CompactVariant(iValue); }
+    const CompactVariant & operator -= (const uint64         & iValue) { return (*this) -= CompactVariant(iValue); }
+    const CompactVariant & operator -= (const sint8          & iValue) { return (*this) -= CompactVariant(iValue); }
+    const CompactVariant & operator -= (const sint16         & iValue) { return (*this) -= CompactVariant(iValue); }
+    const CompactVariant & operator -= (const sint32         & iValue) { return (*this) -= CompactVariant(iValue); }
+    const CompactVariant & operator -= (const sint64         & iValue) { return (*this) -= CompactVariant(iValue); }
+    const CompactVariant & operator -= (const float32        & iValue) { return (*this) -= CompactVariant(iValue); }
+    const CompactVariant & operator -= (const float64        & iValue) { return (*this) -= CompactVariant(iValue); }
+    const CompactVariant & operator -= (const CStr           & iValue) { return (*this) -= CompactVariant(iValue); }
+    const CompactVariant & operator -= (const Str            & iValue) { return (*this) -= CompactVariant(iValue); }
+    const CompactVariant & operator *= (const bool           & iValue) { return (*this) *= CompactVariant(static_cast<sint32>(iValue)); }
+    const CompactVariant & operator *= (const uint8          & iValue) { return (*this) *= CompactVariant(iValue); }
+    const CompactVariant & operator *= (const uint16         & iValue) { return (*this) *= CompactVariant(iValue); }
+    const CompactVariant & operator *= (const uint32         & iValue) { return (*this) *= CompactVariant(iValue); }
+    const CompactVariant & operator *= (const uint64         & iValue) { return (*this) *= CompactVariant(iValue); }
+    const CompactVariant & operator *= (const sint8          & iValue) { return (*this) *= CompactVariant(iValue); }
+    const CompactVariant & operator *= (const sint16         & iValue) { return (*this) *= CompactVariant(iValue); }
+    const CompactVariant & operator *= (const sint32         & iValue) { return (*this) *= CompactVariant(iValue); }
+    const CompactVariant & operator *= (const sint64         & iValue) { return (*this) *= CompactVariant(iValue); }
+    const CompactVariant & operator *= (const float32        & iValue) { return (*this) *= CompactVariant(iValue); }
+    const CompactVariant & operator *= (const float64        & iValue) { return (*this) *= CompactVariant(iValue); }
+    const CompactVariant & operator *= (const CStr           & iValue) { return (*this) *= CompactVariant(iValue); }
+    const CompactVariant & operator *= (const Str            & iValue) { return (*this) *= CompactVariant(iValue); }
+    const CompactVariant & operator /= (const bool           & iValue) { return (*this) /= CompactVariant(static_cast<sint32>(iValue)); }
+    const CompactVariant & operator /= (const uint8          & iValue) { return (*this) /= CompactVariant(iValue); }
+    const CompactVariant & operator /= (const uint16         & iValue) { return (*this) /= CompactVariant(iValue); }
+    const CompactVariant & operator /= (const uint32         & iValue) { return (*this) /= CompactVariant(iValue); }
+    const CompactVariant & operator /= (const uint64         & iValue) { return (*this) /= CompactVariant(iValue); }
+    const CompactVariant & operator /= (const sint8          & iValue) { return (*this) /= CompactVariant(iValue); }
+    const CompactVariant & operator /= (const sint16         & iValue) { return (*this) /= CompactVariant(iValue); }
+    const CompactVariant & operator /= (const sint32         & iValue) { return (*this) /= CompactVariant(iValue); }
+    const CompactVariant & operator /= (const sint64         & iValue) { return (*this) /= CompactVariant(iValue); }
+    const CompactVariant & operator /= (const float32        & iValue) { return (*this) /= CompactVariant(iValue); }
+    const CompactVariant & operator /= (const float64        & iValue) { return (*this) /= CompactVariant(iValue); }
+    const CompactVariant & operator /= (const CStr           & iValue) { return (*this) /= CompactVariant(iValue); }
+    const CompactVariant & operator /= (const Str            & iValue) { return (*this) /= CompactVariant(iValue); }
+
+    //operators ++ and --
+    const CompactVariant & operator ++ ()    { return (*this) += CompactVariant((uint8)1); } // prefix
+    const CompactVariant & operator -- ()    { return (*this) -= CompactVariant((uint8)1); } // prefix
+    const CompactVariant   operator ++ (int) { CompactVariant tmpCopy(*this); ++(*this); return tmpCopy; } // postfix
+    const CompactVariant   operator -- (int) { CompactVariant tmpCopy(*this); --(*this); return tmpCopy; } // postfix
+
+    //----------------------
+    //  compare functions
+    //----------------------
+    /// <summary>
+    /// Compare the internal value of the CompactVariant instance to another value using the same rules as Variant::compare().
+    /// </summary>
+    /// <param name="iValue">A second value used for comparing the internal value of the CompactVariant instance.</param>
+    /// <returns>Returns a negative value if this instance is smaller than the given value, 0 if both values are equal and a positive value otherwise.</returns>
+    int compare(const CompactVariant & iValue) const;
+
+    bool operator == (const CompactVariant & iValue) const { return compare(iValue) == 0; }
+    bool operator != (const CompactVariant & iValue) const { return compare(iValue) != 0; }
+    bool operator <  (const CompactVariant & iValue) const { return compare(iValue) <  0; }
+    bool operator >  (const CompactVariant & iValue) const { return compare(iValue) >  0; }
+    bool operator <= (const CompactVariant & iValue) const { return compare(iValue) <= 0; }
+    bool operator >= (const CompactVariant & iValue) const { return compare(iValue) >= 0; }
+
+    /// <summary>
+    /// Computes a hash of the value of the CompactVariant using the same rules as Variant::hash().
+    /// </summary>
+    /// <returns>Returns the hash of the value of the CompactVariant.</returns>
+    size_t hash() const;
+
+  private:
+    //-----------------
+    // private methods
+    //-----------------
+    class VariantView; //a Variant sharing the value of a CompactVariant without copying strings
+
+    /// <summary>
+    /// Returns true if the internal type is a boolean, a signed or an unsigned integer.
+    /// </summary>
+    bool isNativeInteger() const { return (mFormat <= Variant::SINT64); }
+
+    /// <summary>
+    /// Releases the internal string value (if any) and resets the CompactVariant to UINT8 0.
+    /// </summary>
+    void clear() { if (mFormat == Variant::STRING) releaseString(); mFormat = Variant::UINT8; mData.as_bits = 0; }
+    void releaseString();
+
+    //conversion of floating point and string values
+    bool convertBool() const;
+    void convert(uint8   & oValue) const;
+    void convert(uint16  & oValue) const;
+    void convert(uint32  & oValue) const;
+    void convert(uint64  & oValue) const;
+    void convert(sint8   & oValue) const;
+    void convert(sint16  & oValue) const;
+    void convert(sint32  & oValue) const;
+    void convert(sint64  & oValue) const;
+    void convert(float32 & oValue) const;
+    void convert(float64 & oValue) const;
+
+    /// <summary>
+    /// Moves the value of the CompactVariant to the given Variant. Strings are moved without being copied.
+    /// The CompactVariant is left as UINT8 0.
+    /// </summary>
+    void moveTo(Variant & oValue);
+
+    /// <summary>
+    /// Moves the value of the given Variant to the CompactVariant. Heap allocated strings are moved without being copied.
+    /// The Variant is left as UINT8 0.
+    /// </summary>
+    void moveFrom(Variant & iValue);
+
+    /// <summary>
+    /// Assigns the value of a CompactVariant to the given Variant. Strings are shared with the CompactVariant.
+    /// The Variant must not be modified and must be released with unborrow().
+    /// </summary>
+    static void borrow(const CompactVariant & iValue, Variant & oValue);
+    static void unborrow(Variant & ioValue);
+
+    //-----------------
+    // private attributes
+    //-----------------
+    Variant::VariantFormat mFormat;
+    Variant::VariantUnion mData; //mData.as_str is owned by the CompactVariant if mFormat is STRING.
+  };
+
+  /// <summary>
+  /// Exchanges the values of two CompactVariant instances.
+  /// </summary>
+  inline void swap(CompactVariant & iValue1, CompactVariant & iValue2) noexcept { iValue1.swap(iValue2); }
+
+} // End namespace
+
+namespace std
+{
+  /// <summary>
+  /// Allows CompactVariant to be used as the key of unordered containers.
+  /// </summary>
+  template<> struct hash<libVariant::CompactVariant>
+  {
+    size_t operator()(const libVariant::CompactVariant & iValue) const { return iValue.hash(); }
+  };
+}
+
+#endif //LIBVARIANT_COMPACT_VARIANT_H
@@ -0,0 +1,113 @@
+/**********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2018 Antoine Beauchamp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#ifndef LIBVARIANT_CSV_READER_H
+#define LIBVARIANT_CSV_READER_H
+
+//---------------
+// Include Files
+//---------------
+#include "libvariant/variant.h"
+#include "libvariant/variant_array.h"
+#include "libvariant/thread_pool.h"
+#include "libvariant/config.h"
+#include "libvariant/version.h"
+
+#include <vector>
+
+//-----------
+// Namespace
+//-----------
+
+namespace libVariant
+{
+  //------------------------
+  // Class Declarations
+  //------------------------
+
+  /// <summary>
+  /// Reads delimited text (RFC 4180) from caller buffers into columns of values.
+  /// </summary>
+  /// <remarks>
+  /// Each field is converted to its narrowest native format with the same rules as Variant::simplify(). Fields which cannot be simplified are
+  /// string values. The result is identical to calling Variant::setString() and Variant::simplify() on each field without creating Variant instances
+  /// or allocating memory per field. Quoted fields are converted like unquoted fields once their quotes are removed.
+  ///
+  /// Records end with "\n" or "\r\n". Empty lines are ignored. All records must have the same number of fields. A quote character is only
+  /// allowed at the beginning of a field, to start a quoted field in which delimiters, line endings and doubled quotes ("") are part of the value.
+  ///
+  /// Buffers larger than CHUNK_SIZE bytes are split at record boundaries in parts which are parsed by the threads of a ThreadPool.
+  /// The columns are identical for any number of threads.
+  /// </remarks>
+  class LIBVARIANT_EXPORT CsvReader
+  {
+  public:
+    /// <summary>
+    /// Minimum number of bytes parsed by a single thread.
+    /// </summary>
+    static const size_t CHUNK_SIZE = 1024*1024;
+
+    /// <summary>
+    /// Creates a reader of fields separated by the given delimiter.
+    /// </summary>
+    /// <param name="iDelimiter">The character separating the fields of a record. Use '\t' for tab separated values.</param>
+    /// <param name="iHeader">True if the first record read contains the names of the columns. See getColumnNames().</param>
+    explicit CsvReader(char iDelimiter = ',', bool iHeader = false);
+
+    /// <summary>
+    /// Parses the records of a buffer and appends their fields to the columns.
+    /// A record which ends after the buffer is not parsed unless iFinal is true: keep the bytes after the returned position,
+    /// append the next bytes of the input and read again.
+    /// </summary>
+    /// <param name="iBuffer">The characters to parse.</param>
+    /// <param name="iSize">The number of characters of iBuffer.</param>
+    /// <param name="iFinal">True if iBuffer ends with the last record of the input, which may not end with a line ending.</param>
+    /// <param name="ioColumns">The columns of the records. When empty, the columns are created from the first record.</param>
+    /// <param name="iPool">The threads parsing the records.</param>
+    /// <returns>Returns the number of bytes of the parsed records. Parsing stops at the first invalid record, see hasError().</returns>
+    size_t read(const char * iBuffer, size_t iSize, bool iFinal, std::vector<VariantArray> & ioColumns, ThreadPool & iPool = ThreadPool::getDefault());
+
+    /// <summary>
+    /// Returns true if the last call to read() stopped at an invalid record: a record with a different number of fields,
+    /// a quote in an unquoted field, characters after a quoted field or an unterminated quoted field at the end of the input.
+    /// </summary>
+    bool hasError() const { return mError; }
+
+    /// <summary>
+    /// Returns the names of the columns read from the header record.
+    /// </summary>
+    const std::vector<Str> & getColumnNames() const { return mColumnNames; }
+
+  private:
+    class Parser;
+
+    char mDelimiter;
+    bool mHeaderPending;
+    bool mError;
+    std::vector<Str> mColumnNames;
+  };
+
+} // End namespace
+
+#endif //LIBVARIANT_CSV_READER_H
@@ -0,0 +1,121 @@
+/**********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2018 Antoine Beauchamp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#ifndef LIBVARIANT_CSV_WRITER_H
+#define LIBVARIANT_CSV_WRITER_H
+
+//---------------
+// Include Files
+//---------------
+#include "libvariant/variant.h"
+#include "libvariant/variant_array.h"
+#include "libvariant/config.h"
+#include "libvariant/version.h"
+
+#include <ostream>
+#include <vector>
+
+//-----------
+// Namespace
+//-----------
+
+namespace libVariant
+{
+  //------------------------
+  // Class Declarations
+  //------------------------
+
+  /// <summary>
+  /// Writes values as delimited text (RFC 4180) into an output stream.
+  /// </summary>
+  /// <remarks>
+  /// Values are formatted like Variant::getString() does, directly into a buffer of BUFFER_SIZE bytes which is written to the stream
+  /// with std::ostream::write() once full. No memory is allocated per value.
+  /// String values which are empty or contain the delimiter, a quote or a line ending are quoted and their quotes are doubled.
+  /// Records end with "\n". Text written by CsvWriter is read by CsvReader.
+  /// </remarks>
+  class LIBVARIANT_EXPORT CsvWriter
+  {
+  public:
+    /// <summary>
+    /// Size of the buffer written to the stream at once.
+    /// </summary>
+    static const size_t BUFFER_SIZE = 256*1024;
+
+    /// <summary>
+    /// Creates a writer of fields separated by the given delimiter.
+    /// </summary>
+    /// <param name="iStream">The output stream.</param>
+    /// <param name="iDelimiter">The character separating the fields of a record. Use '\t' for tab separated values.</param>
+    explicit CsvWriter(std::ostream & iStream, char iDelimiter = ',');
+
+    /// <summary>
+    /// Flushes the buffer to the stream.
+    /// </summary>
+    ~CsvWriter();
+
+    /// <summary>
+    /// Writes a value as the next field of the current record.
+    /// </summary>
+    void write(const Variant & iValue);
+
+    /// <summary>
+    /// Writes the value at the given index of an array as the next field of the current record, without creating a Variant.
+    /// </summary>
+    void write(const VariantArray & iValues, size_t iIndex);
+
+    /// <summary>
+    /// Ends the current record.
+    /// </summary>
+    void endRecord();
+
+    /// <summary>
+    /// Writes a record for each row of the given columns. All columns must have the same size.
+    /// </summary>
+    void writeColumns(const std::vector<VariantArray> & iColumns);
+
+    /// <summary>
+    /// Writes the buffer to the stream.
+    /// </summary>
+    /// <returns>Returns true if the stream is still valid. Returns false otherwise.</returns>
+    bool flush();
+
+  private:
+    CsvWriter(const CsvWriter &);
+    CsvWriter & operator = (const CsvWriter &);
+
+    void beginField(size_t iMaxLength);
+    void writeNative(uint8 iFormat, const Variant::VariantUnion & iValue);
+    void writeString(const char * iValue, size_t iLength);
+
+    std::ostream & mStream;
+    char mDelimiter;
+    bool mFirstField;
+    std::vector<char> mBuffer;
+    size_t mUsed;
+  };
+
+} // End namespace
+
+#endif //LIBVARIANT_CSV_WRITER_H
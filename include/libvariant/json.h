@@ -0,0 +1,251 @@
+/**********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2018 Antoine Beauchamp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#ifndef LIBVARIANT_JSON_H
+#define LIBVARIANT_JSON_H
+
+//---------------
+// Include Files
+//---------------
+#include "libvariant/variant.h"
+#include "libvariant/config.h"
+#include "libvariant/version.h"
+
+#include <ostream>
+#include <vector>
+
+//-----------
+// Namespace
+//-----------
+
+namespace libVariant
+{
+  //------------------------
+  // Class Declarations
+  //------------------------
+
+  /// <summary>
+  /// A JSON value: null, a scalar Variant value, an array of values or an object of named values.
+  /// </summary>
+  /// <remarks>
+  /// JSON booleans are BOOL values, integers are the narrowest integer format which can hold them (same order as Variant::simplify()),
+  /// other numbers are FLOAT64 values and strings are STRING values. Integers which do not fit in 64 bits are FLOAT64 values.
+  /// Members of an object keep their order. Their names are STRING Variants.
+  /// </remarks>
+  class LIBVARIANT_EXPORT JsonValue
+  {
+  public:
+    enum JsonType
+    {
+      JSON_NULL,
+      JSON_SCALAR,
+      JSON_ARRAY,
+      JSON_OBJECT,
+    };
+
+    /// <summary>
+    /// Creates a null value.
+    /// </summary>
+    JsonValue();
+
+    /// <summary>
+    /// Creates an empty array or object, or a null value.
+    /// </summary>
+    explicit JsonValue(JsonType iType);
+
+    /// <summary>
+    /// Creates a scalar value.
+    /// </summary>
+    JsonValue(const Variant & iValue);
+
+    JsonType getType() const { return mType; }
+    bool isNull  () const { return mType == JSON_NULL;   }
+    bool isScalar() const { return mType == JSON_SCALAR; }
+    bool isArray () const { return mType == JSON_ARRAY;  }
+    bool isObject() const { return mType == JSON_OBJECT; }
+
+    /// <summary>
+    /// Returns the Variant of a scalar value.
+    /// </summary>
+    const Variant & getValue() const { return mValue; }
+
+    /// <summary>
+    /// Returns the number of elements of an array or the number of members of an object.
+    /// </summary>
+    size_t size() const { return mElements.size(); }
+
+    /// <summary>
+    /// Returns the element of an array or the value of the member of an object at the given index.
+    /// </summary>
+    const JsonValue & operator[](size_t iIndex) const { return mElements[iIndex]; }
+    JsonValue & operator[](size_t iIndex) { return mElements[iIndex]; }
+
+    /// <summary>
+    /// Returns the name of the member of an object at the given index.
+    /// </summary>
+    const Variant & getName(size_t iIndex) const { return mNames[iIndex]; }
+
+    /// <summary>
+    /// Returns the value of the first member of an object with the given name.
+    /// </summary>
+    /// <returns>Returns the value of the member. Returns NULL if the object does not have a member with the given name.</returns>
+    const JsonValue * find(const char * iName) const;
+
+    /// <summary>
+    /// Appends an element to an array.
+    /// </summary>
+    /// <returns>Returns the new element.</returns>
+    JsonValue & append(const JsonValue & iValue);
+
+    /// <summary>
+    /// Appends a member to an object.
+    /// </summary>
+    /// <returns>Returns the value of the new member.</returns>
+    JsonValue & append(const char * iName, const JsonValue & iValue);
+
+    /// <summary>
+    /// Copies the characters of all string views of the value and its children (see Variant::materialize()).
+    /// The value is then independent of the buffer it was read from.
+    /// </summary>
+    void materialize();
+
+  private:
+    friend class JsonReader; //builds values in place
+
+    JsonType mType;
+    Variant mValue;
+    std::vector<JsonValue> mElements;
+    std::vector<Variant> mNames;
+  };
+
+  /// <summary>
+  /// Reads JSON documents (RFC 8259) from caller buffers.
+  /// </summary>
+  /// <remarks>
+  /// String characters are located 8 bytes at a time. With readView(), strings without escape sequences reference the characters
+  /// of the buffer without copying them.
+  /// </remarks>
+  class LIBVARIANT_EXPORT JsonReader
+  {
+  public:
+    /// <summary>
+    /// Maximum nesting level of arrays and objects.
+    /// </summary>
+    static const size_t MAX_DEPTH = 512;
+
+    JsonReader();
+
+    /// <summary>
+    /// Reads a complete document. The characters of string values are copied.
+    /// </summary>
+    /// <returns>Returns true if the buffer contains a valid document. Returns false otherwise, see getErrorPosition().</returns>
+    bool read(const char * iBuffer, size_t iSize, JsonValue & oValue);
+
+    /// <summary>
+    /// Reads a complete document. String values and names without escape sequences reference the characters of the buffer
+    /// (see Variant::setStringView()) and are valid until the buffer is modified or released.
+    /// </summary>
+    bool readView(const char * iBuffer, size_t iSize, JsonValue & oValue);
+
+    /// <summary>
+    /// Returns the position of the invalid character of the last document read, or the size of the buffer if the document is truncated.
+    /// </summary>
+    size_t getErrorPosition() const { return mErrorPosition; }
+
+  private:
+    JsonReader(const JsonReader &);
+    JsonReader & operator = (const JsonReader &);
+
+    bool readDocument(const char * iBuffer, size_t iSize, bool iView, JsonValue & oValue);
+    bool readValue(JsonValue & oValue, size_t iDepth);
+    bool readString(Variant & oValue);
+    bool readNumber(Variant & oValue);
+    bool readLiteral(const char * iLiteral, size_t iLength);
+    bool fail();
+    void skipWhitespace();
+
+    const char * mBegin;
+    const char * mPosition;
+    const char * mEnd;
+    bool mView;
+    size_t mErrorPosition;
+    std::vector<char> mUnescaped;
+  };
+
+  /// <summary>
+  /// Writes JSON documents into an output stream.
+  /// </summary>
+  /// <remarks>
+  /// Documents are written without whitespace, directly into a buffer of BUFFER_SIZE bytes which is written to the stream
+  /// with std::ostream::write() once full. Floating point values are written with the fewest digits that parse back to the identical value
+  /// and always contain a decimal point or an exponent. Infinite and NaN values, which JSON does not support, are written as null.
+  /// </remarks>
+  class LIBVARIANT_EXPORT JsonWriter
+  {
+  public:
+    /// <summary>
+    /// Size of the buffer written to the stream at once.
+    /// </summary>
+    static const size_t BUFFER_SIZE = 64*1024;
+
+    explicit JsonWriter(std::ostream & iStream);
+
+    /// <summary>
+    /// Flushes the buffer to the stream.
+    /// </summary>
+    ~JsonWriter();
+
+    /// <summary>
+    /// Writes a document.
+    /// </summary>
+    void write(const JsonValue & iValue);
+
+    /// <summary>
+    /// Writes a scalar value as a document.
+    /// </summary>
+    void write(const Variant & iValue);
+
+    /// <summary>
+    /// Writes the buffer to the stream.
+    /// </summary>
+    /// <returns>Returns true if the stream is still valid. Returns false otherwise.</returns>
+    bool flush();
+
+  private:
+    JsonWriter(const JsonWriter &);
+    JsonWriter & operator = (const JsonWriter &);
+
+    void reserve(size_t iSize);
+    void writeChars(const char * iValue, size_t iLength);
+    void writeScalar(const Variant & iValue);
+    void writeString(const char * iValue, size_t iLength);
+
+    std::ostream & mStream;
+    std::vector<char> mBuffer;
+    size_t mUsed;
+  };
+
+} // End namespace
+
+#endif //LIBVARIANT_JSON_H
@@ -0,0 +1,131 @@
+/**********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2018 Antoine Beauchamp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#ifndef LIBVARIANT_MAPPEDVARIANTARRAY_H
+#define LIBVARIANT_MAPPEDVARIANTARRAY_H
+
+//---------------
+// Include Files
+//---------------
+#include "libvariant/variant.h"
+#include "libvariant/variant_array.h"
+#include "libvariant/config.h"
+#include "libvariant/version.h"
+
+//-----------
+// Namespace
+//-----------
+
+namespace libVariant
+{
+  //------------------------
+  // Class Declarations
+  //------------------------
+
+  /// <summary>
+  /// A read-only array of values mapped in memory from a file written by save().
+  /// </summary>
+  /// <remarks>
+  /// The file contains a header followed by the columns of a VariantArray: the format of each value, the native value of each value
+  /// and the characters of all string values. The columns are used directly from the mapped memory: opening a file does not copy the values
+  /// and the memory pages are shared by all processes which map the same file. String values are views of the mapped memory.
+  /// Files are written with the byte order of the platform and are rejected by platforms with a different byte order.
+  /// open() validates the header, the format of every value and the bounds of every string value once: corrupted files are rejected.
+  /// The mapped file must not be modified while it is open.
+  /// </remarks>
+  class LIBVARIANT_EXPORT MappedVariantArray
+  {
+  public:
+    MappedVariantArray();
+    ~MappedVariantArray();
+
+    /// <summary>
+    /// Writes the values of an array into a file which can be opened with open().
+    /// </summary>
+    /// <returns>Returns true if the file is written. Returns false otherwise.</returns>
+    static bool save(const VariantArray & iValues, const char * iPath);
+
+    /// <summary>
+    /// Maps a file written by save() in memory. The previous file is closed.
+    /// </summary>
+    /// <returns>Returns true if the file is mapped. Returns false if the file cannot be mapped, is not a valid file or is corrupted.</returns>
+    bool open(const char * iPath);
+
+    /// <summary>
+    /// Unmaps the file. Views returned by getView() are invalid once the file is closed.
+    /// </summary>
+    void close();
+
+    /// <summary>
+    /// Returns true if a file is mapped.
+    /// </summary>
+    bool isOpen() const { return mMapping != NULL; }
+
+    /// <summary>
+    /// Returns the number of values of the file.
+    /// </summary>
+    size_t size() const { return mSize; }
+    bool empty() const { return mSize == 0; }
+
+    /// <summary>
+    /// Returns the internal format of the value at the given index.
+    /// </summary>
+    Variant::VariantFormat getFormat(size_t iIndex) const { return static_cast<Variant::VariantFormat>(mFormats[iIndex]); }
+
+    /// <summary>
+    /// Returns a copy of the value at the given index.
+    /// </summary>
+    Variant get(size_t iIndex) const;
+
+    /// <summary>
+    /// Returns a Variant which borrows the characters of the value at the given index from the mapped memory (see Variant::setStringView()).
+    /// The returned Variant is valid until the file is closed.
+    /// </summary>
+    Variant getView(size_t iIndex) const;
+
+    //raw column access. See VariantArray.
+    const uint8 * getFormats() const { return mFormats; }
+    const Variant::VariantUnion * getValues() const { return mValues; }
+
+    /// <summary>
+    /// Returns the characters of the string value at the given index, in the mapped memory.
+    /// </summary>
+    const char * getStringBuffer(size_t iIndex, size_t & oLength) const;
+
+  private:
+    MappedVariantArray(const MappedVariantArray &);
+    MappedVariantArray & operator = (const MappedVariantArray &);
+
+    struct Mapping;
+    Mapping * mMapping;
+    size_t mSize;
+    const uint8 * mFormats;
+    const Variant::VariantUnion * mValues;
+    const char * mStrings;
+    size_t mStringsSize;
+  };
+
+} // End namespace
+
+#endif //LIBVARIANT_MAPPEDVARIANTARRAY_H
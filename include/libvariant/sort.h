@@ -0,0 +1,99 @@
+/**********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2018 Antoine Beauchamp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#ifndef LIBVARIANT_SORT_H
+#define LIBVARIANT_SORT_H
+
+//---------------
+// Include Files
+//---------------
+#include "libvariant/variant.h"
+#include "libvariant/variant_array.h"
+#include "libvariant/config.h"
+#include "libvariant/version.h"
+
+#include <vector>
+
+//-----------
+// Namespace
+//-----------
+
+namespace libVariant
+{
+  //------------------------
+  // Class Declarations
+  //------------------------
+
+  /// <summary>
+  /// Sorts a range of Variant values or the values of a VariantArray.
+  /// </summary>
+  /// <remarks>
+  /// Each value is encoded into a fixed size key whose bytes are in the same order as the values.
+  /// The keys are sorted with a radix sort which does not call Variant::compare(). Strings whose first bytes are identical are then sorted by their characters.
+  ///
+  /// Variant::compare() is not a total order: it compares numbers with C++ conversion rules (ie: sint32 -1 is larger than uint32 1),
+  /// compares numeric strings by characters with other strings but by value with numbers, and NaN is equal to all values.
+  /// Values are sorted in the following order instead, which matches Variant::compare() for any values of the same kind:
+  ///  1) numbers, including strings which are numbers (see Variant::simplify()), by value regardless of their format.
+  ///  2) NaN values.
+  ///  3) strings which are not numbers, by characters like Variant::compare().
+  /// The sort is stable: equal values keep their original order (ie: 1, 1.0 and "1").
+  /// </remarks>
+  class LIBVARIANT_EXPORT Sort
+  {
+  public:
+    /// <summary>
+    /// Sorts a range of values.
+    /// </summary>
+    /// <param name="ioValues">The first value of the range.</param>
+    /// <param name="iSize">The number of values of the range.</param>
+    static void sort(Variant * ioValues, size_t iSize);
+
+    /// <summary>
+    /// Sorts the values of an array. String characters are not moved.
+    /// </summary>
+    static void sort(VariantArray & ioValues);
+
+    /// <summary>
+    /// Computes the sorted order of a range of values without moving the values.
+    /// </summary>
+    /// <param name="iValues">The first value of the range.</param>
+    /// <param name="iSize">The number of values of the range.</param>
+    /// <param name="oOrder">The indexes of the values in sorted order (output). oOrder[0] is the index of the smallest value.</param>
+    static void getOrder(const Variant * iValues, size_t iSize, std::vector<size_t> & oOrder);
+    static void getOrder(const VariantArray & iValues, std::vector<size_t> & oOrder);
+
+    /// <summary>
+    /// Compares two values in the order of sort().
+    /// </summary>
+    /// <returns>Returns a negative value if iValue1 is sorted before iValue2, a positive value if iValue1 is sorted after iValue2 and 0 if the values are equal.</returns>
+    static int compare(const Variant & iValue1, const Variant & iValue2);
+
+  private:
+    struct Kernels;
+  };
+
+} // End namespace
+
+#endif //LIBVARIANT_SORT_H
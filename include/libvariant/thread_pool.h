@@ -0,0 +1,114 @@
+/**********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2018 Antoine Beauchamp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+
+#ifndef LIBVARIANT_THREAD_POOL_H
+#define LIBVARIANT_THREAD_POOL_H
+
+//---------------
+// Include Files
+//---------------
+#include "libvariant/config.h"
+#include "libvariant/version.h"
+#include <stddef.h> // size_t
+#include <functional>
+
+//-----------
+// Namespace
+//-----------
+
+namespace libVariant
+{
+  //------------------------
+  // Class Declarations
+  //------------------------
+
+  /// <summary>
+  /// A fixed set of threads which process the tasks of a parallel loop.
+  /// The calling thread also processes tasks and a pool of a single thread processes all tasks on the calling thread.
+  /// </summary>
+  /// <remarks>
+  /// Each worker thread has its own current allocator (see Allocator::getCurrent()) which is the default allocator.
+  /// </remarks>
+  class LIBVARIANT_EXPORT ThreadPool
+  {
+  public:
+    /// <summary>
+    /// Creates a pool with one thread per hardware thread.
+    /// </summary>
+    ThreadPool();
+
+    /// <summary>
+    /// Creates a pool with the given number of threads, including the calling thread of parallelFor().
+    /// </summary>
+    /// <param name="iNumThreads">The number of threads processing tasks. 0 selects one thread per hardware thread.</param>
+    explicit ThreadPool(size_t iNumThreads);
+
+    /// <summary>
+    /// Waits for the running loop, if any, and stops the worker threads.
+    /// </summary>
+    ~ThreadPool();
+
+    /// <summary>
+    /// Returns the number of threads processing tasks, including the calling thread.
+    /// </summary>
+    size_t getNumThreads() const;
+
+    /// <summary>
+    /// Calls a function for each index of the range [0, iCount) and returns once all calls are completed.
+    /// Tasks are distributed dynamically to the threads of the pool in any order.
+    /// </summary>
+    /// <remarks>
+    /// Loops from different threads are processed one after the other.
+    /// A loop started from a task of the same pool is processed on the calling thread.
+    /// If a task throws an exception, the remaining tasks are still processed and the first exception is thrown again to the caller.
+    /// </remarks>
+    /// <param name="iCount">The number of tasks.</param>
+    /// <param name="iTask">The function called with the index of each task.</param>
+    void parallelFor(size_t iCount, const std::function<void(size_t)> & iTask);
+
+    //----------------
+    // static methods
+    //----------------
+
+    /// <summary>
+    /// Returns a pool shared by the whole process with one thread per hardware thread.
+    /// </summary>
+    static ThreadPool & getDefault();
+
+  private:
+    ThreadPool(const ThreadPool &);
+    ThreadPool & operator = (const ThreadPool &);
+
+    struct State;
+
+    void start(size_t iNumThreads);
+    void processTasks();
+
+    State * mState;
+  };
+
+} // End namespace
+
+#endif //LIBVARIANT_THREAD_POOL_H
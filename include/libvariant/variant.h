@@ -32,6 +32,10 @@
 #include "libvariant/variant_types.h"
 #include "libvariant/config.h"
 #include "libvariant/version.h"
+#include <atomic>
+#include <utility> // std::declval
+#include <type_traits> // std::remove_cv
+#include <functional> // std::hash
 
 //-----------
 // Namespace
@@ -97,11 +101,35 @@ namespace libVariant
       IGNORE, //Ignore divisions by zero. Internal value is not modified.
     };
 
+    /// <summary>
+    /// An enum which defines how floating point values are converted to string.
+    /// </summary>
+    enum FloatFormattingPolicy { 
+      FIXED_PRECISION,      //Default behavior. Floating point values are printed with 8 (float32) or 15 (float64) significant digits.
+      SHORTEST_ROUND_TRIP,  //Floating point values are printed with the fewest digits that parse back to the identical value.
+    };
+
+    /// <summary>
+    /// Size of a buffer large enough to hold the string representation of any non-STRING Variant, including the null terminator.
+    /// </summary>
+    /// <seealso cref="Variant::getString(char *, size_t)"/>
+    static const size_t NATIVE_STRING_BUFFER_SIZE = 32;
+
+    /// <summary>
+    /// Characters of a STRING Variant. Used by string views and by visit().
+    /// </summary>
+    struct StringView
+    {
+      const char * buffer;  //not null terminated
+      size_t length;
+    };
+
     //----------------------
     // constructors methods
     //----------------------
     Variant();
     Variant(const Variant            & iValue); //copy ctor
+    Variant(Variant                 && iValue) noexcept; //move ctor
     Variant(const CStr               & iValue);
     Variant(const Str                & iValue);
     Variant(const bool               & iValue);
@@ -135,6 +163,19 @@ namespace libVariant
     /// </returns>
     static DivisionByZeroPolicy getDivisionByZeroPolicy();
 
+    /// <summary>
+    /// Sets the FloatFormatting policy used by getString() for FLOAT32 and FLOAT64 values.
+    /// The policy does not change how string values are simplified, compared or hashed.
+    /// </summary>
+    /// <param name="iFloatFormattingPolicy">The new value for the FloatFormatting policy.</param>
+    static void setFloatFormattingPolicy(FloatFormattingPolicy iFloatFormattingPolicy);
+
+    /// <summary>
+    /// Gets the FloatFormatting policy.
+    /// </summary>
+    /// <returns>Returns the FloatFormatting policy used by getString().</returns>
+    static FloatFormattingPolicy getFloatFormattingPolicy();
+
     /// <summary>
     /// Defines if two VariantFormat can be compared with each other using native c++ operators: <, <=, >, >=, ==, !=
     /// </summary>
@@ -149,6 +190,13 @@ namespace libVariant
     // public methods
     //----------------
 
+    /// <summary>
+    /// Exchanges the internal format and value of the Variant instance with the given Variant.
+    /// Heap allocated strings are exchanged by pointer and are never copied.
+    /// </summary>
+    /// <param name="iValue">The Variant to exchange values with.</param>
+    void swap(Variant & iValue) noexcept;
+
     //----------------------
     // getters methods
     //----------------------
@@ -165,6 +213,18 @@ namespace libVariant
     virtual float64  getFloat64() const;
     virtual Str      getString()  const;
 
+    /// <summary>
+    /// Writes the string representation of the internal value to the given buffer without allocating memory.
+    /// </summary>
+    /// <remarks>
+    /// Like snprintf(), the output is truncated to iSize-1 characters and always null terminated if iSize is not 0.
+    /// The value of a non-STRING Variant always fits in a buffer of NATIVE_STRING_BUFFER_SIZE bytes.
+    /// </remarks>
+    /// <param name="oBuffer">The output buffer.</param>
+    /// <param name="iSize">The size in bytes of the output buffer.</param>
+    /// <returns>Returns the length of the string representation of the internal value, excluding the null terminator.</returns>
+    virtual size_t   getString(char * oBuffer, size_t iSize) const;
+
     //----------------------
     // setters methods
     //----------------------
@@ -215,6 +275,39 @@ namespace libVariant
     virtual void get(float64      & iValue) const { iValue = getFloat64(); }
     virtual void get(Str          & iValue) const { iValue = getString (); }
 
+    //----------------------
+    //   template accessors
+    //----------------------
+
+    /// <summary>
+    /// Returns the internal value converted to the given type.
+    /// Same result as the matching getter (ie: get<uint32>() and getUInt32()) but the method is not virtual and is inlined.
+    /// Only string values and conversions between integers and floating point values require a function call.
+    /// </summary>
+    /// <typeparam name="T">One of bool, uint8, uint16, uint32, uint64, sint8, sint16, sint32, sint64, float32, float64 or Str.</typeparam>
+    /// <returns>Returns the internal value converted to T.</returns>
+    template <typename T> T get() const;
+
+    /// <summary>
+    /// Assigns the given value to the Variant. The type must be explicitly given (ie: set<uint32>(5)).
+    /// Same result as the matching setter (ie: setUInt32()) but the method is not virtual and is inlined.
+    /// </summary>
+    /// <typeparam name="T">One of bool, uint8, uint16, uint32, uint64, sint8, sint16, sint32, sint64, float32, float64, CStr or Str.</typeparam>
+    /// <param name="iValue">The new value of the Variant.</param>
+    template <typename T> void set(const typename std::remove_cv<T>::type & iValue);
+
+    /// <summary>
+    /// Calls the given function object with the internal value as its native type.
+    /// The internal format is tested only once.
+    /// </summary>
+    /// <remarks>
+    /// The visitor is called with one of bool, uint8, uint16, uint32, uint64, sint8, sint16, sint32, sint64, float32, float64
+    /// or StringView for STRING Variants. All overloads of the visitor must return the same type.
+    /// </remarks>
+    /// <param name="iVisitor">The function object called with the internal value.</param>
+    /// <returns>Returns the value returned by the visitor.</returns>
+    template <typename F> auto visit(F && iVisitor) const -> decltype(iVisitor(std::declval<const bool &>()));
+
     /// <summary>Getter function to know the internal type of the Variant instance.</summary>
     /// <returns>An enum of type VariantFormat which defines the internal type of the Variant instance.</returns>
     virtual const VariantFormat & getFormat() const;
@@ -273,6 +366,44 @@ namespace libVariant
     /// <returns>Returns true if the internal value is a negative value. Returns false otherwise.</returns>
     bool isNegative() const;
 
+    /// <summary>
+    /// Assigns a borrowed string value to the Variant without copying the characters.
+    /// The Variant is a STRING Variant which references the given characters instead of owning a copy of them.
+    /// The characters must remain valid and unmodified for the lifetime of the Variant and its copies.
+    /// </summary>
+    /// <remarks>
+    /// The characters are copied when the string value is modified (ie: operator +=) or when materialize() is called.
+    /// Copies of the Variant reference the same characters.
+    /// </remarks>
+    /// <param name="iValue">The borrowed characters. The characters does not need to be null terminated.</param>
+    /// <param name="iLength">The number of characters of iValue.</param>
+    void setStringView(const char * iValue, size_t iLength);
+
+    /// <summary>
+    /// Defines if the Variant references borrowed characters assigned with setStringView().
+    /// </summary>
+    /// <returns>Returns true if the internal value is a borrowed string value. Returns false otherwise.</returns>
+    bool isStringView() const;
+
+    /// <summary>
+    /// Copies the borrowed characters of a string view into storage owned by the Variant.
+    /// The Variant no longer references the borrowed characters. Does nothing if the Variant is not a string view.
+    /// </summary>
+    void materialize();
+
+    /// <summary>
+    /// Computes a hash of the value of the Variant which is consistent with compare().
+    /// Numeric values are hashed by value regardless of their format: uint8(5), sint64(5), float64(5.0) and true (1) have the same hash.
+    /// A string value which can be simplified is hashed like its simplified value. Other string values are hashed by characters.
+    /// </summary>
+    /// <remarks>
+    /// compare() converts both values to a common type. Values which are only equal because that conversion rounds an integer
+    /// to a floating point type (ie: uint32(16777217) and float32(16777216)) or wraps a negative value to an unsigned type
+    /// (ie: sint32(-1) and uint32(4294967295)) may have different hashes.
+    /// </remarks>
+    /// <returns>Returns the hash of the value of the Variant.</returns>
+    size_t hash() const;
+
     //----------------------
     //   operator= ()
     //----------------------
@@ -302,6 +433,15 @@ namespace libVariant
     /// </remarks>
     virtual const Variant & operator = (const Variant & iValue);
 
+    /// <summary>
+    /// Moves the value of the given Variant to the Variant instance.
+    /// The internal type of the Variant instance is modified to the same type as the new value.
+    /// Heap allocated strings are moved without being copied.
+    /// </summary>
+    /// <param name="iValue">The Variant to move from. The Variant is left with the same value as a default constructed Variant.</param>
+    /// <returns>Returns the Variant own instance (itself).</returns>
+    virtual const Variant & operator = (Variant && iValue) noexcept;
+
     //----------------------
     //   operator+ ()
     //----------------------
@@ -635,6 +775,50 @@ namespace libVariant
     };
 
   private:
+    friend class VariantAccess; //internal access to the raw format and value for the other modules of the library
+
+    /// <summary>
+    /// Applies a math operator to a Variant for a given pair of internal formats. See processOperator().
+    /// </summary>
+    typedef void (*OperatorKernel)(Variant & ioLocal, const Variant & iValue);
+    struct OperatorKernels;
+
+    //--------------------------
+    // private enums & constants
+    //--------------------------
+
+    /// <summary>
+    /// Defines where the characters of a STRING Variant are stored.
+    /// </summary>
+    enum StringStorage
+    {
+      STRING_INLINE,  //Characters are stored within the Variant instance. No heap allocation required.
+      STRING_HEAP,    //Characters are stored in a heap allocated Str instance owned by the Variant. See CompactVariant.
+      STRING_VIEW,    //Characters are borrowed from the caller. See setStringView().
+      STRING_SHARED,  //Characters are stored in a heap allocated SharedString shared by all copies of the Variant.
+    };
+
+    /// <summary>
+    /// An immutable string value with an atomic reference count.
+    /// Copies of a STRING Variant share the same instance. The string is copied when one of the Variants modifies it.
+    /// The memory is allocated by the current Allocator of the thread. See Allocator::getCurrent().
+    /// </summary>
+    struct SharedString;
+
+    /// <summary>
+    /// Maximum length (in bytes, excluding the null terminator) of a string value that can be stored within the Variant instance.
+    /// </summary>
+    static const size_t INLINE_STRING_CAPACITY = 15;
+
+    /// <summary>
+    /// Special values of mSimplifiedFormat. Any other value is the VariantFormat of the simplified string value.
+    /// </summary>
+    enum SimplifiedState
+    {
+      SIMPLIFIED_UNKNOWN = 0xFF,  //The string value was not parsed yet.
+      SIMPLIFIED_BUSY    = 0xFE,  //The string value is being parsed by another thread.
+    };
+
     //-----------------
     // private methods
     //-----------------
@@ -645,6 +829,24 @@ namespace libVariant
     /// </summary>
     void clear();
 
+    /// <summary>
+    /// Returns true if the internal type is a boolean, a signed or an unsigned integer.
+    /// </summary>
+    bool isNativeInteger() const { return (mFormat <= Variant::SINT64); }
+
+    /// <summary>
+    /// Changes the internal format and zeroize the internal value.
+    /// The string value, if any, is destroyed. Used by the inlined setters.
+    /// </summary>
+    /// <param name="iFormat">The new format of the Variant. Must not be STRING.</param>
+    void resetNative(const VariantFormat & iFormat)
+    {
+      if (mFormat == Variant::STRING)
+        clear();
+      mFormat = iFormat;
+      mData.as_bits = 0;
+    }
+
     /// <summary>
     /// Converts the internal format of the Variant instance to string.
     /// An empty string is assigned to the Variant as its internal value.
@@ -652,16 +854,81 @@ namespace libVariant
     void stringnify();
 
     /// <summary>
-    /// Apply one of the following operator to the Variant:
-    /// operator+=, operator-=, operator*= or operator/=
+    /// Returns a pointer to the characters of a STRING Variant.
+    /// The characters are null terminated unless the Variant is a string view. Use getStringLength() to know the number of characters.
     /// </summary>
-    const Variant & processOperator(MATH_OPERATOR iOperator, const Variant & iValue);
+    /// <returns>Returns a pointer to the internal characters. Returns NULL if the internal format is not STRING.</returns>
+    const char * getStringBuffer() const;
+
+    /// <summary>
+    /// Returns the length (in bytes) of the internal string value of a STRING Variant.
+    /// </summary>
+    /// <returns>Returns the length of the internal string value. Returns 0 if the internal format is not STRING.</returns>
+    size_t getStringLength() const;
+
+    /// <summary>
+    /// Assigns the given null terminated character sequence as the internal value.
+    /// Short strings are stored inline. Long strings are allocated on the heap.
+    /// </summary>
+    /// <param name="iValue">The new string value of the Variant. Can point to the Variant's own characters.</param>
+    void assignString(const char * iValue);
 
     /// <summary>
-    /// Update the internal type of the Variant to match the internal value.
+    /// Appends the given character sequence to the internal string value of a STRING Variant.
     /// </summary>
-    /// <seealso cref="processInternalValueSaturation"/>
-    void processInternalTypePromotion();
+    /// <param name="iValue">The characters to append. Can point to the Variant's own characters.</param>
+    /// <param name="iLength">The length of iValue in bytes.</param>
+    void appendString(const char * iValue, size_t iLength);
+
+    /// <summary>
+    /// Moves the string value of a STRING Variant to a heap allocated Str instance owned by the caller.
+    /// Heap strings are not copied. The Variant is cleared.
+    /// </summary>
+    /// <returns>Returns a new Str instance which must be deleted by the caller.</returns>
+    Str * detachString();
+
+    /// <summary>
+    /// Returns true if the simplified value of the string can be cached within the Variant instance.
+    /// The cached value is stored after the characters of short inline strings, after the pointer of heap strings
+    /// or after a string view if it fits.
+    /// </summary>
+    bool hasSimplifiedValueSlot() const;
+
+    /// <summary>
+    /// Identifies the narrowest native format and value which matches the internal string value of a STRING Variant.
+    /// The result is the same as calling simplify() on a copy of the Variant. It is cached until the string value is modified.
+    /// </summary>
+    /// <param name="oFormat">The simplified format (output).</param>
+    /// <param name="oValue">The simplified value (output).</param>
+    /// <returns>Returns true if the string value can be simplified. Returns false otherwise.</returns>
+    bool getSimplifiedValue(VariantFormat & oFormat, VariantUnion & oValue) const;
+
+    /// <summary>
+    /// Copies the cached simplified value of the given STRING Variant which holds the same string value.
+    /// </summary>
+    void copySimplifiedValue(const Variant & iValue);
+
+    /// <summary>
+    /// Compares the internal value of this Variant to the given native value.
+    /// </summary>
+    /// <param name="iFormat">The format of the native value. Must not be STRING.</param>
+    /// <param name="iValue">The native value.</param>
+    int compareNativeValue(const VariantFormat & iFormat, const VariantUnion & iValue) const;
+
+    /// <summary>
+    /// Compares the value of this Variant to the given string value.
+    /// The string value is parsed in place and is never copied.
+    /// </summary>
+    /// <param name="iValue">The characters of the string value.</param>
+    /// <param name="iLength">The number of characters in iValue.</param>
+    int compareString(const char * iValue, size_t iLength) const;
+
+    /// <summary>
+    /// Apply one of the following operator to the Variant:
+    /// operator+=, operator-=, operator*= or operator/=
+    /// The operator is applied by a single kernel selected by the formats of both Variants.
+    /// </summary>
+    const Variant & processOperator(MATH_OPERATOR iOperator, const Variant & iValue);
 
     /// <summary>
     /// Forces the internal type of the Variant to be converted
@@ -674,17 +941,130 @@ namespace libVariant
     // private attributes
     //-----------------
     VariantFormat mFormat;
-    VariantUnion mData;
+    uint8 mStringStorage; //a StringStorage value. Stored as a single byte to fit in mFormat's padding.
+    uint8 mInlineLength;  //length of mInlineString. Only valid if mStringStorage is STRING_INLINE.
+#ifdef _MSC_VER
+    #pragma warning(push)
+    #pragma warning(disable:4251) //warning C4251: needs to have dll-interface to be used by clients of class
+#endif
+    mutable std::atomic<uint8> mSimplifiedFormat; //a SimplifiedState or the VariantFormat of the simplified string value. Stored in mFormat's padding.
+#ifdef _MSC_VER
+    #pragma warning(pop)
+#endif
+    union
+    {
+      VariantUnion mData;
+      char mInlineString[INLINE_STRING_CAPACITY + 1];
+      mutable VariantUnion mStringData[2]; //mStringData[1] holds the cached simplified value when hasSimplifiedValueSlot() is true. Published by mSimplifiedFormat.
+      StringView mStringView;
+      SharedString * mSharedString;
+    };
 
     //-----------------
     // static attributes
     //-----------------
     static DivisionByZeroPolicy mDivisionByZeroPolicy;
+    static FloatFormattingPolicy mFloatFormattingPolicy;
 
     //static constants
     static const DivisionByZeroPolicy DEFAULT_DIVISION_BY_ZERO_POLICY = THROW;
+    static const FloatFormattingPolicy DEFAULT_FLOAT_FORMATTING_POLICY = FIXED_PRECISION;
   };
 
+  //------------------------
+  // Template definitions
+  //------------------------
+  template <typename T>
+  inline T Variant::get() const
+  {
+    static_assert(sizeof(T) == 0, "Variant::get<T>() only supports the internal types of the Variant class");
+    return T();
+  }
+
+  template<> inline bool     Variant::get<bool   >() const { return (isNativeInteger() ? mData.as_uint8 != 0 : Variant::getBool()); }
+  template<> inline uint8    Variant::get<uint8  >() const { return (isNativeInteger() ? mData.as_uint8  : Variant::getUInt8  ()); }
+  template<> inline uint16   Variant::get<uint16 >() const { return (isNativeInteger() ? mData.as_uint16 : Variant::getUInt16 ()); }
+  template<> inline uint32   Variant::get<uint32 >() const { return (isNativeInteger() ? mData.as_uint32 : Variant::getUInt32 ()); }
+  template<> inline uint64   Variant::get<uint64 >() const { return (isNativeInteger() ? mData.as_uint64 : Variant::getUInt64 ()); }
+  template<> inline sint8    Variant::get<sint8  >() const { return (isNativeInteger() ? mData.as_sint8  : Variant::getSInt8  ()); }
+  template<> inline sint16   Variant::get<sint16 >() const { return (isNativeInteger() ? mData.as_sint16 : Variant::getSInt16 ()); }
+  template<> inline sint32   Variant::get<sint32 >() const { return (isNativeInteger() ? mData.as_sint32 : Variant::getSInt32 ()); }
+  template<> inline sint64   Variant::get<sint64 >() const { return (isNativeInteger() ? mData.as_sint64 : Variant::getSInt64 ()); }
+  template<> inline float32  Variant::get<float32>() const { return (mFormat == Variant::FLOAT32 ? mData.as_float32 : Variant::getFloat32()); }
+  template<> inline float64  Variant::get<float64>() const { return (mFormat == Variant::FLOAT64 ? mData.as_float64 : Variant::getFloat64()); }
+  template<> inline Str      Variant::get<Str    >() const { return Variant::getString(); }
+
+  template <typename T>
+  inline void Variant::set(const typename std::remove_cv<T>::type & /*iValue*/)
+  {
+    static_assert(sizeof(T) == 0, "Variant::set<T>() only supports the internal types of the Variant class");
+  }
+
+  template<> inline void Variant::set<bool   >(const bool    & iValue) { resetNative(Variant::BOOL   ); mData.as_uint64  = iValue; }
+  template<> inline void Variant::set<uint8  >(const uint8   & iValue) { resetNative(Variant::UINT8  ); mData.as_uint64  = iValue; }
+  template<> inline void Variant::set<uint16 >(const uint16  & iValue) { resetNative(Variant::UINT16 ); mData.as_uint64  = iValue; }
+  template<> inline void Variant::set<uint32 >(const uint32  & iValue) { resetNative(Variant::UINT32 ); mData.as_uint64  = iValue; }
+  template<> inline void Variant::set<uint64 >(const uint64  & iValue) { resetNative(Variant::UINT64 ); mData.as_uint64  = iValue; }
+  template<> inline void Variant::set<sint8  >(const sint8   & iValue) { resetNative(Variant::SINT8  ); mData.as_sint64  = iValue; }
+  template<> inline void Variant::set<sint16 >(const sint16  & iValue) { resetNative(Variant::SINT16 ); mData.as_sint64  = iValue; }
+  template<> inline void Variant::set<sint32 >(const sint32  & iValue) { resetNative(Variant::SINT32 ); mData.as_sint64  = iValue; }
+  template<> inline void Variant::set<sint64 >(const sint64  & iValue) { resetNative(Variant::SINT64 ); mData.as_sint64  = iValue; }
+  template<> inline void Variant::set<float32>(const float32 & iValue) { resetNative(Variant::FLOAT32); mData.as_float32 = iValue; }
+  template<> inline void Variant::set<float64>(const float64 & iValue) { resetNative(Variant::FLOAT64); mData.as_float64 = iValue; }
+  template<> inline void Variant::set<CStr   >(const CStr    & iValue) { Variant::setString(iValue); }
+  template<> inline void Variant::set<Str    >(const Str     & iValue) { Variant::setString(iValue); }
+
+  template <typename F>
+  inline auto Variant::visit(F && iVisitor) const -> decltype(iVisitor(std::declval<const bool &>()))
+  {
+    switch(mFormat)
+    {
+    case Variant::BOOL:
+      return iVisitor(mData.as_bool);
+    case Variant::UINT8:
+      return iVisitor(mData.as_uint8);
+    case Variant::SINT8:
+      return iVisitor(mData.as_sint8);
+    case Variant::UINT16:
+      return iVisitor(mData.as_uint16);
+    case Variant::SINT16:
+      return iVisitor(mData.as_sint16);
+    case Variant::UINT32:
+      return iVisitor(mData.as_uint32);
+    case Variant::SINT32:
+      return iVisitor(mData.as_sint32);
+    case Variant::UINT64:
+      return iVisitor(mData.as_uint64);
+    case Variant::SINT64:
+      return iVisitor(mData.as_sint64);
+    case Variant::FLOAT32:
+      return iVisitor(mData.as_float32);
+    case Variant::FLOAT64:
+      return iVisitor(mData.as_float64);
+    default:
+      {
+        const StringView view = { getStringBuffer(), getStringLength() };
+        return iVisitor(view);
+      }
+    };
+  }
+
+  /// <summary>
+  /// Exchanges the values of two Variant instances.
+  /// </summary>
+  inline void swap(Variant & iValue1, Variant & iValue2) noexcept { iValue1.swap(iValue2); }
+
 } // End namespace
 
+namespace std
+{
+  /// <summary>
+  /// Allows Variant to be used as the key of unordered containers.
+  /// </summary>
+  template<> struct hash<libVariant::Variant>
+  {
+    size_t operator()(const libVariant::Variant & iValue) const { return iValue.hash(); }
+  };
+}
+
 #endif //LIBVARIANT_VARIANT_H
@@ -0,0 +1,372 @@
+/**********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2018 Antoine Beauchamp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#ifndef LIBVARIANT_VARIANT_ARRAY_H
+#define LIBVARIANT_VARIANT_ARRAY_H
+
+//---------------
+// Include Files
+//---------------
+#include "libvariant/variant.h"
+#include "libvariant/config.h"
+#include "libvariant/version.h"
+#include <vector>
+
+//-----------
+// Namespace
+//-----------
+
+namespace libVariant
+{
+  //------------------------
+  // Class Declarations
+  //------------------------
+
+  /// <summary>
+  /// A contiguous sequence of values with the same conversion and comparison rules as the Variant class.
+  /// Values are stored as a struct of arrays: a dense array of formats (one byte per value), a dense array of
+  /// 8 bytes payloads and a single buffer holding the characters of all string values.
+  /// Elements are accessed through lightweight references which behave like a Variant.
+  /// </summary>
+  class LIBVARIANT_EXPORT VariantArray
+  {
+  public:
+    class ConstReference;
+    class Reference;
+
+    //----------------------
+    // constructors methods
+    //----------------------
+    VariantArray();
+    explicit VariantArray(size_t iSize);
+
+    //----------------
+    // public methods
+    //----------------
+
+    /// <summary>
+    /// Returns the number of values in the array.
+    /// </summary>
+    size_t size() const { return mFormats.size(); }
+
+    /// <summary>
+    /// Returns true if the array contains no value.
+    /// </summary>
+    bool empty() const { return mFormats.empty(); }
+
+    /// <summary>
+    /// Reserves memory for the given number of values and the given number of string characters.
+    /// </summary>
+    /// <param name="iSize">The number of values.</param>
+    /// <param name="iStringsSize">The total size of all string values, in bytes.</param>
+    void reserve(size_t iSize, size_t iStringsSize = 0);
+
+    /// <summary>
+    /// Resizes the array to the given number of values. New values are UINT8 0, like a default Variant.
+    /// </summary>
+    void resize(size_t iSize);
+
+    /// <summary>
+    /// Removes all values from the array.
+    /// </summary>
+    void clear();
+
+    /// <summary>
+    /// Exchanges the values of the array with the given array.
+    /// </summary>
+    void swap(VariantArray & iValue) noexcept;
+
+    /// <summary>
+    /// Appends a value at the end of the array. The characters of a string value are copied into the strings buffer of the array.
+    /// </summary>
+    void push_back(const Variant & iValue);
+    void push_back(const CStr & iValue);
+    void push_back(const Str & iValue);
+    void push_back(const char * iValue, size_t iLength);
+
+    /// <summary>
+    /// Returns a reference to the value at the given index.
+    /// </summary>
+    Reference operator[](size_t iIndex);
+    ConstReference operator[](size_t iIndex) const;
+
+    /// <summary>
+    /// Returns the internal format of the value at the given index.
+    /// </summary>
+    Variant::VariantFormat getFormat(size_t iIndex) const { return static_cast<Variant::VariantFormat>(mFormats[iIndex]); }
+
+    /// <summary>
+    /// Returns a copy of the value at the given index.
+    /// </summary>
+    Variant get(size_t iIndex) const;
+
+    /// <summary>
+    /// Returns a Variant which borrows the characters of the value at the given index (see Variant::setStringView()).
+    /// The returned Variant is valid until a string value is added or modified in the array.
+    /// </summary>
+    Variant getView(size_t iIndex) const;
+
+    /// <summary>
+    /// Assigns a value at the given index.
+    /// </summary>
+    /// <remarks>
+    /// The characters of the previous string value are not released until compact() is called.
+    /// </remarks>
+    void set(size_t iIndex, const Variant & iValue);
+    void set(size_t iIndex, const char * iValue, size_t iLength);
+
+    /// <summary>
+    /// Returns true if all values of the array have the same internal format.
+    /// </summary>
+    /// <param name="oFormat">The common format of all values (output). Undefined if the array is empty.</param>
+    /// <returns>Returns true if all values have the same internal format. Returns false otherwise or if the array is empty.</returns>
+    bool isHomogeneous(Variant::VariantFormat & oFormat) const;
+
+    /// <summary>
+    /// Releases the characters of string values which were overwritten by set().
+    /// </summary>
+    void compact();
+
+    /// <summary>
+    /// Reorders the values of the array: the value at index i is the previous value at index iOrder[i]. String characters are not moved.
+    /// </summary>
+    /// <param name="iOrder">A permutation of the indexes of the array, such as the order computed by Sort::getOrder().</param>
+    void reorder(const std::vector<size_t> & iOrder);
+
+    //----------------------
+    //   operators
+    //----------------------
+
+    /// <summary>
+    /// Applies a math operator to each value of the array with the value at the same index of the given array.
+    /// Each result is identical to the result of the matching Variant operator (ie: values[i] += iValues[i]).
+    /// </summary>
+    /// <remarks>
+    /// Numeric columns are processed by loops over the raw columns which the compiler can vectorize.
+    /// String values and integer divisions are processed one value at a time by the Variant class.
+    /// </remarks>
+    /// <param name="iValues">An array of the same size.</param>
+    VariantArray & operator += (const VariantArray & iValues);
+    VariantArray & operator -= (const VariantArray & iValues);
+    VariantArray & operator *= (const VariantArray & iValues);
+    VariantArray & operator /= (const VariantArray & iValues);
+
+    /// <summary>
+    /// Applies a math operator to each value of the array with the given value.
+    /// Each result is identical to the result of the matching Variant operator (ie: values[i] += iValue).
+    /// </summary>
+    VariantArray & operator += (const Variant & iValue);
+    VariantArray & operator -= (const Variant & iValue);
+    VariantArray & operator *= (const Variant & iValue);
+    VariantArray & operator /= (const Variant & iValue);
+
+    //----------------------
+    //   selection
+    //----------------------
+
+    /// <summary>
+    /// Comparison operators of select().
+    /// </summary>
+    enum COMPARE_OPERATOR
+    {
+      EQUAL,
+      NOT_EQUAL,
+      LESS,
+      LESS_EQUAL,
+      GREATER,
+      GREATER_EQUAL,
+    };
+
+    /// <summary>
+    /// A packed set of values. The value at index i is in the set if bit (i % 64) of word (i / 64) is set.
+    /// </summary>
+    typedef std::vector<uint64> Bitmap;
+
+    /// <summary>
+    /// Selects the values of the array which match a comparison with the given value.
+    /// A value is selected if the matching Variant operator returns true (ie: values[i] < iValue).
+    /// </summary>
+    /// <remarks>
+    /// Runs of numeric values of the same format are compared by loops over the raw columns which the compiler can vectorize.
+    /// String values are compared one value at a time with Variant::compare().
+    /// </remarks>
+    /// <param name="iOperator">The comparison operator.</param>
+    /// <param name="iValue">The right operand of each comparison.</param>
+    /// <param name="oSelection">The selected values (output). The bitmap is resized to hold size() bits. Unused bits of the last word are cleared.</param>
+    void select(COMPARE_OPERATOR iOperator, const Variant & iValue, Bitmap & oSelection) const;
+
+    /// <summary>
+    /// Selects the values of the array which match a comparison with the value at the same index of the given array.
+    /// A value is selected if the matching Variant operator returns true (ie: values[i] < iValues[i]).
+    /// </summary>
+    /// <param name="iOperator">The comparison operator.</param>
+    /// <param name="iValues">An array of the same size.</param>
+    /// <param name="oSelection">The selected values (output). The bitmap is resized to hold size() bits. Unused bits of the last word are cleared.</param>
+    void select(COMPARE_OPERATOR iOperator, const VariantArray & iValues, Bitmap & oSelection) const;
+
+    /// <summary>
+    /// Returns true if the value at the given index is in the given set of values.
+    /// </summary>
+    static bool isSelected(const Bitmap & iSelection, size_t iIndex) { return ((iSelection[iIndex / 64] >> (iIndex % 64)) & 1) != 0; }
+
+    /// <summary>
+    /// Returns the number of values in the given set of values.
+    /// </summary>
+    static size_t countSelected(const Bitmap & iSelection);
+
+    //raw column access
+    const uint8 * getFormats() const { return (mFormats.empty() ? NULL : &mFormats[0]); }
+    const Variant::VariantUnion * getValues() const { return (mValues.empty() ? NULL : &mValues[0]); }
+    Variant::VariantUnion * getValues() { return (mValues.empty() ? NULL : &mValues[0]); }
+
+    /// <summary>
+    /// Returns the characters of the string value at the given index.
+    /// </summary>
+    /// <param name="iIndex">The index of a STRING value.</param>
+    /// <param name="oLength">The number of characters of the string value (output).</param>
+    /// <returns>Returns the characters of the string value. The characters are not null terminated.</returns>
+    const char * getStringBuffer(size_t iIndex, size_t & oLength) const;
+
+    /// <summary>
+    /// Returns the size of the strings buffer in bytes.
+    /// </summary>
+    size_t getStringsSize() const { return mStrings.size(); }
+
+    //----------------------
+    //   element references
+    //----------------------
+
+    /// <summary>
+    /// A read-only reference to a value of a VariantArray.
+    /// All conversion and comparison rules are delegated to the Variant class.
+    /// </summary>
+    class LIBVARIANT_EXPORT ConstReference
+    {
+    public:
+      ConstReference(const VariantArray & iArray, size_t iIndex) : mArray(&iArray), mIndex(iIndex) {}
+
+      Variant::VariantFormat getFormat() const { return mArray->getFormat(mIndex); }
+      Variant toVariant() const { return mArray->get(mIndex); }
+      operator Variant() const { return toVariant(); }
+
+      //getters
+      bool     getBool()    const { return mArray->getView(mIndex).getBool   (); }
+      uint8    getUInt8()   const { return mArray->getView(mIndex).getUInt8  (); }
+      uint16   getUInt16()  const { return mArray->getView(mIndex).getUInt16 (); }
+      uint32   getUInt32()  const { return mArray->getView(mIndex).getUInt32 (); }
+      uint64   getUInt64()  const { return mArray->getView(mIndex).getUInt64 (); }
+      sint8    getSInt8()   const { return mArray->getView(mIndex).getSInt8  (); }
+      sint16   getSInt16()  const { return mArray->getView(mIndex).getSInt16 (); }
+      sint32   getSInt32()  const { return mArray->getView(mIndex).getSInt32 (); }
+      sint64   getSInt64()  const { return mArray->getView(mIndex).getSInt64 (); }
+      float32  getFloat32() const { return mArray->getView(mIndex).getFloat32(); }
+      float64  getFloat64() const { return mArray->getView(mIndex).getFloat64(); }
+      Str      getString()  const { return mArray->getView(mIndex).getString (); }
+      template <typename T>
+      T get() const { return mArray->getView(mIndex).get<T>(); }
+
+      size_t hash() const { return mArray->getView(mIndex).hash(); }
+
+      //compare functions. See Variant::compare().
+      int compare(const Variant & iValue) const { return mArray->getView(mIndex).compare(iValue); }
+      int compare(const ConstReference & iValue) const { return mArray->getView(mIndex).compare(iValue.mArray->getView(iValue.mIndex)); }
+
+      bool operator == (const Variant & iValue) const { return compare(iValue) == 0; }
+      bool operator != (const Variant & iValue) const { return compare(iValue) != 0; }
+      bool operator <  (const Variant & iValue) const { return compare(iValue) <  0; }
+      bool operator >  (const Variant & iValue) const { return compare(iValue) >  0; }
+      bool operator <= (const Variant & iValue) const { return compare(iValue) <= 0; }
+      bool operator >= (const Variant & iValue) const { return compare(iValue) >= 0; }
+      bool operator == (const ConstReference & iValue) const { return compare(iValue) == 0; }
+      bool operator != (const ConstReference & iValue) const { return compare(iValue) != 0; }
+      bool operator <  (const ConstReference & iValue) const { return compare(iValue) <  0; }
+      bool operator >  (const ConstReference & iValue) const { return compare(iValue) >  0; }
+      bool operator <= (const ConstReference & iValue) const { return compare(iValue) <= 0; }
+      bool operator >= (const ConstReference & iValue) const { return compare(iValue) >= 0; }
+
+    protected:
+      const VariantArray * mArray;
+      size_t mIndex;
+    };
+
+    /// <summary>
+    /// A reference to a value of a VariantArray which can also assign the value.
+    /// </summary>
+    class LIBVARIANT_EXPORT Reference : public ConstReference
+    {
+    public:
+      Reference(VariantArray & iArray, size_t iIndex) : ConstReference(iArray, iIndex) {}
+
+      //assigns the value, not the reference
+      Reference & operator = (const Reference & iValue) { return (*this) = iValue.toVariant(); }
+      Reference & operator = (const ConstReference & iValue) { return (*this) = iValue.toVariant(); }
+      Reference & operator = (const Variant & iValue) { const_cast<VariantArray*>(mArray)->set(mIndex, iValue); return (*this); }
+    };
+
+  private:
+    //-----------------
+    // private methods
+    //-----------------
+
+    /// <summary>
+    /// Copies the given characters at the end of the strings buffer.
+    /// </summary>
+    /// <returns>Returns the payload of the string value.</returns>
+    Variant::VariantUnion appendString(const char * iValue, size_t iLength);
+
+    /// <summary>
+    /// Applies a math operator to each value of the array with the value at the same index of the given array.
+    /// </summary>
+    void processOperator(Variant::MATH_OPERATOR iOperator, const VariantArray & iValues);
+
+    /// <summary>
+    /// Applies a math operator to each value of the array with the given value.
+    /// </summary>
+    void processOperator(Variant::MATH_OPERATOR iOperator, const Variant & iValue);
+
+    /// <summary>
+    /// Applies a math operator to each value of the array with the values of the given operand.
+    /// </summary>
+    /// <param name="iOperator">The operator to apply.</param>
+    /// <param name="iOperand">A column or a single value.</param>
+    /// <param name="iOperandFormats">The set of internal formats of the operand's values. The set contains a format if the bit (1 << format) is set.</param>
+    template <class T>
+    void processOperands(Variant::MATH_OPERATOR iOperator, const T & iOperand, uint32 iOperandFormats);
+
+    //-----------------
+    // private attributes
+    //-----------------
+    std::vector<uint8> mFormats;                 //Variant::VariantFormat of each value
+    std::vector<Variant::VariantUnion> mValues;  //native value, or offset of the characters in mStrings for STRING values
+    std::vector<char> mStrings;                  //length prefixed characters of all string values
+  };
+
+  /// <summary>
+  /// Exchanges the values of two VariantArray instances.
+  /// </summary>
+  inline void swap(VariantArray & iValue1, VariantArray & iValue2) noexcept { iValue1.swap(iValue2); }
+
+} // End namespace
+
+#endif //LIBVARIANT_VARIANT_ARRAY_H
@@ -31,6 +31,7 @@
 //---------------
 #include "libvariant/config.h"
 #include "libvariant/version.h"
+#include "libvariant/allocator.h"
 #include <stdio.h> // for size_t
 
 //-----------
@@ -43,7 +44,9 @@ namespace libVariant
   // Class Declarations
   //------------------------
   /// <summary>
-  /// Wrapping class around std::string class.
+  /// A string class which does not expose the standard library in its interface.
+  /// Short strings are stored within the String instance. Longer strings are stored in a single buffer allocated by the current Allocator of the thread.
+  /// The buffer is released by the allocator which allocated it.
   /// </summary>
   class LIBVARIANT_EXPORT String
   {
@@ -53,7 +56,9 @@ namespace libVariant
     //----------------------
     String();
     String(const String & iValue); //copy ctor
+    String(String && iValue) noexcept; //move ctor
     String(const char * iValue);
+    String(const char * iValue, size_t iLength);
 
     virtual ~String();
 
@@ -78,6 +83,19 @@ namespace libVariant
     /// <returns>Returns a pointer to the internal buffer of the string. Returns "" if the string is empty.</returns>
     virtual const char * c_str() const;
 
+    /// <summary>
+    /// Returns the number of characters that the String can hold without allocating memory.
+    /// </summary>
+    /// <returns>Returns the capacity of the String in bytes, excluding the null terminator.</returns>
+    virtual size_t capacity() const;
+
+    /// <summary>
+    /// Increases the capacity of the String to at least the given number of characters.
+    /// Does nothing if the capacity of the String is already large enough.
+    /// </summary>
+    /// <param name="iCapacity">The new minimum capacity of the String in bytes, excluding the null terminator.</param>
+    virtual void reserve(size_t iCapacity);
+
     /// <summary>
     /// Assigns the given character sequence to the String.
     /// </summary>
@@ -106,6 +124,21 @@ namespace libVariant
     /// <returns>Returns the String obect with the given String added.</returns>
     virtual String & append(const String & iValue);
 
+    /// <summary>
+    /// Appends the given characters to the current value of the String.
+    /// </summary>
+    /// <param name="iValue">The characters to append to the String. Can point to the characters of the String.</param>
+    /// <param name="iLength">The number of characters of iValue.</param>
+    /// <returns>Returns the String obect with the given characters added.</returns>
+    virtual String & append(const char * iValue, size_t iLength);
+
+    /// <summary>
+    /// Exchanges the value of the String with the given String.
+    /// The strings are exchanged without being copied.
+    /// </summary>
+    /// <param name="iValue">The String to exchange values with.</param>
+    void swap(String & iValue) noexcept;
+
     //----------------------
     //   operators
     //----------------------
@@ -124,6 +157,13 @@ namespace libVariant
     /// <returns>Returns the String obect with the given String assigned.</returns>
     virtual const String & operator = (const String & iValue);
 
+    /// <summary>
+    /// Moves the given String to the String.
+    /// </summary>
+    /// <param name="iValue">The String to move from. The String is left empty.</param>
+    /// <returns>Returns the String obect with the given String moved in.</returns>
+    virtual const String & operator = (String && iValue) noexcept;
+
     /// <summary>
     /// Compares the current String with the given String.
     /// </summary>
@@ -167,13 +207,71 @@ namespace libVariant
     virtual bool operator >= (const String & iValue) const;
 
   private:
+    //--------------------------
+    // private enums & constants
+    //--------------------------
+
+    /// <summary>
+    /// Maximum length (in bytes, excluding the null terminator) of a string that can be stored within the String instance.
+    /// </summary>
+    static const size_t INLINE_CAPACITY = 15;
+
+    //-----------------
+    // private methods
+    //-----------------
+
+    /// <summary>
+    /// Returns true if the characters are stored within the String instance.
+    /// </summary>
+    bool isInline() const { return m_capacity == INLINE_CAPACITY; }
+
+    /// <summary>
+    /// Returns a pointer to the characters of the String.
+    /// </summary>
+    char * getBuffer() { return (isInline() ? m_inline : m_heap.characters); }
+
+    /// <summary>
+    /// Replaces the characters of the String with the given characters.
+    /// </summary>
+    /// <param name="iValue">The new characters of the String. Can point to the characters of the String.</param>
+    /// <param name="iLength">The number of characters of iValue.</param>
+    void assignCharacters(const char * iValue, size_t iLength);
+
+    /// <summary>
+    /// Moves the characters of the String to a new buffer of the given capacity allocated by the current Allocator of the thread.
+    /// </summary>
+    /// <param name="iCapacity">The capacity of the new buffer. Must be larger than the current capacity.</param>
+    /// <param name="iValue">A pointer which may point to the current characters of the String. Can be NULL.</param>
+    /// <returns>Returns iValue updated to point to the new buffer if it pointed to the previous characters. Returns iValue otherwise.</returns>
+    const char * grow(size_t iCapacity, const char * iValue);
+
+    /// <summary>
+    /// Releases the heap allocated buffer of the String, if any.
+    /// </summary>
+    void releaseBuffer();
+
     //-----------------
     // private attributes
     //-----------------
-    struct PImpl; //private implementation
-    PImpl * m_pimpl;
+    size_t m_size;
+    size_t m_capacity; //INLINE_CAPACITY when the characters are stored in m_inline.
+    struct HeapBuffer
+    {
+      char * characters; //holds m_capacity+1 characters.
+      Allocator * allocator; //the allocator which allocated the characters.
+    };
+    union
+    {
+      HeapBuffer m_heap;
+      char m_inline[INLINE_CAPACITY + 1]; //must be at least as large as m_heap. See swap().
+    };
   };
 
+  /// <summary>
+  /// Exchanges the values of two String instances.
+  /// </summary>
+  inline void swap(String & iValue1, String & iValue2) noexcept { iValue1.swap(iValue2); }
+
 } // End namespace
 
 #endif //LIBVARIANT_STRING_H
@@ -379,13 +379,15 @@ void generateCompareDefinitions()
   printf("    #pragma warning(pop)\n");
   printf("  }\n");
   printf("\n");
-  printf("  inline int compareStrings(const Str & iLocalValue, const Str & iRemoteValue)\n");
+  printf("  inline int compareStrings(const char * iLocalValue, size_t iLocalLength, const char * iRemoteValue, size_t iRemoteLength)\n");
   printf("  {\n");
-  printf("    if (iLocalValue < iRemoteValue)\n");
+  printf("    //memcmp() compares characters as unsigned char which matches Str's operator < and operator >\n");
+  printf("    int result = memcmp(iLocalValue, iRemoteValue, (iLocalLength < iRemoteLength ? iLocalLength : iRemoteLength));\n");
+  printf("    if (result < 0 || (result == 0 && iLocalLength < iRemoteLength))\n");
   printf("    {\n");
   printf("      return -1;\n");
   printf("    }\n");
-  printf("    else if (iLocalValue > iRemoteValue)\n");
+  printf("    else if (result > 0 || (result == 0 && iLocalLength > iRemoteLength))\n");
   printf("    {\n");
   printf("      return +1;\n");
   printf("    }\n");
@@ -460,17 +462,20 @@ void generateCompareDefinitions()
       printf("    //can't be compared using native C++ types\n");
       printf("    \n");
       printf("    //try to simplify this Variant's string value to a native type\n");
-      printf("    Variant thisCopy(*this);\n");
-      printf("    if (thisCopy.simplify())\n");
+      printf("    VariantFormat simplifiedFormat;\n");
+      printf("    VariantUnion simplifiedValue;\n");
+      printf("    if (getSimplifiedValue(simplifiedFormat, simplifiedValue))\n");
       printf("    {\n");
-      printf("      //thisCopy is now a basic/native type\n");
-      printf("      if (hasNativeCompare(thisCopy.mFormat, thisCopy.mData, result, iValue))\n");
+      printf("      //the string value has a basic/native representation\n");
+      printf("      if (hasNativeCompare(simplifiedFormat, simplifiedValue, result, iValue))\n");
       printf("        return result;\n");
       printf("    }\n");
       printf("  \n");
       printf("    //current Variant's value is an unsimplifiable string\n");
       printf("    assert( mFormat == VariantFormat::STRING );\n");
-      printf("    return compareStrings( (*mData.as_str), Variant(iValue).getString() );\n");
+      printf("    char buffer[NATIVE_STRING_BUFFER_SIZE];\n");
+      printf("    size_t length = Variant(iValue).getString(buffer, sizeof(buffer));\n");
+      printf("    return compareStrings( getStringBuffer(), getStringLength(), buffer, length );\n");
       printf("  }\n");
       printf("  \n");
     }
@@ -662,6 +667,79 @@ void generateDeclarations()
   generateCompareDefinitions();
 }
 
+const char * getOperatorKernelName(const char * iLocalFormat, const char * iRemoteFormat)
+{
+  std::string local = iLocalFormat;
+  std::string remote = iRemoteFormat;
+
+  //classify both formats
+  bool localUnsigned  = (local  == "BOOL" || local.find("UINT") == 0);
+  bool remoteUnsigned = (remote == "BOOL" || remote.find("UINT") == 0);
+  bool localSigned    = (local.find("SINT") == 0);
+  bool remoteSigned   = (remote.find("SINT") == 0);
+  bool localFloat     = (local.find("FLOAT") == 0);
+  bool remoteFloat    = (remote.find("FLOAT") == 0);
+
+  if (local == "STRING" && remote == "STRING")
+    return "stringKernel";
+  if (local == "STRING" || remote == "STRING")
+    return "simplifyKernel";
+  if (local == "FLOAT32" && remote == "FLOAT32")
+    return "float32Kernel";
+  if (local == "FLOAT64" && remote == "FLOAT64")
+    return "float64Kernel";
+  if (localFloat || remoteFloat)
+    return "mixedFloatKernel";
+  if (localUnsigned && remoteUnsigned)
+    return "unsignedKernel";
+  if (localSigned && remoteSigned)
+    return "signedKernel";
+  if (localSigned && remoteUnsigned)
+    return "signedUnsignedKernel";
+  if (localUnsigned && remoteSigned)
+    return "unsignedSignedKernel";
+  return "***";
+}
+
+void generateOperatorKernelTable()
+{
+  //must match the declaration order of Variant::VariantFormat
+  static const char * formats[] = {"BOOL", "UINT8", "SINT8", "UINT16", "SINT16", "UINT32", "SINT32", "UINT64", "SINT64", "FLOAT32", "FLOAT64", "STRING"};
+  static const size_t numFormats = sizeof(formats)/sizeof(formats[0]);
+  static const char * operators[] = {"PLUS_EQUAL", "MINUS_EQUAL", "MULTIPLY_EQUAL", "DIVIDE_EQUAL"};
+  static const size_t numOperators = sizeof(operators)/sizeof(operators[0]);
+
+  printf("  // operator kernels dispatch table\n");
+  printf("#if 1\n");
+  printf("  static_assert(Variant::STRING == %d, \"the dispatch table must be generated again if Variant::VariantFormat is modified\");\n", (int)numFormats-1);
+  printf("  static_assert(Variant::DIVIDE_EQUAL == %d, \"the dispatch table must be generated again if Variant::MATH_OPERATOR is modified\");\n", (int)numOperators-1);
+  printf("  const Variant::OperatorKernel Variant::OperatorKernels::TABLE[%d][%d][%d] = {\n", (int)numOperators, (int)numFormats, (int)numFormats);
+  for(size_t op=0; op<numOperators; op++)
+  {
+    printf("    //%s\n", operators[op]);
+    printf("    {\n");
+    for(size_t i=0; i<numFormats; i++)
+    {
+      printf("      { //%s\n", formats[i]);
+      for(size_t j=0; j<numFormats; j++)
+      {
+        std::string kernel = getOperatorKernelName(formats[i], formats[j]);
+        kernel.append("<");
+        kernel.append(operators[op]);
+        kernel.append(">,");
+        printf("        &%s //%s\n", formatString(kernel, 38).c_str(), formats[j]);
+      }
+      printf("      },\n");
+    }
+    printf("    },\n");
+  }
+  printf("  };\n");
+  printf("#endif\n");
+
+  printf("\n");
+}
+
 void generateDefinitions()
 {
+  generateOperatorKernelTable();
 }
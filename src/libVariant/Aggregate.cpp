@@ -0,0 +1,706 @@
+/**********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2018 Antoine Beauchamp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+
+//---------------
+// Include Files
+//---------------
+#include "libvariant/aggregate.h"
+#include "NativeFormats.h"
+#include "VariantAccess.h"
+
+#include <assert.h>
+#include <math.h> // floor
+#include <string.h> // memcpy
+#include <unordered_set>
+#include <vector>
+
+//-----------
+// Namespace
+//-----------
+
+namespace libVariant
+{
+  struct Aggregate::Kernels
+  {
+    //------------------------------------------------------------------------
+    // sources of values. Native values are read without creating a Variant.
+    //------------------------------------------------------------------------
+    struct VariantRange
+    {
+      bool isSelected(size_t /*iIndex*/) const { return true; }
+      uint8 getFormat(size_t iIndex) const { return static_cast<uint8>(VariantAccess::getFormat(values[iIndex])); }
+      const Variant::VariantUnion & getValue(size_t iIndex) const { return VariantAccess::getValue(values[iIndex]); }
+      const Variant & getView(size_t iIndex) const { return values[iIndex]; }
+
+      //the native values of Variant instances are not contiguous
+      bool getBlockFormat(size_t /*iBegin*/, size_t /*iEnd*/, uint8 & /*oFormat*/) const { return false; }
+      const Variant::VariantUnion * getValues(size_t /*iIndex*/) const { return NULL; }
+
+      const Variant * values;
+      size_t size;
+    };
+
+    struct ArrayRange
+    {
+      bool isSelected(size_t iIndex) const { return (selection == NULL || VariantArray::isSelected(*selection, iIndex)); }
+      uint8 getFormat(size_t iIndex) const { return formats[iIndex]; }
+      const Variant::VariantUnion & getValue(size_t iIndex) const { return values[iIndex]; }
+      Variant getView(size_t iIndex) const { return array->getView(iIndex); }
+      const Variant::VariantUnion * getValues(size_t iIndex) const { return values + iIndex; }
+
+      /// <summary>
+      /// Returns true if all values of a block are selected and of the same format.
+      /// </summary>
+      bool getBlockFormat(size_t iBegin, size_t iEnd, uint8 & oFormat) const
+      {
+        if (selection != NULL)
+        {
+          assert( iBegin % 64 == 0 );
+          for(size_t i=iBegin; i<iEnd; i+=64)
+          {
+            const size_t count = (iEnd - i < 64 ? iEnd - i : 64);
+            const uint64 mask = (count == 64 ? ~0ull : (1ull << count) - 1);
+            if (((*selection)[i / 64] & mask) != mask)
+              return false;
+          }
+        }
+        oFormat = formats[iBegin];
+        return isSameFormat(formats + iBegin, iEnd - iBegin, oFormat);
+      }
+
+      const VariantArray * array;
+      const uint8 * formats;
+      const Variant::VariantUnion * values;
+      const VariantArray::Bitmap * selection;
+      size_t size;
+    };
+
+    /// <summary>
+    /// Chunks are processed by blocks of values. A block of selected values of the same numeric format is processed by a native loop.
+    /// </summary>
+    static const size_t BLOCK_SIZE = 256;
+    static_assert(CHUNK_SIZE % BLOCK_SIZE == 0, "Chunks must contain complete blocks");
+
+    /// <summary>
+    /// The aggregated value of a chunk of values.
+    /// </summary>
+    struct Partial
+    {
+      Partial() : empty(true) {}
+
+      bool empty;
+      Variant value;
+    };
+
+    /// <summary>
+    /// A set of distinct values. Numbers are identified by their value regardless of their format:
+    /// integral numbers by their integer value and other numbers by the bits of their float64 value.
+    /// </summary>
+    struct DistinctValues
+    {
+      void insert(uint8 iFormat, const Variant::VariantUnion & iValue)
+      {
+        switch(iFormat)
+        {
+        case Variant::BOOL:
+          positives.insert(iValue.as_bool ? 1 : 0);
+          break;
+        case Variant::UINT8:
+          positives.insert(iValue.as_uint8);
+          break;
+        case Variant::UINT16:
+          positives.insert(iValue.as_uint16);
+          break;
+        case Variant::UINT32:
+          positives.insert(iValue.as_uint32);
+          break;
+        case Variant::UINT64:
+          positives.insert(iValue.as_uint64);
+          break;
+        case Variant::SINT8:
+          insertInteger(iValue.as_sint8);
+          break;
+        case Variant::SINT16:
+          insertInteger(iValue.as_sint16);
+          break;
+        case Variant::SINT32:
+          insertInteger(iValue.as_sint32);
+          break;
+        case Variant::SINT64:
+          insertInteger(iValue.as_sint64);
+          break;
+        case Variant::FLOAT32:
+          insertFloating(iValue.as_float32);
+          break;
+        case Variant::FLOAT64:
+          insertFloating(iValue.as_float64);
+          break;
+        default:
+          assert( false ); /*error should not happen*/
+          break;
+        };
+      }
+
+      void insertInteger(sint64 iValue)
+      {
+        if (iValue < 0)
+          negatives.insert(static_cast<uint64>(iValue));
+        else
+          positives.insert(static_cast<uint64>(iValue));
+      }
+
+      void insertFloating(float64 iValue)
+      {
+        if (iValue != iValue)
+        {
+          fractions.insert(0x7ff8000000000000ull); //all NaN values are the same value
+          return;
+        }
+
+        //integral values are the same value as the matching integer. Also handles -0.0.
+        if (iValue >= -9223372036854775808.0 && iValue < 18446744073709551616.0 && floor(iValue) == iValue)
+        {
+          if (iValue < 0.0)
+            negatives.insert(static_cast<uint64>(static_cast<sint64>(iValue)));
+          else
+            positives.insert(static_cast<uint64>(iValue));
+          return;
+        }
+
+        uint64 bits;
+        memcpy(&bits, &iValue, sizeof(bits));
+        fractions.insert(bits);
+      }
+
+      void merge(const DistinctValues & iValues)
+      {
+        positives.insert(iValues.positives.begin(), iValues.positives.end());
+        negatives.insert(iValues.negatives.begin(), iValues.negatives.end());
+        fractions.insert(iValues.fractions.begin(), iValues.fractions.end());
+        strings.insert(iValues.strings.begin(), iValues.strings.end());
+      }
+
+      size_t size() const
+      {
+        return positives.size() + negatives.size() + fractions.size() + strings.size();
+      }
+
+      std::unordered_set<uint64> positives;   //integral numbers greater or equal to 0
+      std::unordered_set<uint64> negatives;   //integral numbers lower than 0
+      std::unordered_set<uint64> fractions;   //bits of the other numbers
+      std::unordered_set<Variant> strings;    //strings which are not numbers
+    };
+
+    static ArrayRange getRange(const VariantArray & iValues, const VariantArray::Bitmap * iSelection)
+    {
+      assert( iSelection == NULL || iSelection->size() * 64 >= iValues.size() );
+      ArrayRange range = { &iValues, iValues.getFormats(), iValues.getValues(), iSelection, iValues.size() };
+      return range;
+    }
+
+    static VariantRange getRange(const Variant * iValues, size_t iSize)
+    {
+      VariantRange range = { iValues, iSize };
+      return range;
+    }
+
+    /// <summary>
+    /// Calls a function for each chunk of a range of values with the threads of a pool.
+    /// </summary>
+    template <class T, class U>
+    static void processChunks(ThreadPool & iPool, const T & iRange, std::vector<U> & oPartials, void (*iFunction)(const T &, size_t, size_t, U &))
+    {
+      const size_t numChunks = (iRange.size + CHUNK_SIZE - 1) / CHUNK_SIZE;
+      oPartials.resize(numChunks);
+      iPool.parallelFor(numChunks, [&](size_t iChunk)
+      {
+        const size_t begin = iChunk * CHUNK_SIZE;
+        const size_t end = (iRange.size - begin < CHUNK_SIZE ? iRange.size : begin + CHUNK_SIZE);
+        iFunction(iRange, begin, end, oPartials[iChunk]);
+      });
+    }
+
+    /// <summary>
+    /// Starts a partial result with the given value. String values are copied.
+    /// </summary>
+    static void assign(Partial & oPartial, const Variant & iValue)
+    {
+      oPartial.value = iValue;
+      oPartial.value.materialize();
+      oPartial.empty = false;
+    }
+
+    /// <summary>
+    /// Adds a numeric value to a numeric value with the rules of Variant::processOperator(). See Variant::OperatorKernels.
+    /// </summary>
+    static void add(Variant::VariantFormat & ioFormat, Variant::VariantUnion & ioValue, uint8 iFormat, const Variant::VariantUnion & iValue)
+    {
+      const uint32 formats = (1u << ioFormat) | (1u << iFormat);
+      if (formats & FLOAT_FORMATS)
+      {
+        if (formats == FLOAT32_FORMATS)
+          ioValue.as_float32 += iValue.as_float32;
+        else if (formats == FLOAT64_FORMATS)
+          ioValue.as_float64 += iValue.as_float64;
+        else
+        {
+          //Rule #1 and #2: both values are elevated to float64
+          ioValue.as_float64 = toFloat64(static_cast<uint8>(ioFormat), ioValue) + toFloat64(iFormat, iValue);
+          ioFormat = Variant::FLOAT64;
+        }
+        return;
+      }
+
+      //integers. Signed values are processed as unsigned values to get the same bits without overflow.
+      uint8 format = static_cast<uint8>(ioFormat);
+      const bool isUnsigned = isSubset(1u << format, UNSIGNED_FORMATS);
+      ioValue.as_uint64 += iValue.as_uint64;
+      if (isUnsigned && isSubset(1u << iFormat, UNSIGNED_FORMATS))
+        format = getPromotedUnsignedFormat(format, ioValue.as_uint64);
+      else
+      {
+        //Rule #4: an unsigned value is changed to signed when the argument is signed
+        if (isUnsigned)
+          format = getSignedFormat(format);
+        format = getPromotedSignedFormat(format, ioValue.as_sint64);
+      }
+      ioFormat = static_cast<Variant::VariantFormat>(format);
+    }
+
+    template <int format>
+    static float64 addFloat64(float64 iSum, const Variant::VariantUnion * iValues, size_t iCount)
+    {
+      for(size_t i=0; i<iCount; i++)
+        iSum += static_cast<float64>(CompareTraits<format>::get(iValues[i]));
+      return iSum;
+    }
+
+    /// <summary>
+    /// Adds a block of numeric values of the same format to a numeric value with the rules of add().
+    /// Returns false if the current format requires to add the first value with add(). For example, to change an unsigned sum to a signed sum.
+    /// </summary>
+    static bool addBlock(Variant::VariantFormat & ioFormat, Variant::VariantUnion & ioValue, uint8 iFormat, const Variant::VariantUnion * iValues, size_t iCount)
+    {
+      const uint32 localFormats = (1u << ioFormat);
+      const uint32 blockFormats = (1u << iFormat);
+      if (isSubset(localFormats, UNSIGNED_FORMATS) && isSubset(blockFormats, UNSIGNED_FORMATS))
+      {
+        if (iFormat != Variant::UINT64)
+        {
+          //values are lower than 2^32: the sum of a block cannot overflow.
+          //Without wrap around, the sum only grows which makes the promoted format of the total the format of the last sum.
+          uint64 sum = 0;
+          for(size_t i=0; i<iCount; i++)
+            sum += iValues[i].as_uint64;
+          const uint64 total = ioValue.as_uint64 + sum;
+          if (total >= ioValue.as_uint64)
+          {
+            ioValue.as_uint64 = total;
+            ioFormat = static_cast<Variant::VariantFormat>(getPromotedUnsignedFormat(static_cast<uint8>(ioFormat), total));
+            return true;
+          }
+        }
+
+        //the sum may wrap around
+        for(size_t i=0; i<iCount; i++)
+          add(ioFormat, ioValue, iFormat, iValues[i]);
+        return true;
+      }
+      if (isSubset(localFormats, SIGNED_FORMATS) && isSubset(blockFormats, INTEGER_FORMATS))
+      {
+        //the format is promoted by the last intermediate sum which exceeds the limits of sint8
+        uint64 sum = ioValue.as_uint64;
+        sint64 promoted = 0;
+        for(size_t i=0; i<iCount; i++)
+        {
+          sum += iValues[i].as_uint64;
+          if (static_cast<sint64>(sum) > sint8_max)
+            promoted = static_cast<sint64>(sum);
+        }
+        ioValue.as_uint64 = sum;
+        if (promoted != 0)
+          ioFormat = static_cast<Variant::VariantFormat>(getPromotedSignedFormat(static_cast<uint8>(ioFormat), promoted));
+        return true;
+      }
+      if (ioFormat == Variant::FLOAT32 && iFormat == Variant::FLOAT32)
+      {
+        float32 sum = ioValue.as_float32;
+        for(size_t i=0; i<iCount; i++)
+          sum += iValues[i].as_float32;
+        ioValue.as_float32 = sum;
+        return true;
+      }
+      if (ioFormat != Variant::FLOAT64)
+        return false;
+
+      switch(iFormat)
+      {
+      case Variant::BOOL:    ioValue.as_float64 = addFloat64<Variant::BOOL   >(ioValue.as_float64, iValues, iCount); break;
+      case Variant::UINT8:   ioValue.as_float64 = addFloat64<Variant::UINT8  >(ioValue.as_float64, iValues, iCount); break;
+      case Variant::UINT16:  ioValue.as_float64 = addFloat64<Variant::UINT16 >(ioValue.as_float64, iValues, iCount); break;
+      case Variant::UINT32:  ioValue.as_float64 = addFloat64<Variant::UINT32 >(ioValue.as_float64, iValues, iCount); break;
+      case Variant::UINT64:  ioValue.as_float64 = addFloat64<Variant::UINT64 >(ioValue.as_float64, iValues, iCount); break;
+      case Variant::SINT8:   ioValue.as_float64 = addFloat64<Variant::SINT8  >(ioValue.as_float64, iValues, iCount); break;
+      case Variant::SINT16:  ioValue.as_float64 = addFloat64<Variant::SINT16 >(ioValue.as_float64, iValues, iCount); break;
+      case Variant::SINT32:  ioValue.as_float64 = addFloat64<Variant::SINT32 >(ioValue.as_float64, iValues, iCount); break;
+      case Variant::SINT64:  ioValue.as_float64 = addFloat64<Variant::SINT64 >(ioValue.as_float64, iValues, iCount); break;
+      case Variant::FLOAT32: ioValue.as_float64 = addFloat64<Variant::FLOAT32>(ioValue.as_float64, iValues, iCount); break;
+      case Variant::FLOAT64: ioValue.as_float64 = addFloat64<Variant::FLOAT64>(ioValue.as_float64, iValues, iCount); break;
+      default:
+        assert( false ); /*error should not happen*/
+        return false;
+      };
+      return true;
+    }
+
+    template <class T>
+    static void sumChunk(const T & iRange, size_t iBegin, size_t iEnd, Partial & oPartial)
+    {
+      //the sum of native values is kept in local variables
+      Variant & result = oPartial.value;
+      bool native = false;
+      Variant::VariantFormat format = Variant::UINT8;
+      Variant::VariantUnion value;
+      value.as_uint64 = 0;
+
+      for(size_t block=iBegin; block<iEnd; block+=BLOCK_SIZE)
+      {
+        const size_t blockEnd = (iEnd - block < BLOCK_SIZE ? iEnd : block + BLOCK_SIZE);
+        uint8 blockFormat = Variant::STRING;
+        if (native && iRange.getBlockFormat(block, blockEnd, blockFormat) && blockFormat != Variant::STRING)
+        {
+          for(size_t i=block; i<blockEnd && !addBlock(format, value, blockFormat, iRange.getValues(i), blockEnd - i); i++)
+            add(format, value, blockFormat, iRange.getValue(i));
+          continue;
+        }
+
+        for(size_t i=block; i<blockEnd; i++)
+        {
+          if (!iRange.isSelected(i))
+            continue;
+
+          const uint8 valueFormat = iRange.getFormat(i);
+          if (native && valueFormat != Variant::STRING)
+          {
+            add(format, value, valueFormat, iRange.getValue(i));
+            continue;
+          }
+
+          if (native)
+          {
+            VariantAccess::setValue(result, format, value);
+          }
+          if (oPartial.empty)
+            assign(oPartial, iRange.getView(i));
+          else
+            result += iRange.getView(i);
+
+          native = (VariantAccess::getFormat(result) != Variant::STRING);
+          format = VariantAccess::getFormat(result);
+          value = VariantAccess::getValue(result);
+        }
+      }
+
+      if (native)
+      {
+        VariantAccess::setValue(result, format, value);
+      }
+    }
+
+    /// <summary>
+    /// Replaces a numeric value by the smallest (iDirection < 0) or the largest (iDirection > 0) value of a block of values of the same format.
+    /// Once a value of the block replaces the current value, the remaining values are compared with native values of the same type.
+    /// </summary>
+    template <int iDirection, int blockFormat, int resultFormat>
+    static void extremumBlock(Variant::VariantFormat & ioFormat, Variant::VariantUnion & ioValue, const Variant::VariantUnion * iValues, size_t iCount)
+    {
+      size_t i = 0;
+      while(i < iCount && compareNativeValues<blockFormat, resultFormat>(iValues[i], ioValue) * iDirection <= 0)
+        i++;
+      if (i == iCount)
+        return;
+
+      typedef typename CompareTraits<blockFormat>::local_type type;
+      size_t best = i;
+      type bestValue = static_cast<type>(CompareTraits<blockFormat>::get(iValues[i]));
+      for(i++; i<iCount; i++)
+      {
+        const type value = static_cast<type>(CompareTraits<blockFormat>::get(iValues[i]));
+        if (iDirection < 0 ? value < bestValue : bestValue < value)
+        {
+          best = i;
+          bestValue = value;
+        }
+      }
+      ioFormat = static_cast<Variant::VariantFormat>(blockFormat);
+      ioValue = iValues[best];
+    }
+
+    template <int iDirection, int blockFormat>
+    static void extremumBlock(Variant::VariantFormat & ioFormat, Variant::VariantUnion & ioValue, const Variant::VariantUnion * iValues, size_t iCount)
+    {
+      switch(ioFormat)
+      {
+      case Variant::BOOL:    extremumBlock<iDirection, blockFormat, Variant::BOOL   >(ioFormat, ioValue, iValues, iCount); break;
+      case Variant::UINT8:   extremumBlock<iDirection, blockFormat, Variant::UINT8  >(ioFormat, ioValue, iValues, iCount); break;
+      case Variant::UINT16:  extremumBlock<iDirection, blockFormat, Variant::UINT16 >(ioFormat, ioValue, iValues, iCount); break;
+      case Variant::UINT32:  extremumBlock<iDirection, blockFormat, Variant::UINT32 >(ioFormat, ioValue, iValues, iCount); break;
+      case Variant::UINT64:  extremumBlock<iDirection, blockFormat, Variant::UINT64 >(ioFormat, ioValue, iValues, iCount); break;
+      case Variant::SINT8:   extremumBlock<iDirection, blockFormat, Variant::SINT8  >(ioFormat, ioValue, iValues, iCount); break;
+      case Variant::SINT16:  extremumBlock<iDirection, blockFormat, Variant::SINT16 >(ioFormat, ioValue, iValues, iCount); break;
+      case Variant::SINT32:  extremumBlock<iDirection, blockFormat, Variant::SINT32 >(ioFormat, ioValue, iValues, iCount); break;
+      case Variant::SINT64:  extremumBlock<iDirection, blockFormat, Variant::SINT64 >(ioFormat, ioValue, iValues, iCount); break;
+      case Variant::FLOAT32: extremumBlock<iDirection, blockFormat, Variant::FLOAT32>(ioFormat, ioValue, iValues, iCount); break;
+      case Variant::FLOAT64: extremumBlock<iDirection, blockFormat, Variant::FLOAT64>(ioFormat, ioValue, iValues, iCount); break;
+      default:
+        assert( false ); /*error should not happen*/
+        break;
+      };
+    }
+
+    template <int iDirection>
+    static void extremumBlock(uint8 iFormat, Variant::VariantFormat & ioFormat, Variant::VariantUnion & ioValue, const Variant::VariantUnion * iValues, size_t iCount)
+    {
+      switch(iFormat)
+      {
+      case Variant::BOOL:    extremumBlock<iDirection, Variant::BOOL   >(ioFormat, ioValue, iValues, iCount); break;
+      case Variant::UINT8:   extremumBlock<iDirection, Variant::UINT8  >(ioFormat, ioValue, iValues, iCount); break;
+      case Variant::UINT16:  extremumBlock<iDirection, Variant::UINT16 >(ioFormat, ioValue, iValues, iCount); break;
+      case Variant::UINT32:  extremumBlock<iDirection, Variant::UINT32 >(ioFormat, ioValue, iValues, iCount); break;
+      case Variant::UINT64:  extremumBlock<iDirection, Variant::UINT64 >(ioFormat, ioValue, iValues, iCount); break;
+      case Variant::SINT8:   extremumBlock<iDirection, Variant::SINT8  >(ioFormat, ioValue, iValues, iCount); break;
+      case Variant::SINT16:  extremumBlock<iDirection, Variant::SINT16 >(ioFormat, ioValue, iValues, iCount); break;
+      case Variant::SINT32:  extremumBlock<iDirection, Variant::SINT32 >(ioFormat, ioValue, iValues, iCount); break;
+      case Variant::SINT64:  extremumBlock<iDirection, Variant::SINT64 >(ioFormat, ioValue, iValues, iCount); break;
+      case Variant::FLOAT32: extremumBlock<iDirection, Variant::FLOAT32>(ioFormat, ioValue, iValues, iCount); break;
+      case Variant::FLOAT64: extremumBlock<iDirection, Variant::FLOAT64>(ioFormat, ioValue, iValues, iCount); break;
+      default:
+        assert( false ); /*error should not happen*/
+        break;
+      };
+    }
+
+    /// <summary>
+    /// Keeps the smallest (iDirection < 0) or the largest (iDirection > 0) value of a chunk.
+    /// </summary>
+    template <int iDirection, class T>
+    static void extremumChunk(const T & iRange, size_t iBegin, size_t iEnd, Partial & oPartial)
+    {
+      Variant & result = oPartial.value;
+      for(size_t block=iBegin; block<iEnd; block+=BLOCK_SIZE)
+      {
+        const size_t blockEnd = (iEnd - block < BLOCK_SIZE ? iEnd : block + BLOCK_SIZE);
+        uint8 blockFormat = Variant::STRING;
+        if (!oPartial.empty && VariantAccess::getFormat(result) != Variant::STRING && iRange.getBlockFormat(block, blockEnd, blockFormat) && blockFormat != Variant::STRING)
+        {
+          Variant::VariantFormat format = VariantAccess::getFormat(result);
+          Variant::VariantUnion value = VariantAccess::getValue(result);
+          extremumBlock<iDirection>(blockFormat, format, value, iRange.getValues(block), blockEnd - block);
+          VariantAccess::setValue(result, format, value);
+          continue;
+        }
+
+        for(size_t i=block; i<blockEnd; i++)
+        {
+          if (!iRange.isSelected(i))
+            continue;
+          if (oPartial.empty)
+          {
+            assign(oPartial, iRange.getView(i));
+            continue;
+          }
+
+          const uint8 format = iRange.getFormat(i);
+          if (VariantAccess::getFormat(result) != Variant::STRING && format != Variant::STRING)
+          {
+            if (compareNativeValues(format, iRange.getValue(i), static_cast<uint8>(VariantAccess::getFormat(result)), VariantAccess::getValue(result)) * iDirection > 0)
+            {
+              VariantAccess::setValue(result, static_cast<Variant::VariantFormat>(format), iRange.getValue(i));
+            }
+          }
+          else if (iRange.getView(i).compare(result) * iDirection > 0)
+            assign(oPartial, iRange.getView(i));
+        }
+      }
+    }
+
+    template <class T>
+    static void collectChunk(const T & iRange, size_t iBegin, size_t iEnd, DistinctValues & oValues)
+    {
+      for(size_t i=iBegin; i<iEnd; i++)
+      {
+        if (!iRange.isSelected(i))
+          continue;
+
+        const uint8 format = iRange.getFormat(i);
+        if (format != Variant::STRING)
+        {
+          oValues.insert(format, iRange.getValue(i));
+          continue;
+        }
+
+        //a string which has a native representation is the same value as the native value
+        const Variant & view = iRange.getView(i);
+        Variant::VariantFormat simplifiedFormat;
+        Variant::VariantUnion simplifiedValue;
+        if (VariantAccess::getSimplifiedValue(view, simplifiedFormat, simplifiedValue))
+          oValues.insert(static_cast<uint8>(simplifiedFormat), simplifiedValue);
+        else if (oValues.strings.find(view) == oValues.strings.end())
+        {
+          Variant copy = view;
+          copy.materialize();
+          oValues.strings.insert(copy);
+        }
+      }
+    }
+
+    //----------------------
+    // aggregate functions
+    //----------------------
+    template <class T>
+    static Variant sum(ThreadPool & iPool, const T & iRange)
+    {
+      std::vector<Partial> partials;
+      processChunks(iPool, iRange, partials, sumChunk<T>);
+
+      Partial result;
+      for(size_t i=0; i<partials.size(); i++)
+      {
+        if (partials[i].empty)
+          continue;
+        if (result.empty)
+          assign(result, partials[i].value);
+        else
+          result.value += partials[i].value;
+      }
+      return result.value;
+    }
+
+    template <int iDirection, class T>
+    static Variant extremum(ThreadPool & iPool, const T & iRange)
+    {
+      std::vector<Partial> partials;
+      processChunks(iPool, iRange, partials, extremumChunk<iDirection, T>);
+
+      Partial result;
+      for(size_t i=0; i<partials.size(); i++)
+      {
+        if (partials[i].empty)
+          continue;
+        if (result.empty || partials[i].value.compare(result.value) * iDirection > 0)
+          assign(result, partials[i].value);
+      }
+      return result.value;
+    }
+
+    template <class T>
+    static Variant mean(ThreadPool & iPool, const T & iRange, size_t iCount)
+    {
+      if (iCount == 0)
+        return Variant();
+      Variant result = sum(iPool, iRange);
+      result /= Variant(static_cast<uint64>(iCount));
+      return result;
+    }
+
+    template <class T>
+    static size_t countDistinct(ThreadPool & iPool, const T & iRange)
+    {
+      std::vector<DistinctValues> partials;
+      processChunks(iPool, iRange, partials, collectChunk<T>);
+      if (partials.empty())
+        return 0;
+
+      DistinctValues & result = partials[0];
+      for(size_t i=1; i<partials.size(); i++)
+        result.merge(partials[i]);
+      return result.size();
+    }
+  };
+
+  //----------------------
+  // ranges of values
+  //----------------------
+  Variant Aggregate::sum(const Variant * iValues, size_t iSize, ThreadPool & iPool)
+  {
+    return Kernels::sum(iPool, Kernels::getRange(iValues, iSize));
+  }
+
+  Variant Aggregate::minimum(const Variant * iValues, size_t iSize, ThreadPool & iPool)
+  {
+    return Kernels::extremum<-1>(iPool, Kernels::getRange(iValues, iSize));
+  }
+
+  Variant Aggregate::maximum(const Variant * iValues, size_t iSize, ThreadPool & iPool)
+  {
+    return Kernels::extremum<+1>(iPool, Kernels::getRange(iValues, iSize));
+  }
+
+  Variant Aggregate::mean(const Variant * iValues, size_t iSize, ThreadPool & iPool)
+  {
+    return Kernels::mean(iPool, Kernels::getRange(iValues, iSize), iSize);
+  }
+
+  size_t Aggregate::countDistinct(const Variant * iValues, size_t iSize, ThreadPool & iPool)
+  {
+    return Kernels::countDistinct(iPool, Kernels::getRange(iValues, iSize));
+  }
+
+  //----------------------
+  // arrays of values
+  //----------------------
+  Variant Aggregate::sum(const VariantArray & iValues, const VariantArray::Bitmap * iSelection, ThreadPool & iPool)
+  {
+    return Kernels::sum(iPool, Kernels::getRange(iValues, iSelection));
+  }
+
+  Variant Aggregate::minimum(const VariantArray & iValues, const VariantArray::Bitmap * iSelection, ThreadPool & iPool)
+  {
+    return Kernels::extremum<-1>(iPool, Kernels::getRange(iValues, iSelection));
+  }
+
+  Variant Aggregate::maximum(const VariantArray & iValues, const VariantArray::Bitmap * iSelection, ThreadPool & iPool)
+  {
+    return Kernels::extremum<+1>(iPool, Kernels::getRange(iValues, iSelection));
+  }
+
+  Variant Aggregate::mean(const VariantArray & iValues, const VariantArray::Bitmap * iSelection, ThreadPool & iPool)
+  {
+    return Kernels::mean(iPool, Kernels::getRange(iValues, iSelection), count(iValues, iSelection));
+  }
+
+  size_t Aggregate::countDistinct(const VariantArray & iValues, const VariantArray::Bitmap * iSelection, ThreadPool & iPool)
+  {
+    return Kernels::countDistinct(iPool, Kernels::getRange(iValues, iSelection));
+  }
+
+  size_t Aggregate::count(const VariantArray & iValues, const VariantArray::Bitmap * iSelection)
+  {
+    if (iSelection == NULL)
+      return iValues.size();
+    return VariantArray::countSelected(*iSelection);
+  }
+
+} // End of namespace
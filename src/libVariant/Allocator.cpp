@@ -0,0 +1,199 @@
+/**********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2018 Antoine Beauchamp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+
+
+//---------------
+// Include Files
+//---------------
+#include "libvariant/allocator.h"
+
+#include <new> // operator new
+
+//-----------
+// Namespace
+//-----------
+
+namespace libVariant
+{
+  /// <summary>
+  /// The default allocator. Uses the global operator new and operator delete.
+  /// </summary>
+  class DefaultAllocator : public Allocator
+  {
+  public:
+    virtual void * allocate(size_t iSize)
+    {
+      return ::operator new(iSize);
+    }
+
+    virtual void deallocate(void * iBuffer, size_t /*iSize*/)
+    {
+      ::operator delete(iBuffer);
+    }
+  };
+
+  static DefaultAllocator gDefaultAllocator;
+  static thread_local Allocator * gCurrentAllocator = NULL;
+
+  //------------
+  // Allocator
+  //------------
+  Allocator::~Allocator()
+  {
+  }
+
+  Allocator & Allocator::getDefault()
+  {
+    return gDefaultAllocator;
+  }
+
+  Allocator & Allocator::getCurrent()
+  {
+    if (gCurrentAllocator == NULL)
+      return gDefaultAllocator;
+    return (*gCurrentAllocator);
+  }
+
+  void Allocator::setCurrent(Allocator * iAllocator)
+  {
+    gCurrentAllocator = iAllocator;
+  }
+
+  //----------------
+  // ArenaAllocator
+  //----------------
+
+  /// <summary>
+  /// Header of a memory block of an ArenaAllocator. The allocated buffers follow the header.
+  /// </summary>
+  struct ArenaAllocator::Block
+  {
+    Block * next;
+  };
+
+  /// <summary>
+  /// Alignment of the buffers returned by an ArenaAllocator.
+  /// </summary>
+  static const size_t ARENA_ALIGNMENT = 16;
+
+  inline static size_t alignSize(size_t iSize)
+  {
+    return (iSize + ARENA_ALIGNMENT - 1) & ~(ARENA_ALIGNMENT - 1);
+  }
+
+  ArenaAllocator::ArenaAllocator() :
+    mBlocks(NULL),
+    mCursor(NULL),
+    mEnd(NULL),
+    mBlockSize(DEFAULT_BLOCK_SIZE),
+    mAllocatedSize(0)
+  {
+  }
+
+  ArenaAllocator::ArenaAllocator(size_t iBlockSize) :
+    mBlocks(NULL),
+    mCursor(NULL),
+    mEnd(NULL),
+    mBlockSize(iBlockSize),
+    mAllocatedSize(0)
+  {
+  }
+
+  ArenaAllocator::~ArenaAllocator()
+  {
+    reset();
+  }
+
+  void * ArenaAllocator::allocate(size_t iSize)
+  {
+    iSize = alignSize(iSize == 0 ? 1 : iSize);
+
+    if (mCursor == NULL || static_cast<size_t>(mEnd - mCursor) < iSize)
+    {
+      //request a new block. Large buffers get their own block.
+      size_t size = (iSize > mBlockSize ? iSize : mBlockSize);
+      size_t headerSize = alignSize(sizeof(Block));
+      Block * block = static_cast<Block*>(::operator new(headerSize + size));
+      char * buffer = reinterpret_cast<char*>(block) + headerSize;
+
+      if (mBlocks != NULL && size != mBlockSize)
+      {
+        //keep filling the current block. Insert the large block after it.
+        block->next = mBlocks->next;
+        mBlocks->next = block;
+        mAllocatedSize += iSize;
+        return buffer;
+      }
+
+      block->next = mBlocks;
+      mBlocks = block;
+      mCursor = buffer;
+      mEnd = buffer + size;
+    }
+
+    void * output = mCursor;
+    mCursor += iSize;
+    mAllocatedSize += iSize;
+    return output;
+  }
+
+  void ArenaAllocator::deallocate(void * /*iBuffer*/, size_t /*iSize*/)
+  {
+    //memory is released by reset()
+  }
+
+  void ArenaAllocator::reset()
+  {
+    while(mBlocks)
+    {
+      Block * next = mBlocks->next;
+      ::operator delete(mBlocks);
+      mBlocks = next;
+    }
+    mCursor = NULL;
+    mEnd = NULL;
+    mAllocatedSize = 0;
+  }
+
+  size_t ArenaAllocator::getAllocatedSize() const
+  {
+    return mAllocatedSize;
+  }
+
+  //----------------
+  // AllocatorScope
+  //----------------
+  AllocatorScope::AllocatorScope(Allocator & iAllocator) :
+    mPrevious(gCurrentAllocator)
+  {
+    Allocator::setCurrent(&iAllocator);
+  }
+
+  AllocatorScope::~AllocatorScope()
+  {
+    Allocator::setCurrent(mPrevious);
+  }
+
+} // End of namespace
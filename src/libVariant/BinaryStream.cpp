@@ -0,0 +1,385 @@
+/**********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2018 Antoine Beauchamp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+
+//---------------
+// Include Files
+//---------------
+#include "libvariant/binary_stream.h"
+#include "VariantAccess.h"
+
+#include <assert.h>
+#include <string.h> // memcpy
+
+//-----------
+// Namespace
+//-----------
+
+namespace libVariant
+{
+  enum DECODE_STATUS
+  {
+    DECODE_OK,
+    DECODE_INCOMPLETE, //the buffer ends in the middle of a value
+    DECODE_INVALID,
+  };
+
+  inline static uint64 encodeZigZag(sint64 iValue)
+  {
+    return (static_cast<uint64>(iValue) << 1) ^ static_cast<uint64>(iValue >> 63);
+  }
+
+  inline static sint64 decodeZigZag(uint64 iValue)
+  {
+    return static_cast<sint64>(iValue >> 1) ^ -static_cast<sint64>(iValue & 1);
+  }
+
+  inline static size_t getVarintSize(uint64 iValue)
+  {
+    size_t size = 1;
+    while(iValue >= 0x80)
+    {
+      iValue >>= 7;
+      size++;
+    }
+    return size;
+  }
+
+  inline static char * encodeVarint(uint64 iValue, char * oBuffer)
+  {
+    while(iValue >= 0x80)
+    {
+      *oBuffer++ = static_cast<char>(static_cast<uint8>(iValue) | 0x80);
+      iValue >>= 7;
+    }
+    *oBuffer++ = static_cast<char>(iValue);
+    return oBuffer;
+  }
+
+  inline static DECODE_STATUS decodeVarint(const char * iBuffer, size_t iSize, size_t & ioPosition, uint64 & oValue)
+  {
+    uint64 value = 0;
+    for(size_t shift=0; shift<64; shift+=7)
+    {
+      if (ioPosition == iSize)
+        return DECODE_INCOMPLETE;
+      const uint8 byte = static_cast<uint8>(iBuffer[ioPosition++]);
+      if (shift == 63 && byte > 1)
+        return DECODE_INVALID; //more than 64 bits
+      value |= static_cast<uint64>(byte & 0x7F) << shift;
+      if ((byte & 0x80) == 0)
+      {
+        oValue = value;
+        return DECODE_OK;
+      }
+    }
+    return DECODE_INVALID;
+  }
+
+  template <typename T>
+  inline static char * encodeLittleEndian(T iBits, char * oBuffer)
+  {
+    for(size_t i=0; i<sizeof(T); i++)
+      *oBuffer++ = static_cast<char>(static_cast<uint8>(iBits >> (8 * i)));
+    return oBuffer;
+  }
+
+  template <typename T>
+  inline static T decodeLittleEndian(const char * iBuffer)
+  {
+    T bits = 0;
+    for(size_t i=0; i<sizeof(T); i++)
+      bits |= static_cast<T>(static_cast<uint8>(iBuffer[i])) << (8 * i);
+    return bits;
+  }
+
+  /// <summary>
+  /// Encodes a value which is not a string. The buffer must be at least BinaryWriter::MAX_NUMBER_SIZE bytes.
+  /// </summary>
+  /// <returns>Returns the number of encoded bytes.</returns>
+  static size_t encodeNative(uint8 iFormat, const Variant::VariantUnion & iValue, char * oBuffer)
+  {
+    char * position = oBuffer;
+    *position++ = static_cast<char>(iFormat);
+    switch(iFormat)
+    {
+    case Variant::BOOL:    *position++ = (iValue.as_bool ? 1 : 0); break;
+    case Variant::UINT8:   position = encodeVarint(iValue.as_uint8 , position); break;
+    case Variant::UINT16:  position = encodeVarint(iValue.as_uint16, position); break;
+    case Variant::UINT32:  position = encodeVarint(iValue.as_uint32, position); break;
+    case Variant::UINT64:  position = encodeVarint(iValue.as_uint64, position); break;
+    case Variant::SINT8:   position = encodeVarint(encodeZigZag(iValue.as_sint8 ), position); break;
+    case Variant::SINT16:  position = encodeVarint(encodeZigZag(iValue.as_sint16), position); break;
+    case Variant::SINT32:  position = encodeVarint(encodeZigZag(iValue.as_sint32), position); break;
+    case Variant::SINT64:  position = encodeVarint(encodeZigZag(iValue.as_sint64), position); break;
+    case Variant::FLOAT32:
+      {
+        uint32 bits;
+        memcpy(&bits, &iValue.as_float32, sizeof(bits));
+        position = encodeLittleEndian(bits, position);
+      }
+      break;
+    case Variant::FLOAT64:
+      {
+        uint64 bits;
+        memcpy(&bits, &iValue.as_float64, sizeof(bits));
+        position = encodeLittleEndian(bits, position);
+      }
+      break;
+    default:
+      assert( false ); /*error should not happen*/
+      break;
+    };
+    return static_cast<size_t>(position - oBuffer);
+  }
+
+  //--------------
+  // BinaryWriter
+  //--------------
+  const size_t BinaryWriter::MAX_NUMBER_SIZE;
+
+  BinaryWriter::BinaryWriter(char * iBuffer, size_t iSize) :
+    mBuffer(iBuffer),
+    mSize(iSize),
+    mPosition(0)
+  {
+  }
+
+  void BinaryWriter::reset(char * iBuffer, size_t iSize)
+  {
+    mBuffer = iBuffer;
+    mSize = iSize;
+    mPosition = 0;
+  }
+
+  bool BinaryWriter::write(const Variant & iValue)
+  {
+    if (VariantAccess::getFormat(iValue) == Variant::STRING)
+      return writeString(VariantAccess::getStringBuffer(iValue), VariantAccess::getStringLength(iValue));
+    return writeNative(static_cast<uint8>(VariantAccess::getFormat(iValue)), VariantAccess::getValue(iValue));
+  }
+
+  bool BinaryWriter::write(const VariantArray & iValues, size_t iIndex)
+  {
+    const uint8 format = static_cast<uint8>(iValues.getFormat(iIndex));
+    if (format == Variant::STRING)
+    {
+      size_t length = 0;
+      const char * buffer = iValues.getStringBuffer(iIndex, length);
+      return writeString(buffer, length);
+    }
+    return writeNative(format, iValues.getValues()[iIndex]);
+  }
+
+  size_t BinaryWriter::getEncodedSize(const Variant & iValue)
+  {
+    if (VariantAccess::getFormat(iValue) == Variant::STRING)
+    {
+      const size_t length = VariantAccess::getStringLength(iValue);
+      return 1 + getVarintSize(length) + length;
+    }
+    char buffer[MAX_NUMBER_SIZE];
+    return encodeNative(static_cast<uint8>(VariantAccess::getFormat(iValue)), VariantAccess::getValue(iValue), buffer);
+  }
+
+  bool BinaryWriter::writeNative(uint8 iFormat, const Variant::VariantUnion & iValue)
+  {
+    if (mSize - mPosition >= MAX_NUMBER_SIZE)
+    {
+      mPosition += encodeNative(iFormat, iValue, mBuffer + mPosition);
+      return true;
+    }
+
+    //near the end of the buffer
+    char buffer[MAX_NUMBER_SIZE];
+    const size_t size = encodeNative(iFormat, iValue, buffer);
+    if (mSize - mPosition < size)
+      return false;
+    memcpy(mBuffer + mPosition, buffer, size);
+    mPosition += size;
+    return true;
+  }
+
+  bool BinaryWriter::writeString(const char * iValue, size_t iLength)
+  {
+    const size_t size = 1 + getVarintSize(iLength) + iLength;
+    if (mSize - mPosition < size)
+      return false;
+
+    char * position = mBuffer + mPosition;
+    *position++ = static_cast<char>(Variant::STRING);
+    position = encodeVarint(iLength, position);
+    memcpy(position, iValue, iLength);
+    mPosition += size;
+    return true;
+  }
+
+  //--------------
+  // BinaryReader
+  //--------------
+  BinaryReader::BinaryReader(const char * iBuffer, size_t iSize) :
+    mBuffer(iBuffer),
+    mSize(iSize),
+    mPosition(0),
+    mError(false)
+  {
+  }
+
+  void BinaryReader::reset(const char * iBuffer, size_t iSize)
+  {
+    mBuffer = iBuffer;
+    mSize = iSize;
+    mPosition = 0;
+    mError = false;
+  }
+
+  bool BinaryReader::read(Variant & oValue)
+  {
+    if (!readValue(oValue))
+      return false;
+    oValue.materialize();
+    return true;
+  }
+
+  bool BinaryReader::readView(Variant & oValue)
+  {
+    return readValue(oValue);
+  }
+
+  bool BinaryReader::read(VariantArray & ioValues)
+  {
+    Variant value;
+    if (!readValue(value))
+      return false;
+    ioValues.push_back(value);
+    return true;
+  }
+
+  bool BinaryReader::readValue(Variant & oValue)
+  {
+    if (mError || mPosition == mSize)
+      return false;
+
+    //the maximum value of each integer format
+    static const uint64 MAX_VALUES[] = {
+      1, 0xFFull, 0x7Full, 0xFFFFull, 0x7FFFull, 0xFFFFFFFFull, 0x7FFFFFFFull, 0xFFFFFFFFFFFFFFFFull, 0x7FFFFFFFFFFFFFFFull,
+    };
+
+    size_t position = mPosition;
+    const uint8 format = static_cast<uint8>(mBuffer[position++]);
+    DECODE_STATUS status = DECODE_OK;
+    uint64 value = 0;
+    switch(format)
+    {
+    case Variant::BOOL:
+    case Variant::UINT8:
+    case Variant::UINT16:
+    case Variant::UINT32:
+    case Variant::UINT64:
+      if (format == Variant::BOOL)
+      {
+        if (position == mSize)
+          return false;
+        value = static_cast<uint8>(mBuffer[position++]);
+      }
+      else
+        status = decodeVarint(mBuffer, mSize, position, value);
+      if (status == DECODE_OK && value > MAX_VALUES[format])
+        status = DECODE_INVALID;
+      if (status != DECODE_OK)
+        break;
+      switch(format)
+      {
+      case Variant::BOOL:   oValue.setBool(value != 0); break;
+      case Variant::UINT8:  oValue.setUInt8 (static_cast<uint8 >(value)); break;
+      case Variant::UINT16: oValue.setUInt16(static_cast<uint16>(value)); break;
+      case Variant::UINT32: oValue.setUInt32(static_cast<uint32>(value)); break;
+      default:              oValue.setUInt64(value); break;
+      };
+      break;
+    case Variant::SINT8:
+    case Variant::SINT16:
+    case Variant::SINT32:
+    case Variant::SINT64:
+      {
+        status = decodeVarint(mBuffer, mSize, position, value);
+        const sint64 number = decodeZigZag(value);
+        if (status == DECODE_OK && (number > static_cast<sint64>(MAX_VALUES[format]) || number < -static_cast<sint64>(MAX_VALUES[format]) - 1))
+          status = DECODE_INVALID;
+        if (status != DECODE_OK)
+          break;
+        switch(format)
+        {
+        case Variant::SINT8:  oValue.setSInt8 (static_cast<sint8 >(number)); break;
+        case Variant::SINT16: oValue.setSInt16(static_cast<sint16>(number)); break;
+        case Variant::SINT32: oValue.setSInt32(static_cast<sint32>(number)); break;
+        default:              oValue.setSInt64(number); break;
+        };
+      }
+      break;
+    case Variant::FLOAT32:
+      {
+        if (mSize - position < sizeof(uint32))
+          return false;
+        const uint32 bits = decodeLittleEndian<uint32>(mBuffer + position);
+        position += sizeof(bits);
+        float32 number;
+        memcpy(&number, &bits, sizeof(number));
+        oValue.setFloat32(number);
+      }
+      break;
+    case Variant::FLOAT64:
+      {
+        if (mSize - position < sizeof(uint64))
+          return false;
+        const uint64 bits = decodeLittleEndian<uint64>(mBuffer + position);
+        position += sizeof(bits);
+        float64 number;
+        memcpy(&number, &bits, sizeof(number));
+        oValue.setFloat64(number);
+      }
+      break;
+    case Variant::STRING:
+      status = decodeVarint(mBuffer, mSize, position, value);
+      if (status == DECODE_OK && value > mSize - position)
+        status = DECODE_INCOMPLETE;
+      if (status != DECODE_OK)
+        break;
+      oValue.setStringView(mBuffer + position, static_cast<size_t>(value));
+      position += static_cast<size_t>(value);
+      break;
+    default:
+      status = DECODE_INVALID;
+      break;
+    };
+
+    if (status == DECODE_INVALID)
+      mError = true;
+    if (status != DECODE_OK)
+      return false;
+    mPosition = position;
+    return true;
+  }
+
+} // End of namespace
@@ -0,0 +1,305 @@
+/**********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2018 Antoine Beauchamp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+
+//---------------
+// Include Files
+//---------------
+#include "libvariant/compact_variant.h"
+#include "VariantAccess.h"
+
+#include <assert.h>
+
+//-----------
+// Namespace
+//-----------
+
+namespace libVariant
+{
+  static_assert(sizeof(CompactVariant) <= 2 * sizeof(Variant::VariantUnion), "CompactVariant must be as small as an internal format and a VariantUnion");
+
+  /// <summary>
+  /// A read-only Variant which shares the value of a CompactVariant.
+  /// All conversion and comparison rules of CompactVariant are delegated to the Variant class through a VariantView
+  /// which guarantees that both classes behave identically.
+  /// </summary>
+  class CompactVariant::VariantView
+  {
+  public:
+    VariantView(const CompactVariant & iValue)
+    {
+      CompactVariant::borrow(iValue, mVariant);
+    }
+
+    ~VariantView()
+    {
+      CompactVariant::unborrow(mVariant);
+    }
+
+    const Variant & get() const { return mVariant; }
+
+  private:
+    VariantView(const VariantView &);
+    VariantView & operator = (const VariantView &);
+
+    Variant mVariant;
+  };
+
+  CompactVariant::CompactVariant(const Variant & iValue) : mFormat(Variant::UINT8)
+  {
+    mData.as_bits = 0;
+    if (iValue.getFormat() == Variant::STRING)
+    {
+      mFormat = Variant::STRING;
+      mData.as_str = new Str(VariantAccess::getStringBuffer(iValue), VariantAccess::getStringLength(iValue));
+      return;
+    }
+    mFormat = VariantAccess::getFormat(iValue);
+    mData = VariantAccess::getValue(iValue);
+  }
+
+  //----------------
+  // public methods
+  //----------------
+  Variant CompactVariant::toVariant() const
+  {
+    VariantView view(*this);
+    return Variant(view.get());
+  }
+
+  Str CompactVariant::getString() const
+  {
+    if (mFormat == Variant::STRING)
+      return (*mData.as_str);
+    VariantView view(*this);
+    return view.get().getString();
+  }
+
+  size_t CompactVariant::getString(char * oBuffer, size_t iSize) const
+  {
+    VariantView view(*this);
+    return view.get().getString(oBuffer, iSize);
+  }
+
+  void CompactVariant::setString(const CStr & iValue)
+  {
+    if (iValue == NULL)
+    {
+      //same as Variant: an existing string value is kept
+      if (mFormat != Variant::STRING)
+        setString("");
+      return;
+    }
+
+    //iValue may point to the current string. Release it only once iValue is copied.
+    Str * str = new Str(iValue);
+    clear();
+    mFormat = Variant::STRING;
+    mData.as_str = str;
+  }
+
+  bool CompactVariant::simplify()
+  {
+    if (mFormat != Variant::STRING &&
+        mFormat != Variant::FLOAT32 &&
+        mFormat != Variant::FLOAT64)
+      return false; //no need to simplify;
+
+    Variant tmp;
+    moveTo(tmp);
+    bool simplified = tmp.simplify();
+    moveFrom(tmp);
+    return simplified;
+  }
+
+  void CompactVariant::promote(const Variant::VariantFormat & iFormat)
+  {
+    if (mFormat == iFormat)
+      return; //nothing to do
+
+    Variant tmp;
+    moveTo(tmp);
+    tmp.promote(iFormat);
+    moveFrom(tmp);
+  }
+
+  bool CompactVariant::isPositive() const
+  {
+    VariantView view(*this);
+    return view.get().isPositive();
+  }
+
+  bool CompactVariant::isNegative() const
+  {
+    VariantView view(*this);
+    return view.get().isNegative();
+  }
+
+  //----------------------
+  //   operators
+  //----------------------
+  const CompactVariant & CompactVariant::operator += (const CompactVariant & iValue)
+  {
+    if (this == &iValue)
+    {
+      CompactVariant copy(iValue);
+      return (*this) += copy;
+    }
+
+    VariantView value(iValue);
+    Variant tmp;
+    moveTo(tmp);
+    tmp += value.get();
+    moveFrom(tmp);
+    return (*this);
+  }
+
+  const CompactVariant & CompactVariant::operator -= (const CompactVariant & iValue)
+  {
+    if (this == &iValue)
+    {
+      CompactVariant copy(iValue);
+      return (*this) -= copy;
+    }
+
+    VariantView value(iValue);
+    Variant tmp;
+    moveTo(tmp);
+    tmp -= value.get();
+    moveFrom(tmp);
+    return (*this);
+  }
+
+  const CompactVariant & CompactVariant::operator *= (const CompactVariant & iValue)
+  {
+    if (this == &iValue)
+    {
+      CompactVariant copy(iValue);
+      return (*this) *= copy;
+    }
+
+    VariantView value(iValue);
+    Variant tmp;
+    moveTo(tmp);
+    tmp *= value.get();
+    moveFrom(tmp);
+    return (*this);
+  }
+
+  const CompactVariant & CompactVariant::operator /= (const CompactVariant & iValue)
+  {
+    if (this == &iValue)
+    {
+      CompactVariant copy(iValue);
+      return (*this) /= copy;
+    }
+
+    VariantView value(iValue);
+    Variant tmp;
+    moveTo(tmp);
+    tmp /= value.get();
+    moveFrom(tmp);
+    return (*this);
+  }
+
+  int CompactVariant::compare(const CompactVariant & iValue) const
+  {
+    VariantView local(*this);
+    VariantView remote(iValue);
+    return local.get().compare(remote.get());
+  }
+
+  size_t CompactVariant::hash() const
+  {
+    VariantView view(*this);
+    return view.get().hash();
+  }
+
+  //----------------
+  // private methods
+  //----------------
+  void CompactVariant::releaseString()
+  {
+    assert( mFormat == Variant::STRING );
+    delete mData.as_str;
+    mData.as_str = NULL;
+  }
+
+  bool CompactVariant::convertBool() const
+  {
+    VariantView view(*this);
+    return view.get().getBool();
+  }
+
+  void CompactVariant::convert(uint8   & oValue) const { VariantView view(*this); oValue = view.get().getUInt8  (); }
+  void CompactVariant::convert(uint16  & oValue) const { VariantView view(*this); oValue = view.get().getUInt16 (); }
+  void CompactVariant::convert(uint32  & oValue) const { VariantView view(*this); oValue = view.get().getUInt32 (); }
+  void CompactVariant::convert(uint64  & oValue) const { VariantView view(*this); oValue = view.get().getUInt64 (); }
+  void CompactVariant::convert(sint8   & oValue) const { VariantView view(*this); oValue = view.get().getSInt8  (); }
+  void CompactVariant::convert(sint16  & oValue) const { VariantView view(*this); oValue = view.get().getSInt16 (); }
+  void CompactVariant::convert(sint32  & oValue) const { VariantView view(*this); oValue = view.get().getSInt32 (); }
+  void CompactVariant::convert(sint64  & oValue) const { VariantView view(*this); oValue = view.get().getSInt64 (); }
+  void CompactVariant::convert(float32 & oValue) const { VariantView view(*this); oValue = view.get().getFloat32(); }
+  void CompactVariant::convert(float64 & oValue) const { VariantView view(*this); oValue = view.get().getFloat64(); }
+
+  void CompactVariant::moveTo(Variant & oValue)
+  {
+    borrow(*this, oValue);
+
+    //oValue now owns the string
+    mFormat = Variant::UINT8;
+    mData.as_bits = 0;
+  }
+
+  void CompactVariant::moveFrom(Variant & iValue)
+  {
+    clear();
+
+    if (VariantAccess::getFormat(iValue) != Variant::STRING)
+    {
+      mFormat = VariantAccess::getFormat(iValue);
+      mData = VariantAccess::getValue(iValue);
+      iValue.setUInt8(0); //cleared
+      return;
+    }
+
+    mData.as_str = VariantAccess::detachString(iValue);
+    mFormat = Variant::STRING;
+  }
+
+  void CompactVariant::borrow(const CompactVariant & iValue, Variant & oValue)
+  {
+    if (iValue.mFormat == Variant::STRING)
+      VariantAccess::attachString(oValue, iValue.mData.as_str);
+    else
+      VariantAccess::setValue(oValue, iValue.mFormat, iValue.mData);
+  }
+
+  void CompactVariant::unborrow(Variant & ioValue)
+  {
+    //forget about the shared string without releasing it
+    VariantAccess::releaseString(ioValue);
+  }
+
+} // End of namespace
@@ -0,0 +1,397 @@
+/**********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2018 Antoine Beauchamp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+
+//---------------
+// Include Files
+//---------------
+#include "libvariant/csv_reader.h"
+#include "StringParser.h"
+#include "VariantAccess.h"
+
+#include <assert.h>
+#include <string.h> // memchr
+
+//-----------
+// Namespace
+//-----------
+
+namespace libVariant
+{
+  /// <summary>
+  /// Parses delimited records into columns of values.
+  /// </summary>
+  class CsvReader::Parser
+  {
+  public:
+    /// <summary>
+    /// Result of the parsing of consecutive records.
+    /// </summary>
+    struct Records
+    {
+      std::vector<VariantArray> columns;
+      size_t numColumns; //0 if no record was parsed
+      size_t size;       //number of bytes of the parsed records
+      bool error;        //true if parsing stopped at an invalid record
+    };
+
+    Parser(char iDelimiter) : mDelimiter(iDelimiter) {}
+
+    /// <summary>
+    /// Parses the records of a buffer.
+    /// </summary>
+    /// <param name="iNumColumns">The expected number of fields of each record. 0 accepts the number of fields of the first record.</param>
+    /// <param name="iMaxRecords">The maximum number of records to parse.</param>
+    void parse(const char * iBegin, const char * iEnd, bool iFinal, size_t iNumColumns, size_t iMaxRecords, Records & oRecords)
+    {
+      oRecords.numColumns = iNumColumns;
+      oRecords.size = 0;
+      oRecords.error = false;
+
+      const char * position = iBegin;
+      size_t numRecords = 0;
+      while(position < iEnd && numRecords < iMaxRecords)
+      {
+        const char * next = position;
+        PARSE_STATUS status = parseRecord(next, iEnd, iFinal);
+        if (status == PARSE_INCOMPLETE)
+          break;
+        if (status == PARSE_INVALID || (status == PARSE_RECORD && oRecords.numColumns != 0 && mFields.size() != oRecords.numColumns))
+        {
+          oRecords.error = true;
+          break;
+        }
+        position = next;
+        oRecords.size = position - iBegin;
+        if (status == PARSE_EMPTY_LINE)
+          continue;
+
+        if (oRecords.numColumns == 0)
+          oRecords.numColumns = mFields.size();
+        oRecords.columns.resize(oRecords.numColumns);
+        for(size_t i=0; i<mFields.size(); i++)
+          appendField(mFields[i], oRecords.columns[i]);
+        numRecords++;
+      }
+    }
+
+  private:
+    enum PARSE_STATUS
+    {
+      PARSE_RECORD,     //a record was parsed
+      PARSE_EMPTY_LINE, //an empty line was skipped
+      PARSE_INCOMPLETE, //the record ends after the buffer
+      PARSE_INVALID,    //the record is invalid
+    };
+
+    /// <summary>
+    /// Characters of a field, without the quotes of a quoted field.
+    /// The characters of a field with doubled quotes are copied without the doubled quotes in mUnquoted.
+    /// </summary>
+    struct Field
+    {
+      const char * buffer;
+      size_t offset; //offset in mUnquoted if buffer is NULL
+      size_t length;
+    };
+
+    /// <summary>
+    /// Parses the fields of the record at the given position. The position is moved after the line ending of the record.
+    /// </summary>
+    PARSE_STATUS parseRecord(const char *& ioPosition, const char * iEnd, bool iFinal)
+    {
+      mFields.clear();
+      mUnquoted.clear();
+
+      const char * p = ioPosition;
+      if (*p == '\n' || (*p == '\r' && p + 1 < iEnd && p[1] == '\n'))
+      {
+        ioPosition = p + (*p == '\n' ? 1 : 2);
+        return PARSE_EMPTY_LINE;
+      }
+
+      for(;;)
+      {
+        Field field = { NULL, 0, 0 };
+        if (p < iEnd && *p == '"')
+        {
+          //quoted field
+          const char * begin = p + 1;
+          const char * end = begin;
+          bool escaped = false;
+          for(;;)
+          {
+            end = static_cast<const char *>(memchr(end, '"', iEnd - end));
+            if (end == NULL)
+              return (iFinal ? PARSE_INVALID : PARSE_INCOMPLETE);
+            if (end + 1 < iEnd && end[1] == '"')
+            {
+              escaped = true;
+              end += 2;
+              continue;
+            }
+            if (end + 1 == iEnd && !iFinal)
+              return PARSE_INCOMPLETE; //the next character may be a quote
+            break;
+          }
+          if (escaped)
+          {
+            field.offset = mUnquoted.size();
+            for(const char * c = begin; c < end; c++)
+            {
+              mUnquoted.push_back(*c);
+              if (*c == '"')
+                c++;
+            }
+            field.length = mUnquoted.size() - field.offset;
+          }
+          else
+          {
+            field.buffer = begin;
+            field.length = end - begin;
+          }
+          p = end + 1;
+          if (p < iEnd && *p == '\r' && p + 1 < iEnd && p[1] == '\n')
+            p++;
+          if (p < iEnd && *p != mDelimiter && *p != '\n')
+            return (*p == '\r' && p + 1 == iEnd && !iFinal ? PARSE_INCOMPLETE : PARSE_INVALID);
+        }
+        else
+        {
+          const char * begin = p;
+          while(p < iEnd && *p != mDelimiter && *p != '\n')
+          {
+            if (*p == '"')
+              return PARSE_INVALID;
+            p++;
+          }
+          field.buffer = begin;
+          field.length = p - begin;
+          if (p < iEnd && *p == '\n' && field.length > 0 && p[-1] == '\r')
+            field.length--;
+        }
+        mFields.push_back(field);
+
+        if (p == iEnd)
+        {
+          if (!iFinal)
+            return PARSE_INCOMPLETE;
+          ioPosition = p;
+          return PARSE_RECORD;
+        }
+        if (*p == '\n')
+        {
+          ioPosition = p + 1;
+          return PARSE_RECORD;
+        }
+        p++; //next field
+      }
+    }
+
+    /// <summary>
+    /// Appends a field to a column with its narrowest format.
+    /// </summary>
+    void appendField(const Field & iField, VariantArray & ioColumn)
+    {
+      const char * buffer = (iField.buffer != NULL ? iField.buffer : (mUnquoted.empty() ? "" : &mUnquoted[iField.offset]));
+
+      StringParser parser;
+      parser.parse(buffer, iField.length);
+      Variant::VariantFormat format = Variant::UINT8;
+      Variant::VariantUnion data;
+      if (getNarrowestFormat(parser, format, data))
+      {
+        Variant value;
+        VariantAccess::setValue(value, format, data);
+        ioColumn.push_back(value);
+      }
+      else
+        ioColumn.push_back(buffer, iField.length);
+    }
+
+    char mDelimiter;
+    std::vector<Field> mFields;
+    std::vector<char> mUnquoted;
+  };
+
+  /// <summary>
+  /// Returns the position following the first line ending of a buffer which is not in a quoted field.
+  /// </summary>
+  /// <param name="iQuoted">True if the buffer begins in a quoted field.</param>
+  /// <returns>Returns the position of the next record or iEnd if the buffer does not contain a line ending.</returns>
+  static const char * findRecordBoundary(const char * iBegin, const char * iEnd, bool iQuoted)
+  {
+    bool quoted = iQuoted;
+    for(const char * p = iBegin; p < iEnd; p++)
+    {
+      if (*p == '"')
+        quoted = !quoted;
+      else if (*p == '\n' && !quoted)
+        return p + 1;
+    }
+    return iEnd;
+  }
+
+  static size_t countQuotes(const char * iBegin, const char * iEnd)
+  {
+    size_t count = 0;
+    for(const char * p = iBegin; p < iEnd; p++)
+      count += (*p == '"');
+    return count;
+  }
+
+  /// <summary>
+  /// Appends the values of an array at the end of another array.
+  /// </summary>
+  static void appendColumn(const VariantArray & iValues, VariantArray & ioColumn)
+  {
+    for(size_t i=0; i<iValues.size(); i++)
+      ioColumn.push_back(iValues.getView(i));
+  }
+
+  CsvReader::CsvReader(char iDelimiter, bool iHeader) :
+    mDelimiter(iDelimiter),
+    mHeaderPending(iHeader),
+    mError(false)
+  {
+    assert( iDelimiter != '"' && iDelimiter != '\n' && iDelimiter != '\r' );
+  }
+
+  //----------------
+  // public methods
+  //----------------
+  size_t CsvReader::read(const char * iBuffer, size_t iSize, bool iFinal, std::vector<VariantArray> & ioColumns, ThreadPool & iPool)
+  {
+    mError = false;
+    const char * end = iBuffer + iSize;
+    size_t position = 0;
+
+    if (mHeaderPending)
+    {
+      Parser parser(mDelimiter);
+      Parser::Records header;
+      parser.parse(iBuffer, end, iFinal, ioColumns.size(), 1, header);
+      mError = header.error;
+      if (header.error || header.numColumns == 0)
+        return header.size;
+
+      mHeaderPending = false;
+      mColumnNames.clear();
+      for(size_t i=0; i<header.numColumns; i++)
+        mColumnNames.push_back(header.columns[i].getView(0).getString());
+      if (ioColumns.empty())
+        ioColumns.resize(header.numColumns);
+      position = header.size;
+    }
+
+    //split the buffer at record boundaries. A line ending is a record boundary if the number of quotes before it is even.
+    const char * begin = iBuffer + position;
+    size_t size = end - begin;
+    size_t numParts = (size + CHUNK_SIZE - 1) / CHUNK_SIZE;
+    std::vector<const char *> boundaries(numParts + 1, end);
+    if (numParts > 0)
+      boundaries[0] = begin;
+    if (numParts > 1)
+    {
+      std::vector<size_t> quotes(numParts, 0);
+      iPool.parallelFor(numParts, [&](size_t iChunk)
+      {
+        const char * chunk = begin + iChunk * CHUNK_SIZE;
+        quotes[iChunk] = countQuotes(chunk, (iChunk + 1 == numParts ? end : chunk + CHUNK_SIZE));
+      });
+
+      std::vector<bool> quoted(numParts, false);
+      for(size_t i=1; i<numParts; i++)
+        quoted[i] = (quoted[i-1] != (quotes[i-1] % 2 == 1));
+
+      iPool.parallelFor(numParts - 1, [&](size_t iIndex)
+      {
+        size_t chunk = iIndex + 1;
+        boundaries[chunk] = findRecordBoundary(begin + chunk * CHUNK_SIZE, end, quoted[chunk]);
+      });
+
+      //a record may span multiple chunks
+      for(size_t i=1; i<numParts; i++)
+      {
+        if (boundaries[i] < boundaries[i-1])
+          boundaries[i] = boundaries[i-1];
+      }
+    }
+
+    //parse the parts. Parts which end before the end of the buffer contain complete records.
+    //The first part is appended directly to the columns.
+    std::vector<Parser::Records> parts(numParts);
+    size_t expectedColumns = ioColumns.size();
+    if (numParts > 0)
+      parts[0].columns.swap(ioColumns);
+    iPool.parallelFor(numParts, [&](size_t iPart)
+    {
+      Parser::Records & part = parts[iPart];
+      part.numColumns = 0;
+      part.size = 0;
+      part.error = false;
+      Parser parser(mDelimiter);
+      bool final = (boundaries[iPart + 1] == end ? iFinal : true);
+      parser.parse(boundaries[iPart], boundaries[iPart + 1], final, expectedColumns, static_cast<size_t>(-1), part);
+    });
+
+    //keep the parts in order, up to the first invalid record
+    size_t numColumns = expectedColumns;
+    size_t numValidParts = 0;
+    while(numValidParts < numParts)
+    {
+      const Parser::Records & part = parts[numValidParts];
+      if (part.numColumns != 0 && numColumns != 0 && part.numColumns != numColumns)
+      {
+        mError = true;
+        break;
+      }
+      if (part.numColumns != 0)
+        numColumns = part.numColumns;
+      position = (boundaries[numValidParts] - iBuffer) + part.size;
+      numValidParts++;
+      if (part.error)
+      {
+        mError = true;
+        break;
+      }
+    }
+
+    //append the values of the other parts to the columns
+    if (numParts > 0)
+      ioColumns.swap(parts[0].columns);
+    ioColumns.resize(numColumns);
+    iPool.parallelFor(numColumns, [&](size_t iColumn)
+    {
+      for(size_t i=1; i<numValidParts; i++)
+      {
+        if (parts[i].numColumns != 0)
+          appendColumn(parts[i].columns[iColumn], ioColumns[iColumn]);
+      }
+    });
+
+    return position;
+  }
+
+} // End of namespace
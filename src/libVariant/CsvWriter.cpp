@@ -0,0 +1,200 @@
+/**********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2018 Antoine Beauchamp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+
+//---------------
+// Include Files
+//---------------
+#include "libvariant/csv_writer.h"
+#include "StringEncoder.h"
+#include "VariantAccess.h"
+
+#include <assert.h>
+#include <string.h> // memcpy
+
+//-----------
+// Namespace
+//-----------
+
+namespace libVariant
+{
+  CsvWriter::CsvWriter(std::ostream & iStream, char iDelimiter) :
+    mStream(iStream),
+    mDelimiter(iDelimiter),
+    mFirstField(true),
+    mBuffer(BUFFER_SIZE),
+    mUsed(0)
+  {
+    assert( iDelimiter != '"' && iDelimiter != '\n' && iDelimiter != '\r' );
+  }
+
+  CsvWriter::~CsvWriter()
+  {
+    flush();
+  }
+
+  //----------------
+  // public methods
+  //----------------
+  void CsvWriter::write(const Variant & iValue)
+  {
+    if (VariantAccess::getFormat(iValue) == Variant::STRING)
+      writeString(VariantAccess::getStringBuffer(iValue), VariantAccess::getStringLength(iValue));
+    else
+      writeNative(static_cast<uint8>(VariantAccess::getFormat(iValue)), VariantAccess::getValue(iValue));
+  }
+
+  void CsvWriter::write(const VariantArray & iValues, size_t iIndex)
+  {
+    assert( iIndex < iValues.size() );
+    uint8 format = iValues.getFormats()[iIndex];
+    if (format == Variant::STRING)
+    {
+      size_t length = 0;
+      const char * buffer = iValues.getStringBuffer(iIndex, length);
+      writeString(buffer, length);
+    }
+    else
+      writeNative(format, iValues.getValues()[iIndex]);
+  }
+
+  void CsvWriter::endRecord()
+  {
+    if (mUsed == mBuffer.size())
+      flush();
+    mBuffer[mUsed++] = '\n';
+    mFirstField = true;
+  }
+
+  void CsvWriter::writeColumns(const std::vector<VariantArray> & iColumns)
+  {
+    size_t numRecords = (iColumns.empty() ? 0 : iColumns[0].size());
+    for(size_t i=0; i<numRecords; i++)
+    {
+      for(size_t j=0; j<iColumns.size(); j++)
+      {
+        assert( iColumns[j].size() == numRecords );
+        write(iColumns[j], i);
+      }
+      endRecord();
+    }
+  }
+
+  bool CsvWriter::flush()
+  {
+    if (mUsed > 0)
+      mStream.write(&mBuffer[0], mUsed);
+    mUsed = 0;
+    return mStream.good();
+  }
+
+  //----------------
+  // private methods
+  //----------------
+  void CsvWriter::beginField(size_t iMaxLength)
+  {
+    //the delimiter and a null terminator written by StringEncoder
+    if (mUsed + iMaxLength + 2 > mBuffer.size())
+      flush();
+    if (!mFirstField)
+      mBuffer[mUsed++] = mDelimiter;
+    mFirstField = false;
+  }
+
+  void CsvWriter::writeNative(uint8 iFormat, const Variant::VariantUnion & iValue)
+  {
+    //same as Variant::getString()
+    beginField(StringEncoder::MAX_CHARS_SIZE);
+    char * buffer = &mBuffer[mUsed];
+    const size_t size = StringEncoder::MAX_CHARS_SIZE;
+    bool shortest = (Variant::getFloatFormattingPolicy() == Variant::SHORTEST_ROUND_TRIP);
+    switch(iFormat)
+    {
+    case Variant::BOOL:
+      mUsed += StringEncoder::toChars(buffer, size, iValue.as_uint64 != 0);
+      break;
+    case Variant::UINT8:
+    case Variant::UINT16:
+    case Variant::UINT32:
+    case Variant::UINT64:
+      mUsed += StringEncoder::toChars(buffer, size, iValue.as_uint64);
+      break;
+    case Variant::SINT8:
+    case Variant::SINT16:
+    case Variant::SINT32:
+    case Variant::SINT64:
+      mUsed += StringEncoder::toChars(buffer, size, iValue.as_sint64);
+      break;
+    case Variant::FLOAT32:
+      mUsed += (shortest ? StringEncoder::toShortestChars(buffer, size, iValue.as_float32) : StringEncoder::toChars(buffer, size, iValue.as_float32));
+      break;
+    case Variant::FLOAT64:
+      mUsed += (shortest ? StringEncoder::toShortestChars(buffer, size, iValue.as_float64) : StringEncoder::toChars(buffer, size, iValue.as_float64));
+      break;
+    default:
+      assert( false ); /*error should not happen*/
+      break;
+    };
+  }
+
+  void CsvWriter::writeString(const char * iValue, size_t iLength)
+  {
+    const char * end = iValue + iLength;
+    bool quoted = (iLength == 0); //an empty unquoted field of a single column is an empty line
+    for(const char * c = iValue; c < end && !quoted; c++)
+      quoted = (*c == mDelimiter || *c == '"' || *c == '\n' || *c == '\r');
+
+    if (!quoted)
+    {
+      beginField(0);
+      while(iValue < end)
+      {
+        if (mUsed == mBuffer.size())
+          flush();
+        size_t count = mBuffer.size() - mUsed;
+        if (count > static_cast<size_t>(end - iValue))
+          count = end - iValue;
+        memcpy(&mBuffer[mUsed], iValue, count);
+        mUsed += count;
+        iValue += count;
+      }
+      return;
+    }
+
+    beginField(1);
+    mBuffer[mUsed++] = '"';
+    for(const char * c = iValue; c < end; c++)
+    {
+      if (mUsed + 2 > mBuffer.size())
+        flush();
+      if (*c == '"')
+        mBuffer[mUsed++] = '"';
+      mBuffer[mUsed++] = *c;
+    }
+    if (mUsed == mBuffer.size())
+      flush();
+    mBuffer[mUsed++] = '"';
+  }
+
+} // End of namespace
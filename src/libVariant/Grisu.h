@@ -0,0 +1,407 @@
+/**********************************************************************************
+ * MIT License
+ * 
+ * Copyright (c) 2018 Antoine Beauchamp
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+
+#ifndef LIBVARIANT_GRISU_H
+#define LIBVARIANT_GRISU_H
+
+//---------------
+// Include Files
+//---------------
+#include "libvariant/variant_types.h"
+#include <string.h> // memcpy
+#include <stdio.h> // snprintf
+#include <stdlib.h> // strtod, strtof, strtol
+
+//-----------
+// Namespace
+//-----------
+
+namespace libVariant
+{
+  //------------------------
+  // Class Declarations
+  //------------------------
+  /// <summary>
+  /// Implementation of the Grisu3 algorithm by Florian Loitsch (Printing Floating-Point Numbers Quickly and Accurately with Integers, 2010).
+  /// Finds the shortest sequence of decimal digits which parses back to the exact same floating point value.
+  /// Grisu3 detects the rare values (about 0.5%) for which it cannot prove that its digits are the shortest and closest.
+  /// These values are processed by a slower search based on snprintf() and strtod().
+  /// </summary>
+  class Grisu
+  {
+  public:
+    /// <summary>
+    /// Maximum number of decimal digits returned by getDigits().
+    /// </summary>
+    static const size_t MAX_DIGITS = 20;
+
+    /// <summary>
+    /// Computes the decimal digits of a positive, finite and non-zero floating point value.
+    /// </summary>
+    /// <param name="iValue">The floating point value.</param>
+    /// <param name="oDigits">A buffer of at least MAX_DIGITS characters which receives the decimal digits. The buffer is not null terminated.</param>
+    /// <param name="oExponent">The decimal exponent of the last digit. ie: the value is oDigits * 10^oExponent.</param>
+    /// <returns>Returns the number of digits written to oDigits.</returns>
+    static inline size_t getDigits(float64 iValue, char * oDigits, int & oExponent)
+    {
+      uint64 bits;
+      memcpy(&bits, &iValue, sizeof(bits));
+      size_t length = 0;
+      if (getDigits(bits & 0x000FFFFFFFFFFFFFull, static_cast<int>((bits >> 52) & 0x7FF), 52, 1075, oDigits, length, oExponent))
+        return length;
+      return searchDigits(iValue, oDigits, oExponent);
+    }
+
+    static inline size_t getDigits(float32 iValue, char * oDigits, int & oExponent)
+    {
+      uint32 bits;
+      memcpy(&bits, &iValue, sizeof(bits));
+      size_t length = 0;
+      if (getDigits(bits & 0x007FFFFFu, static_cast<int>((bits >> 23) & 0xFF), 23, 150, oDigits, length, oExponent))
+        return length;
+      return searchDigits(iValue, oDigits, oExponent);
+    }
+
+  private:
+    /// <summary>
+    /// A floating point number with a 64 bit significand and a binary exponent: f * 2^e.
+    /// </summary>
+    struct DiyFp
+    {
+      uint64 f;
+      int e;
+
+      DiyFp(uint64 iF, int iE) : f(iF), e(iE) {}
+
+      DiyFp operator - (const DiyFp & iValue) const
+      {
+        return DiyFp(f - iValue.f, e);
+      }
+
+      /// <summary>
+      /// Multiplies two DiyFp keeping the 64 most significant bits of the product, rounded.
+      /// </summary>
+      DiyFp operator * (const DiyFp & iValue) const
+      {
+        const uint64 M32 = 0xFFFFFFFFull;
+        uint64 a = f >> 32;
+        uint64 b = f & M32;
+        uint64 c = iValue.f >> 32;
+        uint64 d = iValue.f & M32;
+        uint64 ac = a * c;
+        uint64 bc = b * c;
+        uint64 ad = a * d;
+        uint64 bd = b * d;
+        uint64 tmp = (bd >> 32) + (ad & M32) + (bc & M32);
+        tmp += 1ull << 31; //round
+        return DiyFp(ac + (ad >> 32) + (bc >> 32) + (tmp >> 32), e + iValue.e + 64);
+      }
+
+      DiyFp normalize() const
+      {
+        DiyFp result = *this;
+        while ((result.f & (1ull << 63)) == 0)
+        {
+          result.f <<= 1;
+          result.e--;
+        }
+        return result;
+      }
+    };
+
+    /// <summary>
+    /// Returns a cached power of ten c such that the exponent of (c * value) is within [-60, -32] for a value of the given binary exponent.
+    /// </summary>
+    /// <param name="iExponent">The binary exponent of a normalized value.</param>
+    /// <param name="oK">The decimal exponent of the cached power, negated.</param>
+    static inline DiyFp getCachedPower(int iExponent, int & oK)
+    {
+      //10^-348, 10^-340, ..., 10^340
+      static const uint64 significands[] = {
+        0xfa8fd5a0081c0288ull, 0xbaaee17fa23ebf76ull, 0x8b16fb203055ac76ull, 0xcf42894a5dce35eaull,
+        0x9a6bb0aa55653b2dull, 0xe61acf033d1a45dfull, 0xab70fe17c79ac6caull, 0xff77b1fcbebcdc4full,
+        0xbe5691ef416bd60cull, 0x8dd01fad907ffc3cull, 0xd3515c2831559a83ull, 0x9d71ac8fada6c9b5ull,
+        0xea9c227723ee8bcbull, 0xaecc49914078536dull, 0x823c12795db6ce57ull, 0xc21094364dfb5637ull,
+        0x9096ea6f3848984full, 0xd77485cb25823ac7ull, 0xa086cfcd97bf97f4ull, 0xef340a98172aace5ull,
+        0xb23867fb2a35b28eull, 0x84c8d4dfd2c63f3bull, 0xc5dd44271ad3cdbaull, 0x936b9fcebb25c996ull,
+        0xdbac6c247d62a584ull, 0xa3ab66580d5fdaf6ull, 0xf3e2f893dec3f126ull, 0xb5b5ada8aaff80b8ull,
+        0x87625f056c7c4a8bull, 0xc9bcff6034c13053ull, 0x964e858c91ba2655ull, 0xdff9772470297ebdull,
+        0xa6dfbd9fb8e5b88full, 0xf8a95fcf88747d94ull, 0xb94470938fa89bcfull, 0x8a08f0f8bf0f156bull,
+        0xcdb02555653131b6ull, 0x993fe2c6d07b7facull, 0xe45c10c42a2b3b06ull, 0xaa242499697392d3ull,
+        0xfd87b5f28300ca0eull, 0xbce5086492111aebull, 0x8cbccc096f5088ccull, 0xd1b71758e219652cull,
+        0x9c40000000000000ull, 0xe8d4a51000000000ull, 0xad78ebc5ac620000ull, 0x813f3978f8940984ull,
+        0xc097ce7bc90715b3ull, 0x8f7e32ce7bea5c70ull, 0xd5d238a4abe98068ull, 0x9f4f2726179a2245ull,
+        0xed63a231d4c4fb27ull, 0xb0de65388cc8ada8ull, 0x83c7088e1aab65dbull, 0xc45d1df942711d9aull,
+        0x924d692ca61be758ull, 0xda01ee641a708deaull, 0xa26da3999aef774aull, 0xf209787bb47d6b85ull,
+        0xb454e4a179dd1877ull, 0x865b86925b9bc5c2ull, 0xc83553c5c8965d3dull, 0x952ab45cfa97a0b3ull,
+        0xde469fbd99a05fe3ull, 0xa59bc234db398c25ull, 0xf6c69a72a3989f5cull, 0xb7dcbf5354e9beceull,
+        0x88fcf317f22241e2ull, 0xcc20ce9bd35c78a5ull, 0x98165af37b2153dfull, 0xe2a0b5dc971f303aull,
+        0xa8d9d1535ce3b396ull, 0xfb9b7cd9a4a7443cull, 0xbb764c4ca7a44410ull, 0x8bab8eefb6409c1aull,
+        0xd01fef10a657842cull, 0x9b10a4e5e9913129ull, 0xe7109bfba19c0c9dull, 0xac2820d9623bf429ull,
+        0x80444b5e7aa7cf85ull, 0xbf21e44003acdd2dull, 0x8e679c2f5e44ff8full, 0xd433179d9c8cb841ull,
+        0x9e19db92b4e31ba9ull, 0xeb96bf6ebadf77d9ull, 0xaf87023b9bf0ee6bull,
+      };
+      static const sint16 exponents[] = {
+        -1220, -1193, -1166, -1140, -1113, -1087, -1060, -1034, -1007,  -980,
+         -954,  -927,  -901,  -874,  -847,  -821,  -794,  -768,  -741,  -715,
+         -688,  -661,  -635,  -608,  -582,  -555,  -529,  -502,  -475,  -449,
+         -422,  -396,  -369,  -343,  -316,  -289,  -263,  -236,  -210,  -183,
+         -157,  -130,  -103,   -77,   -50,   -24,     3,    30,    56,    83,
+          109,   136,   162,   189,   216,   242,   269,   295,   322,   348,
+          375,   402,   428,   455,   481,   508,   534,   561,   588,   614,
+          641,   667,   694,   720,   747,   774,   800,   827,   853,   880,
+          907,   933,   960,   986,  1013,  1039,  1066,
+      };
+
+      //ceil((-61 - e) * log10(2)) + 347
+      double dk = (-61 - iExponent) * 0.30102999566398114 + 347;
+      int k = static_cast<int>(dk);
+      if (dk - k > 0.0)
+        k++;
+
+      unsigned int index = static_cast<unsigned int>((k >> 3) + 1);
+      oK = -(-348 + static_cast<int>(index << 3));
+      return DiyFp(significands[index], exponents[index]);
+    }
+
+    static inline uint64 getPowerOf10(int iExponent)
+    {
+      static const uint64 powers10[] = {
+        1ull, 10ull, 100ull, 1000ull, 10000ull, 100000ull, 1000000ull, 10000000ull, 100000000ull, 1000000000ull,
+        10000000000ull, 100000000000ull, 1000000000000ull, 10000000000000ull, 100000000000000ull, 1000000000000000ull,
+        10000000000000000ull, 100000000000000000ull, 1000000000000000000ull, 10000000000000000000ull,
+      };
+      return powers10[iExponent];
+    }
+
+    static inline int countDecimalDigits(uint32 iValue)
+    {
+      if (iValue < 10) return 1;
+      if (iValue < 100) return 2;
+      if (iValue < 1000) return 3;
+      if (iValue < 10000) return 4;
+      if (iValue < 100000) return 5;
+      if (iValue < 1000000) return 6;
+      if (iValue < 10000000) return 7;
+      if (iValue < 100000000) return 8;
+      return 9;
+    }
+
+    /// <summary>
+    /// Moves the last digit closer to the exact value while staying within the boundaries.
+    /// All distances are scaled by the same factor and are known within iUnit.
+    /// </summary>
+    /// <returns>Returns true if the digits are proven to be the closest to the exact value. Returns false otherwise.</returns>
+    static inline bool round(char * ioDigits, size_t iLength, uint64 iDistanceTooHigh, uint64 iUnsafeInterval, uint64 iRest, uint64 iTenKappa, uint64 iUnit)
+    {
+      const uint64 smallDistance = iDistanceTooHigh - iUnit;
+      const uint64 bigDistance = iDistanceTooHigh + iUnit;
+      while (iRest < smallDistance && iUnsafeInterval - iRest >= iTenKappa &&
+             (iRest + iTenKappa < smallDistance || smallDistance - iRest >= iRest + iTenKappa - smallDistance))
+      {
+        ioDigits[iLength - 1]--;
+        iRest += iTenKappa;
+      }
+
+      //the next lower digits could also be closer to the exact value
+      if (iRest < bigDistance && iUnsafeInterval - iRest >= iTenKappa &&
+          (iRest + iTenKappa < bigDistance || bigDistance - iRest > iRest + iTenKappa - bigDistance))
+        return false;
+
+      //the digits must be safely within the boundaries
+      return (2 * iUnit <= iRest) && (iRest <= iUnsafeInterval - 4 * iUnit);
+    }
+
+    /// <summary>
+    /// Generates the shortest digits within the boundaries iLow and iHigh, which are known within 1 unit.
+    /// </summary>
+    /// <returns>Returns true if the digits are proven to be the shortest and the closest to iValue. Returns false otherwise.</returns>
+    static inline bool generateDigits(const DiyFp & iLow, const DiyFp & iValue, const DiyFp & iHigh, char * oDigits, size_t & oLength, int & ioK)
+    {
+      uint64 unit = 1;
+      const DiyFp tooLow(iLow.f - unit, iLow.e);
+      const DiyFp tooHigh(iHigh.f + unit, iHigh.e);
+      uint64 unsafeInterval = tooHigh.f - tooLow.f;
+      const DiyFp one(1ull << -iValue.e, iValue.e);
+      uint32 p1 = static_cast<uint32>(tooHigh.f >> -one.e);
+      uint64 p2 = tooHigh.f & (one.f - 1);
+      int kappa = countDecimalDigits(p1);
+      oLength = 0;
+
+      //integral part
+      while (kappa > 0)
+      {
+        const uint32 divisor = static_cast<uint32>(getPowerOf10(kappa - 1));
+        oDigits[oLength++] = static_cast<char>('0' + p1 / divisor);
+        p1 %= divisor;
+        kappa--;
+        uint64 rest = (static_cast<uint64>(p1) << -one.e) + p2;
+        if (rest < unsafeInterval)
+        {
+          ioK += kappa;
+          return round(oDigits, oLength, (tooHigh - iValue).f, unsafeInterval, rest, static_cast<uint64>(divisor) << -one.e, unit);
+        }
+      }
+
+      //fractional part
+      for(;;)
+      {
+        p2 *= 10;
+        unit *= 10;
+        unsafeInterval *= 10;
+        oDigits[oLength++] = static_cast<char>('0' + (p2 >> -one.e));
+        p2 &= one.f - 1;
+        kappa--;
+        if (p2 < unsafeInterval)
+        {
+          ioK += kappa;
+          return round(oDigits, oLength, ((tooHigh - iValue).f) * unit, unsafeInterval, p2, one.f, unit);
+        }
+      }
+    }
+
+    /// <summary>
+    /// Computes the decimal digits of a floating point value given its IEEE-754 fields.
+    /// </summary>
+    /// <param name="iFraction">The stored fraction bits.</param>
+    /// <param name="iBiasedExponent">The stored exponent bits.</param>
+    /// <param name="iFractionBits">The number of fraction bits of the format.</param>
+    /// <param name="iExponentBias">The exponent bias of the format, including the number of fraction bits.</param>
+    /// <returns>Returns true if the digits are proven to be the shortest. Returns false if searchDigits() must be used instead.</returns>
+    static inline bool getDigits(uint64 iFraction, int iBiasedExponent, int iFractionBits, int iExponentBias, char * oDigits, size_t & oLength, int & oExponent)
+    {
+      const uint64 hiddenBit = 1ull << iFractionBits;
+      DiyFp v(iFraction, 1 - iExponentBias); //subnormal
+      if (iBiasedExponent != 0)
+        v = DiyFp(iFraction + hiddenBit, iBiasedExponent - iExponentBias);
+
+      //boundaries are halfway to the neighbor values. The lower neighbor is closer on powers of 2.
+      DiyFp high = DiyFp((v.f << 1) + 1, v.e - 1).normalize();
+      DiyFp low = (v.f == hiddenBit && iBiasedExponent > 1) ? DiyFp((v.f << 2) - 1, v.e - 2) : DiyFp((v.f << 1) - 1, v.e - 1);
+      low.f <<= low.e - high.e;
+      low.e = high.e;
+
+      int k = 0;
+      const DiyFp cachedPower = getCachedPower(high.e, k);
+      const DiyFp w = v.normalize() * cachedPower;
+      const DiyFp wHigh = high * cachedPower;
+      const DiyFp wLow = low * cachedPower;
+
+      bool success = generateDigits(wLow, w, wHigh, oDigits, oLength, k);
+      oExponent = k;
+      return success;
+    }
+
+    static inline bool isIdentical(const char * iValue, float64 iExpected) { return strtod(iValue, NULL) == iExpected; }
+    static inline bool isIdentical(const char * iValue, float32 iExpected) { return strtof(iValue, NULL) == iExpected; }
+
+    /// <summary>
+    /// Returns true if the given digits followed by the given exponent parse back to the given value.
+    /// </summary>
+    template <typename T>
+    static inline bool isRoundTrip(const char * iDigits, size_t iLength, int iExponent, T iValue)
+    {
+      char text[MAX_DIGITS + 16];
+      memcpy(text, iDigits, iLength);
+      snprintf(text + iLength, sizeof(text) - iLength, "e%d", iExponent);
+      return isIdentical(text, iValue);
+    }
+
+    /// <summary>
+    /// Prints the correctly rounded digits of a floating point value with the C library.
+    /// </summary>
+    /// <returns>Returns the number of digits. The digits are followed by the exponent of the last digit.</returns>
+    static inline size_t printDigits(float64 iValue, int iPrecision, char * oDigits, int & oExponent)
+    {
+      //d.ddde+XX, the decimal point depends on the current locale
+      char printed[64];
+      snprintf(printed, sizeof(printed), "%.*e", iPrecision - 1, iValue);
+      size_t length = 0;
+      const char * c = printed;
+      for(; *c != 'e' && *c != '\0'; c++)
+      {
+        if (*c >= '0' && *c <= '9')
+          oDigits[length++] = *c;
+      }
+      oExponent = (*c == 'e' ? static_cast<int>(strtol(c + 1, NULL, 10)) : 0) - (iPrecision - 1);
+      return length;
+    }
+
+    /// <summary>
+    /// Finds the shortest digits of a positive, finite and non-zero floating point value with the C library.
+    /// For each number of digits, the correctly rounded digits are tested first, then their neighbor on the other side of the value.
+    /// One of them is within the boundaries if any sequence of that many digits is.
+    /// </summary>
+    template <typename T>
+    static inline size_t searchDigits(T iValue, char * oDigits, int & oExponent)
+    {
+      static const int MAX_PRECISION = 17;
+      for(int precision = 1; precision < MAX_PRECISION; precision++)
+      {
+        int exponent = 0;
+        size_t length = printDigits(static_cast<float64>(iValue), precision, oDigits, exponent);
+        if (isRoundTrip(oDigits, length, exponent, iValue))
+        {
+          oExponent = exponent;
+          return trimZeros(oDigits, length, oExponent);
+        }
+
+        //the neighbor digits on the other side of the value
+        char text[MAX_DIGITS + 16];
+        memcpy(text, oDigits, length);
+        snprintf(text + length, sizeof(text) - length, "e%d", exponent);
+        const bool up = (strtod(text, NULL) < static_cast<float64>(iValue));
+        size_t i = length;
+        while (i > 0 && oDigits[i - 1] == (up ? '9' : '0'))
+          oDigits[--i] = (up ? '0' : '9');
+        if (i == 0 || (!up && i == 1 && oDigits[0] == '1'))
+          continue; //the neighbor has fewer digits and was already tested
+        oDigits[i - 1] = static_cast<char>(oDigits[i - 1] + (up ? 1 : -1));
+        if (isRoundTrip(oDigits, length, exponent, iValue))
+        {
+          oExponent = exponent;
+          return trimZeros(oDigits, length, oExponent);
+        }
+      }
+
+      //17 significant digits always round-trip
+      size_t length = printDigits(static_cast<float64>(iValue), MAX_PRECISION, oDigits, oExponent);
+      return trimZeros(oDigits, length, oExponent);
+    }
+
+    static inline size_t trimZeros(const char * iDigits, size_t iLength, int & ioExponent)
+    {
+      while (iLength > 1 && iDigits[iLength - 1] == '0')
+      {
+        iLength--;
+        ioExponent++;
+      }
+      return iLength;
+    }
+  };
+
+} // End namespace
+
+#endif // LIBVARIANT_GRISU_H
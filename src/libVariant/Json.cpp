@@ -0,0 +1,730 @@
+/**********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2018 Antoine Beauchamp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+
+//---------------
+// Include Files
+//---------------
+#include "libvariant/json.h"
+#include "StringEncoder.h"
+#include "VariantAccess.h"
+
+#include <assert.h>
+#include <float.h> // DBL_MAX
+#include <stdlib.h> // strtod
+#include <string.h> // memcpy, memcmp, strlen
+#include <string>
+
+//-----------
+// Namespace
+//-----------
+
+namespace libVariant
+{
+  static const uint64 ONES  = 0x0101010101010101ull;
+  static const uint64 HIGHS = 0x8080808080808080ull;
+
+  /// <summary>
+  /// Returns a non zero value if a byte of the given word is a quote, a backslash or a control character.
+  /// Each byte is tested in parallel: a byte b is matched if (b - n) borrows while b does not have its high bit set.
+  /// </summary>
+  inline uint64 findStringDelimiters(uint64 iWord)
+  {
+    const uint64 quotes = iWord ^ (ONES * '"');
+    const uint64 backslashes = iWord ^ (ONES * '\\');
+    return (((quotes - ONES) & ~quotes) | ((backslashes - ONES) & ~backslashes) | ((iWord - ONES * 0x20) & ~iWord)) & HIGHS;
+  }
+
+  inline bool isDigit(char c)
+  {
+    return (c >= '0' && c <= '9');
+  }
+
+  /// <summary>
+  /// Returns the value of an hexadecimal digit or -1 if the character is not an hexadecimal digit.
+  /// </summary>
+  inline int getHexDigit(char c)
+  {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+  }
+
+  /// <summary>
+  /// Appends the UTF-8 encoding of a code point.
+  /// </summary>
+  static void appendUtf8(uint32 iCodePoint, std::vector<char> & ioBuffer)
+  {
+    if (iCodePoint < 0x80)
+    {
+      ioBuffer.push_back(static_cast<char>(iCodePoint));
+    }
+    else if (iCodePoint < 0x800)
+    {
+      ioBuffer.push_back(static_cast<char>(0xC0 | (iCodePoint >> 6)));
+      ioBuffer.push_back(static_cast<char>(0x80 | (iCodePoint & 0x3F)));
+    }
+    else if (iCodePoint < 0x10000)
+    {
+      ioBuffer.push_back(static_cast<char>(0xE0 | (iCodePoint >> 12)));
+      ioBuffer.push_back(static_cast<char>(0x80 | ((iCodePoint >> 6) & 0x3F)));
+      ioBuffer.push_back(static_cast<char>(0x80 | (iCodePoint & 0x3F)));
+    }
+    else
+    {
+      ioBuffer.push_back(static_cast<char>(0xF0 | (iCodePoint >> 18)));
+      ioBuffer.push_back(static_cast<char>(0x80 | ((iCodePoint >> 12) & 0x3F)));
+      ioBuffer.push_back(static_cast<char>(0x80 | ((iCodePoint >> 6) & 0x3F)));
+      ioBuffer.push_back(static_cast<char>(0x80 | (iCodePoint & 0x3F)));
+    }
+  }
+
+  /// <summary>
+  /// Assigns the narrowest format which can hold an integer, in the same order as Variant::simplify().
+  /// </summary>
+  static void setInteger(bool iNegative, uint64 iMagnitude, Variant & oValue)
+  {
+    if (iNegative)
+    {
+      sint64 value = static_cast<sint64>((~iMagnitude) + 1); //two's complement
+      if      (iMagnitude <= 0x80ull)       oValue.setSInt8 (static_cast<sint8 >(value));
+      else if (iMagnitude <= 0x8000ull)     oValue.setSInt16(static_cast<sint16>(value));
+      else if (iMagnitude <= 0x80000000ull) oValue.setSInt32(static_cast<sint32>(value));
+      else                                  oValue.setSInt64(value);
+      return;
+    }
+
+    if      (iMagnitude <= 0x7Full)               oValue.setSInt8 (static_cast<sint8 >(iMagnitude));
+    else if (iMagnitude <= 0xFFull)               oValue.setUInt8 (static_cast<uint8 >(iMagnitude));
+    else if (iMagnitude <= 0x7FFFull)             oValue.setSInt16(static_cast<sint16>(iMagnitude));
+    else if (iMagnitude <= 0xFFFFull)             oValue.setUInt16(static_cast<uint16>(iMagnitude));
+    else if (iMagnitude <= 0x7FFFFFFFull)         oValue.setSInt32(static_cast<sint32>(iMagnitude));
+    else if (iMagnitude <= 0xFFFFFFFFull)         oValue.setUInt32(static_cast<uint32>(iMagnitude));
+    else if (iMagnitude <= 0x7FFFFFFFFFFFFFFFull) oValue.setSInt64(static_cast<sint64>(iMagnitude));
+    else                                          oValue.setUInt64(iMagnitude);
+  }
+
+  //-----------
+  // JsonValue
+  //-----------
+  JsonValue::JsonValue() : mType(JSON_NULL)
+  {
+  }
+
+  JsonValue::JsonValue(JsonType iType) : mType(iType)
+  {
+    assert( iType != JSON_SCALAR );
+  }
+
+  JsonValue::JsonValue(const Variant & iValue) : mType(JSON_SCALAR), mValue(iValue)
+  {
+  }
+
+  const JsonValue * JsonValue::find(const char * iName) const
+  {
+    assert( mType == JSON_OBJECT );
+    size_t length = strlen(iName);
+    for(size_t i=0; i<mNames.size(); i++)
+    {
+      const Variant & name = mNames[i];
+      if (VariantAccess::getStringLength(name) == length && memcmp(VariantAccess::getStringBuffer(name), iName, length) == 0)
+        return &mElements[i];
+    }
+    return NULL;
+  }
+
+  JsonValue & JsonValue::append(const JsonValue & iValue)
+  {
+    assert( mType == JSON_ARRAY );
+    mElements.push_back(iValue);
+    return mElements.back();
+  }
+
+  JsonValue & JsonValue::append(const char * iName, const JsonValue & iValue)
+  {
+    assert( mType == JSON_OBJECT );
+    mNames.push_back(Variant(iName));
+    mElements.push_back(iValue);
+    return mElements.back();
+  }
+
+  void JsonValue::materialize()
+  {
+    mValue.materialize();
+    for(size_t i=0; i<mNames.size(); i++)
+      mNames[i].materialize();
+    for(size_t i=0; i<mElements.size(); i++)
+      mElements[i].materialize();
+  }
+
+  //------------
+  // JsonReader
+  //------------
+  const size_t JsonReader::MAX_DEPTH;
+
+  JsonReader::JsonReader() :
+    mBegin(NULL),
+    mPosition(NULL),
+    mEnd(NULL),
+    mView(false),
+    mErrorPosition(0)
+  {
+  }
+
+  bool JsonReader::read(const char * iBuffer, size_t iSize, JsonValue & oValue)
+  {
+    return readDocument(iBuffer, iSize, false, oValue);
+  }
+
+  bool JsonReader::readView(const char * iBuffer, size_t iSize, JsonValue & oValue)
+  {
+    return readDocument(iBuffer, iSize, true, oValue);
+  }
+
+  bool JsonReader::readDocument(const char * iBuffer, size_t iSize, bool iView, JsonValue & oValue)
+  {
+    mBegin = iBuffer;
+    mPosition = iBuffer;
+    mEnd = iBuffer + iSize;
+    mView = iView;
+    mErrorPosition = 0;
+
+    oValue = JsonValue();
+    bool success = readValue(oValue, 0);
+    if (success)
+    {
+      skipWhitespace();
+      if (mPosition != mEnd)
+        success = fail(); //characters after the document
+    }
+    if (!success)
+      oValue = JsonValue();
+    return success;
+  }
+
+  bool JsonReader::readValue(JsonValue & oValue, size_t iDepth)
+  {
+    skipWhitespace();
+    if (mPosition == mEnd)
+      return fail();
+
+    switch(*mPosition)
+    {
+    case '{':
+    case '[':
+      {
+        const bool object = (*mPosition == '{');
+        const char close = (object ? '}' : ']');
+        if (iDepth >= MAX_DEPTH)
+          return fail();
+        oValue.mType = (object ? JsonValue::JSON_OBJECT : JsonValue::JSON_ARRAY);
+        mPosition++;
+        skipWhitespace();
+        if (mPosition < mEnd && *mPosition == close)
+        {
+          mPosition++;
+          return true;
+        }
+
+        for(;;)
+        {
+          if (object)
+          {
+            skipWhitespace();
+            if (mPosition == mEnd || *mPosition != '"')
+              return fail();
+            oValue.mNames.emplace_back();
+            if (!readString(oValue.mNames.back()))
+              return false;
+            skipWhitespace();
+            if (mPosition == mEnd || *mPosition != ':')
+              return fail();
+            mPosition++;
+          }
+
+          //the element is read in place
+          oValue.mElements.emplace_back();
+          if (!readValue(oValue.mElements.back(), iDepth + 1))
+            return false;
+
+          skipWhitespace();
+          if (mPosition == mEnd)
+            return fail();
+          if (*mPosition == close)
+            break;
+          if (*mPosition != ',')
+            return fail();
+          mPosition++;
+        }
+        mPosition++;
+        return true;
+      }
+    case '"':
+      oValue.mType = JsonValue::JSON_SCALAR;
+      return readString(oValue.mValue);
+    case 't':
+      oValue.mType = JsonValue::JSON_SCALAR;
+      oValue.mValue.setBool(true);
+      return readLiteral("true", 4);
+    case 'f':
+      oValue.mType = JsonValue::JSON_SCALAR;
+      oValue.mValue.setBool(false);
+      return readLiteral("false", 5);
+    case 'n':
+      oValue.mType = JsonValue::JSON_NULL;
+      return readLiteral("null", 4);
+    default:
+      oValue.mType = JsonValue::JSON_SCALAR;
+      return readNumber(oValue.mValue);
+    };
+  }
+
+  bool JsonReader::readString(Variant & oValue)
+  {
+    assert( *mPosition == '"' );
+    mPosition++;
+    const char * begin = mPosition;
+    const char * segment = begin; //first character not yet copied to mUnescaped
+    bool escaped = false;
+
+    for(;;)
+    {
+      //skip 8 ordinary characters at a time
+      while(mEnd - mPosition >= static_cast<ptrdiff_t>(sizeof(uint64)))
+      {
+        uint64 word;
+        memcpy(&word, mPosition, sizeof(word));
+        if (findStringDelimiters(word) != 0)
+          break;
+        mPosition += sizeof(word);
+      }
+      if (mPosition == mEnd)
+        return fail();
+
+      const char c = *mPosition;
+      if (c == '"')
+        break;
+      if (static_cast<unsigned char>(c) < 0x20)
+        return fail(); //control characters must be escaped
+      if (c != '\\')
+      {
+        mPosition++;
+        continue;
+      }
+
+      //escape sequence
+      if (!escaped)
+        mUnescaped.clear();
+      escaped = true;
+      mUnescaped.insert(mUnescaped.end(), segment, mPosition);
+      if (mEnd - mPosition < 2)
+        return fail();
+      mPosition++;
+      switch(*mPosition)
+      {
+      case '"':  mUnescaped.push_back('"');  break;
+      case '\\': mUnescaped.push_back('\\'); break;
+      case '/':  mUnescaped.push_back('/');  break;
+      case 'b':  mUnescaped.push_back('\b'); break;
+      case 'f':  mUnescaped.push_back('\f'); break;
+      case 'n':  mUnescaped.push_back('\n'); break;
+      case 'r':  mUnescaped.push_back('\r'); break;
+      case 't':  mUnescaped.push_back('\t'); break;
+      case 'u':
+        {
+          uint32 codePoint = 0;
+          for(int unit=0; unit<2; unit++)
+          {
+            if (mEnd - mPosition < 5)
+              return fail();
+            uint32 value = 0;
+            for(int i=1; i<=4; i++)
+            {
+              int digit = getHexDigit(mPosition[i]);
+              if (digit < 0)
+              {
+                mPosition += i;
+                return fail();
+              }
+              value = (value << 4) | static_cast<uint32>(digit);
+            }
+            mPosition += 4;
+
+            if (unit == 0)
+            {
+              codePoint = value;
+              if (value >= 0xDC00 && value <= 0xDFFF)
+                return fail(); //unpaired low surrogate
+              if (value < 0xD800 || value > 0xDBFF)
+                break;
+              //a high surrogate must be followed by an escaped low surrogate
+              if (mEnd - mPosition < 3 || mPosition[1] != '\\' || mPosition[2] != 'u')
+              {
+                mPosition++;
+                return fail();
+              }
+              mPosition += 2;
+            }
+            else
+            {
+              if (value < 0xDC00 || value > 0xDFFF)
+                return fail();
+              codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (value - 0xDC00);
+            }
+          }
+          appendUtf8(codePoint, mUnescaped);
+        }
+        break;
+      default:
+        return fail();
+      };
+      mPosition++;
+      segment = mPosition;
+    }
+
+    if (!escaped)
+    {
+      oValue.setStringView(begin, mPosition - begin);
+      if (!mView)
+        oValue.materialize();
+    }
+    else
+    {
+      mUnescaped.insert(mUnescaped.end(), segment, mPosition);
+      oValue.setStringView(&mUnescaped[0], mUnescaped.size());
+      oValue.materialize();
+    }
+    mPosition++; //closing quote
+    return true;
+  }
+
+  bool JsonReader::readNumber(Variant & oValue)
+  {
+    //-?(0|[1-9][0-9]*)(\.[0-9]+)?([eE][+-]?[0-9]+)?
+    const char * begin = mPosition;
+    const bool negative = (*mPosition == '-');
+    if (negative)
+      mPosition++;
+    if (mPosition == mEnd || !isDigit(*mPosition))
+      return fail();
+
+    uint64 magnitude = 0;
+    bool overflow = false;
+    if (*mPosition == '0')
+      mPosition++;
+    else
+    {
+      for(; mPosition < mEnd && isDigit(*mPosition); mPosition++)
+      {
+        uint64 digit = static_cast<uint64>(*mPosition - '0');
+        if (magnitude > (0xFFFFFFFFFFFFFFFFull - digit) / 10)
+          overflow = true;
+        else
+          magnitude = magnitude * 10 + digit;
+      }
+    }
+
+    bool integer = true;
+    if (mPosition < mEnd && *mPosition == '.')
+    {
+      integer = false;
+      mPosition++;
+      if (mPosition == mEnd || !isDigit(*mPosition))
+        return fail();
+      while(mPosition < mEnd && isDigit(*mPosition))
+        mPosition++;
+    }
+    if (mPosition < mEnd && (*mPosition == 'e' || *mPosition == 'E'))
+    {
+      integer = false;
+      mPosition++;
+      if (mPosition < mEnd && (*mPosition == '+' || *mPosition == '-'))
+        mPosition++;
+      if (mPosition == mEnd || !isDigit(*mPosition))
+        return fail();
+      while(mPosition < mEnd && isDigit(*mPosition))
+        mPosition++;
+    }
+
+    //-0 and integers out of the range of 64-bit integers are floating point values
+    if (integer && !overflow && magnitude != 0 && (!negative || magnitude <= 0x8000000000000000ull))
+    {
+      setInteger(negative, magnitude, oValue);
+      return true;
+    }
+    if (integer && !overflow && !negative)
+    {
+      oValue.setSInt8(0);
+      return true;
+    }
+
+    //copy the value to a NULL terminated buffer
+    const size_t length = mPosition - begin;
+    char buffer[64];
+    std::string large;
+    char * value = buffer;
+    if (length < sizeof(buffer))
+    {
+      memcpy(buffer, begin, length);
+      buffer[length] = '\0';
+    }
+    else
+    {
+      large.assign(begin, length);
+      value = &large[0];
+    }
+
+    //strtod() expects the decimal point of the current C locale
+    char * decimalPoint = static_cast<char *>(memchr(value, '.', length));
+    if (decimalPoint)
+      *decimalPoint = StringEncoder::getLocaleDecimalPoint();
+
+    //out of range values are clamped to the largest finite value like StringEncoder::parse() does
+    float64 parsed = strtod(value, NULL);
+    if (parsed > DBL_MAX || parsed < -DBL_MAX)
+      parsed = (parsed > 0 ? DBL_MAX : -DBL_MAX);
+    oValue.setFloat64(parsed);
+    return true;
+  }
+
+  bool JsonReader::readLiteral(const char * iLiteral, size_t iLength)
+  {
+    for(size_t i=0; i<iLength; i++, mPosition++)
+    {
+      if (mPosition == mEnd || *mPosition != iLiteral[i])
+        return fail();
+    }
+    return true;
+  }
+
+  bool JsonReader::fail()
+  {
+    mErrorPosition = mPosition - mBegin;
+    return false;
+  }
+
+  void JsonReader::skipWhitespace()
+  {
+    while(mPosition < mEnd && (*mPosition == ' ' || *mPosition == '\n' || *mPosition == '\r' || *mPosition == '\t'))
+      mPosition++;
+  }
+
+  //------------
+  // JsonWriter
+  //------------
+  const size_t JsonWriter::BUFFER_SIZE;
+
+  JsonWriter::JsonWriter(std::ostream & iStream) :
+    mStream(iStream),
+    mBuffer(BUFFER_SIZE),
+    mUsed(0)
+  {
+  }
+
+  JsonWriter::~JsonWriter()
+  {
+    flush();
+  }
+
+  void JsonWriter::write(const JsonValue & iValue)
+  {
+    switch(iValue.getType())
+    {
+    case JsonValue::JSON_NULL:
+      writeChars("null", 4);
+      break;
+    case JsonValue::JSON_SCALAR:
+      writeScalar(iValue.getValue());
+      break;
+    case JsonValue::JSON_ARRAY:
+      writeChars("[", 1);
+      for(size_t i=0; i<iValue.size(); i++)
+      {
+        if (i > 0)
+          writeChars(",", 1);
+        write(iValue[i]);
+      }
+      writeChars("]", 1);
+      break;
+    case JsonValue::JSON_OBJECT:
+      writeChars("{", 1);
+      for(size_t i=0; i<iValue.size(); i++)
+      {
+        if (i > 0)
+          writeChars(",", 1);
+        const Variant & name = iValue.getName(i);
+        writeString(VariantAccess::getStringBuffer(name), VariantAccess::getStringLength(name));
+        writeChars(":", 1);
+        write(iValue[i]);
+      }
+      writeChars("}", 1);
+      break;
+    default:
+      assert( false ); /*error should not happen*/
+      break;
+    };
+  }
+
+  void JsonWriter::write(const Variant & iValue)
+  {
+    writeScalar(iValue);
+  }
+
+  bool JsonWriter::flush()
+  {
+    if (mUsed > 0)
+      mStream.write(&mBuffer[0], mUsed);
+    mUsed = 0;
+    return mStream.good();
+  }
+
+  //----------------
+  // private methods
+  //----------------
+  void JsonWriter::reserve(size_t iSize)
+  {
+    if (mUsed + iSize > mBuffer.size())
+      flush();
+  }
+
+  void JsonWriter::writeChars(const char * iValue, size_t iLength)
+  {
+    while(iLength > 0)
+    {
+      if (mUsed == mBuffer.size())
+        flush();
+      size_t count = mBuffer.size() - mUsed;
+      if (count > iLength)
+        count = iLength;
+      memcpy(&mBuffer[mUsed], iValue, count);
+      mUsed += count;
+      iValue += count;
+      iLength -= count;
+    }
+  }
+
+  void JsonWriter::writeScalar(const Variant & iValue)
+  {
+    if (VariantAccess::getFormat(iValue) == Variant::STRING)
+    {
+      writeString(VariantAccess::getStringBuffer(iValue), VariantAccess::getStringLength(iValue));
+      return;
+    }
+
+    //room for a number, a decimal point and a null terminator
+    reserve(StringEncoder::MAX_CHARS_SIZE + 2);
+    char * buffer = &mBuffer[mUsed];
+    const size_t size = StringEncoder::MAX_CHARS_SIZE;
+    size_t length = 0;
+    switch(VariantAccess::getFormat(iValue))
+    {
+    case Variant::BOOL:
+      length = StringEncoder::toChars(buffer, size, VariantAccess::getValue(iValue).as_uint64 != 0);
+      break;
+    case Variant::UINT8:
+    case Variant::UINT16:
+    case Variant::UINT32:
+    case Variant::UINT64:
+      length = StringEncoder::toChars(buffer, size, VariantAccess::getValue(iValue).as_uint64);
+      break;
+    case Variant::SINT8:
+    case Variant::SINT16:
+    case Variant::SINT32:
+    case Variant::SINT64:
+      length = StringEncoder::toChars(buffer, size, VariantAccess::getValue(iValue).as_sint64);
+      break;
+    case Variant::FLOAT32:
+    case Variant::FLOAT64:
+      {
+        const float64 value = (VariantAccess::getFormat(iValue) == Variant::FLOAT32 ? VariantAccess::getValue(iValue).as_float32 : VariantAccess::getValue(iValue).as_float64);
+        if (value != value || value > DBL_MAX || value < -DBL_MAX)
+        {
+          writeChars("null", 4);
+          return;
+        }
+        if (VariantAccess::getFormat(iValue) == Variant::FLOAT32)
+          length = StringEncoder::toShortestChars(buffer, size, VariantAccess::getValue(iValue).as_float32);
+        else
+          length = StringEncoder::toShortestChars(buffer, size, VariantAccess::getValue(iValue).as_float64);
+
+        //keep floating point values distinct from integers
+        bool integral = true;
+        for(size_t i=0; i<length && integral; i++)
+          integral = (buffer[i] == '-' || isDigit(buffer[i]));
+        if (integral)
+        {
+          buffer[length++] = '.';
+          buffer[length++] = '0';
+        }
+      }
+      break;
+    default:
+      assert( false ); /*error should not happen*/
+      break;
+    };
+    mUsed += length;
+  }
+
+  void JsonWriter::writeString(const char * iValue, size_t iLength)
+  {
+    static const char HEX_DIGITS[] = "0123456789abcdef";
+    writeChars("\"", 1);
+    const char * segment = iValue; //first character not yet written
+    const char * end = iValue + iLength;
+    for(const char * c = iValue; c < end; c++)
+    {
+      const unsigned char value = static_cast<unsigned char>(*c);
+      if (value >= 0x20 && value != '"' && value != '\\')
+        continue;
+
+      writeChars(segment, c - segment);
+      segment = c + 1;
+      char escape[6] = {'\\', 0, 0, 0, 0, 0};
+      size_t length = 2;
+      switch(value)
+      {
+      case '"':  escape[1] = '"';  break;
+      case '\\': escape[1] = '\\'; break;
+      case '\b': escape[1] = 'b';  break;
+      case '\f': escape[1] = 'f';  break;
+      case '\n': escape[1] = 'n';  break;
+      case '\r': escape[1] = 'r';  break;
+      case '\t': escape[1] = 't';  break;
+      default:
+        escape[1] = 'u';
+        escape[2] = '0';
+        escape[3] = '0';
+        escape[4] = HEX_DIGITS[value >> 4];
+        escape[5] = HEX_DIGITS[value & 0xF];
+        length = 6;
+        break;
+      };
+      writeChars(escape, length);
+    }
+    writeChars(segment, end - segment);
+    writeChars("\"", 1);
+  }
+
+} // End of namespace
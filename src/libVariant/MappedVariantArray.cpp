@@ -0,0 +1,399 @@
+/**********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2018 Antoine Beauchamp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+
+//---------------
+// Include Files
+//---------------
+#include "libvariant/mapped_variant_array.h"
+#include "VariantAccess.h"
+
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+//-----------
+// Namespace
+//-----------
+
+namespace libVariant
+{
+  typedef uint32 STRING_LENGTH_TYPE; //must match VariantArray
+
+  static const char FILE_MAGIC[8] = {'L', 'V', 'A', 'R', 'R', 'A', 'Y', '\0'};
+  static const uint32 FILE_VERSION = 1;
+  static const uint32 BYTE_ORDER_MARK = 0x01020304;
+  static const size_t WRITE_BUFFER_SIZE = 64 * 1024;
+
+  /// <summary>
+  /// Header at the beginning of a file. Sections offsets are relative to the beginning of the file.
+  /// </summary>
+  struct FileHeader
+  {
+    char magic[8];
+    uint32 version;
+    uint32 byteOrder;
+    uint64 size;
+    uint64 formatsOffset;
+    uint64 valuesOffset;
+    uint64 stringsOffset;
+    uint64 stringsSize;
+  };
+  static_assert(sizeof(FileHeader) % sizeof(Variant::VariantUnion) == 0, "FileHeader must preserve the alignment of the sections");
+
+  inline uint64 alignValues(uint64 iOffset)
+  {
+    const uint64 alignment = sizeof(Variant::VariantUnion);
+    return (iOffset + alignment - 1) / alignment * alignment;
+  }
+
+  /// <summary>
+  /// Validates the format of every value and the offset and length of every string value of a mapped file.
+  /// getView() and getStringBuffer() do not check the values again.
+  /// </summary>
+  static bool isValidColumns(const uint8 * iFormats, const Variant::VariantUnion * iValues, size_t iSize, const char * iStrings, size_t iStringsSize)
+  {
+    for(size_t i=0; i<iSize; i++)
+    {
+      const uint8 format = iFormats[i];
+      if (format > Variant::STRING)
+        return false;
+      if (format == Variant::BOOL && iValues[i].as_uint8 > 1)
+        return false;
+      if (format != Variant::STRING)
+        continue;
+
+      const uint64 offset = iValues[i].as_uint64;
+      if (offset > iStringsSize || iStringsSize - offset < sizeof(STRING_LENGTH_TYPE))
+        return false;
+      STRING_LENGTH_TYPE length = 0;
+      memcpy(&length, iStrings + offset, sizeof(length));
+      if (iStringsSize - offset - sizeof(length) < length)
+        return false;
+    }
+    return true;
+  }
+
+  /// <summary>
+  /// Writes a file through a buffer to reduce the number of calls to fwrite().
+  /// </summary>
+  class BufferedFile
+  {
+  public:
+    BufferedFile(FILE * iFile) : mFile(iFile), mUsed(0), mFailed(false) {}
+
+    void write(const void * iData, size_t iSize)
+    {
+      if (iSize == 0)
+        return;
+      if (mUsed + iSize > WRITE_BUFFER_SIZE)
+        flush();
+      if (iSize > WRITE_BUFFER_SIZE)
+      {
+        mFailed |= (fwrite(iData, 1, iSize, mFile) != iSize);
+        return;
+      }
+      memcpy(mBuffer + mUsed, iData, iSize);
+      mUsed += iSize;
+    }
+
+    void flush()
+    {
+      if (mUsed > 0)
+        mFailed |= (fwrite(mBuffer, 1, mUsed, mFile) != mUsed);
+      mUsed = 0;
+    }
+
+    bool hasFailed() const { return mFailed; }
+
+  private:
+    FILE * mFile;
+    char mBuffer[WRITE_BUFFER_SIZE];
+    size_t mUsed;
+    bool mFailed;
+  };
+
+  /// <summary>
+  /// Platform specific handles of a mapped file.
+  /// </summary>
+  struct MappedVariantArray::Mapping
+  {
+    const char * address;
+    size_t size;
+#ifdef _WIN32
+    HANDLE file;
+    HANDLE mapping;
+#endif
+  };
+
+  MappedVariantArray::MappedVariantArray() :
+    mMapping(NULL),
+    mSize(0),
+    mFormats(NULL),
+    mValues(NULL),
+    mStrings(NULL),
+    mStringsSize(0)
+  {
+  }
+
+  MappedVariantArray::~MappedVariantArray()
+  {
+    close();
+  }
+
+  //----------------
+  // public methods
+  //----------------
+  bool MappedVariantArray::save(const VariantArray & iValues, const char * iPath)
+  {
+    if (iPath == NULL)
+      return false;
+
+    //string values are written in a compacted section: characters of overwritten values are not saved.
+    const size_t count = iValues.size();
+    const uint8 * formats = iValues.getFormats();
+    uint64 stringsSize = 0;
+    for(size_t i=0; i<count; i++)
+    {
+      if (formats[i] != Variant::STRING)
+        continue;
+      size_t length = 0;
+      iValues.getStringBuffer(i, length);
+      stringsSize += sizeof(STRING_LENGTH_TYPE) + length;
+    }
+
+    FileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, FILE_MAGIC, sizeof(FILE_MAGIC));
+    header.version = FILE_VERSION;
+    header.byteOrder = BYTE_ORDER_MARK;
+    header.size = count;
+    header.formatsOffset = sizeof(FileHeader);
+    header.valuesOffset = alignValues(header.formatsOffset + count);
+    header.stringsOffset = header.valuesOffset + count * sizeof(Variant::VariantUnion);
+    header.stringsSize = stringsSize;
+
+    FILE * f = fopen(iPath, "wb");
+    if (!f)
+      return false;
+
+    BufferedFile file(f);
+    file.write(&header, sizeof(header));
+    file.write(formats, count);
+    static const char PADDING[sizeof(Variant::VariantUnion)] = {0};
+    file.write(PADDING, static_cast<size_t>(header.valuesOffset - header.formatsOffset - count));
+
+    //values of strings are offsets in the compacted section
+    const Variant::VariantUnion * values = iValues.getValues();
+    uint64 stringOffset = 0;
+    for(size_t i=0; i<count; i++)
+    {
+      if (formats[i] != Variant::STRING)
+      {
+        file.write(&values[i], sizeof(Variant::VariantUnion));
+        continue;
+      }
+      Variant::VariantUnion value;
+      value.as_uint64 = stringOffset;
+      file.write(&value, sizeof(value));
+      size_t length = 0;
+      iValues.getStringBuffer(i, length);
+      stringOffset += sizeof(STRING_LENGTH_TYPE) + length;
+    }
+
+    for(size_t i=0; i<count; i++)
+    {
+      if (formats[i] != Variant::STRING)
+        continue;
+      size_t length = 0;
+      const char * buffer = iValues.getStringBuffer(i, length);
+      STRING_LENGTH_TYPE prefix = static_cast<STRING_LENGTH_TYPE>(length);
+      file.write(&prefix, sizeof(prefix));
+      file.write(buffer, length);
+    }
+
+    file.flush();
+    bool success = !file.hasFailed();
+    success &= (fclose(f) == 0);
+    return success;
+  }
+
+  bool MappedVariantArray::open(const char * iPath)
+  {
+    close();
+    if (iPath == NULL)
+      return false;
+
+    Mapping mapping;
+    memset(&mapping, 0, sizeof(mapping));
+
+#ifdef _WIN32
+    mapping.file = CreateFileA(iPath, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (mapping.file == INVALID_HANDLE_VALUE)
+      return false;
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(mapping.file, &fileSize) || fileSize.QuadPart < static_cast<LONGLONG>(sizeof(FileHeader)) || static_cast<uint64>(fileSize.QuadPart) > static_cast<uint64>(static_cast<size_t>(-1)))
+    {
+      CloseHandle(mapping.file);
+      return false;
+    }
+    mapping.size = static_cast<size_t>(fileSize.QuadPart);
+    mapping.mapping = CreateFileMappingA(mapping.file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (mapping.mapping == NULL)
+    {
+      CloseHandle(mapping.file);
+      return false;
+    }
+    mapping.address = static_cast<const char *>(MapViewOfFile(mapping.mapping, FILE_MAP_READ, 0, 0, 0));
+    if (mapping.address == NULL)
+    {
+      CloseHandle(mapping.mapping);
+      CloseHandle(mapping.file);
+      return false;
+    }
+#else
+    int fd = ::open(iPath, O_RDONLY);
+    if (fd == -1)
+      return false;
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size < static_cast<off_t>(sizeof(FileHeader)) || static_cast<uint64>(info.st_size) > static_cast<uint64>(static_cast<size_t>(-1)))
+    {
+      ::close(fd);
+      return false;
+    }
+    mapping.size = static_cast<size_t>(info.st_size);
+    void * address = mmap(NULL, mapping.size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd); //the mapping keeps a reference to the file
+    if (address == MAP_FAILED)
+      return false;
+    mapping.address = static_cast<const char *>(address);
+#endif
+
+    mMapping = new Mapping(mapping);
+
+    //validate the header and the bounds of the sections
+    FileHeader header;
+    memcpy(&header, mapping.address, sizeof(header));
+    const uint64 fileSize = mapping.size;
+    bool valid = (memcmp(header.magic, FILE_MAGIC, sizeof(FILE_MAGIC)) == 0 &&
+                  header.version == FILE_VERSION &&
+                  header.byteOrder == BYTE_ORDER_MARK &&
+                  header.size <= fileSize &&
+                  header.formatsOffset == sizeof(FileHeader) &&
+                  header.valuesOffset == alignValues(header.formatsOffset + header.size) &&
+                  header.valuesOffset <= fileSize &&
+                  header.size <= (fileSize - header.valuesOffset) / sizeof(Variant::VariantUnion) &&
+                  header.stringsOffset == header.valuesOffset + header.size * sizeof(Variant::VariantUnion) &&
+                  header.stringsSize == fileSize - header.stringsOffset);
+    if (!valid)
+    {
+      close();
+      return false;
+    }
+
+    mSize = static_cast<size_t>(header.size);
+    mFormats = reinterpret_cast<const uint8 *>(mapping.address + header.formatsOffset);
+    mValues = reinterpret_cast<const Variant::VariantUnion *>(mapping.address + header.valuesOffset);
+    mStrings = mapping.address + header.stringsOffset;
+    mStringsSize = static_cast<size_t>(header.stringsSize);
+
+    //validate the columns once. The values are not checked again when they are read.
+    if (!isValidColumns(mFormats, mValues, mSize, mStrings, mStringsSize))
+    {
+      close();
+      return false;
+    }
+    return true;
+  }
+
+  void MappedVariantArray::close()
+  {
+    if (mMapping == NULL)
+      return;
+
+#ifdef _WIN32
+    UnmapViewOfFile(mMapping->address);
+    CloseHandle(mMapping->mapping);
+    CloseHandle(mMapping->file);
+#else
+    munmap(const_cast<char *>(mMapping->address), mMapping->size);
+#endif
+
+    delete mMapping;
+    mMapping = NULL;
+    mSize = 0;
+    mFormats = NULL;
+    mValues = NULL;
+    mStrings = NULL;
+    mStringsSize = 0;
+  }
+
+  Variant MappedVariantArray::get(size_t iIndex) const
+  {
+    Variant value = getView(iIndex);
+    value.materialize();
+    return value;
+  }
+
+  Variant MappedVariantArray::getView(size_t iIndex) const
+  {
+    assert( iIndex < size() );
+    Variant value;
+    if (mFormats[iIndex] == Variant::STRING)
+    {
+      size_t length = 0;
+      const char * buffer = getStringBuffer(iIndex, length);
+      value.setStringView(buffer, length);
+      return value;
+    }
+    VariantAccess::setValue(value, static_cast<Variant::VariantFormat>(mFormats[iIndex]), mValues[iIndex]);
+    return value;
+  }
+
+  const char * MappedVariantArray::getStringBuffer(size_t iIndex, size_t & oLength) const
+  {
+    //the offset and the length were validated by open()
+    assert( iIndex < size() && mFormats[iIndex] == Variant::STRING );
+    assert( mValues[iIndex].as_uint64 + sizeof(STRING_LENGTH_TYPE) <= mStringsSize );
+    const char * buffer = mStrings + mValues[iIndex].as_uint64;
+    STRING_LENGTH_TYPE length = 0;
+    memcpy(&length, buffer, sizeof(length));
+    oLength = length;
+    assert( mValues[iIndex].as_uint64 + sizeof(length) + length <= mStringsSize );
+    return buffer + sizeof(length);
+  }
+
+} // End of namespace
@@ -0,0 +1,254 @@
+/**********************************************************************************
+ * MIT License
+ * 
+ * Copyright (c) 2018 Antoine Beauchamp
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+
+#ifndef LIBVARIANT_NATIVEFORMATS_H
+#define LIBVARIANT_NATIVEFORMATS_H
+
+//---------------
+// Include Files
+//---------------
+#include "libvariant/variant.h"
+
+#include <assert.h>
+#include <type_traits> // common_type
+
+//-----------
+// Namespace
+//-----------
+
+namespace libVariant
+{
+  //----------------------------------------------------------------------------------------------
+  // Rules of the Variant class for values of native formats, shared by the processing of columns.
+  //----------------------------------------------------------------------------------------------
+
+  //limits matching Variant's promotion rules
+  static const uint64 uint8_max  = 0xFFull;
+  static const uint64 uint16_max = 0xFFFFull;
+  static const uint64 uint32_max = 0xFFFFFFFFull;
+  static const sint64 sint8_max  = 0x7Fll;
+  static const sint64 sint16_max = 0x7FFFll;
+  static const sint64 sint32_max = 0x7FFFFFFFll;
+
+  //sets of formats. A set contains a format if the bit (1 << format) is set.
+  static const uint32 UNSIGNED_FORMATS = (1u << Variant::BOOL) | (1u << Variant::UINT8) | (1u << Variant::UINT16) | (1u << Variant::UINT32) | (1u << Variant::UINT64);
+  static const uint32 SIGNED_FORMATS   = (1u << Variant::SINT8) | (1u << Variant::SINT16) | (1u << Variant::SINT32) | (1u << Variant::SINT64);
+  static const uint32 INTEGER_FORMATS  = UNSIGNED_FORMATS | SIGNED_FORMATS;
+  static const uint32 FLOAT32_FORMATS  = (1u << Variant::FLOAT32);
+  static const uint32 FLOAT64_FORMATS  = (1u << Variant::FLOAT64);
+  static const uint32 FLOAT_FORMATS    = FLOAT32_FORMATS | FLOAT64_FORMATS;
+  static const uint32 NUMERIC_FORMATS  = INTEGER_FORMATS | FLOAT_FORMATS;
+
+  /// <summary>
+  /// Returns the set of formats of the given values.
+  /// </summary>
+  inline uint32 getFormatSet(const uint8 * iFormats, size_t iSize)
+  {
+    uint32 formats = 0;
+    for(size_t i=0; i<iSize; i++)
+      formats |= (1u << iFormats[i]);
+    return formats;
+  }
+
+  /// <summary>
+  /// Returns true if all formats of a range of values are identical to the given format.
+  /// </summary>
+  inline bool isSameFormat(const uint8 * iFormats, size_t iCount, uint8 iFormat)
+  {
+    uint8 differences = 0;
+    for(size_t i=0; i<iCount; i++)
+      differences |= (iFormats[i] ^ iFormat);
+    return differences == 0;
+  }
+
+  /// <summary>
+  /// Returns true if all formats of iFormats are also in iSet.
+  /// </summary>
+  inline bool isSubset(uint32 iFormats, uint32 iSet)
+  {
+    return (iFormats & ~iSet) == 0;
+  }
+
+  /// <summary>
+  /// Returns true if the set contains a single format.
+  /// </summary>
+  inline bool getSingleFormat(uint32 iFormats, Variant::VariantFormat & oFormat)
+  {
+    for(int format = Variant::BOOL; format <= Variant::STRING; format++)
+    {
+      if (iFormats == (1u << format))
+      {
+        oFormat = static_cast<Variant::VariantFormat>(format);
+        return true;
+      }
+    }
+    return false;
+  }
+
+  /// <summary>
+  /// Returns the signed format matching an unsigned format. See Variant::signFormatToggle().
+  /// </summary>
+  inline uint8 getSignedFormat(uint8 iFormat)
+  {
+    static_assert(Variant::BOOL == 0 && Variant::UINT8 + 1 == Variant::SINT8 && Variant::UINT16 + 1 == Variant::SINT16 &&
+                  Variant::UINT32 + 1 == Variant::SINT32 && Variant::UINT64 + 1 == Variant::SINT64, "each signed format must follow its unsigned format");
+    return static_cast<uint8>(iFormat == Variant::BOOL ? Variant::SINT8 : iFormat + 1);
+  }
+
+  /// <summary>
+  /// Returns the format of an unsigned result. See Variant::OperatorKernels::promoteUnsignedFormat().
+  /// </summary>
+  inline uint8 getPromotedUnsignedFormat(uint8 iFormat, uint64 iValue)
+  {
+    return (iValue > uint32_max ? (uint8)Variant::UINT64 :
+           (iValue > uint16_max ? (uint8)Variant::UINT32 :
+           (iValue > uint8_max  ? (uint8)Variant::UINT16 : iFormat)));
+  }
+
+  /// <summary>
+  /// Returns the format of a signed result. See Variant::OperatorKernels::promoteSignedFormat().
+  /// </summary>
+  inline uint8 getPromotedSignedFormat(uint8 iFormat, sint64 iValue)
+  {
+    return (iValue > sint32_max ? (uint8)Variant::SINT64 :
+           (iValue > sint16_max ? (uint8)Variant::SINT32 :
+           (iValue > sint8_max  ? (uint8)Variant::SINT16 : iFormat)));
+  }
+
+  /// <summary>
+  /// Converts a numeric value to float64. See Variant::getFloat64().
+  /// </summary>
+  inline float64 toFloat64(uint8 iFormat, const Variant::VariantUnion & iValue)
+  {
+    switch(iFormat)
+    {
+    case Variant::BOOL:
+      return iValue.as_bool;
+    case Variant::UINT8:
+      return iValue.as_uint8;
+    case Variant::UINT16:
+      return iValue.as_uint16;
+    case Variant::UINT32:
+      return iValue.as_uint32;
+    case Variant::UINT64:
+      return static_cast<float64>(iValue.as_uint64);
+    case Variant::SINT8:
+      return iValue.as_sint8;
+    case Variant::SINT16:
+      return iValue.as_sint16;
+    case Variant::SINT32:
+      return iValue.as_sint32;
+    case Variant::SINT64:
+      return static_cast<float64>(iValue.as_sint64);
+    case Variant::FLOAT32:
+      return iValue.as_float32;
+    case Variant::FLOAT64:
+      return iValue.as_float64;
+    default:
+      assert( false ); /*error should not happen*/
+      return 0.0;
+    };
+  }
+
+  /// <summary>
+  /// The native types compared by Variant::compare() for each internal format.
+  /// A bool value is compared as a sint8 and a bool argument as an int. See compareNativeTypes() and DEFAULT_BOOLEAN_REDIRECTION_TYPE.
+  /// </summary>
+  template <int format> struct CompareTraits;
+  template <> struct CompareTraits<Variant::BOOL   > { typedef sint8   local_type; typedef int     remote_type; static bool    get(const Variant::VariantUnion & iValue) { return iValue.as_bool;    } };
+  template <> struct CompareTraits<Variant::UINT8  > { typedef uint8   local_type; typedef uint8   remote_type; static uint8   get(const Variant::VariantUnion & iValue) { return iValue.as_uint8;   } };
+  template <> struct CompareTraits<Variant::UINT16 > { typedef uint16  local_type; typedef uint16  remote_type; static uint16  get(const Variant::VariantUnion & iValue) { return iValue.as_uint16;  } };
+  template <> struct CompareTraits<Variant::UINT32 > { typedef uint32  local_type; typedef uint32  remote_type; static uint32  get(const Variant::VariantUnion & iValue) { return iValue.as_uint32;  } };
+  template <> struct CompareTraits<Variant::UINT64 > { typedef uint64  local_type; typedef uint64  remote_type; static uint64  get(const Variant::VariantUnion & iValue) { return iValue.as_uint64;  } };
+  template <> struct CompareTraits<Variant::SINT8  > { typedef sint8   local_type; typedef sint8   remote_type; static sint8   get(const Variant::VariantUnion & iValue) { return iValue.as_sint8;   } };
+  template <> struct CompareTraits<Variant::SINT16 > { typedef sint16  local_type; typedef sint16  remote_type; static sint16  get(const Variant::VariantUnion & iValue) { return iValue.as_sint16;  } };
+  template <> struct CompareTraits<Variant::SINT32 > { typedef sint32  local_type; typedef sint32  remote_type; static sint32  get(const Variant::VariantUnion & iValue) { return iValue.as_sint32;  } };
+  template <> struct CompareTraits<Variant::SINT64 > { typedef sint64  local_type; typedef sint64  remote_type; static sint64  get(const Variant::VariantUnion & iValue) { return iValue.as_sint64;  } };
+  template <> struct CompareTraits<Variant::FLOAT32> { typedef float32 local_type; typedef float32 remote_type; static float32 get(const Variant::VariantUnion & iValue) { return iValue.as_float32; } };
+  template <> struct CompareTraits<Variant::FLOAT64> { typedef float64 local_type; typedef float64 remote_type; static float64 get(const Variant::VariantUnion & iValue) { return iValue.as_float64; } };
+
+  /// <summary>
+  /// Compares two numeric values like Variant::compare(). See compareNativeTypes().
+  /// </summary>
+  template <int localFormat, int remoteFormat>
+  inline int compareNativeValues(const Variant::VariantUnion & iLocalValue, const Variant::VariantUnion & iRemoteValue)
+  {
+    typedef typename CompareTraits<localFormat>::local_type local_type;
+    typedef typename CompareTraits<remoteFormat>::remote_type remote_type;
+
+    //the usual arithmetic conversions of the built-in operators, made explicit. ie: a sint8 compared to a uint32 is converted to uint32
+    typedef typename std::common_type<local_type, remote_type>::type common_type;
+
+    const common_type localValue = static_cast<common_type>(static_cast<local_type>(CompareTraits<localFormat>::get(iLocalValue)));
+    const common_type remoteValue = static_cast<common_type>(static_cast<remote_type>(CompareTraits<remoteFormat>::get(iRemoteValue)));
+    return (localValue > remoteValue) - (localValue < remoteValue);
+  }
+
+  template <int localFormat>
+  inline int compareNativeValues(const Variant::VariantUnion & iLocalValue, uint8 iRemoteFormat, const Variant::VariantUnion & iRemoteValue)
+  {
+    switch(iRemoteFormat)
+    {
+    case Variant::BOOL:    return compareNativeValues<localFormat, Variant::BOOL   >(iLocalValue, iRemoteValue);
+    case Variant::UINT8:   return compareNativeValues<localFormat, Variant::UINT8  >(iLocalValue, iRemoteValue);
+    case Variant::UINT16:  return compareNativeValues<localFormat, Variant::UINT16 >(iLocalValue, iRemoteValue);
+    case Variant::UINT32:  return compareNativeValues<localFormat, Variant::UINT32 >(iLocalValue, iRemoteValue);
+    case Variant::UINT64:  return compareNativeValues<localFormat, Variant::UINT64 >(iLocalValue, iRemoteValue);
+    case Variant::SINT8:   return compareNativeValues<localFormat, Variant::SINT8  >(iLocalValue, iRemoteValue);
+    case Variant::SINT16:  return compareNativeValues<localFormat, Variant::SINT16 >(iLocalValue, iRemoteValue);
+    case Variant::SINT32:  return compareNativeValues<localFormat, Variant::SINT32 >(iLocalValue, iRemoteValue);
+    case Variant::SINT64:  return compareNativeValues<localFormat, Variant::SINT64 >(iLocalValue, iRemoteValue);
+    case Variant::FLOAT32: return compareNativeValues<localFormat, Variant::FLOAT32>(iLocalValue, iRemoteValue);
+    case Variant::FLOAT64: return compareNativeValues<localFormat, Variant::FLOAT64>(iLocalValue, iRemoteValue);
+    default:
+      assert( false ); /*error should not happen*/
+      return 0;
+    };
+  }
+
+  inline int compareNativeValues(uint8 iLocalFormat, const Variant::VariantUnion & iLocalValue, uint8 iRemoteFormat, const Variant::VariantUnion & iRemoteValue)
+  {
+    switch(iLocalFormat)
+    {
+    case Variant::BOOL:    return compareNativeValues<Variant::BOOL   >(iLocalValue, iRemoteFormat, iRemoteValue);
+    case Variant::UINT8:   return compareNativeValues<Variant::UINT8  >(iLocalValue, iRemoteFormat, iRemoteValue);
+    case Variant::UINT16:  return compareNativeValues<Variant::UINT16 >(iLocalValue, iRemoteFormat, iRemoteValue);
+    case Variant::UINT32:  return compareNativeValues<Variant::UINT32 >(iLocalValue, iRemoteFormat, iRemoteValue);
+    case Variant::UINT64:  return compareNativeValues<Variant::UINT64 >(iLocalValue, iRemoteFormat, iRemoteValue);
+    case Variant::SINT8:   return compareNativeValues<Variant::SINT8  >(iLocalValue, iRemoteFormat, iRemoteValue);
+    case Variant::SINT16:  return compareNativeValues<Variant::SINT16 >(iLocalValue, iRemoteFormat, iRemoteValue);
+    case Variant::SINT32:  return compareNativeValues<Variant::SINT32 >(iLocalValue, iRemoteFormat, iRemoteValue);
+    case Variant::SINT64:  return compareNativeValues<Variant::SINT64 >(iLocalValue, iRemoteFormat, iRemoteValue);
+    case Variant::FLOAT32: return compareNativeValues<Variant::FLOAT32>(iLocalValue, iRemoteFormat, iRemoteValue);
+    case Variant::FLOAT64: return compareNativeValues<Variant::FLOAT64>(iLocalValue, iRemoteFormat, iRemoteValue);
+    default:
+      assert( false ); /*error should not happen*/
+      return 0;
+    };
+  }
+
+} // End namespace
+
+#endif //LIBVARIANT_NATIVEFORMATS_H
@@ -0,0 +1,389 @@
+/**********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2018 Antoine Beauchamp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+
+//---------------
+// Include Files
+//---------------
+#include "libvariant/sort.h"
+#include "VariantAccess.h"
+
+#include <assert.h>
+#include <string.h> // memcpy
+#include <algorithm>
+#include <utility>
+
+//-----------
+// Namespace
+//-----------
+
+namespace libVariant
+{
+  struct Sort::Kernels
+  {
+    //------------------------------------------------------------------------
+    // sources of values. Native values are read without creating a Variant.
+    //------------------------------------------------------------------------
+    struct VariantRange
+    {
+      uint8 getFormat(size_t iIndex) const { return static_cast<uint8>(VariantAccess::getFormat(values[iIndex])); }
+      const Variant::VariantUnion & getValue(size_t iIndex) const { return VariantAccess::getValue(values[iIndex]); }
+      const Variant & getView(size_t iIndex) const { return values[iIndex]; }
+      const char * getString(size_t iIndex, size_t & oLength) const
+      {
+        oLength = VariantAccess::getStringLength(values[iIndex]);
+        return VariantAccess::getStringBuffer(values[iIndex]);
+      }
+
+      const Variant * values;
+      size_t size;
+    };
+
+    struct ArrayRange
+    {
+      uint8 getFormat(size_t iIndex) const { return formats[iIndex]; }
+      const Variant::VariantUnion & getValue(size_t iIndex) const { return values[iIndex]; }
+      Variant getView(size_t iIndex) const { return array->getView(iIndex); }
+      const char * getString(size_t iIndex, size_t & oLength) const { return array->getStringBuffer(iIndex, oLength); }
+
+      const VariantArray * array;
+      const uint8 * formats;
+      const Variant::VariantUnion * values;
+      size_t size;
+    };
+
+    static VariantRange getRange(const Variant * iValues, size_t iSize)
+    {
+      VariantRange range = { iValues, iSize };
+      return range;
+    }
+
+    static ArrayRange getRange(const VariantArray & iValues)
+    {
+      ArrayRange range = { &iValues, iValues.getFormats(), iValues.getValues(), iValues.size() };
+      return range;
+    }
+
+    //------------------------------------------------------------------------
+    // normalized keys
+    //------------------------------------------------------------------------
+
+    //first byte of a key
+    static const uint64 NUMBER_KEY = 0;
+    static const uint64 NAN_KEY    = 1;
+    static const uint64 STRING_KEY = 2;
+
+    //number of bytes of a key and number of bits of the index of a value
+    static const size_t KEY_SIZE = 11;
+    static const size_t INDEX_BITS = 40;
+    static const uint64 INDEX_MASK = (1ull << INDEX_BITS) - 1;
+
+    /// <summary>
+    /// The key of a value and the index of the value. The bytes of a key are compared as unsigned integers: the 8 bytes of
+    /// high first, then the 3 high bytes of low. The other bits of low are the index of the value.
+    /// </summary>
+    /// <remarks>
+    /// The key of a number is the NUMBER_KEY byte followed by the value rounded to float64 and by the difference between
+    /// the value and the rounded value. Integers larger than 2^53 are not exact float64 values but the difference is small enough to fit in 16 bits.
+    /// The key of a string is the STRING_KEY byte followed by the first 10 characters padded with zeros.
+    /// Strings with the same key are compared by their characters.
+    /// </remarks>
+    struct Entry
+    {
+      uint64 high;
+      uint64 low;
+
+      bool isString() const { return (high >> 56) == STRING_KEY; }
+      size_t getIndex() const { return static_cast<size_t>(low & INDEX_MASK); }
+      bool hasSameKey(const Entry & iEntry) const { return high == iEntry.high && (low >> INDEX_BITS) == (iEntry.low >> INDEX_BITS); }
+      bool hasLowerKey(const Entry & iEntry) const { return high < iEntry.high || (high == iEntry.high && (low >> INDEX_BITS) < (iEntry.low >> INDEX_BITS)); }
+
+      /// <summary>
+      /// Returns a byte of the key. Byte 0 is the least significant byte.
+      /// </summary>
+      uint8 getKeyByte(size_t iByte) const
+      {
+        if (iByte < 3)
+          return static_cast<uint8>(low >> (INDEX_BITS + 8 * iByte));
+        return static_cast<uint8>(high >> (8 * (iByte - 3)));
+      }
+    };
+
+    /// <summary>
+    /// Sets the key of a number from its rounded float64 value and the difference with the exact value.
+    /// The bits of the float64 value are changed to compare like unsigned integers: negative values have all their bits inverted
+    /// and positive values have their sign bit set.
+    /// </summary>
+    static void setNumberKey(float64 iRounded, sint64 iResidual, size_t iIndex, Entry & oEntry)
+    {
+      assert( iResidual >= -0x8000 && iResidual < 0x8000 );
+      if (iRounded != iRounded)
+      {
+        oEntry.high = NAN_KEY << 56;
+        oEntry.low = iIndex;
+        return;
+      }
+      if (iRounded == 0.0)
+        iRounded = 0.0; //-0.0 is 0.0
+
+      uint64 bits;
+      memcpy(&bits, &iRounded, sizeof(bits));
+      bits = ((bits >> 63) != 0 ? ~bits : bits | (1ull << 63));
+      const uint64 low = ((bits & 0xFF) << 16) | static_cast<uint64>(iResidual + 0x8000);
+      oEntry.high = (NUMBER_KEY << 56) | (bits >> 8);
+      oEntry.low = (low << INDEX_BITS) | iIndex;
+    }
+
+    static void setIntegerKey(uint64 iValue, size_t iIndex, Entry & oEntry)
+    {
+      const float64 rounded = static_cast<float64>(iValue);
+      if (rounded >= 18446744073709551616.0)
+        setNumberKey(rounded, -static_cast<sint64>(~iValue) - 1, iIndex, oEntry); //iValue - 2^64
+      else
+        setNumberKey(rounded, static_cast<sint64>(iValue - static_cast<uint64>(rounded)), iIndex, oEntry);
+    }
+
+    static void setIntegerKey(sint64 iValue, size_t iIndex, Entry & oEntry)
+    {
+      const float64 rounded = static_cast<float64>(iValue);
+      if (rounded >= 9223372036854775808.0)
+        setNumberKey(rounded, static_cast<sint64>(static_cast<uint64>(iValue) - (1ull << 63)), iIndex, oEntry); //iValue - 2^63
+      else
+        setNumberKey(rounded, static_cast<sint64>(static_cast<uint64>(iValue) - static_cast<uint64>(static_cast<sint64>(rounded))), iIndex, oEntry);
+    }
+
+    static void setNativeKey(uint8 iFormat, const Variant::VariantUnion & iValue, size_t iIndex, Entry & oEntry)
+    {
+      switch(iFormat)
+      {
+      case Variant::BOOL:    setIntegerKey(static_cast<uint64>(iValue.as_bool ? 1 : 0), iIndex, oEntry); break;
+      case Variant::UINT8:   setIntegerKey(static_cast<uint64>(iValue.as_uint8 ), iIndex, oEntry); break;
+      case Variant::UINT16:  setIntegerKey(static_cast<uint64>(iValue.as_uint16), iIndex, oEntry); break;
+      case Variant::UINT32:  setIntegerKey(static_cast<uint64>(iValue.as_uint32), iIndex, oEntry); break;
+      case Variant::UINT64:  setIntegerKey(static_cast<uint64>(iValue.as_uint64), iIndex, oEntry); break;
+      case Variant::SINT8:   setIntegerKey(static_cast<sint64>(iValue.as_sint8 ), iIndex, oEntry); break;
+      case Variant::SINT16:  setIntegerKey(static_cast<sint64>(iValue.as_sint16), iIndex, oEntry); break;
+      case Variant::SINT32:  setIntegerKey(static_cast<sint64>(iValue.as_sint32), iIndex, oEntry); break;
+      case Variant::SINT64:  setIntegerKey(static_cast<sint64>(iValue.as_sint64), iIndex, oEntry); break;
+      case Variant::FLOAT32: setNumberKey(static_cast<float64>(iValue.as_float32), 0, iIndex, oEntry); break;
+      case Variant::FLOAT64: setNumberKey(iValue.as_float64, 0, iIndex, oEntry); break;
+      default:
+        assert( false ); /*error should not happen*/
+        break;
+      };
+    }
+
+    static void setStringKey(const char * iValue, size_t iLength, size_t iIndex, Entry & oEntry)
+    {
+      uint8 prefix[10] = {0};
+      memcpy(prefix, iValue, (iLength < sizeof(prefix) ? iLength : sizeof(prefix)));
+
+      oEntry.high = STRING_KEY << 56;
+      for(size_t i=0; i<7; i++)
+        oEntry.high |= static_cast<uint64>(prefix[i]) << (48 - 8 * i);
+      const uint64 low = (static_cast<uint64>(prefix[7]) << 16) | (static_cast<uint64>(prefix[8]) << 8) | prefix[9];
+      oEntry.low = (low << INDEX_BITS) | iIndex;
+    }
+
+    template <class T>
+    static void setKey(const T & iRange, size_t iIndex, Entry & oEntry)
+    {
+      const uint8 format = iRange.getFormat(iIndex);
+      if (format != Variant::STRING)
+      {
+        setNativeKey(format, iRange.getValue(iIndex), iIndex, oEntry);
+        return;
+      }
+
+      //a string which has a native representation is sorted as a number
+      Variant::VariantFormat simplifiedFormat;
+      Variant::VariantUnion simplifiedValue;
+      if (VariantAccess::getSimplifiedValue(iRange.getView(iIndex), simplifiedFormat, simplifiedValue))
+      {
+        setNativeKey(static_cast<uint8>(simplifiedFormat), simplifiedValue, iIndex, oEntry);
+        return;
+      }
+
+      size_t length = 0;
+      const char * buffer = iRange.getString(iIndex, length);
+      setStringKey(buffer, length, iIndex, oEntry);
+    }
+
+    //------------------------------------------------------------------------
+    // sorting
+    //------------------------------------------------------------------------
+
+    /// <summary>
+    /// Sorts entries by their keys with a least significant byte radix sort, which is stable.
+    /// The histograms of all bytes are computed at once. A byte which is identical for all keys is skipped.
+    /// </summary>
+    static void radixSort(std::vector<Entry> & ioEntries)
+    {
+      const size_t size = ioEntries.size();
+      if (size < 2)
+        return;
+
+      std::vector<size_t> histograms(KEY_SIZE * 256, 0);
+      for(size_t i=0; i<size; i++)
+      {
+        const Entry & entry = ioEntries[i];
+        for(size_t b=0; b<KEY_SIZE; b++)
+          histograms[b * 256 + entry.getKeyByte(b)]++;
+      }
+
+      std::vector<Entry> buffer(size);
+      Entry * source = &ioEntries[0];
+      Entry * target = &buffer[0];
+      for(size_t b=0; b<KEY_SIZE; b++)
+      {
+        size_t * offsets = &histograms[b * 256];
+        if (offsets[source[0].getKeyByte(b)] == size)
+          continue;
+
+        size_t offset = 0;
+        for(size_t k=0; k<256; k++)
+        {
+          const size_t count = offsets[k];
+          offsets[k] = offset;
+          offset += count;
+        }
+        for(size_t i=0; i<size; i++)
+          target[offsets[source[i].getKeyByte(b)]++] = source[i];
+        std::swap(source, target);
+      }
+      if (source != &ioEntries[0])
+        ioEntries.swap(buffer);
+    }
+
+    inline static int compareStrings(const char * iValue1, size_t iLength1, const char * iValue2, size_t iLength2)
+    {
+      //same as Variant::compare(): characters are compared as unsigned char
+      const int result = memcmp(iValue1, iValue2, (iLength1 < iLength2 ? iLength1 : iLength2));
+      if (result != 0)
+        return (result < 0 ? -1 : +1);
+      return (iLength1 < iLength2 ? -1 : (iLength1 > iLength2 ? +1 : 0));
+    }
+
+    template <class T>
+    struct StringLess
+    {
+      bool operator()(const Entry & iEntry1, const Entry & iEntry2) const
+      {
+        size_t length1 = 0;
+        size_t length2 = 0;
+        const char * buffer1 = range->getString(iEntry1.getIndex(), length1);
+        const char * buffer2 = range->getString(iEntry2.getIndex(), length2);
+        return compareStrings(buffer1, length1, buffer2, length2) < 0;
+      }
+
+      const T * range;
+    };
+
+    /// <summary>
+    /// Returns the indexes of a range of values in sorted order.
+    /// </summary>
+    template <class T>
+    static void getOrder(const T & iRange, std::vector<size_t> & oOrder)
+    {
+      assert( iRange.size <= INDEX_MASK );
+      std::vector<Entry> entries(iRange.size);
+      for(size_t i=0; i<iRange.size; i++)
+        setKey(iRange, i, entries[i]);
+
+      radixSort(entries);
+
+      //strings with the same key are sorted by their characters
+      const StringLess<T> less = { &iRange };
+      for(size_t first=0; first<entries.size(); )
+      {
+        size_t last = first + 1;
+        while(last < entries.size() && entries[last].hasSameKey(entries[first]))
+          last++;
+        if (last - first > 1 && entries[first].isString())
+          std::stable_sort(entries.begin() + first, entries.begin() + last, less);
+        first = last;
+      }
+
+      oOrder.resize(entries.size());
+      for(size_t i=0; i<entries.size(); i++)
+        oOrder[i] = entries[i].getIndex();
+    }
+  };
+
+  //----------------
+  // public methods
+  //----------------
+  void Sort::sort(Variant * ioValues, size_t iSize)
+  {
+    std::vector<size_t> order;
+    getOrder(ioValues, iSize, order);
+
+    std::vector<Variant> sorted;
+    sorted.reserve(iSize);
+    for(size_t i=0; i<iSize; i++)
+      sorted.push_back(std::move(ioValues[order[i]]));
+    for(size_t i=0; i<iSize; i++)
+      ioValues[i] = std::move(sorted[i]);
+  }
+
+  void Sort::sort(VariantArray & ioValues)
+  {
+    std::vector<size_t> order;
+    getOrder(ioValues, order);
+    ioValues.reorder(order);
+  }
+
+  void Sort::getOrder(const Variant * iValues, size_t iSize, std::vector<size_t> & oOrder)
+  {
+    Kernels::getOrder(Kernels::getRange(iValues, iSize), oOrder);
+  }
+
+  void Sort::getOrder(const VariantArray & iValues, std::vector<size_t> & oOrder)
+  {
+    Kernels::getOrder(Kernels::getRange(iValues), oOrder);
+  }
+
+  int Sort::compare(const Variant & iValue1, const Variant & iValue2)
+  {
+    const Kernels::VariantRange range1 = Kernels::getRange(&iValue1, 1);
+    const Kernels::VariantRange range2 = Kernels::getRange(&iValue2, 1);
+    Kernels::Entry entry1;
+    Kernels::Entry entry2;
+    Kernels::setKey(range1, 0, entry1);
+    Kernels::setKey(range2, 0, entry2);
+    if (entry1.hasLowerKey(entry2))
+      return -1;
+    if (entry2.hasLowerKey(entry1))
+      return +1;
+    if (!entry1.isString())
+      return 0;
+
+    size_t length1 = 0;
+    size_t length2 = 0;
+    const char * buffer1 = range1.getString(0, length1);
+    const char * buffer2 = range2.getString(0, length2);
+    return Kernels::compareStrings(buffer1, length1, buffer2, length2);
+  }
+
+} // End of namespace
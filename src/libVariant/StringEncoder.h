@@ -29,9 +29,15 @@
 //---------------
 // Include Files
 //---------------
+#include "libvariant/variant_types.h"
+#include "Grisu.h"
 #include <string>
 #include <sstream>
 #include <float.h>
+#include <limits> // std::numeric_limits
+#include <stdio.h> // snprintf
+#include <string.h> // memcpy
+#include <locale.h> // localeconv
  
 //-----------
 // Namespace
@@ -45,6 +51,78 @@ namespace libVariant
   class StringEncoder
   {
   public:
+    /// <summary>
+    /// Size of a buffer large enough to hold the string representation of any native value, including the null terminator.
+    /// </summary>
+    static const size_t MAX_CHARS_SIZE = 32;
+
+    /// <summary>
+    /// Writes the string representation of the given value to the given buffer without allocating memory.
+    /// The characters are identical to the ones returned by toString().
+    /// </summary>
+    /// <remarks>
+    /// Like snprintf(), the output is truncated to iSize-1 characters and always null terminated if iSize is not 0.
+    /// A buffer of MAX_CHARS_SIZE bytes is never truncated.
+    /// </remarks>
+    /// <param name="oBuffer">The output buffer.</param>
+    /// <param name="iSize">The size in bytes of the output buffer.</param>
+    /// <param name="iValue">The value to convert as string.</param>
+    /// <returns>Returns the length of the string representation of the given value, excluding the null terminator.</returns>
+    static inline size_t toChars(char * oBuffer, size_t iSize, const bool    & iValue) { return copyChars(oBuffer, iSize, (iValue ? "true" : "false"), (iValue ? 4 : 5)); }
+    static inline size_t toChars(char * oBuffer, size_t iSize, const uint8   & iValue) { return toChars(oBuffer, iSize, static_cast<uint64>(iValue)); }
+    static inline size_t toChars(char * oBuffer, size_t iSize, const uint16  & iValue) { return toChars(oBuffer, iSize, static_cast<uint64>(iValue)); }
+    static inline size_t toChars(char * oBuffer, size_t iSize, const uint32  & iValue) { return toChars(oBuffer, iSize, static_cast<uint64>(iValue)); }
+    static inline size_t toChars(char * oBuffer, size_t iSize, const sint8   & iValue) { return toChars(oBuffer, iSize, static_cast<sint64>(iValue)); }
+    static inline size_t toChars(char * oBuffer, size_t iSize, const sint16  & iValue) { return toChars(oBuffer, iSize, static_cast<sint64>(iValue)); }
+    static inline size_t toChars(char * oBuffer, size_t iSize, const sint32  & iValue) { return toChars(oBuffer, iSize, static_cast<sint64>(iValue)); }
+
+    static inline size_t toChars(char * oBuffer, size_t iSize, const uint64  & iValue)
+    {
+      char digits[MAX_CHARS_SIZE];
+      char * end = digits + sizeof(digits);
+      return copyChars(oBuffer, iSize, writeDigits(end, iValue), end);
+    }
+
+    static inline size_t toChars(char * oBuffer, size_t iSize, const sint64  & iValue)
+    {
+      char digits[MAX_CHARS_SIZE];
+      char * end = digits + sizeof(digits);
+      uint64 magnitude = static_cast<uint64>(iValue);
+      if (iValue < 0)
+        magnitude = 0 - magnitude; //two's complement, also valid for the minimum value
+      char * first = writeDigits(end, magnitude);
+      if (iValue < 0)
+        *(--first) = '-';
+      return copyChars(oBuffer, iSize, first, end);
+    }
+
+    static inline size_t toChars(char * oBuffer, size_t iSize, const float32 & iValue)
+    {
+      //same precision as toString<float>()
+      return printChars(oBuffer, iSize, FLT_DIG+2, iValue);
+    }
+
+    static inline size_t toChars(char * oBuffer, size_t iSize, const float64 & iValue)
+    {
+      //same precision as toString<double>()
+      return printChars(oBuffer, iSize, DBL_DIG, iValue);
+    }
+
+    /// <summary>
+    /// Writes the shortest string representation of the given floating point value which parses back to the identical value.
+    /// The notation is the same as toChars(): the exponent notation is used for very large or very small values.
+    /// </summary>
+    /// <remarks>
+    /// Like snprintf(), the output is truncated to iSize-1 characters and always null terminated if iSize is not 0.
+    /// A buffer of MAX_CHARS_SIZE bytes is never truncated.
+    /// </remarks>
+    /// <param name="oBuffer">The output buffer.</param>
+    /// <param name="iSize">The size in bytes of the output buffer.</param>
+    /// <param name="iValue">The value to convert as string.</param>
+    /// <returns>Returns the length of the string representation of the given value, excluding the null terminator.</returns>
+    static inline size_t toShortestChars(char * oBuffer, size_t iSize, const float32 & iValue) { return printShortestChars(oBuffer, iSize, FLT_DIG+2, iValue); }
+    static inline size_t toShortestChars(char * oBuffer, size_t iSize, const float64 & iValue) { return printShortestChars(oBuffer, iSize, DBL_DIG, iValue); }
+
     /// <summary>
     /// Converts the given value of type T to a string representation.
     /// </summary>
@@ -60,6 +138,15 @@ namespace libVariant
       return s;
     }
 
+    /// <summary>
+    /// Returns the decimal point character used by the C library functions (snprintf(), strtod()) in the current locale.
+    /// </summary>
+    static inline char getLocaleDecimalPoint()
+    {
+      const char * decimalPoint = localeconv()->decimal_point;
+      return (decimalPoint != NULL && decimalPoint[0] != '\0' ? decimalPoint[0] : '.');
+    }
+
     /// <summary>
     /// Parses the given string value as a value of type T.
     /// </summary>
@@ -74,6 +161,164 @@ namespace libVariant
       inputStream >> t;
       return t;
     }
+
+    /// <summary>
+    /// Parses the given characters as a value of type T.
+    /// </summary>
+    /// <param name="iValue">The characters to convert to type T. The characters does not need to be null terminated.</param>
+    /// <param name="iLength">The number of characters of iValue.</param>
+    /// <returns>Returns a variable of type T which value is set to the given value.</returns>
+    template <typename T>
+    static T parse(const char * iValue, size_t iLength)
+    {
+      return parse<T>(std::string(iValue, iLength));
+    }
+
+  private:
+    /// <summary>
+    /// Writes the decimal digits of the given value backward, two digits at a time, ending at the given position.
+    /// </summary>
+    /// <returns>Returns a pointer to the first digit.</returns>
+    static inline char * writeDigits(char * iEnd, uint64 iValue)
+    {
+      static const char pairs[] =
+        "00010203040506070809"
+        "10111213141516171819"
+        "20212223242526272829"
+        "30313233343536373839"
+        "40414243444546474849"
+        "50515253545556575859"
+        "60616263646566676869"
+        "70717273747576777879"
+        "80818283848586878889"
+        "90919293949596979899";
+      char * first = iEnd;
+      while (iValue >= 100)
+      {
+        const char * pair = pairs + (iValue % 100) * 2;
+        iValue /= 100;
+        *(--first) = pair[1];
+        *(--first) = pair[0];
+      }
+      if (iValue >= 10)
+      {
+        const char * pair = pairs + iValue * 2;
+        *(--first) = pair[1];
+        *(--first) = pair[0];
+      }
+      else
+        *(--first) = static_cast<char>('0' + iValue);
+      return first;
+    }
+
+    static inline size_t copyChars(char * oBuffer, size_t iSize, const char * iFirst, const char * iEnd)
+    {
+      return copyChars(oBuffer, iSize, iFirst, static_cast<size_t>(iEnd - iFirst));
+    }
+
+    static inline size_t copyChars(char * oBuffer, size_t iSize, const char * iValue, size_t iLength)
+    {
+      if (iSize > 0)
+      {
+        size_t count = (iLength < iSize ? iLength : iSize - 1);
+        memcpy(oBuffer, iValue, count);
+        oBuffer[count] = '\0';
+      }
+      return iLength;
+    }
+
+    static inline size_t printChars(char * oBuffer, size_t iSize, int iPrecision, float64 iValue)
+    {
+      //printf's %g conversion matches std::ostream's default floating point notation.
+      //The value is printed to a local buffer first to replace the decimal point of the current C locale.
+      char printed[MAX_CHARS_SIZE];
+      int length = snprintf(printed, sizeof(printed), "%.*g", iPrecision, iValue);
+      size_t printedLength = (length < 0 ? 0 : static_cast<size_t>(length));
+      if (printedLength >= sizeof(printed))
+        printedLength = sizeof(printed) - 1;
+      char decimalPoint = getLocaleDecimalPoint();
+      if (decimalPoint != '.')
+      {
+        char * found = static_cast<char *>(memchr(printed, decimalPoint, printedLength));
+        if (found)
+          *found = '.';
+      }
+      return copyChars(oBuffer, iSize, printed, printedLength);
+    }
+
+    /// <summary>
+    /// Prints the shortest digits of a floating point value using printf's %g notation.
+    /// The exponent notation is used if the exponent is smaller than -4 or greater or equal to the given precision (or to the number of digits, if larger).
+    /// </summary>
+    template <typename T>
+    static inline size_t printShortestChars(char * oBuffer, size_t iSize, int iPrecision, T iValue)
+    {
+      //zero, infinity and nan are printed as usual
+      if (iValue == 0 || iValue != iValue || iValue > std::numeric_limits<T>::max() || iValue < -std::numeric_limits<T>::max())
+        return printChars(oBuffer, iSize, iPrecision, iValue);
+
+      char chars[MAX_CHARS_SIZE];
+      char * c = chars;
+      if (iValue < 0)
+      {
+        *c++ = '-';
+        iValue = -iValue;
+      }
+
+      char digits[Grisu::MAX_DIGITS];
+      int lastExponent = 0;
+      int length = static_cast<int>(Grisu::getDigits(iValue, digits, lastExponent));
+      int exponent = length + lastExponent - 1; //exponent of the first digit
+      int precision = (length > iPrecision ? length : iPrecision);
+
+      if (exponent < -4 || exponent >= precision)
+      {
+        //d.ddde+XX
+        *c++ = digits[0];
+        if (length > 1)
+        {
+          *c++ = '.';
+          memcpy(c, digits + 1, length - 1);
+          c += length - 1;
+        }
+        *c++ = 'e';
+        *c++ = (exponent < 0 ? '-' : '+');
+        uint32 absExponent = static_cast<uint32>(exponent < 0 ? -exponent : exponent);
+        if (absExponent >= 100)
+          *c++ = static_cast<char>('0' + absExponent / 100);
+        *c++ = static_cast<char>('0' + (absExponent / 10) % 10);
+        *c++ = static_cast<char>('0' + absExponent % 10);
+      }
+      else if (exponent < 0)
+      {
+        //0.000ddd
+        *c++ = '0';
+        *c++ = '.';
+        for(int i=-1; i>exponent; i--)
+          *c++ = '0';
+        memcpy(c, digits, length);
+        c += length;
+      }
+      else if (length <= exponent + 1)
+      {
+        //ddd000
+        memcpy(c, digits, length);
+        c += length;
+        for(int i=length; i<=exponent; i++)
+          *c++ = '0';
+      }
+      else
+      {
+        //ddd.ddd
+        memcpy(c, digits, exponent + 1);
+        c += exponent + 1;
+        *c++ = '.';
+        memcpy(c, digits + exponent + 1, length - exponent - 1);
+        c += length - exponent - 1;
+      }
+
+      return copyChars(oBuffer, iSize, chars, c);
+    }
   };
  
   //specializations must be inline according to https://stackoverflow.com/questions/4445654/multiple-definition-of-template-specialization-when-using-different-objects
@@ -81,55 +326,91 @@ namespace libVariant
   template<> inline
   std::string StringEncoder::toString<char>(const char & value)
   {
-    std::stringstream out;
-    out << (int)value;
-    std::string s;
-    s = out.str().c_str();
-    return s;
+    char buffer[MAX_CHARS_SIZE];
+    size_t length = toChars(buffer, sizeof(buffer), static_cast<sint32>(value));
+    return std::string(buffer, length);
   }
- 
+
   template<> inline
   std::string StringEncoder::toString<signed char>(const signed char & value)
   {
-    std::stringstream out;
-    out << (int)value;
-    std::string s;
-    s = out.str().c_str();
-    return s;
+    char buffer[MAX_CHARS_SIZE];
+    size_t length = toChars(buffer, sizeof(buffer), value);
+    return std::string(buffer, length);
   }
- 
+
   template<> inline
   std::string StringEncoder::toString<unsigned char>(const unsigned char & value)
   {
-    std::stringstream out;
-    out << (int)value;
-    std::string s;
-    s = out.str().c_str();
-    return s;
+    char buffer[MAX_CHARS_SIZE];
+    size_t length = toChars(buffer, sizeof(buffer), value);
+    return std::string(buffer, length);
   }
- 
+
   template<> inline
-  std::string StringEncoder::toString<float>(const float & t)
+  std::string StringEncoder::toString<short>(const short & value)
   {
-    std::stringstream out;
-    out.precision(FLT_DIG+2); //note that FLT_DIG is 6 but more digits can be squeezed out from a float32 using 8 digits
-    out << t;
-    std::string s;
-    s = out.str().c_str();
-    return s;
+    char buffer[MAX_CHARS_SIZE];
+    size_t length = toChars(buffer, sizeof(buffer), value);
+    return std::string(buffer, length);
   }
- 
+
   template<> inline
-  std::string StringEncoder::toString<double>(const double & t)
+  std::string StringEncoder::toString<unsigned short>(const unsigned short & value)
   {
-    std::stringstream out;
-    out.precision(DBL_DIG);
-    out << t;
-    std::string s;
-    s = out.str().c_str();
-    return s;
+    char buffer[MAX_CHARS_SIZE];
+    size_t length = toChars(buffer, sizeof(buffer), value);
+    return std::string(buffer, length);
   }
- 
+
+  template<> inline
+  std::string StringEncoder::toString<int>(const int & value)
+  {
+    char buffer[MAX_CHARS_SIZE];
+    size_t length = toChars(buffer, sizeof(buffer), value);
+    return std::string(buffer, length);
+  }
+
+  template<> inline
+  std::string StringEncoder::toString<unsigned int>(const unsigned int & value)
+  {
+    char buffer[MAX_CHARS_SIZE];
+    size_t length = toChars(buffer, sizeof(buffer), value);
+    return std::string(buffer, length);
+  }
+
+  template<> inline
+  std::string StringEncoder::toString<sint64>(const sint64 & value)
+  {
+    char buffer[MAX_CHARS_SIZE];
+    size_t length = toChars(buffer, sizeof(buffer), value);
+    return std::string(buffer, length);
+  }
+
+  template<> inline
+  std::string StringEncoder::toString<uint64>(const uint64 & value)
+  {
+    char buffer[MAX_CHARS_SIZE];
+    size_t length = toChars(buffer, sizeof(buffer), value);
+    return std::string(buffer, length);
+  }
+
+  template<> inline
+  std::string StringEncoder::toString<float>(const float & value)
+  {
+    char buffer[MAX_CHARS_SIZE];
+    size_t length = toChars(buffer, sizeof(buffer), value);
+    return std::string(buffer, length);
+  }
+
+  template<> inline
+  std::string StringEncoder::toString<double>(const double & value)
+  {
+    char buffer[MAX_CHARS_SIZE];
+    size_t length = toChars(buffer, sizeof(buffer), value);
+    return std::string(buffer, length);
+  }
+
   template<> inline
   std::string StringEncoder::toString<long double>(const long double & t)
   {
@@ -29,8 +29,14 @@
 //---------------
 // Include Files
 //---------------
+#include "libvariant/variant.h"
+#include "StringEncoder.h"
 #include <string>
-#include <algorithm> //std::transform
+#include <string.h> // strlen, memcpy, memcmp
+#include <stdio.h> // snprintf
+#include <stdlib.h> // strtof, strtod
+#include <ctype.h> // tolower
+#include <float.h> // FLT_DIG, DBL_DIG, FLT_MAX, DBL_MAX
 
 //-----------
 // Namespace
@@ -97,50 +103,6 @@ namespace libVariant
       oParseSucess = ( (Tin)( oParsedValue ) == iValue);
     }
 
-    /// <summary>
-    /// Parses a string value to a value of the given type.
-    /// The function is considered succesful if the parsed value can also be converted back to the same string value.
-    /// </summary>
-    /// <remarks>
-    /// For floating points values, the function is considered succesful if the floating point has a precision higher or equal as the original string value.
-    /// For example:
-    ///   iValue =      "0.416666666666667"
-    ///   oParsedValue = 0.41666666666666702
-    ///   must be considered as identical
-    /// </remarks>
-    /// <param name="iValue">The given string value input.</summary>
-    /// <param name="oParsedValue">The converted value (output).</summary>
-    /// <param name="oParseSucess">The return state (success) of the function. True if the conversion is succesful. False otherwise.</summary>
-    template <typename Tout>
-    inline void testStringParse(const Str & iValue, Tout & oParsedValue, bool & oParseSucess)
-    {
-      oParsedValue = StringEncoder::parse<Tout>( iValue );
-
-      //allowing the conversion as succesful if the floating point has a precision
-      //higher or equal as the original string value.
-      //ie:
-      //iValue =      "0.416666666666667"
-      //oParsedValue = 0.41666666666666702
-      //which should appear as identical
-      
-      //convert back to string
-      Str parsedStr = StringEncoder::toString( oParsedValue );
-
-      //try a perfect value match
-      oParseSucess = (parsedStr == iValue);
-
-      //try an almost perfect match
-      if (oParseSucess == false)
-      {
-        //truncate parsedStr to the length of iValue
-        Str truncatedStr = parsedStr.substr(0, iValue.size());
-
-        //is it identical now ?
-        oParseSucess = (truncatedStr == iValue);
-      }
-
-    }
-
     /// <summary>
     /// Parses a 32-bit floating point value to all C++ native type.
     /// </summary>
@@ -195,41 +157,214 @@ namespace libVariant
     /// Parsed values are stored in attributes named parsed_*.
     /// </remarks>
     /// <seealso cref="testFloatParse"/>
-    /// <seealso cref="testStringParse"/>
     void parse(const char * iValue)
     {
-      //remember the given value
-      Str strValue = iValue;
+      parse(iValue, strlen(iValue));
+    }
 
+    /// <summary>
+    /// Parses the given characters of a string value to all C++ native type.
+    /// The string is classified in a single pass. A value is considered succesfully parsed to a given type
+    /// if the parsed value can also be converted back to the same string value with StringEncoder::toString().
+    /// The result does not depend on Variant::getFloatFormattingPolicy(): simplified string values are cached and hashed.
+    /// </summary>
+    /// <remarks>
+    /// For floating points values, the function is considered succesful if the floating point has a precision higher or equal as the original string value.
+    /// For example:
+    ///   iValue =      "0.416666666666667"
+    ///   oParsedValue = 0.41666666666666702
+    ///   must be considered as identical
+    /// </remarks>
+    /// <param name="iValue">The given input characters. The characters does not need to be NULL terminated.</summary>
+    /// <param name="iLength">The number of characters of iValue.</summary>
+    void parse(const char * iValue, size_t iLength)
+    {
       //bool
+      if (equalsNoCase(iValue, iLength, "true", 4))
       {
-        Str uppercaseValue = iValue;
-        std::transform(uppercaseValue.begin(), uppercaseValue.end(), uppercaseValue.begin(), ::toupper);
+        is_Boolean = true;
+        parsed_boolean = true;
+        return;
+      }
+      else if (equalsNoCase(iValue, iLength, "false", 5))
+      {
+        is_Boolean = true;
+        parsed_boolean = false;
+        return;
+      }
 
-        if (uppercaseValue == "TRUE")
-        {
-          is_Boolean = true;
-          parsed_boolean = true;
-        }
-        else if (uppercaseValue == "FALSE")
+      //integers: an optional minus sign followed by decimal digits without any leading zero.
+      const char * digits = iValue;
+      const char * end = iValue + iLength;
+      bool negative = (iLength > 0 && iValue[0] == '-');
+      if (negative)
+        digits++;
+      bool integer = (digits < end) && (digits[0] != '0' || (digits + 1 == end && !negative));
+      bool overflow = false;
+      uint64 magnitude = 0;
+      for(const char * c = digits; integer && c < end; c++)
+      {
+        uint8 digit = static_cast<uint8>(*c - '0');
+        if (digit > 9)
+          integer = false;
+        else if (magnitude > (uint64_max - digit) / 10)
+          overflow = true;
+        else if (!overflow)
+          magnitude = magnitude*10 + digit;
+      }
+
+      if (iLength == 0)
+      {
+        //an empty string is a truncated "0"
+        setInteger(false, 0);
+        is_Float32 = true;
+        is_Float64 = true;
+        return;
+      }
+
+      if (integer && !overflow)
+      {
+        setInteger(negative, magnitude);
+
+        //all integers up to 8 (or 15) digits are printed without exponent
+        if (magnitude < 100000000ull && static_cast<uint64>(static_cast<float32>(magnitude)) == magnitude)
         {
-          is_Boolean = true;
-          parsed_boolean = false;
+          parsed_float32 = static_cast<float32>(magnitude);
+          parsed_float64 = static_cast<float64>(magnitude);
+          if (negative)
+          {
+            parsed_float32 = -parsed_float32;
+            parsed_float64 = -parsed_float64;
+          }
+          is_Float32 = true;
+          is_Float64 = true;
+          return;
         }
       }
 
-      testStringParse<uint8    >(strValue, parsed_uint8  , is_UInt8  );
-      testStringParse<sint8    >(strValue, parsed_sint8  , is_SInt8  );
-      testStringParse<uint16   >(strValue, parsed_uint16 , is_UInt16 );
-      testStringParse<sint16   >(strValue, parsed_sint16 , is_SInt16 );
-      testStringParse<uint32   >(strValue, parsed_uint32 , is_UInt32 );
-      testStringParse<sint32   >(strValue, parsed_sint32 , is_SInt32 );
-      testStringParse<uint64   >(strValue, parsed_uint64 , is_UInt64 );
-      testStringParse<sint64   >(strValue, parsed_sint64 , is_SInt64 );
-      testStringParse<float32  >(strValue, parsed_float32, is_Float32);
-      testStringParse<float64  >(strValue, parsed_float64, is_Float64);
+      if (isFloatCandidate(iValue, iLength))
+      {
+        //copy the value to a NULL terminated buffer
+        char value[FLOAT_BUFFER_SIZE];
+        memcpy(value, iValue, iLength);
+        value[iLength] = '\0';
+
+        //strtof() and strtod() expect the decimal point of the current C locale
+        char localized[FLOAT_BUFFER_SIZE];
+        memcpy(localized, value, iLength + 1);
+        replaceChar(localized, iLength, '.', StringEncoder::getLocaleDecimalPoint());
+
+        //out of range values are clamped to the largest finite value like StringEncoder::parse() does
+        parsed_float32 = strtof(localized, NULL);
+        if (parsed_float32 > FLT_MAX || parsed_float32 < -FLT_MAX)
+          parsed_float32 = (parsed_float32 > 0 ? FLT_MAX : -FLT_MAX);
+        is_Float32 = isFloatPrefix(value, iLength, FLT_DIG+2, parsed_float32);
+
+        parsed_float64 = strtod(localized, NULL);
+        if (parsed_float64 > DBL_MAX || parsed_float64 < -DBL_MAX)
+          parsed_float64 = (parsed_float64 > 0 ? DBL_MAX : -DBL_MAX);
+        is_Float64 = isFloatPrefix(value, iLength, DBL_DIG, parsed_float64);
+      }
+    }
+
+  private:
+    static const uint64 uint64_max = 0xFFFFFFFFFFFFFFFFull;
+    static const size_t FLOAT_BUFFER_SIZE = 32;
+
+    static inline bool equalsNoCase(const char * iValue, size_t iLength, const char * iLowercase, size_t iLowercaseLength)
+    {
+      if (iLength != iLowercaseLength)
+        return false;
+      for(size_t i=0; i<iLength; i++)
+      {
+        if (tolower(static_cast<unsigned char>(iValue[i])) != iLowercase[i])
+          return false;
+      }
+      return true;
+    }
+
+    static inline void replaceChar(char * iValue, size_t iLength, char iOld, char iNew)
+    {
+      if (iOld == iNew)
+        return;
+      for(size_t i=0; i<iLength; i++)
+      {
+        if (iValue[i] == iOld)
+          iValue[i] = iNew;
+      }
+    }
+
+    /// <summary>
+    /// Sets all integer types which can hold the given value.
+    /// </summary>
+    inline void setInteger(bool iNegative, uint64 iMagnitude)
+    {
+      if (iNegative)
+      {
+        uint64 value = (~iMagnitude) + 1; //two's complement
+        parsed_sint8  = static_cast<sint8 >(value);
+        parsed_sint16 = static_cast<sint16>(value);
+        parsed_sint32 = static_cast<sint32>(value);
+        parsed_sint64 = static_cast<sint64>(value);
+        is_SInt8  = (iMagnitude <= 0x80ull);
+        is_SInt16 = (iMagnitude <= 0x8000ull);
+        is_SInt32 = (iMagnitude <= 0x80000000ull);
+        is_SInt64 = (iMagnitude <= 0x8000000000000000ull);
+        return;
+      }
+
+      parsed_uint8  = static_cast<uint8 >(iMagnitude);
+      parsed_uint16 = static_cast<uint16>(iMagnitude);
+      parsed_uint32 = static_cast<uint32>(iMagnitude);
+      parsed_uint64 = iMagnitude;
+      parsed_sint8  = static_cast<sint8 >(iMagnitude);
+      parsed_sint16 = static_cast<sint16>(iMagnitude);
+      parsed_sint32 = static_cast<sint32>(iMagnitude);
+      parsed_sint64 = static_cast<sint64>(iMagnitude);
+      is_UInt8  = (iMagnitude <= 0xFFull);
+      is_UInt16 = (iMagnitude <= 0xFFFFull);
+      is_UInt32 = (iMagnitude <= 0xFFFFFFFFull);
+      is_UInt64 = true;
+      is_SInt8  = (iMagnitude <= 0x7Full);
+      is_SInt16 = (iMagnitude <= 0x7FFFull);
+      is_SInt32 = (iMagnitude <= 0x7FFFFFFFull);
+      is_SInt64 = (iMagnitude <= 0x7FFFFFFFFFFFFFFFull);
     }
 
+    /// <summary>
+    /// Returns true if the given string could be the beginning of a floating point value printed by StringEncoder::toString().
+    /// Printed values starts with a minus sign or a digit and only contains digits, decimal points, exponents and signs.
+    /// </summary>
+    static inline bool isFloatCandidate(const char * iValue, size_t iLength)
+    {
+      if (iLength == 0 || iLength >= FLOAT_BUFFER_SIZE)
+        return false;
+      if (iValue[0] != '-' && (iValue[0] < '0' || iValue[0] > '9'))
+        return false;
+      for(size_t i=1; i<iLength; i++)
+      {
+        char c = iValue[i];
+        if ((c < '0' || c > '9') && c != '.' && c != 'e' && c != '+' && c != '-')
+          return false;
+      }
+      return true;
+    }
+
+    /// <summary>
+    /// Returns true if the given string is identical or the beginning of the given value printed with the given precision.
+    /// The value is printed the same way as StringEncoder::toString() does.
+    /// </summary>
+    static inline bool isFloatPrefix(const char * iValue, size_t iLength, int iPrecision, float64 iParsedValue)
+    {
+      char printed[FLOAT_BUFFER_SIZE];
+      int printedLength = snprintf(printed, sizeof(printed), "%.*g", iPrecision, iParsedValue);
+      if (printedLength < 0 || static_cast<size_t>(printedLength) < iLength || static_cast<size_t>(printedLength) >= sizeof(printed))
+        return false;
+      replaceChar(printed, static_cast<size_t>(printedLength), StringEncoder::getLocaleDecimalPoint(), '.');
+      return memcmp(printed, iValue, iLength) == 0;
+    }
+
+  public:
     //parsed results
     bool     parsed_boolean;
     uint8    parsed_uint8  ;
@@ -258,6 +393,30 @@ namespace libVariant
  
   //specializations
  
+  /// <summary>
+  /// Identifies the narrowest native format found by a StringParser.
+  /// Formats are tested in the same order as Variant::simplify().
+  /// </summary>
+  /// <param name="iParser">The parser results.</param>
+  /// <param name="oFormat">The narrowest format (output).</param>
+  /// <param name="oValue">The value matching the narrowest format (output).</param>
+  /// <returns>Returns true if the parsed value can be simplified. Returns false otherwise.</returns>
+  inline bool getNarrowestFormat(const StringParser & iParser, Variant::VariantFormat & oFormat, Variant::VariantUnion & oValue)
+  {
+    oValue.as_bits = 0;
+    if (iParser.is_Boolean) { oFormat = Variant::BOOL;    oValue.as_uint64  = iParser.parsed_boolean; return true; }
+    if (iParser.is_SInt8  ) { oFormat = Variant::SINT8;   oValue.as_sint64  = iParser.parsed_sint8  ; return true; }
+    if (iParser.is_UInt8  ) { oFormat = Variant::UINT8;   oValue.as_uint64  = iParser.parsed_uint8  ; return true; }
+    if (iParser.is_SInt16 ) { oFormat = Variant::SINT16;  oValue.as_sint64  = iParser.parsed_sint16 ; return true; }
+    if (iParser.is_UInt16 ) { oFormat = Variant::UINT16;  oValue.as_uint64  = iParser.parsed_uint16 ; return true; }
+    if (iParser.is_SInt32 ) { oFormat = Variant::SINT32;  oValue.as_sint64  = iParser.parsed_sint32 ; return true; }
+    if (iParser.is_UInt32 ) { oFormat = Variant::UINT32;  oValue.as_uint64  = iParser.parsed_uint32 ; return true; }
+    if (iParser.is_SInt64 ) { oFormat = Variant::SINT64;  oValue.as_sint64  = iParser.parsed_sint64 ; return true; }
+    if (iParser.is_UInt64 ) { oFormat = Variant::UINT64;  oValue.as_uint64  = iParser.parsed_uint64 ; return true; }
+    if (iParser.is_Float32) { oFormat = Variant::FLOAT32; oValue.as_float32 = iParser.parsed_float32; return true; }
+    if (iParser.is_Float64) { oFormat = Variant::FLOAT64; oValue.as_float64 = iParser.parsed_float64; return true; }
+    return false; //no simplication available
+  }
 
 } // End namespace
 
@@ -0,0 +1,223 @@
+/**********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2018 Antoine Beauchamp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+
+//---------------
+// Include Files
+//---------------
+#include "libvariant/thread_pool.h"
+
+#include <assert.h>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//-----------
+// Namespace
+//-----------
+
+namespace libVariant
+{
+  //pool whose tasks are processed by the calling thread
+  static thread_local ThreadPool * gCurrentPool = NULL;
+
+  struct ThreadPool::State
+  {
+    State() : task(NULL), count(0), next(0), generation(0), busyWorkers(0), stopping(false) {}
+
+    /// <summary>
+    /// Processes the tasks of the current loop until all tasks are started.
+    /// </summary>
+    void processTasks()
+    {
+      for(;;)
+      {
+        const size_t index = next.fetch_add(1);
+        if (index >= count)
+          return;
+        try
+        {
+          (*task)(index);
+        }
+        catch(...)
+        {
+          std::lock_guard<std::mutex> lock(mutex);
+          if (!exception)
+            exception = std::current_exception();
+        }
+      }
+    }
+
+    std::vector<std::thread> threads;
+    std::mutex loopMutex;               //serializes the loops of different callers
+    std::mutex mutex;                   //protects the following attributes
+    std::condition_variable wakeUp;     //signaled when a loop starts or when the pool stops
+    std::condition_variable finished;   //signaled when the last worker completes a loop
+    const std::function<void(size_t)> * task;
+    size_t count;
+    std::atomic<size_t> next;           //index of the next task to process
+    size_t generation;                  //incremented for each loop
+    size_t busyWorkers;                 //number of workers which did not complete the current loop
+    std::exception_ptr exception;       //first exception thrown by a task of the current loop
+    bool stopping;
+  };
+
+  ThreadPool::ThreadPool() : mState(new State())
+  {
+    start(0);
+  }
+
+  ThreadPool::ThreadPool(size_t iNumThreads) : mState(new State())
+  {
+    start(iNumThreads);
+  }
+
+  ThreadPool::~ThreadPool()
+  {
+    {
+      std::lock_guard<std::mutex> loopLock(mState->loopMutex);
+      std::lock_guard<std::mutex> lock(mState->mutex);
+      mState->stopping = true;
+    }
+    mState->wakeUp.notify_all();
+    for(size_t i=0; i<mState->threads.size(); i++)
+      mState->threads[i].join();
+    delete mState;
+  }
+
+  //----------------
+  // public methods
+  //----------------
+  size_t ThreadPool::getNumThreads() const
+  {
+    return mState->threads.size() + 1;
+  }
+
+  void ThreadPool::parallelFor(size_t iCount, const std::function<void(size_t)> & iTask)
+  {
+    if (iCount == 0)
+      return;
+
+    if (mState->threads.empty() || iCount == 1 || gCurrentPool == this)
+    {
+      //process all tasks on the calling thread with the same rules
+      std::exception_ptr exception;
+      for(size_t i=0; i<iCount; i++)
+      {
+        try
+        {
+          iTask(i);
+        }
+        catch(...)
+        {
+          if (!exception)
+            exception = std::current_exception();
+        }
+      }
+      if (exception)
+        std::rethrow_exception(exception);
+      return;
+    }
+
+    std::lock_guard<std::mutex> loopLock(mState->loopMutex);
+    {
+      std::lock_guard<std::mutex> lock(mState->mutex);
+      mState->task = &iTask;
+      mState->count = iCount;
+      mState->next.store(0);
+      mState->busyWorkers = mState->threads.size();
+      mState->generation++;
+    }
+    mState->wakeUp.notify_all();
+
+    //help the workers
+    ThreadPool * previous = gCurrentPool;
+    gCurrentPool = this;
+    mState->processTasks();
+    gCurrentPool = previous;
+
+    std::exception_ptr exception;
+    {
+      std::unique_lock<std::mutex> lock(mState->mutex);
+      while(mState->busyWorkers > 0)
+        mState->finished.wait(lock);
+      mState->task = NULL;
+      exception = mState->exception;
+      mState->exception = std::exception_ptr();
+    }
+    if (exception)
+      std::rethrow_exception(exception);
+  }
+
+  ThreadPool & ThreadPool::getDefault()
+  {
+    static ThreadPool gDefaultPool;
+    return gDefaultPool;
+  }
+
+  //-----------------
+  // private methods
+  //-----------------
+  void ThreadPool::start(size_t iNumThreads)
+  {
+    size_t numThreads = iNumThreads;
+    if (numThreads == 0)
+      numThreads = std::thread::hardware_concurrency();
+    if (numThreads == 0)
+      numThreads = 1; //unknown hardware
+
+    //the calling thread of parallelFor() is also processing tasks
+    for(size_t i=1; i<numThreads; i++)
+      mState->threads.push_back(std::thread(&ThreadPool::processTasks, this));
+  }
+
+  void ThreadPool::processTasks()
+  {
+    gCurrentPool = this;
+
+    size_t generation = 0;
+    std::unique_lock<std::mutex> lock(mState->mutex);
+    for(;;)
+    {
+      while(!mState->stopping && mState->generation == generation)
+        mState->wakeUp.wait(lock);
+      if (mState->stopping)
+        return;
+      generation = mState->generation;
+
+      lock.unlock();
+      mState->processTasks();
+      lock.lock();
+
+      assert( mState->busyWorkers > 0 );
+      mState->busyWorkers--;
+      if (mState->busyWorkers == 0)
+        mState->finished.notify_one();
+    }
+  }
+
+} // End of namespace
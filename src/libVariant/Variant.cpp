@@ -27,11 +27,15 @@
 // Include Files
 //---------------
 #include "libvariant/variant.h"
+#include "libvariant/allocator.h"
 #include "StringEncoder.h"
 #include "StringParser.h"
 
 #include <assert.h>
+#include <new> // placement new
+#include <string.h> // memcpy, memmove, memcmp, strlen
 #include <limits> // std::numeric_limits
+#include <math.h> // floor
 #include <sstream>
 
 //-----------
@@ -43,6 +47,67 @@ namespace libVariant
   typedef int DEFAULT_BOOLEAN_REDIRECTION_TYPE; //default type to use for conversion and comparision when dealing with 'bool' native type.
 
   Variant::DivisionByZeroPolicy Variant::mDivisionByZeroPolicy = DEFAULT_DIVISION_BY_ZERO_POLICY;
+  Variant::FloatFormattingPolicy Variant::mFloatFormattingPolicy = DEFAULT_FLOAT_FORMATTING_POLICY;
+  /// <summary>
+  /// The characters of a SharedString are stored in the same buffer, right after the header.
+  /// The buffer is allocated by the current Allocator of the thread and released by the same allocator.
+  /// </summary>
+  struct Variant::SharedString
+  {
+    /// <summary>
+    /// Creates a new SharedString with the given characters and room for at least iCapacity characters.
+    /// </summary>
+    static SharedString * create(const char * iValue, size_t iLength, size_t iCapacity)
+    {
+      if (iCapacity < iLength)
+        iCapacity = iLength;
+      Allocator & allocator = Allocator::getCurrent();
+      void * buffer = allocator.allocate(sizeof(SharedString) + iCapacity);
+      SharedString * str = new (buffer) SharedString();
+      str->references.store(1, std::memory_order_relaxed);
+      str->allocator = &allocator;
+      str->length = iLength;
+      str->capacity = iCapacity;
+      memcpy(str->characters, iValue, iLength);
+      str->characters[iLength] = '\0';
+      return str;
+    }
+
+    /// <summary>
+    /// Shares the given string if it was allocated by the current allocator.
+    /// Otherwise, the characters are copied with the current allocator: the copy must not depend on the lifetime of an other allocator.
+    /// </summary>
+    static SharedString * acquire(SharedString * iString)
+    {
+      if (iString->allocator != &Allocator::getCurrent())
+        return create(iString->characters, iString->length, iString->length);
+      iString->references.fetch_add(1, std::memory_order_relaxed);
+      return iString;
+    }
+
+    static void release(SharedString * iString)
+    {
+      if (iString->references.fetch_sub(1, std::memory_order_acq_rel) == 1)
+      {
+        Allocator * allocator = iString->allocator;
+        size_t size = sizeof(SharedString) + iString->capacity;
+        iString->~SharedString();
+        allocator->deallocate(iString, size);
+      }
+    }
+
+    bool isUnique() const
+    {
+      return references.load(std::memory_order_acquire) == 1;
+    }
+
+    std::atomic<uint32> references;
+    Allocator * allocator;
+    size_t length;
+    size_t capacity;
+    char characters[1]; //null terminated. The buffer holds capacity+1 characters.
+  };
+
   const char * gStringTrue  = "true";
   const char * gStringFalse = "false";
 
@@ -160,11 +225,11 @@ namespace libVariant
   }
 
   template <typename T>
-  inline static const T staticCastConversion( const Variant::VariantFormat & iFormat, const Variant::VariantUnion & iData, const T & iDefault )
+  inline static const T staticCastConversion( const Variant::VariantFormat & iFormat, const Variant::VariantUnion & iData, const char * iString, size_t iLength, const T & iDefault )
   {
     if (iFormat == Variant::STRING)
     {
-      return StringEncoder::parse<T>( iData.as_str->c_str() );
+      return StringEncoder::parse<T>( iString, iLength );
     }
     else if (iFormat == Variant::FLOAT32)
     {
@@ -182,6 +247,7 @@ namespace libVariant
   Variant::Variant(void) : mFormat(Variant::UINT8) { clear(); }
 
   Variant::Variant(const Variant    & iValue) : mFormat(Variant::UINT8) { clear(); (*this) = iValue; }
+  Variant::Variant(Variant         && iValue) noexcept : mFormat(Variant::UINT8) { clear(); swap(iValue); }
   Variant::Variant(const bool       & iValue) : mFormat(Variant::UINT8) { clear(); (*this) = iValue; }
   Variant::Variant(const uint8      & iValue) : mFormat(Variant::UINT8) { clear(); (*this) = iValue; }
   Variant::Variant(const sint8      & iValue) : mFormat(Variant::UINT8) { clear(); (*this) = iValue; }
@@ -211,6 +277,16 @@ namespace libVariant
     return mDivisionByZeroPolicy;
   }
 
+  void Variant::setFloatFormattingPolicy(FloatFormattingPolicy iFloatFormattingPolicy)
+  {
+    mFloatFormattingPolicy = iFloatFormattingPolicy;
+  }
+
+  Variant::FloatFormattingPolicy Variant::getFloatFormattingPolicy()
+  {
+    return mFloatFormattingPolicy;
+  }
+
   bool Variant::isNativelyComparable(const VariantFormat & iFormat1, const VariantFormat & iFormat2)
   {
     if (iFormat1 == Variant::STRING && iFormat2 == Variant::STRING)
@@ -224,18 +300,46 @@ namespace libVariant
     return true;
   }
 
+  void Variant::swap(Variant & iValue) noexcept
+  {
+    if (this == &iValue)
+      return;
+
+    VariantFormat format = mFormat;
+    mFormat = iValue.mFormat;
+    iValue.mFormat = format;
+
+    uint8 storage = mStringStorage;
+    mStringStorage = iValue.mStringStorage;
+    iValue.mStringStorage = storage;
+
+    uint8 length = mInlineLength;
+    mInlineLength = iValue.mInlineLength;
+    iValue.mInlineLength = length;
+
+    uint8 simplified = mSimplifiedFormat.load(std::memory_order_relaxed);
+    mSimplifiedFormat.store(iValue.mSimplifiedFormat.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    iValue.mSimplifiedFormat.store(simplified, std::memory_order_relaxed);
+
+    //exchange the whole storage. This also exchanges heap string pointers.
+    char buffer[sizeof(mInlineString)];
+    memcpy(buffer, mInlineString, sizeof(mInlineString));
+    memcpy(mInlineString, iValue.mInlineString, sizeof(mInlineString));
+    memcpy(iValue.mInlineString, buffer, sizeof(mInlineString));
+  }
+
   bool      Variant::getBool   () const
   {
     if (mFormat == Variant::STRING)
     {
       //look for hardcoded string values
-      StringParser p;
-      p.parse(mData.as_str->c_str());
-      if (p.is_Boolean)
-        return p.parsed_boolean;
+      VariantFormat simplifiedFormat;
+      VariantUnion simplifiedValue;
+      if (getSimplifiedValue(simplifiedFormat, simplifiedValue) && simplifiedFormat == Variant::BOOL)
+        return simplifiedValue.as_uint8 != 0;
 
       //might be 0, 1, or any other value
-      return StringEncoder::parse<uint8  >( mData.as_str->c_str() ) != 0;
+      return StringEncoder::parse<uint8  >( getStringBuffer(), getStringLength() ) != 0;
     }
     else if (mFormat == Variant::FLOAT32)
     {
@@ -247,47 +351,47 @@ namespace libVariant
     }
 
     //signed or unsigned integer
-    return mData.as_bool; //possible overflow
+    return mData.as_uint8 != 0; //possible overflow. Read as uint8 since any non-zero byte is not a valid bool value.
   }
 
   uint8       Variant::getUInt8  () const
   {
-    return staticCastConversion<uint8  >(mFormat, mData, mData.as_uint8);
+    return staticCastConversion<uint8  >(mFormat, mData, getStringBuffer(), getStringLength(), mData.as_uint8);
   }
 
   sint8      Variant::getSInt8  () const
   {
-    return staticCastConversion<sint8 >(mFormat, mData, mData.as_sint8);
+    return staticCastConversion<sint8 >(mFormat, mData, getStringBuffer(), getStringLength(), mData.as_sint8);
   }
 
   uint16      Variant::getUInt16 () const
   {
-    return staticCastConversion<uint16  >(mFormat, mData, mData.as_uint16);
+    return staticCastConversion<uint16  >(mFormat, mData, getStringBuffer(), getStringLength(), mData.as_uint16);
   }
 
   sint16     Variant::getSInt16 () const
   {
-    return staticCastConversion<sint16 >(mFormat, mData, mData.as_sint16);
+    return staticCastConversion<sint16 >(mFormat, mData, getStringBuffer(), getStringLength(), mData.as_sint16);
   }
 
   uint32      Variant::getUInt32 () const
   {
-    return staticCastConversion<uint32  >(mFormat, mData, mData.as_uint32);
+    return staticCastConversion<uint32  >(mFormat, mData, getStringBuffer(), getStringLength(), mData.as_uint32);
   }
 
   sint32     Variant::getSInt32 () const
   {
-    return staticCastConversion<sint32 >(mFormat, mData, mData.as_sint32);
+    return staticCastConversion<sint32 >(mFormat, mData, getStringBuffer(), getStringLength(), mData.as_sint32);
   }
 
   uint64      Variant::getUInt64 () const
   {
-    return staticCastConversion<uint64  >(mFormat, mData, mData.as_uint64);
+    return staticCastConversion<uint64  >(mFormat, mData, getStringBuffer(), getStringLength(), mData.as_uint64);
   }
 
   sint64     Variant::getSInt64 () const
   {
-    return staticCastConversion<sint64 >(mFormat, mData, mData.as_sint64);
+    return staticCastConversion<sint64 >(mFormat, mData, getStringBuffer(), getStringLength(), mData.as_sint64);
   }
 
   float32   Variant::getFloat32() const
@@ -321,7 +425,7 @@ namespace libVariant
     case Variant::FLOAT64:
       return mData.as_float64;
     case Variant::STRING:
-      return StringEncoder::parse<float32>( mData.as_str->c_str() );
+      return StringEncoder::parse<float32>( getStringBuffer(), getStringLength() );
     default:
       assert( false ); /*error should not happen*/
       break;
@@ -363,7 +467,7 @@ namespace libVariant
     case Variant::FLOAT64:
       return mData.as_float64;
     case Variant::STRING:
-      return StringEncoder::parse<float64>( mData.as_str->c_str() );
+      return StringEncoder::parse<float64>( getStringBuffer(), getStringLength() );
     default:
       assert( false ); /*error should not happen*/
       break;
@@ -375,33 +479,58 @@ namespace libVariant
   }
 
   Str Variant::getString () const
+  {
+    if (mFormat == Variant::STRING)
+      return Str(getStringBuffer(), getStringLength());
+
+    char buffer[NATIVE_STRING_BUFFER_SIZE];
+    getString(buffer, sizeof(buffer));
+    return Str(buffer);
+  }
+
+  size_t Variant::getString(char * oBuffer, size_t iSize) const
   {
     switch(mFormat)
     {
     case Variant::BOOL:
-      return (mData.as_uint64 == 0 ? Str(gStringFalse) : Str(gStringTrue));
+      return StringEncoder::toChars(oBuffer, iSize, mData.as_uint64 != 0);
     case Variant::UINT8:
     case Variant::UINT16:
     case Variant::UINT32:
     case Variant::UINT64:
-      return StringEncoder::toString( mData.as_uint64 ).c_str();
+      return StringEncoder::toChars(oBuffer, iSize, mData.as_uint64);
     case Variant::SINT8:
     case Variant::SINT16:
     case Variant::SINT32:
     case Variant::SINT64:
-      return StringEncoder::toString( mData.as_sint64 ).c_str();
+      return StringEncoder::toChars(oBuffer, iSize, mData.as_sint64);
     case Variant::FLOAT32:
-      return StringEncoder::toString( mData.as_float32 ).c_str();
+      if (mFloatFormattingPolicy == SHORTEST_ROUND_TRIP)
+        return StringEncoder::toShortestChars(oBuffer, iSize, mData.as_float32);
+      return StringEncoder::toChars(oBuffer, iSize, mData.as_float32);
     case Variant::FLOAT64:
-      return StringEncoder::toString( mData.as_float64 ).c_str();
+      if (mFloatFormattingPolicy == SHORTEST_ROUND_TRIP)
+        return StringEncoder::toShortestChars(oBuffer, iSize, mData.as_float64);
+      return StringEncoder::toChars(oBuffer, iSize, mData.as_float64);
     case Variant::STRING:
-      return (*mData.as_str);
+      {
+        size_t length = getStringLength();
+        if (iSize > 0)
+        {
+          size_t count = (length < iSize ? length : iSize - 1);
+          memcpy(oBuffer, getStringBuffer(), count);
+          oBuffer[count] = '\0';
+        }
+        return length;
+      }
     default:
       assert( false ); /*error should not happen*/
       break;
     };
     assert( false ); /*error should not happen*/
-    return Str();
+    if (iSize > 0)
+      oBuffer[0] = '\0';
+    return 0;
   }
 
   void Variant::setBool   (const bool      & iValue)
@@ -497,9 +626,7 @@ namespace libVariant
     }
 
     //plain text format
-    stringnify();
-    mFormat = Variant::STRING;
-    (*mData.as_str) = iValue;
+    assignString(iValue);
   }
 
   const Variant::VariantFormat & Variant::getFormat() const
@@ -599,12 +726,57 @@ namespace libVariant
     };
     return false;
   }
+
+  void Variant::setStringView(const char * iValue, size_t iLength)
+  {
+    clear();
+    mFormat = Variant::STRING;
+    mStringStorage = STRING_VIEW;
+    mStringView.buffer = (iValue == NULL ? "" : iValue);
+    mStringView.length = (iValue == NULL ? 0 : iLength);
+  }
+
+  bool Variant::isStringView() const
+  {
+    return (mFormat == Variant::STRING && mStringStorage == STRING_VIEW);
+  }
+
+  void Variant::materialize()
+  {
+    if (!isStringView())
+      return;
+
+    StringView view = mStringView; //overwritten by the inline characters
+    if (view.length <= INLINE_STRING_CAPACITY)
+    {
+      memcpy(mInlineString, view.buffer, view.length);
+      mInlineString[view.length] = '\0';
+      mInlineLength = static_cast<uint8>(view.length);
+      mStringStorage = STRING_INLINE;
+    }
+    else
+    {
+      mSharedString = SharedString::create(view.buffer, view.length, view.length);
+      mStringStorage = STRING_SHARED;
+    }
+    mSimplifiedFormat.store(SIMPLIFIED_UNKNOWN, std::memory_order_relaxed);
+  }
   
   //-----------
   // operators
   //-----------
   const Variant & Variant::operator = (const Variant & iValue)
   {
+    if (this == &iValue)
+      return (*this);
+
+    if (iValue.mFormat == Variant::STRING && iValue.mStringStorage == STRING_HEAP)
+    {
+      assignString(iValue.getStringBuffer());
+      copySimplifiedValue(iValue);
+      return (*this);
+    }
+
     clear();
 
     switch(iValue.mFormat)
@@ -624,9 +796,18 @@ namespace libVariant
       mData.as_bits = iValue.mData.as_bits;
       break;
     case Variant::STRING:
-      stringnify();
+      //inline string, string view or shared string. Copy the characters (or the view) without allocating memory
+      //unless the shared string was allocated by an other allocator than the current one
       mFormat = iValue.mFormat;
-      (*mData.as_str) = (*iValue.mData.as_str); //copy constructor
+      mStringStorage = iValue.mStringStorage;
+      mInlineLength = iValue.mInlineLength;
+      if (mStringStorage == STRING_VIEW)
+        mStringView = iValue.mStringView;
+      else if (mStringStorage == STRING_SHARED)
+        mSharedString = SharedString::acquire(iValue.mSharedString);
+      else
+        memcpy(mInlineString, iValue.mInlineString, iValue.mInlineLength + 1);
+      copySimplifiedValue(iValue);
       break;
     default:
       assert( false ); /*error should not happen*/
@@ -636,6 +817,16 @@ namespace libVariant
     return (*this);
   }
 
+  const Variant & Variant::operator = (Variant && iValue) noexcept
+  {
+    if (this != &iValue)
+    {
+      clear();
+      swap(iValue); //iValue is left cleared
+    }
+    return (*this);
+  }
+
   // compare(...)
 #if 1 
   template <typename T>
@@ -676,13 +867,15 @@ namespace libVariant
     #pragma warning(pop)
   }
 
-  inline int compareStrings(const Str & iLocalValue, const Str & iRemoteValue)
+  inline int compareStrings(const char * iLocalValue, size_t iLocalLength, const char * iRemoteValue, size_t iRemoteLength)
   {
-    if (iLocalValue < iRemoteValue)
+    //memcmp() compares characters as unsigned char which matches Str's operator < and operator >
+    int result = memcmp(iLocalValue, iRemoteValue, (iLocalLength < iRemoteLength ? iLocalLength : iRemoteLength));
+    if (result < 0 || (result == 0 && iLocalLength < iRemoteLength))
     {
       return -1;
     }
-    else if (iLocalValue > iRemoteValue)
+    else if (result > 0 || (result == 0 && iLocalLength > iRemoteLength))
     {
       return +1;
     }
@@ -747,17 +940,20 @@ namespace libVariant
     //can't be compared using native C++ types
     
     //try to simplify this Variant's string value to a native type
-    Variant thisCopy(*this);
-    if (thisCopy.simplify())
+    VariantFormat simplifiedFormat;
+    VariantUnion simplifiedValue;
+    if (getSimplifiedValue(simplifiedFormat, simplifiedValue))
     {
-      //thisCopy is now a basic/native type
-      if (hasNativeCompare(thisCopy.mFormat, thisCopy.mData, result, static_cast<DEFAULT_BOOLEAN_REDIRECTION_TYPE>(iValue)))
+      //the string value has a basic/native representation
+      if (hasNativeCompare(simplifiedFormat, simplifiedValue, result, static_cast<DEFAULT_BOOLEAN_REDIRECTION_TYPE>(iValue)))
         return result;
     }
 
     //current Variant's value is an unsimplifiable string
     assert( mFormat == Variant::STRING );
-    return compareStrings( (*mData.as_str), Variant(iValue).getString() );
+    char buffer[NATIVE_STRING_BUFFER_SIZE];
+    size_t length = Variant(iValue).getString(buffer, sizeof(buffer));
+    return compareStrings( getStringBuffer(), getStringLength(), buffer, length );
   }
 
   int Variant::compare(const uint8          & iValue) const
@@ -769,17 +965,20 @@ namespace libVariant
     //can't be compared using native C++ types
     
     //try to simplify this Variant's string value to a native type
-    Variant thisCopy(*this);
-    if (thisCopy.simplify())
+    VariantFormat simplifiedFormat;
+    VariantUnion simplifiedValue;
+    if (getSimplifiedValue(simplifiedFormat, simplifiedValue))
     {
-      //thisCopy is now a basic/native type
-      if (hasNativeCompare(thisCopy.mFormat, thisCopy.mData, result, iValue))
+      //the string value has a basic/native representation
+      if (hasNativeCompare(simplifiedFormat, simplifiedValue, result, iValue))
         return result;
     }
 
     //current Variant's value is an unsimplifiable string
     assert( mFormat == Variant::STRING );
-    return compareStrings( (*mData.as_str), Variant(iValue).getString() );
+    char buffer[NATIVE_STRING_BUFFER_SIZE];
+    size_t length = Variant(iValue).getString(buffer, sizeof(buffer));
+    return compareStrings( getStringBuffer(), getStringLength(), buffer, length );
   }
 
   int Variant::compare(const uint16         & iValue) const
@@ -791,17 +990,20 @@ namespace libVariant
     //can't be compared using native C++ types
     
     //try to simplify this Variant's string value to a native type
-    Variant thisCopy(*this);
-    if (thisCopy.simplify())
+    VariantFormat simplifiedFormat;
+    VariantUnion simplifiedValue;
+    if (getSimplifiedValue(simplifiedFormat, simplifiedValue))
     {
-      //thisCopy is now a basic/native type
-      if (hasNativeCompare(thisCopy.mFormat, thisCopy.mData, result, iValue))
+      //the string value has a basic/native representation
+      if (hasNativeCompare(simplifiedFormat, simplifiedValue, result, iValue))
         return result;
     }
 
     //current Variant's value is an unsimplifiable string
     assert( mFormat == Variant::STRING );
-    return compareStrings( (*mData.as_str), Variant(iValue).getString() );
+    char buffer[NATIVE_STRING_BUFFER_SIZE];
+    size_t length = Variant(iValue).getString(buffer, sizeof(buffer));
+    return compareStrings( getStringBuffer(), getStringLength(), buffer, length );
   }
 
   int Variant::compare(const uint32         & iValue) const
@@ -813,17 +1015,20 @@ namespace libVariant
     //can't be compared using native C++ types
     
     //try to simplify this Variant's string value to a native type
-    Variant thisCopy(*this);
-    if (thisCopy.simplify())
+    VariantFormat simplifiedFormat;
+    VariantUnion simplifiedValue;
+    if (getSimplifiedValue(simplifiedFormat, simplifiedValue))
     {
-      //thisCopy is now a basic/native type
-      if (hasNativeCompare(thisCopy.mFormat, thisCopy.mData, result, iValue))
+      //the string value has a basic/native representation
+      if (hasNativeCompare(simplifiedFormat, simplifiedValue, result, iValue))
         return result;
     }
 
     //current Variant's value is an unsimplifiable string
     assert( mFormat == Variant::STRING );
-    return compareStrings( (*mData.as_str), Variant(iValue).getString() );
+    char buffer[NATIVE_STRING_BUFFER_SIZE];
+    size_t length = Variant(iValue).getString(buffer, sizeof(buffer));
+    return compareStrings( getStringBuffer(), getStringLength(), buffer, length );
   }
 
   int Variant::compare(const uint64         & iValue) const
@@ -835,17 +1040,20 @@ namespace libVariant
     //can't be compared using native C++ types
     
     //try to simplify this Variant's string value to a native type
-    Variant thisCopy(*this);
-    if (thisCopy.simplify())
+    VariantFormat simplifiedFormat;
+    VariantUnion simplifiedValue;
+    if (getSimplifiedValue(simplifiedFormat, simplifiedValue))
     {
-      //thisCopy is now a basic/native type
-      if (hasNativeCompare(thisCopy.mFormat, thisCopy.mData, result, iValue))
+      //the string value has a basic/native representation
+      if (hasNativeCompare(simplifiedFormat, simplifiedValue, result, iValue))
         return result;
     }
 
     //current Variant's value is an unsimplifiable string
     assert( mFormat == Variant::STRING );
-    return compareStrings( (*mData.as_str), Variant(iValue).getString() );
+    char buffer[NATIVE_STRING_BUFFER_SIZE];
+    size_t length = Variant(iValue).getString(buffer, sizeof(buffer));
+    return compareStrings( getStringBuffer(), getStringLength(), buffer, length );
   }
 
   int Variant::compare(const sint8         & iValue) const
@@ -857,17 +1065,20 @@ namespace libVariant
     //can't be compared using native C++ types
     
     //try to simplify this Variant's string value to a native type
-    Variant thisCopy(*this);
-    if (thisCopy.simplify())
+    VariantFormat simplifiedFormat;
+    VariantUnion simplifiedValue;
+    if (getSimplifiedValue(simplifiedFormat, simplifiedValue))
     {
-      //thisCopy is now a basic/native type
-      if (hasNativeCompare(thisCopy.mFormat, thisCopy.mData, result, iValue))
+      //the string value has a basic/native representation
+      if (hasNativeCompare(simplifiedFormat, simplifiedValue, result, iValue))
         return result;
     }
 
     //current Variant's value is an unsimplifiable string
     assert( mFormat == Variant::STRING );
-    return compareStrings( (*mData.as_str), Variant(iValue).getString() );
+    char buffer[NATIVE_STRING_BUFFER_SIZE];
+    size_t length = Variant(iValue).getString(buffer, sizeof(buffer));
+    return compareStrings( getStringBuffer(), getStringLength(), buffer, length );
   }
 
   int Variant::compare(const sint16        & iValue) const
@@ -879,17 +1090,20 @@ namespace libVariant
     //can't be compared using native C++ types
     
     //try to simplify this Variant's string value to a native type
-    Variant thisCopy(*this);
-    if (thisCopy.simplify())
+    VariantFormat simplifiedFormat;
+    VariantUnion simplifiedValue;
+    if (getSimplifiedValue(simplifiedFormat, simplifiedValue))
     {
-      //thisCopy is now a basic/native type
-      if (hasNativeCompare(thisCopy.mFormat, thisCopy.mData, result, iValue))
+      //the string value has a basic/native representation
+      if (hasNativeCompare(simplifiedFormat, simplifiedValue, result, iValue))
         return result;
     }
 
     //current Variant's value is an unsimplifiable string
     assert( mFormat == Variant::STRING );
-    return compareStrings( (*mData.as_str), Variant(iValue).getString() );
+    char buffer[NATIVE_STRING_BUFFER_SIZE];
+    size_t length = Variant(iValue).getString(buffer, sizeof(buffer));
+    return compareStrings( getStringBuffer(), getStringLength(), buffer, length );
   }
 
   int Variant::compare(const sint32        & iValue) const
@@ -901,17 +1115,20 @@ namespace libVariant
     //can't be compared using native C++ types
     
     //try to simplify this Variant's string value to a native type
-    Variant thisCopy(*this);
-    if (thisCopy.simplify())
+    VariantFormat simplifiedFormat;
+    VariantUnion simplifiedValue;
+    if (getSimplifiedValue(simplifiedFormat, simplifiedValue))
     {
-      //thisCopy is now a basic/native type
-      if (hasNativeCompare(thisCopy.mFormat, thisCopy.mData, result, iValue))
+      //the string value has a basic/native representation
+      if (hasNativeCompare(simplifiedFormat, simplifiedValue, result, iValue))
         return result;
     }
 
     //current Variant's value is an unsimplifiable string
     assert( mFormat == Variant::STRING );
-    return compareStrings( (*mData.as_str), Variant(iValue).getString() );
+    char buffer[NATIVE_STRING_BUFFER_SIZE];
+    size_t length = Variant(iValue).getString(buffer, sizeof(buffer));
+    return compareStrings( getStringBuffer(), getStringLength(), buffer, length );
   }
 
   int Variant::compare(const sint64        & iValue) const
@@ -923,17 +1140,20 @@ namespace libVariant
     //can't be compared using native C++ types
     
     //try to simplify this Variant's string value to a native type
-    Variant thisCopy(*this);
-    if (thisCopy.simplify())
+    VariantFormat simplifiedFormat;
+    VariantUnion simplifiedValue;
+    if (getSimplifiedValue(simplifiedFormat, simplifiedValue))
     {
-      //thisCopy is now a basic/native type
-      if (hasNativeCompare(thisCopy.mFormat, thisCopy.mData, result, iValue))
+      //the string value has a basic/native representation
+      if (hasNativeCompare(simplifiedFormat, simplifiedValue, result, iValue))
         return result;
     }
 
     //current Variant's value is an unsimplifiable string
     assert( mFormat == Variant::STRING );
-    return compareStrings( (*mData.as_str), Variant(iValue).getString() );
+    char buffer[NATIVE_STRING_BUFFER_SIZE];
+    size_t length = Variant(iValue).getString(buffer, sizeof(buffer));
+    return compareStrings( getStringBuffer(), getStringLength(), buffer, length );
   }
 
   int Variant::compare(const float32      & iValue) const
@@ -945,17 +1165,20 @@ namespace libVariant
     //can't be compared using native C++ types
     
     //try to simplify this Variant's string value to a native type
-    Variant thisCopy(*this);
-    if (thisCopy.simplify())
+    VariantFormat simplifiedFormat;
+    VariantUnion simplifiedValue;
+    if (getSimplifiedValue(simplifiedFormat, simplifiedValue))
     {
-      //thisCopy is now a basic/native type
-      if (hasNativeCompare(thisCopy.mFormat, thisCopy.mData, result, iValue))
+      //the string value has a basic/native representation
+      if (hasNativeCompare(simplifiedFormat, simplifiedValue, result, iValue))
         return result;
     }
 
     //current Variant's value is an unsimplifiable string
     assert( mFormat == Variant::STRING );
-    return compareStrings( (*mData.as_str), Variant(iValue).getString() );
+    char buffer[NATIVE_STRING_BUFFER_SIZE];
+    size_t length = Variant(iValue).getString(buffer, sizeof(buffer));
+    return compareStrings( getStringBuffer(), getStringLength(), buffer, length );
   }
 
   int Variant::compare(const float64      & iValue) const
@@ -967,17 +1190,20 @@ namespace libVariant
     //can't be compared using native C++ types
     
     //try to simplify this Variant's string value to a native type
-    Variant thisCopy(*this);
-    if (thisCopy.simplify())
+    VariantFormat simplifiedFormat;
+    VariantUnion simplifiedValue;
+    if (getSimplifiedValue(simplifiedFormat, simplifiedValue))
     {
-      //thisCopy is now a basic/native type
-      if (hasNativeCompare(thisCopy.mFormat, thisCopy.mData, result, iValue))
+      //the string value has a basic/native representation
+      if (hasNativeCompare(simplifiedFormat, simplifiedValue, result, iValue))
         return result;
     }
 
     //current Variant's value is an unsimplifiable string
     assert( mFormat == Variant::STRING );
-    return compareStrings( (*mData.as_str), Variant(iValue).getString() );
+    char buffer[NATIVE_STRING_BUFFER_SIZE];
+    size_t length = Variant(iValue).getString(buffer, sizeof(buffer));
+    return compareStrings( getStringBuffer(), getStringLength(), buffer, length );
   }
 #endif
 
@@ -985,91 +1211,95 @@ namespace libVariant
 #if 1
   int Variant::compare(const CStr         & iValue) const
   {
-    return compare(Str(iValue));
+    return compareString(iValue, strlen(iValue));
   }
 
   int Variant::compare(const Str          & iValue) const
   {
+    return compareString(iValue.c_str(), iValue.size());
+  }
+
+  int Variant::compare(const Variant      & iValue) const
+  {
+    if (iValue.mFormat != Variant::STRING)
+      return compareNativeValue(iValue.mFormat, iValue.mData);
+
     if (mFormat == Variant::STRING)
     {
       //both strings.
       //They can be compared using native c++ operators
-      return compareStrings( *mData.as_str, iValue );
+      return compareStrings( getStringBuffer(), getStringLength(), iValue.getStringBuffer(), iValue.getStringLength() );
     }
 
-    //try to simplify the string argument to a native type
-    Variant simplifiedValue(iValue);
-    if (simplifiedValue.simplify())
+    //try to simplify the string argument to a native type. The result is cached by the argument.
+    VariantFormat simplifiedFormat;
+    VariantUnion simplifiedValue;
+    if (iValue.getSimplifiedValue(simplifiedFormat, simplifiedValue))
+      return compareNativeValue(simplifiedFormat, simplifiedValue);
+
+    //local variant is not a string and the argument is not simplifiable.
+    //local Variant must be converted to a string to be compared
+    char buffer[NATIVE_STRING_BUFFER_SIZE];
+    size_t length = getString(buffer, sizeof(buffer));
+    return compareStrings( buffer, length, iValue.getStringBuffer(), iValue.getStringLength() );
+  }
+
+  int Variant::compareString(const char * iValue, size_t iLength) const
+  {
+    if (mFormat == Variant::STRING)
+    {
+      //both strings.
+      //They can be compared using native c++ operators
+      return compareStrings( getStringBuffer(), getStringLength(), iValue, iLength );
+    }
+
+    //try to simplify the string argument to a native type without copying it
+    StringParser p;
+    p.parse(iValue, iLength);
+    VariantFormat simplifiedFormat;
+    VariantUnion simplifiedValue;
+    if (getNarrowestFormat(p, simplifiedFormat, simplifiedValue))
     {
       //delegate the compare task to a lower compare() function
-      switch(simplifiedValue.mFormat)
-      {
-      case Variant::BOOL:
-        return compare(simplifiedValue.mData.as_bool);
-      case Variant::UINT8:
-        return compare(simplifiedValue.mData.as_uint8);
-      case Variant::UINT16:
-        return compare(simplifiedValue.mData.as_uint16);
-      case Variant::UINT32:
-        return compare(simplifiedValue.mData.as_uint32);
-      case Variant::UINT64:
-        return compare(simplifiedValue.mData.as_uint64);
-      case Variant::SINT8:
-        return compare(simplifiedValue.mData.as_sint8);
-      case Variant::SINT16:
-        return compare(simplifiedValue.mData.as_sint16);
-      case Variant::SINT32:
-        return compare(simplifiedValue.mData.as_sint32);
-      case Variant::SINT64:
-        return compare(simplifiedValue.mData.as_sint64);
-      case Variant::FLOAT32:
-        return compare(simplifiedValue.mData.as_float32);
-      case Variant::FLOAT64:
-        return compare(simplifiedValue.mData.as_float64);
-      case Variant::STRING:
-        assert( false ); /*error should not happen*/
-        return 0;
-      default:
-        assert( false ); /*error should not happen*/
-        return 0;
-      };
+      return compareNativeValue(simplifiedFormat, simplifiedValue);
     }
 
     //at this point, local variant is not a string. ie uint16  =2518
     //argument is not simplifiable. ie: "foobar"
     //local Variant must be converted to a string to be compared: "2518" compared to "foobar"
-    return compareStrings( this->getString(), iValue );
+    char buffer[NATIVE_STRING_BUFFER_SIZE];
+    size_t length = getString(buffer, sizeof(buffer));
+    return compareStrings( buffer, length, iValue, iLength );
   }
 
-  int Variant::compare(const Variant      & iValue) const
+  int Variant::compareNativeValue(const VariantFormat & iFormat, const VariantUnion & iValue) const
   {
     //delegate compare processing to compare([internal value])...
-    switch(iValue.mFormat)
+    switch(iFormat)
     {
     case Variant::BOOL:
-      return compare(iValue.mData.as_bool);
+      return compare(iValue.as_bool);
     case Variant::UINT8:
-      return compare(iValue.mData.as_uint8);
+      return compare(iValue.as_uint8);
     case Variant::UINT16:
-      return compare(iValue.mData.as_uint16);
+      return compare(iValue.as_uint16);
     case Variant::UINT32:
-      return compare(iValue.mData.as_uint32);
+      return compare(iValue.as_uint32);
     case Variant::UINT64:
-      return compare(iValue.mData.as_uint64);
+      return compare(iValue.as_uint64);
     case Variant::SINT8:
-      return compare(iValue.mData.as_sint8);
+      return compare(iValue.as_sint8);
     case Variant::SINT16:
-      return compare(iValue.mData.as_sint16);
+      return compare(iValue.as_sint16);
     case Variant::SINT32:
-      return compare(iValue.mData.as_sint32);
+      return compare(iValue.as_sint32);
     case Variant::SINT64:
-      return compare(iValue.mData.as_sint64);
+      return compare(iValue.as_sint64);
     case Variant::FLOAT32:
-      return compare(iValue.mData.as_float32);
+      return compare(iValue.as_float32);
     case Variant::FLOAT64:
-      return compare(iValue.mData.as_float64);
+      return compare(iValue.as_float64);
     case Variant::STRING:
-      return compare(*iValue.mData.as_str);
     default:
       assert( false ); /*error should not happen*/
       return 0;
@@ -1077,6 +1307,109 @@ namespace libVariant
   }
 #endif
 
+  // hash()
+#if 1
+  /// <summary>
+  /// Mixes the bits of a 64 bits value (MurmurHash3 finalizer).
+  /// </summary>
+  inline uint64 mixHash(uint64 iValue)
+  {
+    iValue ^= iValue >> 33;
+    iValue *= 0xff51afd7ed558ccdull;
+    iValue ^= iValue >> 33;
+    iValue *= 0xc4ceb9fe1a85ec53ull;
+    iValue ^= iValue >> 33;
+    return iValue;
+  }
+
+  inline uint64 hashCharacters(const char * iValue, size_t iLength)
+  {
+    //process 8 characters at a time
+    uint64 hash = 0x9e3779b97f4a7c15ull ^ (iLength * 0xc6a4a7935bd1e995ull);
+    size_t offset = 0;
+    for(; offset + sizeof(uint64) <= iLength; offset += sizeof(uint64))
+    {
+      uint64 block;
+      memcpy(&block, iValue + offset, sizeof(block));
+      hash = (hash ^ mixHash(block)) * 0xc6a4a7935bd1e995ull;
+    }
+    uint64 block = 0;
+    memcpy(&block, iValue + offset, iLength - offset);
+    hash ^= block;
+    return mixHash(hash);
+  }
+
+  inline uint64 hashInteger(uint64 iValue)
+  {
+    return mixHash(iValue);
+  }
+
+  inline uint64 hashFloating(float64 iValue)
+  {
+    if (iValue != iValue)
+      return mixHash(0x7ff8000000000000ull); //all NaN values are hashed the same way
+
+    //integral values must hash like the matching integer. Also handles -0.0.
+    if (iValue >= -9223372036854775808.0 && iValue < 18446744073709551616.0 && floor(iValue) == iValue)
+    {
+      if (iValue < 0.0)
+        return hashInteger(static_cast<uint64>(static_cast<sint64>(iValue)));
+      return hashInteger(static_cast<uint64>(iValue));
+    }
+
+    uint64 bits;
+    memcpy(&bits, &iValue, sizeof(bits));
+    return mixHash(bits ^ 0x5bd1e9955bd1e995ull);
+  }
+
+  inline uint64 hashNativeValue(const Variant::VariantFormat & iFormat, const Variant::VariantUnion & iValue)
+  {
+    switch(iFormat)
+    {
+    case Variant::BOOL:
+      return hashInteger(iValue.as_bool ? 1 : 0);
+    case Variant::UINT8:
+      return hashInteger(iValue.as_uint8);
+    case Variant::UINT16:
+      return hashInteger(iValue.as_uint16);
+    case Variant::UINT32:
+      return hashInteger(iValue.as_uint32);
+    case Variant::UINT64:
+      return hashInteger(iValue.as_uint64);
+    case Variant::SINT8:
+      return hashInteger(static_cast<uint64>(static_cast<sint64>(iValue.as_sint8)));
+    case Variant::SINT16:
+      return hashInteger(static_cast<uint64>(static_cast<sint64>(iValue.as_sint16)));
+    case Variant::SINT32:
+      return hashInteger(static_cast<uint64>(static_cast<sint64>(iValue.as_sint32)));
+    case Variant::SINT64:
+      return hashInteger(static_cast<uint64>(iValue.as_sint64));
+    case Variant::FLOAT32:
+      return hashFloating(iValue.as_float32);
+    case Variant::FLOAT64:
+      return hashFloating(iValue.as_float64);
+    case Variant::STRING:
+    default:
+      assert( false ); /*error should not happen*/
+      return 0;
+    };
+  }
+
+  size_t Variant::hash() const
+  {
+    if (mFormat != Variant::STRING)
+      return static_cast<size_t>(hashNativeValue(mFormat, mData));
+
+    //a string which has a native representation is compared as the native value
+    VariantFormat simplifiedFormat;
+    VariantUnion simplifiedValue;
+    if (getSimplifiedValue(simplifiedFormat, simplifiedValue))
+      return static_cast<size_t>(hashNativeValue(simplifiedFormat, simplifiedValue));
+
+    return static_cast<size_t>(hashCharacters(getStringBuffer(), getStringLength()));
+  }
+#endif
+
   //operator +=
 #if 1 
   const Variant & Variant::operator += (const bool      & iValue)
@@ -1454,182 +1787,103 @@ namespace libVariant
     }
 #endif
 
-  const Variant & Variant::processOperator(MATH_OPERATOR iOperator, const Variant & iValue)
-  {
-
-#define PROCESS_DIVISION_VALIDATION(targetVariable, sourceVariable) \
-    {\
-      sint64  modulo = (iOperator == Variant::DIVIDE_EQUAL && sourceVariable != 0) ? targetVariable % sourceVariable : 0;\
-      if (modulo != 0)\
-      {\
-        promote(Variant::FLOAT64);\
-        _applyOperator(iOperator, mData.as_float64, static_cast<float64>(sourceVariable) );\
-        return (*this);\
-      }\
+  /// <summary>
+  /// Specialized implementations of processOperator() for each pair of internal formats.
+  /// Each kernel already knows the formats of both Variants and applies the following rules:
+  ///   #1 - if + - / * on a non-float with a float, then promote local to float
+  ///   #2 - if + - / * on float with a non-float, then promote argument to float
+  ///   #3 - if + - / * on a signed with an unsigned, then promote argument to signed
+  ///   #4 - if + - / * on an unsigned with a signed, then promote local to signed
+  ///   #5 - if / by any value, if value%argument != 0, convert to float and proceed with division
+  /// </summary>
+  struct Variant::OperatorKernels
+  {
+    /// <summary>
+    /// Dispatch table of the kernels indexed by MATH_OPERATOR, local format and argument format.
+    /// The table is generated by the code_generator project.
+    /// </summary>
+    static const OperatorKernel TABLE[4][12][12];
+
+    template <MATH_OPERATOR op, typename T>
+    inline static bool processInexactDivision(Variant & ioLocal, const T iLeftValue, const T iRightValue)
+    {
+      //Rule #5
+      if (op != DIVIDE_EQUAL || iRightValue == 0 || iLeftValue % iRightValue == 0)
+        return false;
+
+      ioLocal.promote(Variant::FLOAT64);
+      _applyOperator(op, ioLocal.mData.as_float64, static_cast<float64>(iRightValue) );
+      return true;
     }
 
-    //Rules:
-    //  #1 - if + - / * on a non-float with a float, then promote local to float
-    //  #2 - if + - / * on float with a non-float, then promote argument to float
-    //  #3 - if + - / * on a signed with an unsigned, then promote argument to signed
-    //  #4 - if + - / * on an unsigned with a signed, then promote local to signed
-    //  #5 - if / by any value, if value%argument != 0, convert to float and proceed with division
-
-    if (this->mFormat == iValue.mFormat)
+    inline static void promoteUnsignedFormat(Variant & ioLocal)
     {
-      //both variant have the same format
-      switch(mFormat)
+      if (ioLocal.mData.as_uint64 > (uint64  )uint32_max)
       {
-      case Variant::BOOL:
-      case Variant::UINT8:
-      case Variant::UINT16:
-      case Variant::UINT32:
-      case Variant::UINT64:
-        //apply operator
-        PROCESS_DIVISION_VALIDATION(mData.as_uint64, iValue.mData.as_uint64);
-        _applyOperator(iOperator, mData.as_uint64, iValue.mData.as_uint64);
-        processInternalTypePromotion();
-        return (*this);
-      case Variant::SINT8:
-      case Variant::SINT16:
-      case Variant::SINT32:
-      case Variant::SINT64:
-        //apply operator
-        PROCESS_DIVISION_VALIDATION(mData.as_sint64, iValue.mData.as_sint64);
-        _applyOperator(iOperator, mData.as_sint64, iValue.mData.as_sint64);
-        processInternalTypePromotion();
-        return (*this);
-      case Variant::FLOAT32:
-        //apply operator
-        _applyOperator(iOperator, mData.as_float32, iValue.mData.as_float32);
-        processInternalTypePromotion();
-        return (*this);
-      case Variant::FLOAT64:
-        //apply operator
-        _applyOperator(iOperator, mData.as_float64, iValue.mData.as_float64);
-        processInternalTypePromotion();
-        return (*this);
-      case Variant::STRING:
-        //apply operator
-        switch(iOperator)
-        {
-        case PLUS_EQUAL:
-          mData.as_str->append(*iValue.mData.as_str);
-          break;
-        case MINUS_EQUAL:
-        case MULTIPLY_EQUAL:
-        case DIVIDE_EQUAL:
-          //undefined
-          break;
-        default:
-          assert( false ); /*error should not happen*/
-          break;
-        };
-        return (*this);
-      default:
-        assert( false ); /*error should not happen*/
-        return (*this);
-      };
-    }
-
-    //both format are different
-    
-    //is both variant floating ?
-    else if (isFloatingFormat(mFormat) && isFloatingFormat(iValue.mFormat))
-    {
-      //They can be compared as floating point.
-      //Since we know they are not the same type
-      //one must be a float32 and the other
-      //is a float64
-
-      //elevate local type to float64
-      float64 a = getFloat64();
-      float64 b = iValue.getFloat64();
-      _applyOperator(iOperator, a, b);
-      setFloat64(a);
-
-      return (*this);
+        ioLocal.mFormat = Variant::UINT64;
+      }
+      else if (ioLocal.mData.as_uint64 > (uint64  )uint16_max)
+      {
+        ioLocal.mFormat = Variant::UINT32;
+      }
+      else if (ioLocal.mData.as_uint64 > (uint64  )uint8_max)
+      {
+        ioLocal.mFormat = Variant::UINT16;
+      }
     }
 
-    //is both variant unsigned ?
-    else if (isUnsignedFormat(mFormat) && isUnsignedFormat(iValue.mFormat))
+    inline static void promoteSignedFormat(Variant & ioLocal)
     {
-      //they can be compared as unsigned
-      //apply operator
-      PROCESS_DIVISION_VALIDATION(mData.as_uint64, iValue.mData.as_uint64);
-      _applyOperator(iOperator, mData.as_uint64, iValue.mData.as_uint64);
-      processInternalTypePromotion();
-
-      return (*this);
+      if (ioLocal.mData.as_sint64 > (sint64 )sint32_max)
+      {
+        ioLocal.mFormat = Variant::SINT64;
+      }
+      else if (ioLocal.mData.as_sint64 > (sint64 )sint16_max)
+      {
+        ioLocal.mFormat = Variant::SINT32;
+      }
+      else if (ioLocal.mData.as_sint64 > (sint64 )sint8_max)
+      {
+        ioLocal.mFormat = Variant::SINT16;
+      }
     }
 
-    //is both variant signed ?
-    else if (isSignedFormat(mFormat) && isSignedFormat(iValue.mFormat))
+    template <MATH_OPERATOR op>
+    static void unsignedKernel(Variant & ioLocal, const Variant & iValue)
     {
-      //they can be compared as signed
-      //apply operator
-      PROCESS_DIVISION_VALIDATION(mData.as_sint64, iValue.mData.as_sint64);
-      _applyOperator(iOperator, mData.as_sint64, iValue.mData.as_sint64);
-      processInternalTypePromotion();
-
-      return (*this);
+      if (processInexactDivision<op>(ioLocal, ioLocal.mData.as_uint64, iValue.mData.as_uint64))
+        return;
+      _applyOperator(op, ioLocal.mData.as_uint64, iValue.mData.as_uint64);
+      promoteUnsignedFormat(ioLocal);
     }
 
-    //is local variant un/signed and the other floating ?
-    else if ( (isUnsignedFormat(mFormat) || isSignedFormat(mFormat))  && isFloatingFormat(iValue.mFormat))
+    template <MATH_OPERATOR op>
+    static void signedKernel(Variant & ioLocal, const Variant & iValue)
     {
-      //Rule #1 - if + - / * on a non-float with a float, then elevate local to float
-
-      //They can be compared as floating point
-
-      //elevate local type to float64
-      float64 a = getFloat64();
-      float64 b = iValue.getFloat64();
-      _applyOperator(iOperator, a, b);
-
-      setFloat64(a);
-
-      return (*this);
+      if (processInexactDivision<op>(ioLocal, ioLocal.mData.as_sint64, iValue.mData.as_sint64))
+        return;
+      _applyOperator(op, ioLocal.mData.as_sint64, iValue.mData.as_sint64);
+      promoteSignedFormat(ioLocal);
     }
 
-    //is local variant floating and the other un/signed ?
-    else if ( isFloatingFormat(mFormat) &&   (isUnsignedFormat(iValue.mFormat) || isSignedFormat(iValue.mFormat))   )
-    {
-      //Rule #2 - if + - / * on float with a non-float, then elevate argument to float
-
-      //They can be compared as floating point
-
-      //elevate both as float64
-      float64 a = getFloat64();
-      float64 b = iValue.getFloat64();
-      _applyOperator(iOperator, a, b);
-
-      setFloat64(a);
-
-      return (*this);
+    template <MATH_OPERATOR op>
+    static void signedUnsignedKernel(Variant & ioLocal, const Variant & iValue)
+    {
+      //Rule #3
+      //ie local=-4 other=4444444444 -> express local as unsigned
+      //  size_t a = (size_t)-4;
+      //  a += 6; //a==2
+      const sint64 value = static_cast<sint64 >(iValue.mData.as_uint64);
+      if (processInexactDivision<op>(ioLocal, ioLocal.mData.as_sint64, value))
+        return;
+      _applyOperator(op, ioLocal.mData.as_sint64, value);
+      promoteSignedFormat(ioLocal);
     }
 
-    //is local variant signed and other variant unsigned ?
-    //ie local=-4 other=4444444444 -> express local as unsigned
-    //  size_t a = (size_t)-4;
-    //  a += 6; //a==2
-    else if (isSignedFormat(mFormat) && isUnsignedFormat(iValue.mFormat))
+    template <MATH_OPERATOR op>
+    static void unsignedSignedKernel(Variant & ioLocal, const Variant & iValue)
     {
-      //Rule #3 - if + - / * on a signed with an unsigned, then elevate argument to signed
-
-      //they must be compared as the same type as the local variant
-
-      //apply operator
-      PROCESS_DIVISION_VALIDATION(mData.as_sint64, static_cast<sint64 >(iValue.mData.as_uint64));
-      _applyOperator(iOperator, mData.as_sint64, static_cast<sint64 >(iValue.mData.as_uint64));
-      processInternalTypePromotion();
-
-      return (*this);
-    }
-    else if (isUnsignedFormat(mFormat) && isSignedFormat(iValue.mFormat))
-    {
-      //Rule #4 - if + - / * on an unsigned with a signed, then elevate local to signed
-
+      //Rule #4
       //Note:
       //uint8   value = 4;
       //Variant v;
@@ -1637,70 +1891,788 @@ namespace libVariant
       //v *= -2;
       //v == -8 or 18446744073709551608
       //for consistencies, local type must be changed to signed.
-      signFormatToggle();
-
-      //apply operator
-      PROCESS_DIVISION_VALIDATION(mData.as_sint64, iValue.mData.as_sint64);
-      _applyOperator(iOperator, mData.as_sint64, iValue.mData.as_sint64);
-      processInternalTypePromotion();
-
-      return (*this);
+      ioLocal.signFormatToggle();
+      signedKernel<op>(ioLocal, iValue);
     }
 
-    //-----------------------------------------------------------------
-    //all 'perfect' use cases failed.
-    //could this be because local or other Variant are strings ?
-    //-----------------------------------------------------------------
-
-    //try to simplify both
-    Variant valueCopy = iValue;
-    bool thisSimplified = isSimplifiable(*this);
-    bool copySimplified = isSimplifiable(valueCopy);
+    template <MATH_OPERATOR op>
+    static void float32Kernel(Variant & ioLocal, const Variant & iValue)
+    {
+      _applyOperator(op, ioLocal.mData.as_float32, iValue.mData.as_float32);
+    }
 
-    //is this local Variant and the argument could be simplified?
-    if (thisSimplified && copySimplified)
+    template <MATH_OPERATOR op>
+    static void float64Kernel(Variant & ioLocal, const Variant & iValue)
     {
-      //both were simplified.
-      //both this and the copied argument may now be identical.
-      //run operator again
-      return this->processOperator(iOperator, valueCopy);
+      _applyOperator(op, ioLocal.mData.as_float64, iValue.mData.as_float64);
     }
-    else if(thisSimplified && !copySimplified)
+
+    template <MATH_OPERATOR op>
+    static void mixedFloatKernel(Variant & ioLocal, const Variant & iValue)
     {
-      //local instance was simplified
-      //both this and the argument may now be identical.
-      //run operator again
-      return this->processOperator(iOperator, iValue);
+      //Rule #1 and #2
+      //elevate both as float64
+      float64 a = ioLocal.getFloat64();
+      float64 b = iValue.getFloat64();
+      _applyOperator(op, a, b);
+      ioLocal.setFloat64(a);
     }
-    else if(!thisSimplified && copySimplified)
+
+    template <MATH_OPERATOR op>
+    static void stringKernel(Variant & ioLocal, const Variant & iValue)
     {
-      //argument instance was simplified
-      //both this and the argument may now be identical.
-      //run operator again
-      return this->processOperator(iOperator, valueCopy);
+      //other operators are undefined
+      if (op == PLUS_EQUAL)
+        ioLocal.appendString(iValue.getStringBuffer(), iValue.getStringLength());
     }
 
-    //outch! either local variant or the argument must be an unsimplifiable string
-    //concatenate both elements
-    switch(iOperator)
+    template <MATH_OPERATOR op>
+    static void simplifyKernel(Variant & ioLocal, const Variant & iValue)
     {
-    case PLUS_EQUAL:
-      setString( getString().append(iValue.getString()) );
-      break;
-    case MINUS_EQUAL:
-    case MULTIPLY_EQUAL:
-    case DIVIDE_EQUAL:
-      //undefined
-      break;
-    default:
-      assert( false ); /*error should not happen*/
-      break;
-    };
+      //local or other Variant is a string
+      //try to simplify both
+      Variant valueCopy;
+      bool copySimplified = false;
+      if (iValue.mFormat == Variant::STRING)
+      {
+        //the simplified string value is cached by the argument
+        VariantFormat simplifiedFormat;
+        VariantUnion simplifiedValue;
+        copySimplified = iValue.getSimplifiedValue(simplifiedFormat, simplifiedValue);
+        if (copySimplified)
+        {
+          valueCopy.mFormat = simplifiedFormat;
+          valueCopy.mData = simplifiedValue;
+        }
+      }
+      else
+      {
+        valueCopy = iValue;
+        copySimplified = isSimplifiable(valueCopy);
+      }
+      bool thisSimplified = isSimplifiable(ioLocal);
 
-    //not supported
-    return (*this);
+      if (copySimplified)
+      {
+        //the argument was simplified.
+        //both this and the copied argument may now be identical.
+        //run operator again
+        ioLocal.processOperator(op, valueCopy);
+        return;
+      }
+      else if (thisSimplified)
+      {
+        //local instance was simplified
+        //both this and the argument may now be identical.
+        //run operator again
+        ioLocal.processOperator(op, iValue);
+        return;
+      }
+
+      //outch! either local variant or the argument must be an unsimplifiable string
+      //concatenate both elements. Other operators are undefined
+      if (op == PLUS_EQUAL)
+        ioLocal.setString( ioLocal.getString().append(iValue.getString()) );
+    }
+  };
+
+  // operator kernels dispatch table
+#if 1
+  static_assert(Variant::STRING == 11, "the dispatch table must be generated again if Variant::VariantFormat is modified");
+  static_assert(Variant::DIVIDE_EQUAL == 3, "the dispatch table must be generated again if Variant::MATH_OPERATOR is modified");
+  const Variant::OperatorKernel Variant::OperatorKernels::TABLE[4][12][12] = {
+    //PLUS_EQUAL
+    {
+      { //BOOL
+        &unsignedKernel<PLUS_EQUAL>,            //BOOL
+        &unsignedKernel<PLUS_EQUAL>,            //UINT8
+        &unsignedSignedKernel<PLUS_EQUAL>,      //SINT8
+        &unsignedKernel<PLUS_EQUAL>,            //UINT16
+        &unsignedSignedKernel<PLUS_EQUAL>,      //SINT16
+        &unsignedKernel<PLUS_EQUAL>,            //UINT32
+        &unsignedSignedKernel<PLUS_EQUAL>,      //SINT32
+        &unsignedKernel<PLUS_EQUAL>,            //UINT64
+        &unsignedSignedKernel<PLUS_EQUAL>,      //SINT64
+        &mixedFloatKernel<PLUS_EQUAL>,          //FLOAT32
+        &mixedFloatKernel<PLUS_EQUAL>,          //FLOAT64
+        &simplifyKernel<PLUS_EQUAL>,            //STRING
+      },
+      { //UINT8
+        &unsignedKernel<PLUS_EQUAL>,            //BOOL
+        &unsignedKernel<PLUS_EQUAL>,            //UINT8
+        &unsignedSignedKernel<PLUS_EQUAL>,      //SINT8
+        &unsignedKernel<PLUS_EQUAL>,            //UINT16
+        &unsignedSignedKernel<PLUS_EQUAL>,      //SINT16
+        &unsignedKernel<PLUS_EQUAL>,            //UINT32
+        &unsignedSignedKernel<PLUS_EQUAL>,      //SINT32
+        &unsignedKernel<PLUS_EQUAL>,            //UINT64
+        &unsignedSignedKernel<PLUS_EQUAL>,      //SINT64
+        &mixedFloatKernel<PLUS_EQUAL>,          //FLOAT32
+        &mixedFloatKernel<PLUS_EQUAL>,          //FLOAT64
+        &simplifyKernel<PLUS_EQUAL>,            //STRING
+      },
+      { //SINT8
+        &signedUnsignedKernel<PLUS_EQUAL>,      //BOOL
+        &signedUnsignedKernel<PLUS_EQUAL>,      //UINT8
+        &signedKernel<PLUS_EQUAL>,              //SINT8
+        &signedUnsignedKernel<PLUS_EQUAL>,      //UINT16
+        &signedKernel<PLUS_EQUAL>,              //SINT16
+        &signedUnsignedKernel<PLUS_EQUAL>,      //UINT32
+        &signedKernel<PLUS_EQUAL>,              //SINT32
+        &signedUnsignedKernel<PLUS_EQUAL>,      //UINT64
+        &signedKernel<PLUS_EQUAL>,              //SINT64
+        &mixedFloatKernel<PLUS_EQUAL>,          //FLOAT32
+        &mixedFloatKernel<PLUS_EQUAL>,          //FLOAT64
+        &simplifyKernel<PLUS_EQUAL>,            //STRING
+      },
+      { //UINT16
+        &unsignedKernel<PLUS_EQUAL>,            //BOOL
+        &unsignedKernel<PLUS_EQUAL>,            //UINT8
+        &unsignedSignedKernel<PLUS_EQUAL>,      //SINT8
+        &unsignedKernel<PLUS_EQUAL>,            //UINT16
+        &unsignedSignedKernel<PLUS_EQUAL>,      //SINT16
+        &unsignedKernel<PLUS_EQUAL>,            //UINT32
+        &unsignedSignedKernel<PLUS_EQUAL>,      //SINT32
+        &unsignedKernel<PLUS_EQUAL>,            //UINT64
+        &unsignedSignedKernel<PLUS_EQUAL>,      //SINT64
+        &mixedFloatKernel<PLUS_EQUAL>,          //FLOAT32
+        &mixedFloatKernel<PLUS_EQUAL>,          //FLOAT64
+        &simplifyKernel<PLUS_EQUAL>,            //STRING
+      },
+      { //SINT16
+        &signedUnsignedKernel<PLUS_EQUAL>,      //BOOL
+        &signedUnsignedKernel<PLUS_EQUAL>,      //UINT8
+        &signedKernel<PLUS_EQUAL>,              //SINT8
+        &signedUnsignedKernel<PLUS_EQUAL>,      //UINT16
+        &signedKernel<PLUS_EQUAL>,              //SINT16
+        &signedUnsignedKernel<PLUS_EQUAL>,      //UINT32
+        &signedKernel<PLUS_EQUAL>,              //SINT32
+        &signedUnsignedKernel<PLUS_EQUAL>,      //UINT64
+        &signedKernel<PLUS_EQUAL>,              //SINT64
+        &mixedFloatKernel<PLUS_EQUAL>,          //FLOAT32
+        &mixedFloatKernel<PLUS_EQUAL>,          //FLOAT64
+        &simplifyKernel<PLUS_EQUAL>,            //STRING
+      },
+      { //UINT32
+        &unsignedKernel<PLUS_EQUAL>,            //BOOL
+        &unsignedKernel<PLUS_EQUAL>,            //UINT8
+        &unsignedSignedKernel<PLUS_EQUAL>,      //SINT8
+        &unsignedKernel<PLUS_EQUAL>,            //UINT16
+        &unsignedSignedKernel<PLUS_EQUAL>,      //SINT16
+        &unsignedKernel<PLUS_EQUAL>,            //UINT32
+        &unsignedSignedKernel<PLUS_EQUAL>,      //SINT32
+        &unsignedKernel<PLUS_EQUAL>,            //UINT64
+        &unsignedSignedKernel<PLUS_EQUAL>,      //SINT64
+        &mixedFloatKernel<PLUS_EQUAL>,          //FLOAT32
+        &mixedFloatKernel<PLUS_EQUAL>,          //FLOAT64
+        &simplifyKernel<PLUS_EQUAL>,            //STRING
+      },
+      { //SINT32
+        &signedUnsignedKernel<PLUS_EQUAL>,      //BOOL
+        &signedUnsignedKernel<PLUS_EQUAL>,      //UINT8
+        &signedKernel<PLUS_EQUAL>,              //SINT8
+        &signedUnsignedKernel<PLUS_EQUAL>,      //UINT16
+        &signedKernel<PLUS_EQUAL>,              //SINT16
+        &signedUnsignedKernel<PLUS_EQUAL>,      //UINT32
+        &signedKernel<PLUS_EQUAL>,              //SINT32
+        &signedUnsignedKernel<PLUS_EQUAL>,      //UINT64
+        &signedKernel<PLUS_EQUAL>,              //SINT64
+        &mixedFloatKernel<PLUS_EQUAL>,          //FLOAT32
+        &mixedFloatKernel<PLUS_EQUAL>,          //FLOAT64
+        &simplifyKernel<PLUS_EQUAL>,            //STRING
+      },
+      { //UINT64
+        &unsignedKernel<PLUS_EQUAL>,            //BOOL
+        &unsignedKernel<PLUS_EQUAL>,            //UINT8
+        &unsignedSignedKernel<PLUS_EQUAL>,      //SINT8
+        &unsignedKernel<PLUS_EQUAL>,            //UINT16
+        &unsignedSignedKernel<PLUS_EQUAL>,      //SINT16
+        &unsignedKernel<PLUS_EQUAL>,            //UINT32
+        &unsignedSignedKernel<PLUS_EQUAL>,      //SINT32
+        &unsignedKernel<PLUS_EQUAL>,            //UINT64
+        &unsignedSignedKernel<PLUS_EQUAL>,      //SINT64
+        &mixedFloatKernel<PLUS_EQUAL>,          //FLOAT32
+        &mixedFloatKernel<PLUS_EQUAL>,          //FLOAT64
+        &simplifyKernel<PLUS_EQUAL>,            //STRING
+      },
+      { //SINT64
+        &signedUnsignedKernel<PLUS_EQUAL>,      //BOOL
+        &signedUnsignedKernel<PLUS_EQUAL>,      //UINT8
+        &signedKernel<PLUS_EQUAL>,              //SINT8
+        &signedUnsignedKernel<PLUS_EQUAL>,      //UINT16
+        &signedKernel<PLUS_EQUAL>,              //SINT16
+        &signedUnsignedKernel<PLUS_EQUAL>,      //UINT32
+        &signedKernel<PLUS_EQUAL>,              //SINT32
+        &signedUnsignedKernel<PLUS_EQUAL>,      //UINT64
+        &signedKernel<PLUS_EQUAL>,              //SINT64
+        &mixedFloatKernel<PLUS_EQUAL>,          //FLOAT32
+        &mixedFloatKernel<PLUS_EQUAL>,          //FLOAT64
+        &simplifyKernel<PLUS_EQUAL>,            //STRING
+      },
+      { //FLOAT32
+        &mixedFloatKernel<PLUS_EQUAL>,          //BOOL
+        &mixedFloatKernel<PLUS_EQUAL>,          //UINT8
+        &mixedFloatKernel<PLUS_EQUAL>,          //SINT8
+        &mixedFloatKernel<PLUS_EQUAL>,          //UINT16
+        &mixedFloatKernel<PLUS_EQUAL>,          //SINT16
+        &mixedFloatKernel<PLUS_EQUAL>,          //UINT32
+        &mixedFloatKernel<PLUS_EQUAL>,          //SINT32
+        &mixedFloatKernel<PLUS_EQUAL>,          //UINT64
+        &mixedFloatKernel<PLUS_EQUAL>,          //SINT64
+        &float32Kernel<PLUS_EQUAL>,             //FLOAT32
+        &mixedFloatKernel<PLUS_EQUAL>,          //FLOAT64
+        &simplifyKernel<PLUS_EQUAL>,            //STRING
+      },
+      { //FLOAT64
+        &mixedFloatKernel<PLUS_EQUAL>,          //BOOL
+        &mixedFloatKernel<PLUS_EQUAL>,          //UINT8
+        &mixedFloatKernel<PLUS_EQUAL>,          //SINT8
+        &mixedFloatKernel<PLUS_EQUAL>,          //UINT16
+        &mixedFloatKernel<PLUS_EQUAL>,          //SINT16
+        &mixedFloatKernel<PLUS_EQUAL>,          //UINT32
+        &mixedFloatKernel<PLUS_EQUAL>,          //SINT32
+        &mixedFloatKernel<PLUS_EQUAL>,          //UINT64
+        &mixedFloatKernel<PLUS_EQUAL>,          //SINT64
+        &mixedFloatKernel<PLUS_EQUAL>,          //FLOAT32
+        &float64Kernel<PLUS_EQUAL>,             //FLOAT64
+        &simplifyKernel<PLUS_EQUAL>,            //STRING
+      },
+      { //STRING
+        &simplifyKernel<PLUS_EQUAL>,            //BOOL
+        &simplifyKernel<PLUS_EQUAL>,            //UINT8
+        &simplifyKernel<PLUS_EQUAL>,            //SINT8
+        &simplifyKernel<PLUS_EQUAL>,            //UINT16
+        &simplifyKernel<PLUS_EQUAL>,            //SINT16
+        &simplifyKernel<PLUS_EQUAL>,            //UINT32
+        &simplifyKernel<PLUS_EQUAL>,            //SINT32
+        &simplifyKernel<PLUS_EQUAL>,            //UINT64
+        &simplifyKernel<PLUS_EQUAL>,            //SINT64
+        &simplifyKernel<PLUS_EQUAL>,            //FLOAT32
+        &simplifyKernel<PLUS_EQUAL>,            //FLOAT64
+        &stringKernel<PLUS_EQUAL>,              //STRING
+      },
+    },
+    //MINUS_EQUAL
+    {
+      { //BOOL
+        &unsignedKernel<MINUS_EQUAL>,           //BOOL
+        &unsignedKernel<MINUS_EQUAL>,           //UINT8
+        &unsignedSignedKernel<MINUS_EQUAL>,     //SINT8
+        &unsignedKernel<MINUS_EQUAL>,           //UINT16
+        &unsignedSignedKernel<MINUS_EQUAL>,     //SINT16
+        &unsignedKernel<MINUS_EQUAL>,           //UINT32
+        &unsignedSignedKernel<MINUS_EQUAL>,     //SINT32
+        &unsignedKernel<MINUS_EQUAL>,           //UINT64
+        &unsignedSignedKernel<MINUS_EQUAL>,     //SINT64
+        &mixedFloatKernel<MINUS_EQUAL>,         //FLOAT32
+        &mixedFloatKernel<MINUS_EQUAL>,         //FLOAT64
+        &simplifyKernel<MINUS_EQUAL>,           //STRING
+      },
+      { //UINT8
+        &unsignedKernel<MINUS_EQUAL>,           //BOOL
+        &unsignedKernel<MINUS_EQUAL>,           //UINT8
+        &unsignedSignedKernel<MINUS_EQUAL>,     //SINT8
+        &unsignedKernel<MINUS_EQUAL>,           //UINT16
+        &unsignedSignedKernel<MINUS_EQUAL>,     //SINT16
+        &unsignedKernel<MINUS_EQUAL>,           //UINT32
+        &unsignedSignedKernel<MINUS_EQUAL>,     //SINT32
+        &unsignedKernel<MINUS_EQUAL>,           //UINT64
+        &unsignedSignedKernel<MINUS_EQUAL>,     //SINT64
+        &mixedFloatKernel<MINUS_EQUAL>,         //FLOAT32
+        &mixedFloatKernel<MINUS_EQUAL>,         //FLOAT64
+        &simplifyKernel<MINUS_EQUAL>,           //STRING
+      },
+      { //SINT8
+        &signedUnsignedKernel<MINUS_EQUAL>,     //BOOL
+        &signedUnsignedKernel<MINUS_EQUAL>,     //UINT8
+        &signedKernel<MINUS_EQUAL>,             //SINT8
+        &signedUnsignedKernel<MINUS_EQUAL>,     //UINT16
+        &signedKernel<MINUS_EQUAL>,             //SINT16
+        &signedUnsignedKernel<MINUS_EQUAL>,     //UINT32
+        &signedKernel<MINUS_EQUAL>,             //SINT32
+        &signedUnsignedKernel<MINUS_EQUAL>,     //UINT64
+        &signedKernel<MINUS_EQUAL>,             //SINT64
+        &mixedFloatKernel<MINUS_EQUAL>,         //FLOAT32
+        &mixedFloatKernel<MINUS_EQUAL>,         //FLOAT64
+        &simplifyKernel<MINUS_EQUAL>,           //STRING
+      },
+      { //UINT16
+        &unsignedKernel<MINUS_EQUAL>,           //BOOL
+        &unsignedKernel<MINUS_EQUAL>,           //UINT8
+        &unsignedSignedKernel<MINUS_EQUAL>,     //SINT8
+        &unsignedKernel<MINUS_EQUAL>,           //UINT16
+        &unsignedSignedKernel<MINUS_EQUAL>,     //SINT16
+        &unsignedKernel<MINUS_EQUAL>,           //UINT32
+        &unsignedSignedKernel<MINUS_EQUAL>,     //SINT32
+        &unsignedKernel<MINUS_EQUAL>,           //UINT64
+        &unsignedSignedKernel<MINUS_EQUAL>,     //SINT64
+        &mixedFloatKernel<MINUS_EQUAL>,         //FLOAT32
+        &mixedFloatKernel<MINUS_EQUAL>,         //FLOAT64
+        &simplifyKernel<MINUS_EQUAL>,           //STRING
+      },
+      { //SINT16
+        &signedUnsignedKernel<MINUS_EQUAL>,     //BOOL
+        &signedUnsignedKernel<MINUS_EQUAL>,     //UINT8
+        &signedKernel<MINUS_EQUAL>,             //SINT8
+        &signedUnsignedKernel<MINUS_EQUAL>,     //UINT16
+        &signedKernel<MINUS_EQUAL>,             //SINT16
+        &signedUnsignedKernel<MINUS_EQUAL>,     //UINT32
+        &signedKernel<MINUS_EQUAL>,             //SINT32
+        &signedUnsignedKernel<MINUS_EQUAL>,     //UINT64
+        &signedKernel<MINUS_EQUAL>,             //SINT64
+        &mixedFloatKernel<MINUS_EQUAL>,         //FLOAT32
+        &mixedFloatKernel<MINUS_EQUAL>,         //FLOAT64
+        &simplifyKernel<MINUS_EQUAL>,           //STRING
+      },
+      { //UINT32
+        &unsignedKernel<MINUS_EQUAL>,           //BOOL
+        &unsignedKernel<MINUS_EQUAL>,           //UINT8
+        &unsignedSignedKernel<MINUS_EQUAL>,     //SINT8
+        &unsignedKernel<MINUS_EQUAL>,           //UINT16
+        &unsignedSignedKernel<MINUS_EQUAL>,     //SINT16
+        &unsignedKernel<MINUS_EQUAL>,           //UINT32
+        &unsignedSignedKernel<MINUS_EQUAL>,     //SINT32
+        &unsignedKernel<MINUS_EQUAL>,           //UINT64
+        &unsignedSignedKernel<MINUS_EQUAL>,     //SINT64
+        &mixedFloatKernel<MINUS_EQUAL>,         //FLOAT32
+        &mixedFloatKernel<MINUS_EQUAL>,         //FLOAT64
+        &simplifyKernel<MINUS_EQUAL>,           //STRING
+      },
+      { //SINT32
+        &signedUnsignedKernel<MINUS_EQUAL>,     //BOOL
+        &signedUnsignedKernel<MINUS_EQUAL>,     //UINT8
+        &signedKernel<MINUS_EQUAL>,             //SINT8
+        &signedUnsignedKernel<MINUS_EQUAL>,     //UINT16
+        &signedKernel<MINUS_EQUAL>,             //SINT16
+        &signedUnsignedKernel<MINUS_EQUAL>,     //UINT32
+        &signedKernel<MINUS_EQUAL>,             //SINT32
+        &signedUnsignedKernel<MINUS_EQUAL>,     //UINT64
+        &signedKernel<MINUS_EQUAL>,             //SINT64
+        &mixedFloatKernel<MINUS_EQUAL>,         //FLOAT32
+        &mixedFloatKernel<MINUS_EQUAL>,         //FLOAT64
+        &simplifyKernel<MINUS_EQUAL>,           //STRING
+      },
+      { //UINT64
+        &unsignedKernel<MINUS_EQUAL>,           //BOOL
+        &unsignedKernel<MINUS_EQUAL>,           //UINT8
+        &unsignedSignedKernel<MINUS_EQUAL>,     //SINT8
+        &unsignedKernel<MINUS_EQUAL>,           //UINT16
+        &unsignedSignedKernel<MINUS_EQUAL>,     //SINT16
+        &unsignedKernel<MINUS_EQUAL>,           //UINT32
+        &unsignedSignedKernel<MINUS_EQUAL>,     //SINT32
+        &unsignedKernel<MINUS_EQUAL>,           //UINT64
+        &unsignedSignedKernel<MINUS_EQUAL>,     //SINT64
+        &mixedFloatKernel<MINUS_EQUAL>,         //FLOAT32
+        &mixedFloatKernel<MINUS_EQUAL>,         //FLOAT64
+        &simplifyKernel<MINUS_EQUAL>,           //STRING
+      },
+      { //SINT64
+        &signedUnsignedKernel<MINUS_EQUAL>,     //BOOL
+        &signedUnsignedKernel<MINUS_EQUAL>,     //UINT8
+        &signedKernel<MINUS_EQUAL>,             //SINT8
+        &signedUnsignedKernel<MINUS_EQUAL>,     //UINT16
+        &signedKernel<MINUS_EQUAL>,             //SINT16
+        &signedUnsignedKernel<MINUS_EQUAL>,     //UINT32
+        &signedKernel<MINUS_EQUAL>,             //SINT32
+        &signedUnsignedKernel<MINUS_EQUAL>,     //UINT64
+        &signedKernel<MINUS_EQUAL>,             //SINT64
+        &mixedFloatKernel<MINUS_EQUAL>,         //FLOAT32
+        &mixedFloatKernel<MINUS_EQUAL>,         //FLOAT64
+        &simplifyKernel<MINUS_EQUAL>,           //STRING
+      },
+      { //FLOAT32
+        &mixedFloatKernel<MINUS_EQUAL>,         //BOOL
+        &mixedFloatKernel<MINUS_EQUAL>,         //UINT8
+        &mixedFloatKernel<MINUS_EQUAL>,         //SINT8
+        &mixedFloatKernel<MINUS_EQUAL>,         //UINT16
+        &mixedFloatKernel<MINUS_EQUAL>,         //SINT16
+        &mixedFloatKernel<MINUS_EQUAL>,         //UINT32
+        &mixedFloatKernel<MINUS_EQUAL>,         //SINT32
+        &mixedFloatKernel<MINUS_EQUAL>,         //UINT64
+        &mixedFloatKernel<MINUS_EQUAL>,         //SINT64
+        &float32Kernel<MINUS_EQUAL>,            //FLOAT32
+        &mixedFloatKernel<MINUS_EQUAL>,         //FLOAT64
+        &simplifyKernel<MINUS_EQUAL>,           //STRING
+      },
+      { //FLOAT64
+        &mixedFloatKernel<MINUS_EQUAL>,         //BOOL
+        &mixedFloatKernel<MINUS_EQUAL>,         //UINT8
+        &mixedFloatKernel<MINUS_EQUAL>,         //SINT8
+        &mixedFloatKernel<MINUS_EQUAL>,         //UINT16
+        &mixedFloatKernel<MINUS_EQUAL>,         //SINT16
+        &mixedFloatKernel<MINUS_EQUAL>,         //UINT32
+        &mixedFloatKernel<MINUS_EQUAL>,         //SINT32
+        &mixedFloatKernel<MINUS_EQUAL>,         //UINT64
+        &mixedFloatKernel<MINUS_EQUAL>,         //SINT64
+        &mixedFloatKernel<MINUS_EQUAL>,         //FLOAT32
+        &float64Kernel<MINUS_EQUAL>,            //FLOAT64
+        &simplifyKernel<MINUS_EQUAL>,           //STRING
+      },
+      { //STRING
+        &simplifyKernel<MINUS_EQUAL>,           //BOOL
+        &simplifyKernel<MINUS_EQUAL>,           //UINT8
+        &simplifyKernel<MINUS_EQUAL>,           //SINT8
+        &simplifyKernel<MINUS_EQUAL>,           //UINT16
+        &simplifyKernel<MINUS_EQUAL>,           //SINT16
+        &simplifyKernel<MINUS_EQUAL>,           //UINT32
+        &simplifyKernel<MINUS_EQUAL>,           //SINT32
+        &simplifyKernel<MINUS_EQUAL>,           //UINT64
+        &simplifyKernel<MINUS_EQUAL>,           //SINT64
+        &simplifyKernel<MINUS_EQUAL>,           //FLOAT32
+        &simplifyKernel<MINUS_EQUAL>,           //FLOAT64
+        &stringKernel<MINUS_EQUAL>,             //STRING
+      },
+    },
+    //MULTIPLY_EQUAL
+    {
+      { //BOOL
+        &unsignedKernel<MULTIPLY_EQUAL>,        //BOOL
+        &unsignedKernel<MULTIPLY_EQUAL>,        //UINT8
+        &unsignedSignedKernel<MULTIPLY_EQUAL>,  //SINT8
+        &unsignedKernel<MULTIPLY_EQUAL>,        //UINT16
+        &unsignedSignedKernel<MULTIPLY_EQUAL>,  //SINT16
+        &unsignedKernel<MULTIPLY_EQUAL>,        //UINT32
+        &unsignedSignedKernel<MULTIPLY_EQUAL>,  //SINT32
+        &unsignedKernel<MULTIPLY_EQUAL>,        //UINT64
+        &unsignedSignedKernel<MULTIPLY_EQUAL>,  //SINT64
+        &mixedFloatKernel<MULTIPLY_EQUAL>,      //FLOAT32
+        &mixedFloatKernel<MULTIPLY_EQUAL>,      //FLOAT64
+        &simplifyKernel<MULTIPLY_EQUAL>,        //STRING
+      },
+      { //UINT8
+        &unsignedKernel<MULTIPLY_EQUAL>,        //BOOL
+        &unsignedKernel<MULTIPLY_EQUAL>,        //UINT8
+        &unsignedSignedKernel<MULTIPLY_EQUAL>,  //SINT8
+        &unsignedKernel<MULTIPLY_EQUAL>,        //UINT16
+        &unsignedSignedKernel<MULTIPLY_EQUAL>,  //SINT16
+        &unsignedKernel<MULTIPLY_EQUAL>,        //UINT32
+        &unsignedSignedKernel<MULTIPLY_EQUAL>,  //SINT32
+        &unsignedKernel<MULTIPLY_EQUAL>,        //UINT64
+        &unsignedSignedKernel<MULTIPLY_EQUAL>,  //SINT64
+        &mixedFloatKernel<MULTIPLY_EQUAL>,      //FLOAT32
+        &mixedFloatKernel<MULTIPLY_EQUAL>,      //FLOAT64
+        &simplifyKernel<MULTIPLY_EQUAL>,        //STRING
+      },
+      { //SINT8
+        &signedUnsignedKernel<MULTIPLY_EQUAL>,  //BOOL
+        &signedUnsignedKernel<MULTIPLY_EQUAL>,  //UINT8
+        &signedKernel<MULTIPLY_EQUAL>,          //SINT8
+        &signedUnsignedKernel<MULTIPLY_EQUAL>,  //UINT16
+        &signedKernel<MULTIPLY_EQUAL>,          //SINT16
+        &signedUnsignedKernel<MULTIPLY_EQUAL>,  //UINT32
+        &signedKernel<MULTIPLY_EQUAL>,          //SINT32
+        &signedUnsignedKernel<MULTIPLY_EQUAL>,  //UINT64
+        &signedKernel<MULTIPLY_EQUAL>,          //SINT64
+        &mixedFloatKernel<MULTIPLY_EQUAL>,      //FLOAT32
+        &mixedFloatKernel<MULTIPLY_EQUAL>,      //FLOAT64
+        &simplifyKernel<MULTIPLY_EQUAL>,        //STRING
+      },
+      { //UINT16
+        &unsignedKernel<MULTIPLY_EQUAL>,        //BOOL
+        &unsignedKernel<MULTIPLY_EQUAL>,        //UINT8
+        &unsignedSignedKernel<MULTIPLY_EQUAL>,  //SINT8
+        &unsignedKernel<MULTIPLY_EQUAL>,        //UINT16
+        &unsignedSignedKernel<MULTIPLY_EQUAL>,  //SINT16
+        &unsignedKernel<MULTIPLY_EQUAL>,        //UINT32
+        &unsignedSignedKernel<MULTIPLY_EQUAL>,  //SINT32
+        &unsignedKernel<MULTIPLY_EQUAL>,        //UINT64
+        &unsignedSignedKernel<MULTIPLY_EQUAL>,  //SINT64
+        &mixedFloatKernel<MULTIPLY_EQUAL>,      //FLOAT32
+        &mixedFloatKernel<MULTIPLY_EQUAL>,      //FLOAT64
+        &simplifyKernel<MULTIPLY_EQUAL>,        //STRING
+      },
+      { //SINT16
+        &signedUnsignedKernel<MULTIPLY_EQUAL>,  //BOOL
+        &signedUnsignedKernel<MULTIPLY_EQUAL>,  //UINT8
+        &signedKernel<MULTIPLY_EQUAL>,          //SINT8
+        &signedUnsignedKernel<MULTIPLY_EQUAL>,  //UINT16
+        &signedKernel<MULTIPLY_EQUAL>,          //SINT16
+        &signedUnsignedKernel<MULTIPLY_EQUAL>,  //UINT32
+        &signedKernel<MULTIPLY_EQUAL>,          //SINT32
+        &signedUnsignedKernel<MULTIPLY_EQUAL>,  //UINT64
+        &signedKernel<MULTIPLY_EQUAL>,          //SINT64
+        &mixedFloatKernel<MULTIPLY_EQUAL>,      //FLOAT32
+        &mixedFloatKernel<MULTIPLY_EQUAL>,      //FLOAT64
+        &simplifyKernel<MULTIPLY_EQUAL>,        //STRING
+      },
+      { //UINT32
+        &unsignedKernel<MULTIPLY_EQUAL>,        //BOOL
+        &unsignedKernel<MULTIPLY_EQUAL>,        //UINT8
+        &unsignedSignedKernel<MULTIPLY_EQUAL>,  //SINT8
+        &unsignedKernel<MULTIPLY_EQUAL>,        //UINT16
+        &unsignedSignedKernel<MULTIPLY_EQUAL>,  //SINT16
+        &unsignedKernel<MULTIPLY_EQUAL>,        //UINT32
+        &unsignedSignedKernel<MULTIPLY_EQUAL>,  //SINT32
+        &unsignedKernel<MULTIPLY_EQUAL>,        //UINT64
+        &unsignedSignedKernel<MULTIPLY_EQUAL>,  //SINT64
+        &mixedFloatKernel<MULTIPLY_EQUAL>,      //FLOAT32
+        &mixedFloatKernel<MULTIPLY_EQUAL>,      //FLOAT64
+        &simplifyKernel<MULTIPLY_EQUAL>,        //STRING
+      },
+      { //SINT32
+        &signedUnsignedKernel<MULTIPLY_EQUAL>,  //BOOL
+        &signedUnsignedKernel<MULTIPLY_EQUAL>,  //UINT8
+        &signedKernel<MULTIPLY_EQUAL>,          //SINT8
+        &signedUnsignedKernel<MULTIPLY_EQUAL>,  //UINT16
+        &signedKernel<MULTIPLY_EQUAL>,          //SINT16
+        &signedUnsignedKernel<MULTIPLY_EQUAL>,  //UINT32
+        &signedKernel<MULTIPLY_EQUAL>,          //SINT32
+        &signedUnsignedKernel<MULTIPLY_EQUAL>,  //UINT64
+        &signedKernel<MULTIPLY_EQUAL>,          //SINT64
+        &mixedFloatKernel<MULTIPLY_EQUAL>,      //FLOAT32
+        &mixedFloatKernel<MULTIPLY_EQUAL>,      //FLOAT64
+        &simplifyKernel<MULTIPLY_EQUAL>,        //STRING
+      },
+      { //UINT64
+        &unsignedKernel<MULTIPLY_EQUAL>,        //BOOL
+        &unsignedKernel<MULTIPLY_EQUAL>,        //UINT8
+        &unsignedSignedKernel<MULTIPLY_EQUAL>,  //SINT8
+        &unsignedKernel<MULTIPLY_EQUAL>,        //UINT16
+        &unsignedSignedKernel<MULTIPLY_EQUAL>,  //SINT16
+        &unsignedKernel<MULTIPLY_EQUAL>,        //UINT32
+        &unsignedSignedKernel<MULTIPLY_EQUAL>,  //SINT32
+        &unsignedKernel<MULTIPLY_EQUAL>,        //UINT64
+        &unsignedSignedKernel<MULTIPLY_EQUAL>,  //SINT64
+        &mixedFloatKernel<MULTIPLY_EQUAL>,      //FLOAT32
+        &mixedFloatKernel<MULTIPLY_EQUAL>,      //FLOAT64
+        &simplifyKernel<MULTIPLY_EQUAL>,        //STRING
+      },
+      { //SINT64
+        &signedUnsignedKernel<MULTIPLY_EQUAL>,  //BOOL
+        &signedUnsignedKernel<MULTIPLY_EQUAL>,  //UINT8
+        &signedKernel<MULTIPLY_EQUAL>,          //SINT8
+        &signedUnsignedKernel<MULTIPLY_EQUAL>,  //UINT16
+        &signedKernel<MULTIPLY_EQUAL>,          //SINT16
+        &signedUnsignedKernel<MULTIPLY_EQUAL>,  //UINT32
+        &signedKernel<MULTIPLY_EQUAL>,          //SINT32
+        &signedUnsignedKernel<MULTIPLY_EQUAL>,  //UINT64
+        &signedKernel<MULTIPLY_EQUAL>,          //SINT64
+        &mixedFloatKernel<MULTIPLY_EQUAL>,      //FLOAT32
+        &mixedFloatKernel<MULTIPLY_EQUAL>,      //FLOAT64
+        &simplifyKernel<MULTIPLY_EQUAL>,        //STRING
+      },
+      { //FLOAT32
+        &mixedFloatKernel<MULTIPLY_EQUAL>,      //BOOL
+        &mixedFloatKernel<MULTIPLY_EQUAL>,      //UINT8
+        &mixedFloatKernel<MULTIPLY_EQUAL>,      //SINT8
+        &mixedFloatKernel<MULTIPLY_EQUAL>,      //UINT16
+        &mixedFloatKernel<MULTIPLY_EQUAL>,      //SINT16
+        &mixedFloatKernel<MULTIPLY_EQUAL>,      //UINT32
+        &mixedFloatKernel<MULTIPLY_EQUAL>,      //SINT32
+        &mixedFloatKernel<MULTIPLY_EQUAL>,      //UINT64
+        &mixedFloatKernel<MULTIPLY_EQUAL>,      //SINT64
+        &float32Kernel<MULTIPLY_EQUAL>,         //FLOAT32
+        &mixedFloatKernel<MULTIPLY_EQUAL>,      //FLOAT64
+        &simplifyKernel<MULTIPLY_EQUAL>,        //STRING
+      },
+      { //FLOAT64
+        &mixedFloatKernel<MULTIPLY_EQUAL>,      //BOOL
+        &mixedFloatKernel<MULTIPLY_EQUAL>,      //UINT8
+        &mixedFloatKernel<MULTIPLY_EQUAL>,      //SINT8
+        &mixedFloatKernel<MULTIPLY_EQUAL>,      //UINT16
+        &mixedFloatKernel<MULTIPLY_EQUAL>,      //SINT16
+        &mixedFloatKernel<MULTIPLY_EQUAL>,      //UINT32
+        &mixedFloatKernel<MULTIPLY_EQUAL>,      //SINT32
+        &mixedFloatKernel<MULTIPLY_EQUAL>,      //UINT64
+        &mixedFloatKernel<MULTIPLY_EQUAL>,      //SINT64
+        &mixedFloatKernel<MULTIPLY_EQUAL>,      //FLOAT32
+        &float64Kernel<MULTIPLY_EQUAL>,         //FLOAT64
+        &simplifyKernel<MULTIPLY_EQUAL>,        //STRING
+      },
+      { //STRING
+        &simplifyKernel<MULTIPLY_EQUAL>,        //BOOL
+        &simplifyKernel<MULTIPLY_EQUAL>,        //UINT8
+        &simplifyKernel<MULTIPLY_EQUAL>,        //SINT8
+        &simplifyKernel<MULTIPLY_EQUAL>,        //UINT16
+        &simplifyKernel<MULTIPLY_EQUAL>,        //SINT16
+        &simplifyKernel<MULTIPLY_EQUAL>,        //UINT32
+        &simplifyKernel<MULTIPLY_EQUAL>,        //SINT32
+        &simplifyKernel<MULTIPLY_EQUAL>,        //UINT64
+        &simplifyKernel<MULTIPLY_EQUAL>,        //SINT64
+        &simplifyKernel<MULTIPLY_EQUAL>,        //FLOAT32
+        &simplifyKernel<MULTIPLY_EQUAL>,        //FLOAT64
+        &stringKernel<MULTIPLY_EQUAL>,          //STRING
+      },
+    },
+    //DIVIDE_EQUAL
+    {
+      { //BOOL
+        &unsignedKernel<DIVIDE_EQUAL>,          //BOOL
+        &unsignedKernel<DIVIDE_EQUAL>,          //UINT8
+        &unsignedSignedKernel<DIVIDE_EQUAL>,    //SINT8
+        &unsignedKernel<DIVIDE_EQUAL>,          //UINT16
+        &unsignedSignedKernel<DIVIDE_EQUAL>,    //SINT16
+        &unsignedKernel<DIVIDE_EQUAL>,          //UINT32
+        &unsignedSignedKernel<DIVIDE_EQUAL>,    //SINT32
+        &unsignedKernel<DIVIDE_EQUAL>,          //UINT64
+        &unsignedSignedKernel<DIVIDE_EQUAL>,    //SINT64
+        &mixedFloatKernel<DIVIDE_EQUAL>,        //FLOAT32
+        &mixedFloatKernel<DIVIDE_EQUAL>,        //FLOAT64
+        &simplifyKernel<DIVIDE_EQUAL>,          //STRING
+      },
+      { //UINT8
+        &unsignedKernel<DIVIDE_EQUAL>,          //BOOL
+        &unsignedKernel<DIVIDE_EQUAL>,          //UINT8
+        &unsignedSignedKernel<DIVIDE_EQUAL>,    //SINT8
+        &unsignedKernel<DIVIDE_EQUAL>,          //UINT16
+        &unsignedSignedKernel<DIVIDE_EQUAL>,    //SINT16
+        &unsignedKernel<DIVIDE_EQUAL>,          //UINT32
+        &unsignedSignedKernel<DIVIDE_EQUAL>,    //SINT32
+        &unsignedKernel<DIVIDE_EQUAL>,          //UINT64
+        &unsignedSignedKernel<DIVIDE_EQUAL>,    //SINT64
+        &mixedFloatKernel<DIVIDE_EQUAL>,        //FLOAT32
+        &mixedFloatKernel<DIVIDE_EQUAL>,        //FLOAT64
+        &simplifyKernel<DIVIDE_EQUAL>,          //STRING
+      },
+      { //SINT8
+        &signedUnsignedKernel<DIVIDE_EQUAL>,    //BOOL
+        &signedUnsignedKernel<DIVIDE_EQUAL>,    //UINT8
+        &signedKernel<DIVIDE_EQUAL>,            //SINT8
+        &signedUnsignedKernel<DIVIDE_EQUAL>,    //UINT16
+        &signedKernel<DIVIDE_EQUAL>,            //SINT16
+        &signedUnsignedKernel<DIVIDE_EQUAL>,    //UINT32
+        &signedKernel<DIVIDE_EQUAL>,            //SINT32
+        &signedUnsignedKernel<DIVIDE_EQUAL>,    //UINT64
+        &signedKernel<DIVIDE_EQUAL>,            //SINT64
+        &mixedFloatKernel<DIVIDE_EQUAL>,        //FLOAT32
+        &mixedFloatKernel<DIVIDE_EQUAL>,        //FLOAT64
+        &simplifyKernel<DIVIDE_EQUAL>,          //STRING
+      },
+      { //UINT16
+        &unsignedKernel<DIVIDE_EQUAL>,          //BOOL
+        &unsignedKernel<DIVIDE_EQUAL>,          //UINT8
+        &unsignedSignedKernel<DIVIDE_EQUAL>,    //SINT8
+        &unsignedKernel<DIVIDE_EQUAL>,          //UINT16
+        &unsignedSignedKernel<DIVIDE_EQUAL>,    //SINT16
+        &unsignedKernel<DIVIDE_EQUAL>,          //UINT32
+        &unsignedSignedKernel<DIVIDE_EQUAL>,    //SINT32
+        &unsignedKernel<DIVIDE_EQUAL>,          //UINT64
+        &unsignedSignedKernel<DIVIDE_EQUAL>,    //SINT64
+        &mixedFloatKernel<DIVIDE_EQUAL>,        //FLOAT32
+        &mixedFloatKernel<DIVIDE_EQUAL>,        //FLOAT64
+        &simplifyKernel<DIVIDE_EQUAL>,          //STRING
+      },
+      { //SINT16
+        &signedUnsignedKernel<DIVIDE_EQUAL>,    //BOOL
+        &signedUnsignedKernel<DIVIDE_EQUAL>,    //UINT8
+        &signedKernel<DIVIDE_EQUAL>,            //SINT8
+        &signedUnsignedKernel<DIVIDE_EQUAL>,    //UINT16
+        &signedKernel<DIVIDE_EQUAL>,            //SINT16
+        &signedUnsignedKernel<DIVIDE_EQUAL>,    //UINT32
+        &signedKernel<DIVIDE_EQUAL>,            //SINT32
+        &signedUnsignedKernel<DIVIDE_EQUAL>,    //UINT64
+        &signedKernel<DIVIDE_EQUAL>,            //SINT64
+        &mixedFloatKernel<DIVIDE_EQUAL>,        //FLOAT32
+        &mixedFloatKernel<DIVIDE_EQUAL>,        //FLOAT64
+        &simplifyKernel<DIVIDE_EQUAL>,          //STRING
+      },
+      { //UINT32
+        &unsignedKernel<DIVIDE_EQUAL>,          //BOOL
+        &unsignedKernel<DIVIDE_EQUAL>,          //UINT8
+        &unsignedSignedKernel<DIVIDE_EQUAL>,    //SINT8
+        &unsignedKernel<DIVIDE_EQUAL>,          //UINT16
+        &unsignedSignedKernel<DIVIDE_EQUAL>,    //SINT16
+        &unsignedKernel<DIVIDE_EQUAL>,          //UINT32
+        &unsignedSignedKernel<DIVIDE_EQUAL>,    //SINT32
+        &unsignedKernel<DIVIDE_EQUAL>,          //UINT64
+        &unsignedSignedKernel<DIVIDE_EQUAL>,    //SINT64
+        &mixedFloatKernel<DIVIDE_EQUAL>,        //FLOAT32
+        &mixedFloatKernel<DIVIDE_EQUAL>,        //FLOAT64
+        &simplifyKernel<DIVIDE_EQUAL>,          //STRING
+      },
+      { //SINT32
+        &signedUnsignedKernel<DIVIDE_EQUAL>,    //BOOL
+        &signedUnsignedKernel<DIVIDE_EQUAL>,    //UINT8
+        &signedKernel<DIVIDE_EQUAL>,            //SINT8
+        &signedUnsignedKernel<DIVIDE_EQUAL>,    //UINT16
+        &signedKernel<DIVIDE_EQUAL>,            //SINT16
+        &signedUnsignedKernel<DIVIDE_EQUAL>,    //UINT32
+        &signedKernel<DIVIDE_EQUAL>,            //SINT32
+        &signedUnsignedKernel<DIVIDE_EQUAL>,    //UINT64
+        &signedKernel<DIVIDE_EQUAL>,            //SINT64
+        &mixedFloatKernel<DIVIDE_EQUAL>,        //FLOAT32
+        &mixedFloatKernel<DIVIDE_EQUAL>,        //FLOAT64
+        &simplifyKernel<DIVIDE_EQUAL>,          //STRING
+      },
+      { //UINT64
+        &unsignedKernel<DIVIDE_EQUAL>,          //BOOL
+        &unsignedKernel<DIVIDE_EQUAL>,          //UINT8
+        &unsignedSignedKernel<DIVIDE_EQUAL>,    //SINT8
+        &unsignedKernel<DIVIDE_EQUAL>,          //UINT16
+        &unsignedSignedKernel<DIVIDE_EQUAL>,    //SINT16
+        &unsignedKernel<DIVIDE_EQUAL>,          //UINT32
+        &unsignedSignedKernel<DIVIDE_EQUAL>,    //SINT32
+        &unsignedKernel<DIVIDE_EQUAL>,          //UINT64
+        &unsignedSignedKernel<DIVIDE_EQUAL>,    //SINT64
+        &mixedFloatKernel<DIVIDE_EQUAL>,        //FLOAT32
+        &mixedFloatKernel<DIVIDE_EQUAL>,        //FLOAT64
+        &simplifyKernel<DIVIDE_EQUAL>,          //STRING
+      },
+      { //SINT64
+        &signedUnsignedKernel<DIVIDE_EQUAL>,    //BOOL
+        &signedUnsignedKernel<DIVIDE_EQUAL>,    //UINT8
+        &signedKernel<DIVIDE_EQUAL>,            //SINT8
+        &signedUnsignedKernel<DIVIDE_EQUAL>,    //UINT16
+        &signedKernel<DIVIDE_EQUAL>,            //SINT16
+        &signedUnsignedKernel<DIVIDE_EQUAL>,    //UINT32
+        &signedKernel<DIVIDE_EQUAL>,            //SINT32
+        &signedUnsignedKernel<DIVIDE_EQUAL>,    //UINT64
+        &signedKernel<DIVIDE_EQUAL>,            //SINT64
+        &mixedFloatKernel<DIVIDE_EQUAL>,        //FLOAT32
+        &mixedFloatKernel<DIVIDE_EQUAL>,        //FLOAT64
+        &simplifyKernel<DIVIDE_EQUAL>,          //STRING
+      },
+      { //FLOAT32
+        &mixedFloatKernel<DIVIDE_EQUAL>,        //BOOL
+        &mixedFloatKernel<DIVIDE_EQUAL>,        //UINT8
+        &mixedFloatKernel<DIVIDE_EQUAL>,        //SINT8
+        &mixedFloatKernel<DIVIDE_EQUAL>,        //UINT16
+        &mixedFloatKernel<DIVIDE_EQUAL>,        //SINT16
+        &mixedFloatKernel<DIVIDE_EQUAL>,        //UINT32
+        &mixedFloatKernel<DIVIDE_EQUAL>,        //SINT32
+        &mixedFloatKernel<DIVIDE_EQUAL>,        //UINT64
+        &mixedFloatKernel<DIVIDE_EQUAL>,        //SINT64
+        &float32Kernel<DIVIDE_EQUAL>,           //FLOAT32
+        &mixedFloatKernel<DIVIDE_EQUAL>,        //FLOAT64
+        &simplifyKernel<DIVIDE_EQUAL>,          //STRING
+      },
+      { //FLOAT64
+        &mixedFloatKernel<DIVIDE_EQUAL>,        //BOOL
+        &mixedFloatKernel<DIVIDE_EQUAL>,        //UINT8
+        &mixedFloatKernel<DIVIDE_EQUAL>,        //SINT8
+        &mixedFloatKernel<DIVIDE_EQUAL>,        //UINT16
+        &mixedFloatKernel<DIVIDE_EQUAL>,        //SINT16
+        &mixedFloatKernel<DIVIDE_EQUAL>,        //UINT32
+        &mixedFloatKernel<DIVIDE_EQUAL>,        //SINT32
+        &mixedFloatKernel<DIVIDE_EQUAL>,        //UINT64
+        &mixedFloatKernel<DIVIDE_EQUAL>,        //SINT64
+        &mixedFloatKernel<DIVIDE_EQUAL>,        //FLOAT32
+        &float64Kernel<DIVIDE_EQUAL>,           //FLOAT64
+        &simplifyKernel<DIVIDE_EQUAL>,          //STRING
+      },
+      { //STRING
+        &simplifyKernel<DIVIDE_EQUAL>,          //BOOL
+        &simplifyKernel<DIVIDE_EQUAL>,          //UINT8
+        &simplifyKernel<DIVIDE_EQUAL>,          //SINT8
+        &simplifyKernel<DIVIDE_EQUAL>,          //UINT16
+        &simplifyKernel<DIVIDE_EQUAL>,          //SINT16
+        &simplifyKernel<DIVIDE_EQUAL>,          //UINT32
+        &simplifyKernel<DIVIDE_EQUAL>,          //SINT32
+        &simplifyKernel<DIVIDE_EQUAL>,          //UINT64
+        &simplifyKernel<DIVIDE_EQUAL>,          //SINT64
+        &simplifyKernel<DIVIDE_EQUAL>,          //FLOAT32
+        &simplifyKernel<DIVIDE_EQUAL>,          //FLOAT64
+        &stringKernel<DIVIDE_EQUAL>,            //STRING
+      },
+    },
+  };
+#endif
 
-#undef PROCESS_DIVISION_VALIDATION
+  const Variant & Variant::processOperator(MATH_OPERATOR iOperator, const Variant & iValue)
+  {
+    assert( mFormat <= Variant::STRING && iValue.mFormat <= Variant::STRING );
+    OperatorKernels::TABLE[iOperator][mFormat][iValue.mFormat](*this, iValue);
+    return (*this);
   }
 
   //-----------------
@@ -1708,9 +2680,14 @@ namespace libVariant
   //-----------------
   void Variant::clear()
   {
-    if (mFormat == Variant::STRING)
+    if (mFormat == Variant::STRING && mStringStorage == STRING_HEAP)
       delete mData.as_str;
+    else if (mFormat == Variant::STRING && mStringStorage == STRING_SHARED)
+      SharedString::release(mSharedString);
     mFormat = Variant::UINT8;
+    mStringStorage = STRING_INLINE;
+    mInlineLength = 0;
+    mSimplifiedFormat.store(SIMPLIFIED_UNKNOWN, std::memory_order_relaxed);
     mData.as_bits = 0;
   }
 
@@ -1719,142 +2696,248 @@ namespace libVariant
     if (mFormat != Variant::STRING)
     {
       clear();
-      mData.as_str = new Str();
+      mInlineString[0] = '\0';
       mFormat = Variant::STRING;
     }
   }
 
-  bool Variant::simplify()
+  const char * Variant::getStringBuffer() const
   {
-    if (mFormat != Variant::STRING && 
-        mFormat != Variant::FLOAT32 && 
-        mFormat != Variant::FLOAT64)
-      return false; //no need to simplify;
+    if (mFormat != Variant::STRING)
+      return NULL;
+    if (mStringStorage == STRING_INLINE)
+      return mInlineString;
+    if (mStringStorage == STRING_VIEW)
+      return mStringView.buffer;
+    if (mStringStorage == STRING_SHARED)
+      return mSharedString->characters;
+    return mData.as_str->c_str();
+  }
 
-    StringParser p;
+  size_t Variant::getStringLength() const
+  {
+    if (mFormat != Variant::STRING)
+      return 0;
+    if (mStringStorage == STRING_INLINE)
+      return mInlineLength;
+    if (mStringStorage == STRING_VIEW)
+      return mStringView.length;
+    if (mStringStorage == STRING_SHARED)
+      return mSharedString->length;
+    return mData.as_str->size();
+  }
 
-    //simplify a string
-    if (mFormat == Variant::STRING)
+  void Variant::assignString(const char * iValue)
+  {
+    //iValue may point to the current heap string. Release it only once iValue is copied.
+    Str * previous = (mFormat == Variant::STRING && mStringStorage == STRING_HEAP) ? mData.as_str : NULL;
+    SharedString * previousShared = (mFormat == Variant::STRING && mStringStorage == STRING_SHARED) ? mSharedString : NULL;
+
+    size_t length = strlen(iValue);
+    if (length <= INLINE_STRING_CAPACITY)
     {
-      p.parse(mData.as_str->c_str());
+      memmove(mInlineString, iValue, length); //iValue may point to mInlineString
+      mInlineString[length] = '\0';
+      mInlineLength = static_cast<uint8>(length);
+      mStringStorage = STRING_INLINE;
     }
-    else if (mFormat == Variant::FLOAT32)
+    else
     {
-      p.parse(mData.as_float32);
+      mSharedString = SharedString::create(iValue, length, length);
+      mStringStorage = STRING_SHARED;
     }
-    else if (mFormat == Variant::FLOAT64)
+    mFormat = Variant::STRING;
+    mSimplifiedFormat.store(SIMPLIFIED_UNKNOWN, std::memory_order_relaxed);
+
+    if (previous)
+      delete previous;
+    if (previousShared)
+      SharedString::release(previousShared);
+  }
+
+  void Variant::appendString(const char * iValue, size_t iLength)
+  {
+    assert( mFormat == Variant::STRING );
+
+    //the borrowed characters must not be modified. iValue may point to them and remains valid.
+    if (mStringStorage == STRING_VIEW)
+      materialize();
+
+    mSimplifiedFormat.store(SIMPLIFIED_UNKNOWN, std::memory_order_relaxed);
+
+    if (mStringStorage == STRING_HEAP)
     {
-      p.parse(mData.as_float64);
+      mData.as_str->append(Str(iValue, iLength));
+      return;
     }
 
-    //apply any findings
-    if (p.is_Boolean)
+    if (mStringStorage == STRING_SHARED)
     {
-      setBool(p.parsed_boolean);
-      return true;
+      SharedString * previous = mSharedString;
+      size_t length = previous->length + iLength;
+      if (previous->isUnique() && length <= previous->capacity)
+      {
+        memmove(&previous->characters[previous->length], iValue, iLength); //iValue may point to the same characters
+        previous->characters[length] = '\0';
+        previous->length = length;
+        return;
+      }
+
+      //copy on write or grow. iValue may point to the previous characters which are released last.
+      SharedString * str = SharedString::create(previous->characters, previous->length, length * 2);
+      memcpy(&str->characters[str->length], iValue, iLength);
+      str->characters[length] = '\0';
+      str->length = length;
+      mSharedString = str;
+      SharedString::release(previous);
+      return;
     }
-    if (p.is_SInt8)
+
+    size_t length = mInlineLength + iLength;
+    if (length <= INLINE_STRING_CAPACITY)
     {
-      setSInt8(p.parsed_sint8);
-      return true;
+      memmove(&mInlineString[mInlineLength], iValue, iLength);
+      mInlineString[length] = '\0';
+      mInlineLength = static_cast<uint8>(length);
+      return;
     }
-    if (p.is_UInt8)
+
+    //string no longer fits inline. Move to the heap.
+    //iValue may point to mInlineString which is overwritten by the heap pointer.
+    SharedString * str = SharedString::create(mInlineString, mInlineLength, length * 2);
+    memcpy(&str->characters[str->length], iValue, iLength);
+    str->characters[length] = '\0';
+    str->length = length;
+    mSharedString = str;
+    mStringStorage = STRING_SHARED;
+  }
+
+  Str * Variant::detachString()
+  {
+    assert( mFormat == Variant::STRING );
+
+    Str * str = NULL;
+    if (mStringStorage == STRING_HEAP)
     {
-      setUInt8(p.parsed_uint8);
-      return true;
+      //steal the heap string
+      str = mData.as_str;
+      mStringStorage = STRING_INLINE;
     }
-    if (p.is_SInt16)
+    else
     {
-      setSInt16(p.parsed_sint16);
-      return true;
+      //inline string, string view or shared string
+      str = new Str(getStringBuffer(), getStringLength());
     }
-    if (p.is_UInt16)
-    {
-      setUInt16(p.parsed_uint16);
+    clear();
+    return str;
+  }
+
+  bool Variant::hasSimplifiedValueSlot() const
+  {
+    if (mStringStorage == STRING_HEAP || mStringStorage == STRING_SHARED)
       return true;
+    if (mStringStorage == STRING_VIEW)
+      return (sizeof(StringView) <= sizeof(VariantUnion)); //32-bit platforms only
+    return (static_cast<size_t>(mInlineLength) + 1 <= sizeof(VariantUnion)); //characters and null terminator fit in mStringData[0]
+  }
+
+  bool Variant::getSimplifiedValue(VariantFormat & oFormat, VariantUnion & oValue) const
+  {
+    assert( mFormat == Variant::STRING );
+
+    uint8 state = mSimplifiedFormat.load(std::memory_order_acquire);
+    if (state != SIMPLIFIED_UNKNOWN && state != SIMPLIFIED_BUSY)
+    {
+      //string value was already parsed
+      if (state == Variant::STRING)
+        return false;
+      if (hasSimplifiedValueSlot())
+      {
+        oFormat = static_cast<VariantFormat>(state);
+        oValue = mStringData[1];
+        return true;
+      }
+      //the value is not cached. Parse the string again.
     }
-    if (p.is_SInt32)
+
+    StringParser p;
+    p.parse(getStringBuffer(), getStringLength());
+    bool simplified = getNarrowestFormat(p, oFormat, oValue);
+    uint8 newState = static_cast<uint8>(simplified ? oFormat : Variant::STRING);
+
+    //remember the findings. If another thread is also parsing the string value, let it win.
+    //The cached value is written while the state is SIMPLIFIED_BUSY and published by the release store of the new state.
+    uint8 expected = SIMPLIFIED_UNKNOWN;
+    if (simplified && hasSimplifiedValueSlot())
     {
-      setSInt32(p.parsed_sint32);
-      return true;
+      if (mSimplifiedFormat.compare_exchange_strong(expected, SIMPLIFIED_BUSY, std::memory_order_acquire, std::memory_order_relaxed))
+      {
+        mStringData[1] = oValue;
+        mSimplifiedFormat.store(newState, std::memory_order_release);
+      }
     }
-    if (p.is_UInt32)
+    else
     {
-      setUInt32(p.parsed_uint32);
-      return true;
+      mSimplifiedFormat.compare_exchange_strong(expected, newState, std::memory_order_release);
     }
-    if (p.is_SInt64)
+
+    return simplified;
+  }
+
+  void Variant::copySimplifiedValue(const Variant & iValue)
+  {
+    assert( mFormat == Variant::STRING && iValue.mFormat == Variant::STRING );
+
+    uint8 state = iValue.mSimplifiedFormat.load(std::memory_order_acquire);
+    if (state == SIMPLIFIED_UNKNOWN || state == SIMPLIFIED_BUSY)
+      return;
+
+    if (state != Variant::STRING && hasSimplifiedValueSlot())
     {
-      setSInt64(p.parsed_sint64);
-      return true;
+      if (!iValue.hasSimplifiedValueSlot())
+        return; //the value is unknown
+      mStringData[1] = iValue.mStringData[1];
     }
-    if (p.is_UInt64)
+    mSimplifiedFormat.store(state, std::memory_order_release);
+  }
+
+  bool Variant::simplify()
+  {
+    if (mFormat != Variant::STRING && 
+        mFormat != Variant::FLOAT32 && 
+        mFormat != Variant::FLOAT64)
+      return false; //no need to simplify;
+
+    VariantFormat simplifiedFormat;
+    VariantUnion simplifiedValue;
+    bool simplified = false;
+
+    //simplify a string
+    if (mFormat == Variant::STRING)
     {
-      setUInt64(p.parsed_uint64);
-      return true;
+      simplified = getSimplifiedValue(simplifiedFormat, simplifiedValue);
     }
-    if (p.is_Float32)
+    else if (mFormat == Variant::FLOAT32)
     {
-      setFloat32(p.parsed_float32);
-      return true;
+      StringParser p;
+      p.parse(mData.as_float32);
+      simplified = getNarrowestFormat(p, simplifiedFormat, simplifiedValue);
     }
-    if (p.is_Float64)
+    else if (mFormat == Variant::FLOAT64)
     {
-      setFloat64(p.parsed_float64);
-      return true;
+      StringParser p;
+      p.parse(mData.as_float64);
+      simplified = getNarrowestFormat(p, simplifiedFormat, simplifiedValue);
     }
 
-    return false; //no simplication available
-  }
-
-  void Variant::processInternalTypePromotion()
-  {
-    switch(mFormat)
+    //apply any findings
+    if (simplified)
     {
-    case Variant::BOOL:
-    case Variant::UINT8:
-    case Variant::UINT16:
-    case Variant::UINT32:
-    case Variant::UINT64:
-      if (mData.as_uint64 > (uint64  )uint32_max)
-      {
-        mFormat = Variant::UINT64;
-      }
-      else if (mData.as_uint64 > (uint64  )uint16_max)
-      {
-        mFormat = Variant::UINT32;
-      }
-      else if (mData.as_uint64 > (uint64  )uint8_max)
-      {
-        mFormat = Variant::UINT16;
-      }
-      break;
-    case Variant::SINT8:
-    case Variant::SINT16:
-    case Variant::SINT32:
-    case Variant::SINT64:
-      if (mData.as_sint64 > (sint64 )sint32_max)
-      {
-        mFormat = Variant::SINT64;
-      }
-      else if (mData.as_sint64 > (sint64 )sint16_max)
-      {
-        mFormat = Variant::SINT32;
-      }
-      else if (mData.as_sint64 > (sint64 )sint8_max)
-      {
-        mFormat = Variant::SINT16;
-      }
-      break;
-    case Variant::FLOAT32:
-    case Variant::FLOAT64:
-    case Variant::STRING:
-      //nothing to do
-      break;
-    default:
-      assert( false ); /*error should not happen*/
-      break;
-    };
+      clear();
+      mFormat = simplifiedFormat;
+      mData = simplifiedValue;
+    }
+    return simplified;
   }
 
   void Variant::signFormatToggle()
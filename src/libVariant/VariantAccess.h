@@ -0,0 +1,122 @@
+/**********************************************************************************
+ * MIT License
+ * 
+ * Copyright (c) 2018 Antoine Beauchamp
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+
+#ifndef LIBVARIANT_VARIANTACCESS_H
+#define LIBVARIANT_VARIANTACCESS_H
+
+//---------------
+// Include Files
+//---------------
+#include "libvariant/variant.h"
+
+#include <assert.h>
+
+//-----------
+// Namespace
+//-----------
+
+namespace libVariant
+{
+  /// <summary>
+  /// Internal access to the raw format and value of a Variant.
+  /// Used by the modules of the library which read and build Variants without copying or converting their values.
+  /// This class is not part of the public interface of the library.
+  /// </summary>
+  class VariantAccess
+  {
+  public:
+    /// <summary>
+    /// Returns the internal format of a Variant without a virtual call.
+    /// </summary>
+    static Variant::VariantFormat getFormat(const Variant & iValue) { return iValue.mFormat; }
+
+    /// <summary>
+    /// Returns the internal value of a Variant. Only meaningful if the format of the Variant is not STRING.
+    /// </summary>
+    static const Variant::VariantUnion & getValue(const Variant & iValue) { return iValue.mData; }
+
+    /// <summary>
+    /// Assigns a native format and value to a Variant. String values are assigned with Variant::setStringView() or the Variant setters.
+    /// </summary>
+    /// <param name="oValue">The Variant to assign.</param>
+    /// <param name="iFormat">The new format of the Variant. Must not be STRING.</param>
+    /// <param name="iValue">The new value of the Variant.</param>
+    static void setValue(Variant & oValue, Variant::VariantFormat iFormat, const Variant::VariantUnion & iValue)
+    {
+      assert( iFormat != Variant::STRING );
+      oValue.resetNative(iFormat);
+      oValue.mData = iValue;
+    }
+
+    /// <summary>
+    /// Returns the characters of a STRING Variant. See Variant::getStringBuffer().
+    /// </summary>
+    static const char * getStringBuffer(const Variant & iValue) { return iValue.getStringBuffer(); }
+
+    /// <summary>
+    /// Returns the length of the string value of a STRING Variant. See Variant::getStringLength().
+    /// </summary>
+    static size_t getStringLength(const Variant & iValue) { return iValue.getStringLength(); }
+
+    /// <summary>
+    /// Returns the cached simplified value of a STRING Variant. See Variant::getSimplifiedValue().
+    /// </summary>
+    static bool getSimplifiedValue(const Variant & iValue, Variant::VariantFormat & oFormat, Variant::VariantUnion & oValue) { return iValue.getSimplifiedValue(oFormat, oValue); }
+
+    /// <summary>
+    /// Applies a math operator to a Variant. See Variant::processOperator().
+    /// </summary>
+    static void processOperator(Variant & ioValue, Variant::MATH_OPERATOR iOperator, const Variant & iValue) { ioValue.processOperator(iOperator, iValue); }
+
+    /// <summary>
+    /// Moves the string value of a STRING Variant to a Str instance owned by the caller. See Variant::detachString().
+    /// </summary>
+    static Str * detachString(Variant & ioValue) { return ioValue.detachString(); }
+
+    /// <summary>
+    /// Assigns a Str instance as the string value of a Variant without copying it. The Variant owns the Str instance
+    /// unless releaseString() is called before the Variant is modified or destroyed.
+    /// </summary>
+    static void attachString(Variant & oValue, Str * iValue)
+    {
+      oValue.clear();
+      oValue.mFormat = Variant::STRING;
+      oValue.mData.as_str = iValue;
+      oValue.mStringStorage = Variant::STRING_HEAP;
+    }
+
+    /// <summary>
+    /// Clears a Variant assigned with attachString() without deleting its Str instance.
+    /// </summary>
+    static void releaseString(Variant & ioValue)
+    {
+      ioValue.mStringStorage = Variant::STRING_INLINE;
+      ioValue.clear();
+    }
+  };
+
+} // End namespace
+
+#endif //LIBVARIANT_VARIANTACCESS_H
@@ -0,0 +1,779 @@
+/**********************************************************************************
+ * MIT License
+ *
+ * Copyright (c) 2018 Antoine Beauchamp
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+
+//---------------
+// Include Files
+//---------------
+#include "libvariant/variant_array.h"
+#include "NativeFormats.h"
+#include "VariantAccess.h"
+
+#include <assert.h>
+#include <string.h> // memcpy, memset, strlen
+#include <type_traits> // common_type
+
+//-----------
+// Namespace
+//-----------
+
+namespace libVariant
+{
+  typedef uint32 STRING_LENGTH_TYPE; //type of the length prefix of the characters of a string value
+
+  static const size_t FLOAT_BLOCK_SIZE = 256; //number of values converted to float64 at once by mixed floating point operators
+  static const size_t INTEGER_BLOCK_SIZE = 256; //number of integer results computed before their formats
+
+  /// <summary>
+  /// A column of values used as an operand of a math operator.
+  /// </summary>
+  struct ColumnOperand
+  {
+    const Variant::VariantUnion & operator[](size_t iIndex) const { return values[iIndex]; }
+    uint8 getFormat(size_t iIndex) const { return formats[iIndex]; }
+    Variant getView(size_t iIndex) const { return array->getView(iIndex); }
+
+    const VariantArray * array;
+    const uint8 * formats;
+    const Variant::VariantUnion * values;
+  };
+
+  /// <summary>
+  /// A single value used as the right operand of a math operator for all values of a column.
+  /// </summary>
+  struct ScalarOperand
+  {
+    const Variant::VariantUnion & operator[](size_t /*iIndex*/) const { return value; }
+    uint8 getFormat(size_t /*iIndex*/) const { return format; }
+    const Variant & getView(size_t /*iIndex*/) const { return *variant; }
+
+    const Variant * variant;
+    uint8 format;
+    Variant::VariantUnion value;
+  };
+
+  /// <summary>
+  /// Applies +, - or * to integers. Signed values are processed as unsigned values to get the same bits without overflow.
+  /// </summary>
+  template <Variant::MATH_OPERATOR op>
+  inline static uint64 applyIntegerOperator(uint64 iLeftValue, uint64 iRightValue)
+  {
+    return (op == Variant::PLUS_EQUAL  ? iLeftValue + iRightValue :
+           (op == Variant::MINUS_EQUAL ? iLeftValue - iRightValue : iLeftValue * iRightValue));
+  }
+
+  /// <summary>
+  /// Applies a math operator to floating point values. A division by zero leaves the value unmodified unless
+  /// the division by zero policy is Variant::THROW. See _applyOperator().
+  /// </summary>
+  template <Variant::MATH_OPERATOR op, typename T>
+  inline static T applyFloatOperator(T iLeftValue, T iRightValue, bool iSkipDivisionByZero)
+  {
+    switch(op)
+    {
+    case Variant::PLUS_EQUAL:
+      return iLeftValue + iRightValue;
+    case Variant::MINUS_EQUAL:
+      return iLeftValue - iRightValue;
+    case Variant::MULTIPLY_EQUAL:
+      return iLeftValue * iRightValue;
+    case Variant::DIVIDE_EQUAL:
+    default:
+      return ((iSkipDivisionByZero && iRightValue == 0) ? iLeftValue : iLeftValue / iRightValue);
+    };
+  }
+
+  /// <summary>
+  /// Converts numeric values to float64. A single format is converted by a loop which the compiler can vectorize.
+  /// </summary>
+  template <class T>
+  inline static void convertToFloat64(const T & iValues, uint32 iFormats, size_t iOffset, size_t iCount, float64 * oValues)
+  {
+    Variant::VariantFormat format;
+    if (!getSingleFormat(iFormats, format))
+    {
+      for(size_t i=0; i<iCount; i++)
+        oValues[i] = toFloat64(iValues.getFormat(iOffset+i), iValues[iOffset+i]);
+      return;
+    }
+
+    switch(format)
+    {
+    case Variant::BOOL:
+      for(size_t i=0; i<iCount; i++) oValues[i] = iValues[iOffset+i].as_bool;
+      break;
+    case Variant::UINT8:
+      for(size_t i=0; i<iCount; i++) oValues[i] = iValues[iOffset+i].as_uint8;
+      break;
+    case Variant::UINT16:
+      for(size_t i=0; i<iCount; i++) oValues[i] = iValues[iOffset+i].as_uint16;
+      break;
+    case Variant::UINT32:
+      for(size_t i=0; i<iCount; i++) oValues[i] = iValues[iOffset+i].as_uint32;
+      break;
+    case Variant::UINT64:
+      for(size_t i=0; i<iCount; i++) oValues[i] = static_cast<float64>(iValues[iOffset+i].as_uint64);
+      break;
+    case Variant::SINT8:
+      for(size_t i=0; i<iCount; i++) oValues[i] = iValues[iOffset+i].as_sint8;
+      break;
+    case Variant::SINT16:
+      for(size_t i=0; i<iCount; i++) oValues[i] = iValues[iOffset+i].as_sint16;
+      break;
+    case Variant::SINT32:
+      for(size_t i=0; i<iCount; i++) oValues[i] = iValues[iOffset+i].as_sint32;
+      break;
+    case Variant::SINT64:
+      for(size_t i=0; i<iCount; i++) oValues[i] = static_cast<float64>(iValues[iOffset+i].as_sint64);
+      break;
+    case Variant::FLOAT32:
+      for(size_t i=0; i<iCount; i++) oValues[i] = iValues[iOffset+i].as_float32;
+      break;
+    case Variant::FLOAT64:
+      for(size_t i=0; i<iCount; i++) oValues[i] = iValues[iOffset+i].as_float64;
+      break;
+    default:
+      assert( false ); /*error should not happen*/
+      break;
+    };
+  }
+
+  /// <summary>
+  /// Applies +, - or * to a column of integers. The values and their formats are computed in separate loops
+  /// because writing formats (bytes) in the same loop would prevent the compiler from vectorizing the loop.
+  /// </summary>
+  /// <remarks>
+  /// The format of each result depends on the format of the local value and on the result like Variant::OperatorKernels::unsignedKernel(),
+  /// signedKernel(), signedUnsignedKernel() and unsignedSignedKernel().
+  /// </remarks>
+  template <Variant::MATH_OPERATOR op, bool isSigned, bool isSignToggled, class T>
+  inline static void processIntegerColumn(uint8 * ioFormats, Variant::VariantUnion * ioValues, const T & iOperand, size_t iSize)
+  {
+    uint8 formats[INTEGER_BLOCK_SIZE];
+    for(size_t offset=0; offset<iSize; offset+=INTEGER_BLOCK_SIZE)
+    {
+      const size_t count = (iSize - offset < INTEGER_BLOCK_SIZE ? iSize - offset : INTEGER_BLOCK_SIZE);
+      Variant::VariantUnion * values = ioValues + offset;
+      for(size_t i=0; i<count; i++)
+        values[i].as_uint64 = applyIntegerOperator<op>(values[i].as_uint64, iOperand[offset+i].as_uint64);
+      for(size_t i=0; i<count; i++)
+      {
+        //Rule #4: an unsigned value is changed to signed when the argument is signed
+        const uint8 format = (isSignToggled ? getSignedFormat(ioFormats[offset+i]) : ioFormats[offset+i]);
+        formats[i] = (isSigned ? getPromotedSignedFormat(format, values[i].as_sint64) : getPromotedUnsignedFormat(format, values[i].as_uint64));
+      }
+      memcpy(ioFormats + offset, formats, count);
+    }
+  }
+
+  template <Variant::MATH_OPERATOR op, class T>
+  inline static void processFloat32Column(Variant::VariantUnion * ioValues, const T & iOperand, size_t iSize, bool iSkipDivisionByZero)
+  {
+    for(size_t i=0; i<iSize; i++)
+      ioValues[i].as_float32 = applyFloatOperator<op>(ioValues[i].as_float32, iOperand[i].as_float32, iSkipDivisionByZero);
+  }
+
+  template <Variant::MATH_OPERATOR op, class T>
+  inline static void processFloat64Column(Variant::VariantUnion * ioValues, const T & iOperand, size_t iSize, bool iSkipDivisionByZero)
+  {
+    for(size_t i=0; i<iSize; i++)
+      ioValues[i].as_float64 = applyFloatOperator<op>(ioValues[i].as_float64, iOperand[i].as_float64, iSkipDivisionByZero);
+  }
+
+  template <Variant::MATH_OPERATOR op, class T>
+  inline static void processMixedFloatColumn(uint8 * ioFormats, Variant::VariantUnion * ioValues, const ColumnOperand & iLocal, uint32 iLocalFormats, const T & iOperand, uint32 iOperandFormats, size_t iSize, bool iSkipDivisionByZero)
+  {
+    //Rule #1 and #2: both values are elevated to float64
+    float64 left[FLOAT_BLOCK_SIZE];
+    float64 right[FLOAT_BLOCK_SIZE];
+    for(size_t offset=0; offset<iSize; offset+=FLOAT_BLOCK_SIZE)
+    {
+      const size_t count = (iSize - offset < FLOAT_BLOCK_SIZE ? iSize - offset : FLOAT_BLOCK_SIZE);
+      convertToFloat64(iLocal, iLocalFormats, offset, count, left);
+      convertToFloat64(iOperand, iOperandFormats, offset, count, right);
+      for(size_t i=0; i<count; i++)
+        ioValues[offset+i].as_float64 = applyFloatOperator<op>(left[i], right[i], iSkipDivisionByZero);
+      memset(ioFormats + offset, Variant::FLOAT64, count);
+    }
+  }
+
+  /// <summary>
+  /// Applies a math operator to a column of numeric values with an operand of numeric values.
+  /// The kernel is selected from the sets of formats of both columns and must match the kernel selected by Variant::processOperator() for each pair of values.
+  /// </summary>
+  /// <returns>Returns true if the operator was applied. Returns false if the values must be processed one at a time.</returns>
+  template <Variant::MATH_OPERATOR op, class T>
+  inline static bool processColumn(uint8 * ioFormats, Variant::VariantUnion * ioValues, const ColumnOperand & iLocal, uint32 iLocalFormats, const T & iOperand, uint32 iOperandFormats, size_t iSize)
+  {
+    const bool skipDivisionByZero = (Variant::getDivisionByZeroPolicy() != Variant::THROW);
+    if (!isSubset(iLocalFormats, NUMERIC_FORMATS) || !isSubset(iOperandFormats, NUMERIC_FORMATS))
+      return false;
+    if (iLocalFormats == FLOAT32_FORMATS && iOperandFormats == FLOAT32_FORMATS)
+    {
+      processFloat32Column<op>(ioValues, iOperand, iSize, skipDivisionByZero);
+      return true;
+    }
+    if (iLocalFormats == FLOAT64_FORMATS && iOperandFormats == FLOAT64_FORMATS)
+    {
+      processFloat64Column<op>(ioValues, iOperand, iSize, skipDivisionByZero);
+      return true;
+    }
+    if ((iLocalFormats & FLOAT_FORMATS) || (iOperandFormats & FLOAT_FORMATS))
+    {
+      //each pair of values must be processed by mixedFloatKernel() or float64Kernel() which give the same results
+      const bool mixed = isSubset(iLocalFormats, FLOAT64_FORMATS) || isSubset(iOperandFormats, FLOAT64_FORMATS) ||
+                         (isSubset(iLocalFormats, FLOAT_FORMATS) && isSubset(iOperandFormats, INTEGER_FORMATS)) ||
+                         (isSubset(iLocalFormats, INTEGER_FORMATS) && isSubset(iOperandFormats, FLOAT_FORMATS));
+      if (!mixed)
+        return false;
+      processMixedFloatColumn<op>(ioFormats, ioValues, iLocal, iLocalFormats, iOperand, iOperandFormats, iSize, skipDivisionByZero);
+      return true;
+    }
+
+    //integer divisions may be promoted to float64 (Rule #5) and are processed by the Variant class
+    if (op == Variant::DIVIDE_EQUAL)
+      return false;
+
+    if (isSubset(iLocalFormats, UNSIGNED_FORMATS) && isSubset(iOperandFormats, UNSIGNED_FORMATS))
+      processIntegerColumn<op, false, false>(ioFormats, ioValues, iOperand, iSize);
+    else if (isSubset(iLocalFormats, SIGNED_FORMATS))
+      processIntegerColumn<op, true, false>(ioFormats, ioValues, iOperand, iSize);
+    else if (isSubset(iLocalFormats, UNSIGNED_FORMATS) && isSubset(iOperandFormats, SIGNED_FORMATS))
+      processIntegerColumn<op, true, true>(ioFormats, ioValues, iOperand, iSize);
+    else
+      return false;
+    return true;
+  }
+
+  static const size_t SELECT_BLOCK_SIZE = 256; //number of comparison results computed before they are packed. Must be a multiple of 64.
+
+  /// <summary>
+  /// The results of a comparison which match a comparison operator.
+  /// Each field is 1 if the operator matches the result or 0 otherwise.
+  /// </summary>
+  struct CompareMask
+  {
+    uint8 less;
+    uint8 equal;
+    uint8 greater;
+  };
+
+  inline static CompareMask getCompareMask(VariantArray::COMPARE_OPERATOR iOperator)
+  {
+    CompareMask mask = { 0, 0, 0 };
+    switch(iOperator)
+    {
+    case VariantArray::EQUAL:
+      mask.equal = 1;
+      break;
+    case VariantArray::NOT_EQUAL:
+      mask.less = mask.greater = 1;
+      break;
+    case VariantArray::LESS:
+      mask.less = 1;
+      break;
+    case VariantArray::LESS_EQUAL:
+      mask.less = mask.equal = 1;
+      break;
+    case VariantArray::GREATER:
+      mask.greater = 1;
+      break;
+    case VariantArray::GREATER_EQUAL:
+      mask.greater = mask.equal = 1;
+      break;
+    default:
+      assert( false ); /*error should not happen*/
+      break;
+    };
+    return mask;
+  }
+
+  /// <summary>
+  /// Returns 1 if the result of a comparison matches a comparison operator or 0 otherwise.
+  /// </summary>
+  inline static uint8 isMatching(const CompareMask & iMask, bool iLess, bool iGreater)
+  {
+    return static_cast<uint8>((iLess & iMask.less) | (iGreater & iMask.greater) | (((iLess | iGreater) == 0) & iMask.equal));
+  }
+
+  /// <summary>
+  /// Packs 8 bytes of value 0 or 1 into the 8 lowest bits of an integer. The first byte is the lowest bit.
+  /// </summary>
+  inline static uint64 packBits(const uint8 * iValues)
+  {
+    const uint64 bytes = (uint64)iValues[0]       | (uint64)iValues[1] <<  8 | (uint64)iValues[2] << 16 | (uint64)iValues[3] << 24 |
+                         (uint64)iValues[4] << 32 | (uint64)iValues[5] << 40 | (uint64)iValues[6] << 48 | (uint64)iValues[7] << 56;
+    //the multiplication moves the lowest bit of each byte to the highest byte without carry
+    return (bytes * 0x0102040810204080ull) >> 56;
+  }
+
+  /// <summary>
+  /// Compares a run of numeric values of the same format with numeric values of the same format.
+  /// The comparison uses the native C++ operators like compareNativeTypes(). The loop has no branch and can be vectorized by the compiler.
+  /// </summary>
+  template <int localFormat, int operandFormat, class T>
+  inline static void compareNumericRun(const CompareMask & iMask, const Variant::VariantUnion * iValues, const T & iOperand, size_t iOffset, size_t iCount, uint8 * oResults)
+  {
+    typedef CompareTraits<localFormat> Local;
+    typedef CompareTraits<operandFormat> Remote;
+
+    //the usual arithmetic conversions of the built-in operators, made explicit. ie: a sint8 compared to a uint32 is converted to uint32
+    typedef typename std::common_type<typename Local::local_type, typename Remote::remote_type>::type common_type;
+
+    for(size_t i=0; i<iCount; i++)
+    {
+      const common_type localValue = static_cast<common_type>(static_cast<typename Local::local_type>(Local::get(iValues[iOffset+i])));
+      const common_type remoteValue = static_cast<common_type>(static_cast<typename Remote::remote_type>(Remote::get(iOperand[iOffset+i])));
+      oResults[i] = isMatching(iMask, localValue < remoteValue, localValue > remoteValue);
+    }
+  }
+
+  template <int localFormat, class T>
+  inline static void compareNumericRun(uint8 iOperandFormat, const CompareMask & iMask, const Variant::VariantUnion * iValues, const T & iOperand, size_t iOffset, size_t iCount, uint8 * oResults)
+  {
+    switch(iOperandFormat)
+    {
+    case Variant::BOOL:    compareNumericRun<localFormat, Variant::BOOL   >(iMask, iValues, iOperand, iOffset, iCount, oResults); break;
+    case Variant::UINT8:   compareNumericRun<localFormat, Variant::UINT8  >(iMask, iValues, iOperand, iOffset, iCount, oResults); break;
+    case Variant::UINT16:  compareNumericRun<localFormat, Variant::UINT16 >(iMask, iValues, iOperand, iOffset, iCount, oResults); break;
+    case Variant::UINT32:  compareNumericRun<localFormat, Variant::UINT32 >(iMask, iValues, iOperand, iOffset, iCount, oResults); break;
+    case Variant::UINT64:  compareNumericRun<localFormat, Variant::UINT64 >(iMask, iValues, iOperand, iOffset, iCount, oResults); break;
+    case Variant::SINT8:   compareNumericRun<localFormat, Variant::SINT8  >(iMask, iValues, iOperand, iOffset, iCount, oResults); break;
+    case Variant::SINT16:  compareNumericRun<localFormat, Variant::SINT16 >(iMask, iValues, iOperand, iOffset, iCount, oResults); break;
+    case Variant::SINT32:  compareNumericRun<localFormat, Variant::SINT32 >(iMask, iValues, iOperand, iOffset, iCount, oResults); break;
+    case Variant::SINT64:  compareNumericRun<localFormat, Variant::SINT64 >(iMask, iValues, iOperand, iOffset, iCount, oResults); break;
+    case Variant::FLOAT32: compareNumericRun<localFormat, Variant::FLOAT32>(iMask, iValues, iOperand, iOffset, iCount, oResults); break;
+    case Variant::FLOAT64: compareNumericRun<localFormat, Variant::FLOAT64>(iMask, iValues, iOperand, iOffset, iCount, oResults); break;
+    default:
+      assert( false ); /*error should not happen*/
+      break;
+    };
+  }
+
+  template <class T>
+  inline static void compareNumericRun(uint8 iLocalFormat, uint8 iOperandFormat, const CompareMask & iMask, const Variant::VariantUnion * iValues, const T & iOperand, size_t iOffset, size_t iCount, uint8 * oResults)
+  {
+    switch(iLocalFormat)
+    {
+    case Variant::BOOL:    compareNumericRun<Variant::BOOL   >(iOperandFormat, iMask, iValues, iOperand, iOffset, iCount, oResults); break;
+    case Variant::UINT8:   compareNumericRun<Variant::UINT8  >(iOperandFormat, iMask, iValues, iOperand, iOffset, iCount, oResults); break;
+    case Variant::UINT16:  compareNumericRun<Variant::UINT16 >(iOperandFormat, iMask, iValues, iOperand, iOffset, iCount, oResults); break;
+    case Variant::UINT32:  compareNumericRun<Variant::UINT32 >(iOperandFormat, iMask, iValues, iOperand, iOffset, iCount, oResults); break;
+    case Variant::UINT64:  compareNumericRun<Variant::UINT64 >(iOperandFormat, iMask, iValues, iOperand, iOffset, iCount, oResults); break;
+    case Variant::SINT8:   compareNumericRun<Variant::SINT8  >(iOperandFormat, iMask, iValues, iOperand, iOffset, iCount, oResults); break;
+    case Variant::SINT16:  compareNumericRun<Variant::SINT16 >(iOperandFormat, iMask, iValues, iOperand, iOffset, iCount, oResults); break;
+    case Variant::SINT32:  compareNumericRun<Variant::SINT32 >(iOperandFormat, iMask, iValues, iOperand, iOffset, iCount, oResults); break;
+    case Variant::SINT64:  compareNumericRun<Variant::SINT64 >(iOperandFormat, iMask, iValues, iOperand, iOffset, iCount, oResults); break;
+    case Variant::FLOAT32: compareNumericRun<Variant::FLOAT32>(iOperandFormat, iMask, iValues, iOperand, iOffset, iCount, oResults); break;
+    case Variant::FLOAT64: compareNumericRun<Variant::FLOAT64>(iOperandFormat, iMask, iValues, iOperand, iOffset, iCount, oResults); break;
+    default:
+      assert( false ); /*error should not happen*/
+      break;
+    };
+  }
+
+  inline static bool isSameFormat(const ColumnOperand & iValues, size_t iOffset, size_t iCount, uint8 iFormat) { return isSameFormat(iValues.formats + iOffset, iCount, iFormat); }
+  inline static bool isSameFormat(const ScalarOperand & /*iValue*/, size_t /*iOffset*/, size_t /*iCount*/, uint8 /*iFormat*/) { return true; }
+
+  /// <summary>
+  /// Selects the values of a column which match a comparison with the values of an operand.
+  /// The values are processed by blocks. A block of values of mixed formats is split in runs of values whose formats do not change.
+  /// </summary>
+  template <class T>
+  inline static void selectColumn(const CompareMask & iMask, const ColumnOperand & iLocal, const T & iOperand, size_t iSize, uint64 * oSelection)
+  {
+    //the results are padded with zeros up to a multiple of 8 values
+    uint8 results[SELECT_BLOCK_SIZE];
+    for(size_t offset=0; offset<iSize; offset+=SELECT_BLOCK_SIZE)
+    {
+      const size_t count = (iSize - offset < SELECT_BLOCK_SIZE ? iSize - offset : SELECT_BLOCK_SIZE);
+
+      size_t first = 0;
+      while(first < count)
+      {
+        const uint8 localFormat = iLocal.getFormat(offset+first);
+        const uint8 operandFormat = iOperand.getFormat(offset+first);
+        size_t last = count;
+        if (first > 0 || !isSameFormat(iLocal, offset, count, localFormat) || !isSameFormat(iOperand, offset, count, operandFormat))
+        {
+          last = first + 1;
+          while(last < count && iLocal.getFormat(offset+last) == localFormat && iOperand.getFormat(offset+last) == operandFormat)
+            last++;
+        }
+
+        if (localFormat != Variant::STRING && operandFormat != Variant::STRING)
+          compareNumericRun(localFormat, operandFormat, iMask, iLocal.values, iOperand, offset+first, last-first, results+first);
+        else
+        {
+          //strings must be simplified or converted. Delegate to the Variant class.
+          for(size_t i=first; i<last; i++)
+          {
+            const int result = iLocal.getView(offset+i).compare(iOperand.getView(offset+i));
+            results[i] = isMatching(iMask, result < 0, result > 0);
+          }
+        }
+        first = last;
+      }
+
+      //pack the results
+      const size_t padded = (count + 7) / 8 * 8;
+      memset(results + count, 0, padded - count);
+      for(size_t i=0; i<padded; i+=64)
+      {
+        const size_t bytes = (padded - i < 64 ? padded - i : 64);
+        uint64 word = 0;
+        for(size_t j=0; j<bytes; j+=8)
+          word |= packBits(results + i + j) << j;
+        oSelection[(offset+i) / 64] = word;
+      }
+    }
+  }
+
+  VariantArray::VariantArray()
+  {
+  }
+
+  VariantArray::VariantArray(size_t iSize)
+  {
+    resize(iSize);
+  }
+
+  //----------------
+  // public methods
+  //----------------
+  void VariantArray::reserve(size_t iSize, size_t iStringsSize)
+  {
+    mFormats.reserve(iSize);
+    mValues.reserve(iSize);
+    mStrings.reserve(iStringsSize);
+  }
+
+  void VariantArray::resize(size_t iSize)
+  {
+    Variant::VariantUnion zero;
+    zero.as_bits = 0;
+    mFormats.resize(iSize, static_cast<uint8>(Variant::UINT8));
+    mValues.resize(iSize, zero);
+  }
+
+  void VariantArray::clear()
+  {
+    mFormats.clear();
+    mValues.clear();
+    mStrings.clear();
+  }
+
+  void VariantArray::swap(VariantArray & iValue) noexcept
+  {
+    mFormats.swap(iValue.mFormats);
+    mValues.swap(iValue.mValues);
+    mStrings.swap(iValue.mStrings);
+  }
+
+  void VariantArray::push_back(const Variant & iValue)
+  {
+    if (VariantAccess::getFormat(iValue) == Variant::STRING)
+    {
+      push_back(VariantAccess::getStringBuffer(iValue), VariantAccess::getStringLength(iValue));
+      return;
+    }
+    mFormats.push_back(static_cast<uint8>(VariantAccess::getFormat(iValue)));
+    mValues.push_back(VariantAccess::getValue(iValue));
+  }
+
+  void VariantArray::push_back(const CStr & iValue)
+  {
+    push_back(iValue, (iValue == NULL ? 0 : strlen(iValue)));
+  }
+
+  void VariantArray::push_back(const Str & iValue)
+  {
+    push_back(iValue.c_str(), iValue.size());
+  }
+
+  void VariantArray::push_back(const char * iValue, size_t iLength)
+  {
+    Variant::VariantUnion value = appendString(iValue, iLength);
+    mFormats.push_back(static_cast<uint8>(Variant::STRING));
+    mValues.push_back(value);
+  }
+
+  VariantArray::Reference VariantArray::operator[](size_t iIndex)
+  {
+    assert( iIndex < size() );
+    return Reference(*this, iIndex);
+  }
+
+  VariantArray::ConstReference VariantArray::operator[](size_t iIndex) const
+  {
+    assert( iIndex < size() );
+    return ConstReference(*this, iIndex);
+  }
+
+  Variant VariantArray::get(size_t iIndex) const
+  {
+    Variant value = getView(iIndex);
+    value.materialize();
+    return value;
+  }
+
+  Variant VariantArray::getView(size_t iIndex) const
+  {
+    assert( iIndex < size() );
+    Variant value;
+    if (mFormats[iIndex] == Variant::STRING)
+    {
+      size_t length = 0;
+      const char * buffer = getStringBuffer(iIndex, length);
+      value.setStringView(buffer, length);
+      return value;
+    }
+    VariantAccess::setValue(value, static_cast<Variant::VariantFormat>(mFormats[iIndex]), mValues[iIndex]);
+    return value;
+  }
+
+  void VariantArray::set(size_t iIndex, const Variant & iValue)
+  {
+    assert( iIndex < size() );
+    if (VariantAccess::getFormat(iValue) == Variant::STRING)
+    {
+      set(iIndex, VariantAccess::getStringBuffer(iValue), VariantAccess::getStringLength(iValue));
+      return;
+    }
+    mFormats[iIndex] = static_cast<uint8>(VariantAccess::getFormat(iValue));
+    mValues[iIndex] = VariantAccess::getValue(iValue);
+  }
+
+  void VariantArray::set(size_t iIndex, const char * iValue, size_t iLength)
+  {
+    assert( iIndex < size() );
+    mValues[iIndex] = appendString(iValue, iLength);
+    mFormats[iIndex] = static_cast<uint8>(Variant::STRING);
+  }
+
+  bool VariantArray::isHomogeneous(Variant::VariantFormat & oFormat) const
+  {
+    if (mFormats.empty())
+      return false;
+
+    const uint8 format = mFormats[0];
+    for(size_t i=1; i<mFormats.size(); i++)
+    {
+      if (mFormats[i] != format)
+        return false;
+    }
+    oFormat = static_cast<Variant::VariantFormat>(format);
+    return true;
+  }
+
+  void VariantArray::compact()
+  {
+    std::vector<char> previous;
+    previous.swap(mStrings);
+    for(size_t i=0; i<mFormats.size(); i++)
+    {
+      if (mFormats[i] != Variant::STRING)
+        continue;
+      STRING_LENGTH_TYPE length = 0;
+      const char * buffer = &previous[mValues[i].as_uint64];
+      memcpy(&length, buffer, sizeof(length));
+      mValues[i] = appendString(buffer + sizeof(length), length);
+    }
+    std::vector<char>(mStrings).swap(mStrings); //release unused capacity
+  }
+
+  void VariantArray::reorder(const std::vector<size_t> & iOrder)
+  {
+    assert( iOrder.size() == mFormats.size() );
+    std::vector<uint8> formats(mFormats.size());
+    std::vector<Variant::VariantUnion> values(mValues.size());
+    for(size_t i=0; i<iOrder.size(); i++)
+    {
+      assert( iOrder[i] < mFormats.size() );
+      formats[i] = mFormats[iOrder[i]];
+      values[i] = mValues[iOrder[i]];
+    }
+    mFormats.swap(formats);
+    mValues.swap(values);
+  }
+
+  //----------------------
+  //   operators
+  //----------------------
+  VariantArray & VariantArray::operator += (const VariantArray & iValues) { processOperator(Variant::PLUS_EQUAL    , iValues); return (*this); }
+  VariantArray & VariantArray::operator -= (const VariantArray & iValues) { processOperator(Variant::MINUS_EQUAL   , iValues); return (*this); }
+  VariantArray & VariantArray::operator *= (const VariantArray & iValues) { processOperator(Variant::MULTIPLY_EQUAL, iValues); return (*this); }
+  VariantArray & VariantArray::operator /= (const VariantArray & iValues) { processOperator(Variant::DIVIDE_EQUAL  , iValues); return (*this); }
+
+  VariantArray & VariantArray::operator += (const Variant & iValue) { processOperator(Variant::PLUS_EQUAL    , iValue); return (*this); }
+  VariantArray & VariantArray::operator -= (const Variant & iValue) { processOperator(Variant::MINUS_EQUAL   , iValue); return (*this); }
+  VariantArray & VariantArray::operator *= (const Variant & iValue) { processOperator(Variant::MULTIPLY_EQUAL, iValue); return (*this); }
+  VariantArray & VariantArray::operator /= (const Variant & iValue) { processOperator(Variant::DIVIDE_EQUAL  , iValue); return (*this); }
+
+  void VariantArray::select(COMPARE_OPERATOR iOperator, const Variant & iValue, Bitmap & oSelection) const
+  {
+    oSelection.assign((size() + 63) / 64, 0);
+    if (empty())
+      return;
+
+    //a string argument which has a native representation is compared with the native values of the array as a native value.
+    //The original string is still used for comparing with string values.
+    ScalarOperand operand = { &iValue, static_cast<uint8>(VariantAccess::getFormat(iValue)), VariantAccess::getValue(iValue) };
+    Variant::VariantFormat simplifiedFormat;
+    Variant::VariantUnion simplifiedValue;
+    if (VariantAccess::getFormat(iValue) == Variant::STRING && VariantAccess::getSimplifiedValue(iValue, simplifiedFormat, simplifiedValue))
+    {
+      operand.format = static_cast<uint8>(simplifiedFormat);
+      operand.value = simplifiedValue;
+    }
+
+    const ColumnOperand local = { this, &mFormats[0], &mValues[0] };
+    selectColumn(getCompareMask(iOperator), local, operand, size(), &oSelection[0]);
+  }
+
+  void VariantArray::select(COMPARE_OPERATOR iOperator, const VariantArray & iValues, Bitmap & oSelection) const
+  {
+    assert( iValues.size() == size() );
+    oSelection.assign((size() + 63) / 64, 0);
+    if (empty())
+      return;
+
+    const ColumnOperand local = { this, &mFormats[0], &mValues[0] };
+    const ColumnOperand operand = { &iValues, &iValues.mFormats[0], &iValues.mValues[0] };
+    selectColumn(getCompareMask(iOperator), local, operand, size(), &oSelection[0]);
+  }
+
+  size_t VariantArray::countSelected(const Bitmap & iSelection)
+  {
+    size_t count = 0;
+    for(size_t i=0; i<iSelection.size(); i++)
+    {
+      //count the bits of a word in parallel
+      uint64 word = iSelection[i];
+      word = word - ((word >> 1) & 0x5555555555555555ull);
+      word = (word & 0x3333333333333333ull) + ((word >> 2) & 0x3333333333333333ull);
+      word = (word + (word >> 4)) & 0x0F0F0F0F0F0F0F0Full;
+      count += static_cast<size_t>((word * 0x0101010101010101ull) >> 56);
+    }
+    return count;
+  }
+
+  const char * VariantArray::getStringBuffer(size_t iIndex, size_t & oLength) const
+  {
+    assert( iIndex < size() && mFormats[iIndex] == Variant::STRING );
+    const char * buffer = &mStrings[mValues[iIndex].as_uint64];
+    STRING_LENGTH_TYPE length = 0;
+    memcpy(&length, buffer, sizeof(length));
+    oLength = length;
+    return buffer + sizeof(length);
+  }
+
+  //----------------
+  // private methods
+  //----------------
+  void VariantArray::processOperator(Variant::MATH_OPERATOR iOperator, const VariantArray & iValues)
+  {
+    assert( iValues.size() == size() );
+    ColumnOperand operand = { &iValues, iValues.getFormats(), iValues.getValues() };
+    processOperands(iOperator, operand, getFormatSet(iValues.getFormats(), iValues.size()));
+  }
+
+  void VariantArray::processOperator(Variant::MATH_OPERATOR iOperator, const Variant & iValue)
+  {
+    //the value may borrow characters of the array which may be moved by the operator
+    Variant value = iValue;
+    value.materialize();
+    ScalarOperand operand = { &value, static_cast<uint8>(VariantAccess::getFormat(value)), VariantAccess::getValue(value) };
+    processOperands(iOperator, operand, (1u << VariantAccess::getFormat(value)));
+  }
+
+  template <class T>
+  void VariantArray::processOperands(Variant::MATH_OPERATOR iOperator, const T & iOperand, uint32 iOperandFormats)
+  {
+    if (empty())
+      return;
+
+    const ColumnOperand local = { this, &mFormats[0], &mValues[0] };
+    const uint32 localFormats = getFormatSet(&mFormats[0], size());
+    bool processed = false;
+    switch(iOperator)
+    {
+    case Variant::PLUS_EQUAL:
+      processed = processColumn<Variant::PLUS_EQUAL    >(&mFormats[0], &mValues[0], local, localFormats, iOperand, iOperandFormats, size());
+      break;
+    case Variant::MINUS_EQUAL:
+      processed = processColumn<Variant::MINUS_EQUAL   >(&mFormats[0], &mValues[0], local, localFormats, iOperand, iOperandFormats, size());
+      break;
+    case Variant::MULTIPLY_EQUAL:
+      processed = processColumn<Variant::MULTIPLY_EQUAL>(&mFormats[0], &mValues[0], local, localFormats, iOperand, iOperandFormats, size());
+      break;
+    case Variant::DIVIDE_EQUAL:
+      processed = processColumn<Variant::DIVIDE_EQUAL  >(&mFormats[0], &mValues[0], local, localFormats, iOperand, iOperandFormats, size());
+      break;
+    default:
+      assert( false ); /*error should not happen*/
+      break;
+    };
+    if (processed)
+      return;
+
+    //process one value at a time
+    for(size_t i=0; i<size(); i++)
+    {
+      Variant value = getView(i);
+      VariantAccess::processOperator(value, iOperator, iOperand.getView(i));
+
+      //a string view which is still a view was not modified
+      if (!value.isStringView())
+        set(i, value);
+    }
+  }
+
+  Variant::VariantUnion VariantArray::appendString(const char * iValue, size_t iLength)
+  {
+    assert( iLength == static_cast<STRING_LENGTH_TYPE>(iLength) );
+
+    const size_t offset = mStrings.size();
+    const size_t required = offset + sizeof(STRING_LENGTH_TYPE) + iLength;
+    const STRING_LENGTH_TYPE length = static_cast<STRING_LENGTH_TYPE>(iLength);
+
+    //iValue may point into mStrings (ie: arr[1] = arr[0]). Keep the current buffer alive until the characters are copied.
+    std::vector<char> strings;
+    if (required > mStrings.capacity())
+    {
+      strings.reserve(required > 2 * mStrings.capacity() ? required : 2 * mStrings.capacity());
+      strings.assign(mStrings.begin(), mStrings.end());
+      strings.swap(mStrings);
+    }
+    mStrings.resize(required);
+    memcpy(&mStrings[offset], &length, sizeof(length));
+    if (iLength > 0)
+      memcpy(&mStrings[offset + sizeof(length)], iValue, iLength);
+
+    Variant::VariantUnion value;
+    value.as_uint64 = offset;
+    return value;
+  }
+
+} // End of namespace
@@ -27,7 +27,7 @@
 // Include Files
 //---------------
 #include "libvariant/variant_string.h"
-#include <string>
+#include <string.h> // memcpy, memmove, memcmp, strlen
 
 //-----------
 // Namespace
@@ -35,33 +35,104 @@
 
 namespace libVariant
 {
-  struct String::PImpl
-  {
-    std::string str;
-  };
-
   String::String() :
-    m_pimpl( new String::PImpl() )
+    m_size(0),
+    m_capacity(INLINE_CAPACITY)
   {
+    m_inline[0] = '\0';
   }
 
   String::String(const String & iValue) :
-    m_pimpl( new String::PImpl() )
+    m_size(0),
+    m_capacity(INLINE_CAPACITY)
+  {
+    m_inline[0] = '\0';
+    assignCharacters(iValue.c_str(), iValue.size());
+  }
+
+  String::String(String && iValue) noexcept :
+    m_size(0),
+    m_capacity(INLINE_CAPACITY)
   {
-    (*this) = iValue;
+    m_inline[0] = '\0';
+    swap(iValue);
   }
 
   String::String(const char * iValue) :
-    m_pimpl( new String::PImpl() )
+    m_size(0),
+    m_capacity(INLINE_CAPACITY)
+  {
+    m_inline[0] = '\0';
+    if (iValue)
+      assignCharacters(iValue, strlen(iValue));
+  }
+
+  String::String(const char * iValue, size_t iLength) :
+    m_size(0),
+    m_capacity(INLINE_CAPACITY)
   {
-    (*this) = iValue;
+    m_inline[0] = '\0';
+    assignCharacters(iValue, iLength);
   }
 
   String::~String()
   {
-    if (m_pimpl)
-      delete m_pimpl;
-    m_pimpl = NULL;
+    releaseBuffer();
+  }
+
+  //----------------
+  // private methods
+  //----------------
+  void String::assignCharacters(const char * iValue, size_t iLength)
+  {
+    if (iLength > m_capacity)
+      iValue = grow(iLength, iValue);
+
+    char * buffer = getBuffer();
+    memmove(buffer, iValue, iLength); //iValue may point to the current characters
+    buffer[iLength] = '\0';
+    m_size = iLength;
+  }
+
+  const char * String::grow(size_t iCapacity, const char * iValue)
+  {
+    const char * previous = c_str();
+    const bool isOwnCharacters = (iValue >= previous && iValue <= previous + m_size);
+    const size_t offset = (isOwnCharacters ? static_cast<size_t>(iValue - previous) : 0);
+
+    Allocator & allocator = Allocator::getCurrent();
+    char * buffer = static_cast<char *>(allocator.allocate(iCapacity + 1));
+    memcpy(buffer, previous, m_size + 1);
+    releaseBuffer();
+    m_heap.characters = buffer;
+    m_heap.allocator = &allocator;
+    m_capacity = iCapacity;
+
+    return (isOwnCharacters ? buffer + offset : iValue);
+  }
+
+  void String::releaseBuffer()
+  {
+    if (!isInline())
+      m_heap.allocator->deallocate(m_heap.characters, m_capacity + 1);
+  }
+
+  /// <summary>
+  /// Compares two character sequences the same way std::string::compare() does.
+  /// </summary>
+  static inline int compareStrings(const String & iValue1, const String & iValue2)
+  {
+    const size_t length1 = iValue1.size();
+    const size_t length2 = iValue2.size();
+    const size_t length = (length1 < length2 ? length1 : length2);
+    int result = memcmp(iValue1.c_str(), iValue2.c_str(), length);
+    if (result != 0)
+      return result;
+    if (length1 < length2)
+      return -1;
+    if (length1 > length2)
+      return +1;
+    return 0;
   }
 
   //----------------
@@ -69,76 +140,133 @@ namespace libVariant
   //----------------
   size_t String::size() const
   {
-    size_t output = m_pimpl->str.size();
-    return output;
+    return m_size;
   }
 
   const char * String::c_str() const
   {
-    const char * output = m_pimpl->str.c_str();
-    return output;
+    return (isInline() ? m_inline : m_heap.characters);
+  }
+
+  size_t String::capacity() const
+  {
+    return m_capacity;
+  }
+
+  void String::reserve(size_t iCapacity)
+  {
+    if (iCapacity <= m_capacity)
+      return;
+    grow(iCapacity, NULL);
   }
 
   String & String::append(const char * iValue)
   {
-    if (this->m_pimpl->str.c_str() != iValue)
-      m_pimpl->str.append( iValue );
+    if (iValue)
+      append(iValue, strlen(iValue));
     return (*this);
   }
 
   String & String::append(const String & iValue)
   {
-    if (this->m_pimpl->str.c_str() != iValue.m_pimpl->str.c_str())
-      m_pimpl->str.append( iValue.m_pimpl->str );
+    return append(iValue.c_str(), iValue.size());
+  }
+
+  String & String::append(const char * iValue, size_t iLength)
+  {
+    const size_t length = m_size + iLength;
+    if (length > m_capacity)
+    {
+      size_t capacity = m_capacity * 2;
+      iValue = grow(length > capacity ? length : capacity, iValue);
+    }
+
+    char * buffer = getBuffer();
+    memmove(&buffer[m_size], iValue, iLength); //iValue may point to the current characters
+    buffer[length] = '\0';
+    m_size = length;
     return (*this);
   }
 
+  void String::swap(String & iValue) noexcept
+  {
+    if (this == &iValue)
+      return;
+
+    size_t size = m_size;
+    m_size = iValue.m_size;
+    iValue.m_size = size;
+
+    size_t capacity = m_capacity;
+    m_capacity = iValue.m_capacity;
+    iValue.m_capacity = capacity;
+
+    //exchange the inline characters or the heap buffers
+    static_assert(sizeof(m_inline) >= sizeof(m_heap), "the inline characters must cover the heap buffer");
+    char buffer[sizeof(m_inline)];
+    memcpy(buffer, m_inline, sizeof(m_inline));
+    memcpy(m_inline, iValue.m_inline, sizeof(m_inline));
+    memcpy(iValue.m_inline, buffer, sizeof(m_inline));
+  }
+
   //----------------------
   //   operators
   //----------------------
   const String & String::operator = (const String & iValue)
   {
     if (this != &iValue)
-      m_pimpl->str = iValue.m_pimpl->str;
+      assignCharacters(iValue.c_str(), iValue.size());
+    return (*this);
+  }
+
+  const String & String::operator = (String && iValue) noexcept
+  {
+    if (this != &iValue)
+    {
+      String tmp;
+      swap(iValue);
+      iValue.swap(tmp); //iValue is left empty
+    }
     return (*this);
   }
 
   const String & String::operator = (const char * iValue)
   {
-    if (this->m_pimpl->str.c_str() != iValue)
-      m_pimpl->str = iValue;
+    if (iValue == NULL)
+      assignCharacters("", 0);
+    else
+      assignCharacters(iValue, strlen(iValue));
     return (*this);
   }
 
   bool String::operator == (const String & iValue) const
   {
-    return m_pimpl->str == iValue.m_pimpl->str;
+    return compareStrings(*this, iValue) == 0;
   }
 
   bool String::operator != (const String & iValue) const
   {
-    return m_pimpl->str != iValue.m_pimpl->str;
+    return compareStrings(*this, iValue) != 0;
   }
 
   bool String::operator <  (const String & iValue) const
   {
-    return m_pimpl->str < iValue.m_pimpl->str;
+    return compareStrings(*this, iValue) <  0;
   }
 
   bool String::operator >  (const String & iValue) const
   {
-    return m_pimpl->str > iValue.m_pimpl->str;
+    return compareStrings(*this, iValue) >  0;
   }
 
   bool String::operator <= (const String & iValue) const
   {
-    return m_pimpl->str <= iValue.m_pimpl->str;
+    return compareStrings(*this, iValue) <= 0;
   }
 
   bool String::operator >= (const String & iValue) const
   {
-    return m_pimpl->str >= iValue.m_pimpl->str;
+    return compareStrings(*this, iValue) >= 0;
   }
-  
 
 } // End of namespace
@@ -0,0 +1,300 @@
+/**********************************************************************************
+ * MIT License
+ * 
+ * Copyright (c) 2018 Antoine Beauchamp
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+#include "TestAggregate.h"
+#include "libvariant/aggregate.h"
+#include <vector>
+
+using namespace libVariant;
+
+void TestAggregate::SetUp()
+{
+}
+
+void TestAggregate::TearDown()
+{
+}
+
+static Variant createValue(size_t iIndex, size_t iKind, bool iWithText)
+{
+  const uint32 number = static_cast<uint32>((iIndex * 7919) % 1000);
+  Variant value;
+  switch(iKind % 13)
+  {
+  case 0:  value = Variant(number % 2 == 0); break;
+  case 1:  value = Variant(static_cast<uint8>(number)); break;
+  case 2:  value = Variant(static_cast<uint16>(number * 60)); break;
+  case 3:  value = Variant(static_cast<uint32>(number * 100000)); break;
+  case 4:  value = Variant(static_cast<uint64>(static_cast<uint64>(number) * 10000000000ull)); break;
+  case 5:  value = Variant(static_cast<sint8>(number % 200) - 100); break;
+  case 6:  value = Variant(static_cast<sint16>(-static_cast<sint32>(number) * 30)); break;
+  case 7:  value = Variant(-static_cast<sint32>(number) * 1000); break;
+  case 8:  value = Variant(static_cast<sint64>(-static_cast<sint64>(number) * 10000000000ll)); break;
+  case 9:  value = Variant(number / 8.0f); break;
+  case 10: value = Variant(number / 3.0); break;
+  case 11: value.setString(Variant(number).getString()); break;
+  default: value = (iWithText && number % 3 == 0 ? Variant("foo") : Variant(number)); break;
+  };
+  return value;
+}
+
+static std::vector<Variant> createValues(size_t iSize, bool iWithText)
+{
+  //numbers of all formats, numeric strings and a few strings which are not numbers
+  std::vector<Variant> values;
+  for(size_t i=0; i<iSize; i++)
+    values.push_back(createValue(i, i, iWithText));
+  return values;
+}
+
+static void assertIdentical(const Variant & iExpected, const Variant & iActual)
+{
+  ASSERT_EQ( iExpected.getFormat(), iActual.getFormat() );
+  ASSERT_EQ( iExpected.getString(), iActual.getString() );
+}
+
+TEST_F(TestAggregate, testMatchVariant)
+{
+  //a range smaller than a chunk is aggregated like a sequence of Variant operations
+  static const size_t sizes[] = {1, 2, 13, 100, 5000};
+  for(size_t s=0; s<sizeof(sizes)/sizeof(sizes[0]); s++)
+  {
+    std::vector<Variant> all = createValues(sizes[s], true);
+
+    //only numbers, only integers and all values
+    for(size_t mode=0; mode<3; mode++)
+    {
+      std::vector<Variant> values;
+      for(size_t i=0; i<all.size(); i++)
+      {
+        const Variant::VariantFormat format = all[i].getFormat();
+        if (mode == 0 && format != Variant::FLOAT32 && format != Variant::FLOAT64 && format != Variant::STRING)
+          values.push_back(all[i]);
+        else if (mode == 1 && format != Variant::STRING)
+          values.push_back(all[i]);
+        else if (mode == 2)
+          values.push_back(all[i]);
+      }
+      if (values.empty())
+        continue;
+
+      Variant sum = values[0];
+      Variant minimum = values[0];
+      Variant maximum = values[0];
+      for(size_t i=1; i<values.size(); i++)
+      {
+        sum += values[i];
+        if (values[i] < minimum)
+          minimum = values[i];
+        if (values[i] > maximum)
+          maximum = values[i];
+      }
+      Variant mean = sum;
+      mean /= Variant(static_cast<uint64>(values.size()));
+
+      VariantArray array;
+      for(size_t i=0; i<values.size(); i++)
+        array.push_back(values[i]);
+
+      assertIdentical(sum, Aggregate::sum(&values[0], values.size()));
+      assertIdentical(minimum, Aggregate::minimum(&values[0], values.size()));
+      assertIdentical(maximum, Aggregate::maximum(&values[0], values.size()));
+      assertIdentical(mean, Aggregate::mean(&values[0], values.size()));
+      assertIdentical(sum, Aggregate::sum(array));
+      assertIdentical(minimum, Aggregate::minimum(array));
+      assertIdentical(maximum, Aggregate::maximum(array));
+      assertIdentical(mean, Aggregate::mean(array));
+      ASSERT_EQ( values.size(), Aggregate::count(array) );
+    }
+  }
+}
+
+TEST_F(TestAggregate, testNumberOfThreads)
+{
+  //results do not depend on the number of threads. The sum of text values is a long string which is slow to build.
+  std::vector<Variant> values = createValues(Aggregate::CHUNK_SIZE * 3 + 1234, false);
+  VariantArray array;
+  for(size_t i=0; i<values.size(); i++)
+    array.push_back(values[i]);
+
+  ThreadPool single(1);
+  ThreadPool multiple(4);
+  const Variant * range = &values[0];
+  assertIdentical(Aggregate::sum(range, values.size(), single), Aggregate::sum(range, values.size(), multiple));
+  assertIdentical(Aggregate::minimum(range, values.size(), single), Aggregate::minimum(range, values.size(), multiple));
+  assertIdentical(Aggregate::maximum(range, values.size(), single), Aggregate::maximum(range, values.size(), multiple));
+  assertIdentical(Aggregate::mean(range, values.size(), single), Aggregate::mean(range, values.size(), multiple));
+  ASSERT_EQ( Aggregate::countDistinct(range, values.size(), single), Aggregate::countDistinct(range, values.size(), multiple) );
+  assertIdentical(Aggregate::sum(range, values.size(), single), Aggregate::sum(array, NULL, multiple));
+  assertIdentical(Aggregate::minimum(range, values.size(), single), Aggregate::minimum(array, NULL, multiple));
+  assertIdentical(Aggregate::maximum(range, values.size(), single), Aggregate::maximum(array, NULL, multiple));
+  ASSERT_EQ( Aggregate::countDistinct(range, values.size(), single), Aggregate::countDistinct(array, NULL, multiple) );
+
+  //a large sum of integers
+  VariantArray integers;
+  for(size_t i=0; i<values.size(); i++)
+    integers.push_back(Variant(static_cast<uint32>(i)));
+  const uint64 n = values.size();
+  ASSERT_EQ( n * (n - 1) / 2, Aggregate::sum(integers, NULL, multiple).getUInt64() );
+  ASSERT_EQ( 0, Aggregate::minimum(integers, NULL, multiple).getUInt64() );
+  ASSERT_EQ( n - 1, Aggregate::maximum(integers, NULL, multiple).getUInt64() );
+  ASSERT_EQ( n, Aggregate::countDistinct(integers, NULL, multiple) );
+}
+
+TEST_F(TestAggregate, testBlocks)
+{
+  //runs of values of the same format are aggregated like a sequence of Variant operations
+  std::vector< std::vector<Variant> > sequences(4);
+  for(size_t i=0; i<13*700; i++)
+    sequences[0].push_back(createValue(i, i / 700, false));
+  for(size_t i=0; i<3000; i++)
+  {
+    //unsigned sums which wrap around
+    if (i == 0)
+      sequences[1].push_back(Variant(static_cast<uint64>(0xFFFFFFFFFFFE0000ull)));
+    else if (i < 2000)
+      sequences[1].push_back(Variant(static_cast<uint8>(i)));
+    else
+      sequences[1].push_back(Variant(static_cast<uint64>(0xFFFFFFFFFFFFFF00ull + i)));
+
+    //signed sums which are promoted
+    if (i < 1024)
+      sequences[2].push_back(Variant(static_cast<sint8>(i % 2 == 0 ? 100 : -100)));
+    else if (i < 2048)
+      sequences[2].push_back(Variant(static_cast<uint32>(i * 1000)));
+    else
+      sequences[2].push_back(Variant(static_cast<sint16>(-30000)));
+
+    //float sums
+    if (i < 1000)
+      sequences[3].push_back(Variant(i / 8.0f));
+    else
+      sequences[3].push_back(Variant(static_cast<uint32>(i)));
+  }
+
+  for(size_t s=0; s<sequences.size(); s++)
+  {
+    const std::vector<Variant> & values = sequences[s];
+    VariantArray array;
+    for(size_t i=0; i<values.size(); i++)
+      array.push_back(values[i]);
+
+    //all values, then all values but a few values of some blocks
+    VariantArray::Bitmap selection((values.size() + 63) / 64, ~0ull);
+    for(size_t i=0; i<values.size(); i++)
+      if (i % 1000 >= 500 && i % 1000 < 510)
+        selection[i / 64] &= ~(1ull << (i % 64));
+
+    for(size_t mode=0; mode<2; mode++)
+    {
+      const VariantArray::Bitmap * selected = (mode == 0 ? NULL : &selection);
+      bool empty = true;
+      Variant sum;
+      Variant minimum;
+      Variant maximum;
+      for(size_t i=0; i<values.size(); i++)
+      {
+        if (selected != NULL && !VariantArray::isSelected(*selected, i))
+          continue;
+        if (empty)
+        {
+          sum = minimum = maximum = values[i];
+          empty = false;
+          continue;
+        }
+        sum += values[i];
+        if (values[i] < minimum)
+          minimum = values[i];
+        if (values[i] > maximum)
+          maximum = values[i];
+      }
+
+      assertIdentical(sum, Aggregate::sum(array, selected));
+      assertIdentical(minimum, Aggregate::minimum(array, selected));
+      assertIdentical(maximum, Aggregate::maximum(array, selected));
+    }
+  }
+}
+
+TEST_F(TestAggregate, testSelection)
+{
+  VariantArray values;
+  for(int i=0; i<1000; i++)
+    values.push_back(Variant(i % 100));
+
+  VariantArray::Bitmap selection;
+  values.select(VariantArray::GREATER_EQUAL, Variant(90), selection);
+  ASSERT_EQ( 100, Aggregate::count(values, &selection) );
+  ASSERT_EQ( 9450, Aggregate::sum(values, &selection).getSInt32() );
+  ASSERT_EQ( 90, Aggregate::minimum(values, &selection).getSInt32() );
+  ASSERT_EQ( 99, Aggregate::maximum(values, &selection).getSInt32() );
+  ASSERT_EQ( 94.5, Aggregate::mean(values, &selection).getFloat64() );
+  ASSERT_EQ( 10, Aggregate::countDistinct(values, &selection) );
+
+  //nothing selected
+  values.select(VariantArray::LESS, Variant(0), selection);
+  ASSERT_EQ( 0, Aggregate::count(values, &selection) );
+  assertIdentical(Variant(), Aggregate::sum(values, &selection));
+  assertIdentical(Variant(), Aggregate::minimum(values, &selection));
+  assertIdentical(Variant(), Aggregate::mean(values, &selection));
+  ASSERT_EQ( 0, Aggregate::countDistinct(values, &selection) );
+}
+
+TEST_F(TestAggregate, testPromotion)
+{
+  //same promotion rules as Variant::operator +=
+  std::vector<Variant> values;
+  values.push_back(Variant(static_cast<uint8>(200)));
+  values.push_back(Variant(static_cast<uint8>(100)));
+  Variant sum = Aggregate::sum(&values[0], values.size());
+  ASSERT_EQ( Variant::UINT16, sum.getFormat() );
+  ASSERT_EQ( 300, sum.getUInt16() );
+
+  values.push_back(Variant(static_cast<sint8>(-1)));
+  sum = Aggregate::sum(&values[0], values.size());
+  ASSERT_EQ( Variant::SINT16, sum.getFormat() );
+  ASSERT_EQ( 299, sum.getSInt16() );
+
+  values.push_back(Variant(0.5f));
+  sum = Aggregate::sum(&values[0], values.size());
+  ASSERT_EQ( Variant::FLOAT64, sum.getFormat() );
+  ASSERT_EQ( 299.5, sum.getFloat64() );
+
+  //the mean of integers is an integer if the division is exact
+  std::vector<Variant> integers;
+  integers.push_back(Variant(1));
+  integers.push_back(Variant(2));
+  integers.push_back(Variant(3));
+  assertIdentical(Variant(2), Aggregate::mean(&integers[0], integers.size()));
+  assertIdentical(Variant(1.5), Aggregate::mean(&integers[0], 2));
+
+  //equal values of different formats are not distinct
+  std::vector<Variant> distinct;
+  distinct.push_back(Variant(1));
+  distinct.push_back(Variant(1.0));
+  distinct.push_back(Variant("1"));
+  distinct.push_back(Variant(2));
+  distinct.push_back(Variant("foo"));
+  distinct.push_back(Variant("foo"));
+  ASSERT_EQ( 3, Aggregate::countDistinct(&distinct[0], distinct.size()) );
+}
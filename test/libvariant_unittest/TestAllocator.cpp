@@ -0,0 +1,255 @@
+/**********************************************************************************
+ * MIT License
+ * 
+ * Copyright (c) 2018 Antoine Beauchamp
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+#include "TestAllocator.h"
+#include "libvariant/allocator.h"
+#include "libvariant/variant.h"
+#include <vector>
+#include <thread>
+#include <stdint.h>
+
+using namespace libVariant;
+
+void TestAllocator::SetUp()
+{
+}
+
+void TestAllocator::TearDown()
+{
+}
+
+/// <summary>
+/// An allocator which counts the allocations and deallocations.
+/// </summary>
+class CountingAllocator : public Allocator
+{
+public:
+  CountingAllocator() : allocations(0), deallocations(0) {}
+
+  virtual void * allocate(size_t iSize)
+  {
+    allocations++;
+    return Allocator::getDefault().allocate(iSize);
+  }
+
+  virtual void deallocate(void * iBuffer, size_t iSize)
+  {
+    deallocations++;
+    Allocator::getDefault().deallocate(iBuffer, iSize);
+  }
+
+  size_t allocations;
+  size_t deallocations;
+};
+
+static const char * LONG_STRING = "a string value which is longer than the inline storage";
+
+TEST_F(TestAllocator, testCurrentAllocator)
+{
+  ASSERT_EQ( &Allocator::getDefault(), &Allocator::getCurrent() );
+
+  CountingAllocator counter;
+  ArenaAllocator arena;
+  {
+    AllocatorScope scope1(counter);
+    ASSERT_EQ( &counter, &Allocator::getCurrent() );
+    {
+      AllocatorScope scope2(arena);
+      ASSERT_EQ( &arena, &Allocator::getCurrent() );
+
+      //other threads are not affected
+      Allocator * other = NULL;
+      std::thread t([&other]() { other = &Allocator::getCurrent(); });
+      t.join();
+      ASSERT_EQ( &Allocator::getDefault(), other );
+    }
+    ASSERT_EQ( &counter, &Allocator::getCurrent() );
+  }
+  ASSERT_EQ( &Allocator::getDefault(), &Allocator::getCurrent() );
+
+  Allocator::setCurrent(&counter);
+  ASSERT_EQ( &counter, &Allocator::getCurrent() );
+  Allocator::setCurrent(NULL);
+  ASSERT_EQ( &Allocator::getDefault(), &Allocator::getCurrent() );
+}
+
+TEST_F(TestAllocator, testVariantStrings)
+{
+  CountingAllocator counter;
+  {
+    AllocatorScope scope(counter);
+
+    //short strings are stored inline
+    Variant a = "short";
+    ASSERT_EQ( 0, counter.allocations );
+
+    Variant b = LONG_STRING;
+    ASSERT_EQ( 1, counter.allocations );
+
+    //copies share the string
+    Variant c = b;
+    ASSERT_EQ( 1, counter.allocations );
+
+    //copy on write
+    c += "!";
+    ASSERT_EQ( 2, counter.allocations );
+    ASSERT_TRUE( b == LONG_STRING );
+
+    //unique strings grow in place
+    c += "!";
+    ASSERT_EQ( 2, counter.allocations );
+  }
+
+  //memory is released by the allocator which allocated it
+  ASSERT_EQ( 2, counter.deallocations );
+  {
+    Variant v;
+    {
+      AllocatorScope scope(counter);
+      v = LONG_STRING;
+    }
+    ASSERT_EQ( 3, counter.allocations );
+  }
+  ASSERT_EQ( 3, counter.deallocations );
+}
+
+TEST_F(TestAllocator, testArena)
+{
+  ArenaAllocator arena(1024);
+  ASSERT_EQ( 0, arena.getAllocatedSize() );
+
+  //buffers are aligned and do not overlap
+  std::vector<char*> buffers;
+  for(size_t i=0; i<100; i++)
+  {
+    char * buffer = static_cast<char*>(arena.allocate(i+1));
+    ASSERT_EQ( 0, reinterpret_cast<uintptr_t>(buffer) % 16 );
+    memset(buffer, (int)i, i+1);
+    buffers.push_back(buffer);
+  }
+  for(size_t i=0; i<buffers.size(); i++)
+  {
+    for(size_t j=0; j<=i; j++)
+    {
+      ASSERT_EQ( (char)i, buffers[i][j] );
+    }
+  }
+
+  //large buffers
+  char * large = static_cast<char*>(arena.allocate(10000));
+  memset(large, 0, 10000);
+  char * small = static_cast<char*>(arena.allocate(16));
+  memset(small, 0, 16);
+  ASSERT_GT( arena.getAllocatedSize(), 10000 );
+
+  arena.reset();
+  ASSERT_EQ( 0, arena.getAllocatedSize() );
+  ASSERT_TRUE( arena.allocate(16) != NULL );
+}
+
+TEST_F(TestAllocator, testArenaVariants)
+{
+  ArenaAllocator arena;
+  {
+    AllocatorScope scope(arena);
+    std::vector<Variant> values;
+    for(size_t i=0; i<1000; i++)
+    {
+      Variant v = LONG_STRING;
+      v += (uint32)i;
+      values.push_back(v);
+    }
+    ASSERT_GT( arena.getAllocatedSize(), 0 );
+    ASSERT_EQ( Str(LONG_STRING).append("999"), values[999].getString() );
+    ASSERT_TRUE( values[500] > values[499] );
+  }
+  //all Variants are destroyed. Release the memory at once.
+  arena.reset();
+}
+
+TEST_F(TestAllocator, testArenaCopiesOutliveArena)
+{
+  CountingAllocator counter;
+  Variant copy;
+  Variant assigned = "short";
+  {
+    ArenaAllocator arena;
+    Variant v;
+    {
+      AllocatorScope scope(arena);
+      v = LONG_STRING;
+
+      //copies within the arena share the string
+      Variant shared = v;
+      ASSERT_EQ( v.getString(), shared.getString() );
+    }
+
+    //copies made outside of the arena scope own their characters
+    {
+      AllocatorScope scope(counter);
+      copy = v;
+      ASSERT_EQ( 1, counter.allocations );
+    }
+    assigned = v;
+
+    v = "";
+    arena.reset();
+    memset(arena.allocate(1000), 'x', 1000);
+  }
+  ASSERT_EQ( Str(LONG_STRING), copy.getString() );
+  ASSERT_EQ( Str(LONG_STRING), assigned.getString() );
+  copy = "";
+  ASSERT_EQ( 1, counter.deallocations );
+}
+
+TEST_F(TestAllocator, testCompareDoesNotAllocate)
+{
+  static const char * LONG_NUMBER = "-1234567890123456789";
+  Variant number = (uint32)2518;
+  Variant real = 1.5;
+  Variant text = LONG_STRING;
+  Variant longNumber = LONG_NUMBER;
+  Str str = LONG_NUMBER;
+
+  CountingAllocator counter;
+  {
+    AllocatorScope scope(counter);
+
+    //native values compared to string values
+    ASSERT_TRUE( number < LONG_STRING );
+    ASSERT_TRUE( number > LONG_NUMBER );
+    ASSERT_TRUE( number > str );
+    ASSERT_TRUE( number < text );
+    ASSERT_TRUE( number > longNumber );
+    ASSERT_TRUE( real > LONG_NUMBER );
+    ASSERT_TRUE( real == "1.5" );
+
+    //string values compared to native values
+    ASSERT_TRUE( text > (uint32)2518 );
+    ASSERT_TRUE( longNumber < 2518.0 );
+    ASSERT_TRUE( longNumber < number );
+    ASSERT_TRUE( text == LONG_STRING );
+    ASSERT_TRUE( longNumber == str );
+  }
+  ASSERT_EQ( 0, counter.allocations );
+}
@@ -0,0 +1,231 @@
+/**********************************************************************************
+ * MIT License
+ * 
+ * Copyright (c) 2018 Antoine Beauchamp
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+#include "TestBinaryStream.h"
+#include "libvariant/binary_stream.h"
+#include <limits>
+#include <vector>
+
+using namespace libVariant;
+
+void TestBinaryStream::SetUp()
+{
+}
+
+void TestBinaryStream::TearDown()
+{
+}
+
+static std::vector<Variant> createValues()
+{
+  std::vector<Variant> values;
+  values.push_back(Variant(false));
+  values.push_back(Variant(true));
+  values.push_back(Variant(static_cast<uint8>(0)));
+  values.push_back(Variant(std::numeric_limits<uint8>::max()));
+  values.push_back(Variant(std::numeric_limits<uint16>::max()));
+  values.push_back(Variant(std::numeric_limits<uint32>::max()));
+  values.push_back(Variant(std::numeric_limits<uint64>::max()));
+  values.push_back(Variant(std::numeric_limits<sint8>::min()));
+  values.push_back(Variant(std::numeric_limits<sint8>::max()));
+  values.push_back(Variant(std::numeric_limits<sint16>::min()));
+  values.push_back(Variant(std::numeric_limits<sint32>::min()));
+  values.push_back(Variant(std::numeric_limits<sint64>::min()));
+  values.push_back(Variant(std::numeric_limits<sint64>::max()));
+  values.push_back(Variant(static_cast<sint16>(-1)));
+  values.push_back(Variant(-0.0f));
+  values.push_back(Variant(3.14159f));
+  values.push_back(Variant(std::numeric_limits<float64>::infinity()));
+  values.push_back(Variant(1.0/3.0));
+  values.push_back(Variant(""));
+  values.push_back(Variant("foo"));
+  values.push_back(Variant("a long string which is not stored inline by the Variant class"));
+  values.push_back(Variant(std::numeric_limits<float64>::quiet_NaN()));
+  return values;
+}
+
+static void assertIdentical(const Variant & iExpected, const Variant & iActual)
+{
+  ASSERT_EQ( iExpected.getFormat(), iActual.getFormat() );
+  ASSERT_EQ( iExpected.getString(), iActual.getString() );
+}
+
+TEST_F(TestBinaryStream, testRoundTrip)
+{
+  std::vector<Variant> values = createValues();
+  std::vector<char> buffer(1024);
+  BinaryWriter writer(&buffer[0], buffer.size());
+  size_t expectedSize = 0;
+  for(size_t i=0; i<values.size(); i++)
+  {
+    ASSERT_TRUE( writer.write(values[i]) );
+    expectedSize += BinaryWriter::getEncodedSize(values[i]);
+    ASSERT_EQ( expectedSize, writer.getSize() );
+  }
+
+  //the internal format of each value is kept
+  BinaryReader reader(&buffer[0], writer.getSize());
+  for(size_t i=0; i<values.size(); i++)
+  {
+    Variant value;
+    ASSERT_TRUE( reader.read(value) );
+    assertIdentical(values[i], value);
+    ASSERT_FALSE( value.isStringView() );
+  }
+  ASSERT_TRUE( reader.isEnd() );
+  ASSERT_FALSE( reader.hasError() );
+  Variant value;
+  ASSERT_FALSE( reader.read(value) );
+
+  //string values reference the buffer
+  reader.reset(&buffer[0], writer.getSize());
+  VariantArray array;
+  for(size_t i=0; i<values.size(); i++)
+  {
+    ASSERT_TRUE( reader.readView(value) );
+    assertIdentical(values[i], value);
+    ASSERT_EQ( values[i].getFormat() == Variant::STRING, value.isStringView() );
+    array.push_back(value);
+  }
+
+  //arrays are written without creating Variants
+  std::vector<char> other(1024);
+  writer.reset(&other[0], other.size());
+  for(size_t i=0; i<array.size(); i++)
+    ASSERT_TRUE( writer.write(array, i) );
+  ASSERT_EQ( expectedSize, writer.getSize() );
+  ASSERT_EQ( 0, memcmp(&buffer[0], &other[0], expectedSize) );
+
+  reader.reset(&other[0], writer.getSize());
+  VariantArray copy;
+  while(reader.read(copy))
+  {
+  }
+  ASSERT_TRUE( reader.isEnd() );
+  ASSERT_EQ( array.size(), copy.size() );
+  for(size_t i=0; i<array.size(); i++)
+    assertIdentical(array.get(i), copy.get(i));
+}
+
+TEST_F(TestBinaryStream, testEncoding)
+{
+  std::vector<char> buffer(64);
+  BinaryWriter writer(&buffer[0], buffer.size());
+  ASSERT_TRUE( writer.write(Variant(static_cast<uint16>(300))) );
+  ASSERT_TRUE( writer.write(Variant(static_cast<sint8>(-2))) );
+  ASSERT_TRUE( writer.write(Variant(1.0f)) );
+  ASSERT_TRUE( writer.write(Variant("ab")) );
+
+  static const unsigned char expected[] = {
+    Variant::UINT16, 0xAC, 0x02,
+    Variant::SINT8, 0x03,
+    Variant::FLOAT32, 0x00, 0x00, 0x80, 0x3F,
+    Variant::STRING, 0x02, 'a', 'b',
+  };
+  ASSERT_EQ( sizeof(expected), writer.getSize() );
+  ASSERT_EQ( 0, memcmp(expected, &buffer[0], sizeof(expected)) );
+
+  //small numbers use 2 bytes
+  ASSERT_EQ( 2, BinaryWriter::getEncodedSize(Variant(static_cast<uint64>(100))) );
+  ASSERT_EQ( 2, BinaryWriter::getEncodedSize(Variant(static_cast<sint64>(-50))) );
+  ASSERT_EQ( BinaryWriter::MAX_NUMBER_SIZE, BinaryWriter::getEncodedSize(Variant(std::numeric_limits<uint64>::max())) );
+}
+
+TEST_F(TestBinaryStream, testStreaming)
+{
+  std::vector<Variant> values = createValues();
+  std::vector<char> encoded(1024);
+  BinaryWriter writer(&encoded[0], encoded.size());
+  for(size_t i=0; i<values.size(); i++)
+    ASSERT_TRUE( writer.write(values[i]) );
+  const size_t size = writer.getSize();
+
+  //a full buffer rejects the value without writing it
+  for(size_t capacity=0; capacity<size; capacity++)
+  {
+    std::vector<char> small(capacity + 1, 'x');
+    writer.reset(&small[0], capacity);
+    size_t count = 0;
+    while(count < values.size() && writer.write(values[count]))
+      count++;
+    ASSERT_LT( count, values.size() );
+    ASSERT_EQ( 0, memcmp(&encoded[0], &small[0], writer.getSize()) );
+    ASSERT_EQ( 'x', small[capacity] );
+  }
+
+  //the data is received in small pieces: unread bytes are moved to the beginning of the buffer
+  for(size_t piece=1; piece<16; piece++)
+  {
+    std::vector<char> buffer;
+    BinaryReader reader(NULL, 0);
+    size_t received = 0;
+    size_t count = 0;
+    while(received < size || !reader.isEnd())
+    {
+      buffer.erase(buffer.begin(), buffer.begin() + reader.getPosition());
+      const size_t length = (size - received < piece ? size - received : piece);
+      buffer.insert(buffer.end(), encoded.begin() + received, encoded.begin() + received + length);
+      received += length;
+      reader.reset(buffer.empty() ? NULL : &buffer[0], buffer.size());
+
+      Variant value;
+      while(reader.read(value))
+      {
+        assertIdentical(values[count], value);
+        count++;
+      }
+      ASSERT_FALSE( reader.hasError() );
+    }
+    ASSERT_EQ( values.size(), count );
+  }
+}
+
+TEST_F(TestBinaryStream, testInvalidData)
+{
+  static const unsigned char invalid[][12] = {
+    {Variant::STRING + 1},
+    {Variant::BOOL, 2},
+    {Variant::UINT8, 0x80, 0x02}, //256
+    {Variant::SINT8, 0x80, 0x02}, //128
+    {Variant::SINT16, 0x81, 0x80, 0x04}, //-32769
+    {Variant::UINT64, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x02}, //2^64
+    {Variant::UINT64, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x81, 0x00}, //more than 10 bytes
+  };
+  for(size_t i=0; i<sizeof(invalid)/sizeof(invalid[0]); i++)
+  {
+    BinaryReader reader(reinterpret_cast<const char *>(invalid[i]), sizeof(invalid[i]));
+    Variant value;
+    ASSERT_FALSE( reader.read(value) ) << "at index " << i;
+    ASSERT_TRUE( reader.hasError() ) << "at index " << i;
+    ASSERT_EQ( 0, reader.getPosition() );
+    ASSERT_FALSE( reader.read(value) );
+  }
+
+  //incomplete values are not errors
+  static const unsigned char incomplete[] = {Variant::STRING, 0x05, 'a', 'b'};
+  BinaryReader reader(reinterpret_cast<const char *>(incomplete), sizeof(incomplete));
+  Variant value;
+  ASSERT_FALSE( reader.read(value) );
+  ASSERT_FALSE( reader.hasError() );
+  ASSERT_EQ( 0, reader.getPosition() );
+}
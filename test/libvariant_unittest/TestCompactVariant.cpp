@@ -0,0 +1,241 @@
+/**********************************************************************************
+ * MIT License
+ * 
+ * Copyright (c) 2018 Antoine Beauchamp
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+#include "TestCompactVariant.h"
+#include "libvariant/compact_variant.h"
+#include <vector>
+#include <utility>
+
+using namespace libVariant;
+
+void TestCompactVariant::SetUp()
+{
+}
+
+void TestCompactVariant::TearDown()
+{
+}
+
+/// <summary>
+/// Returns a list of values of all supported internal types.
+/// </summary>
+std::vector<Variant> getCompactTestValues()
+{
+  std::vector<Variant> values;
+  values.push_back( Variant(true) );
+  values.push_back( Variant(false) );
+  values.push_back( Variant((uint8 )200) );
+  values.push_back( Variant((sint8 )-100) );
+  values.push_back( Variant((uint16)60000) );
+  values.push_back( Variant((sint16)-30000) );
+  values.push_back( Variant((uint32)4000000000u) );
+  values.push_back( Variant((sint32)-2000000000) );
+  values.push_back( Variant((uint64)18000000000000000000ull) );
+  values.push_back( Variant((sint64)-9000000000000000000ll) );
+  values.push_back( Variant((sint32)0) );
+  values.push_back( Variant((sint32)7) );
+  values.push_back( Variant(3.5f) );
+  values.push_back( Variant(-1234.5678) );
+  values.push_back( Variant("42") );
+  values.push_back( Variant("-3.25") );
+  values.push_back( Variant("true") );
+  values.push_back( Variant("foo") );
+  values.push_back( Variant("a string value which is longer than the inline capacity of Variant") );
+  return values;
+}
+
+TEST_F(TestCompactVariant, testConversions)
+{
+  std::vector<Variant> values = getCompactTestValues();
+  for(size_t i=0; i<values.size(); i++)
+  {
+    const Variant & v = values[i];
+    CompactVariant c = v;
+
+    ASSERT_EQ( v.getFormat(),       c.getFormat() );
+    ASSERT_EQ( v.getBool(),         c.getBool() );
+    ASSERT_EQ( v.getUInt8(),        c.getUInt8() );
+    ASSERT_EQ( v.getUInt16(),       c.getUInt16() );
+    ASSERT_EQ( v.getUInt32(),       c.getUInt32() );
+    ASSERT_EQ( v.getUInt64(),       c.getUInt64() );
+    ASSERT_EQ( v.getSInt8(),        c.getSInt8() );
+    ASSERT_EQ( v.getSInt16(),       c.getSInt16() );
+    ASSERT_EQ( v.getSInt32(),       c.getSInt32() );
+    ASSERT_EQ( v.getSInt64(),       c.getSInt64() );
+    ASSERT_EQ( v.getFloat32(),      c.getFloat32() );
+    ASSERT_EQ( v.getFloat64(),      c.getFloat64() );
+    ASSERT_EQ( v.getString(),       c.getString() );
+    ASSERT_EQ( v.isSigned(),        c.isSigned() );
+    ASSERT_EQ( v.isUnsigned(),      c.isUnsigned() );
+    ASSERT_EQ( v.isFloating(),      c.isFloating() );
+    ASSERT_EQ( v.isPositive(),      c.isPositive() );
+    ASSERT_EQ( v.isNegative(),      c.isNegative() );
+
+    //back to Variant
+    Variant back = c;
+    ASSERT_EQ( v.getFormat(), back.getFormat() );
+    ASSERT_TRUE( v == back );
+
+    //simplify
+    Variant vs = v;
+    CompactVariant cs = c;
+    ASSERT_EQ( vs.simplify(), cs.simplify() );
+    ASSERT_EQ( vs.getFormat(), cs.getFormat() );
+    ASSERT_EQ( vs.getString(), cs.getString() );
+
+    //promote
+    for(int f=Variant::BOOL; f<=Variant::STRING; f++)
+    {
+      Variant vp = v;
+      CompactVariant cp = c;
+      vp.promote((Variant::VariantFormat)f);
+      cp.promote((Variant::VariantFormat)f);
+      ASSERT_EQ( vp.getFormat(), cp.getFormat() );
+      ASSERT_EQ( vp.getString(), cp.getString() );
+    }
+  }
+}
+
+TEST_F(TestCompactVariant, testOperators)
+{
+  //division by zero of integers is not portable
+  Variant::DivisionByZeroPolicy policy = Variant::getDivisionByZeroPolicy();
+  Variant::setDivisionByZeroPolicy(Variant::IGNORE);
+
+  std::vector<Variant> values = getCompactTestValues();
+  for(size_t i=0; i<values.size(); i++)
+  {
+    for(size_t j=0; j<values.size(); j++)
+    {
+      const Variant & v1 = values[i];
+      const Variant & v2 = values[j];
+      const CompactVariant c1 = v1;
+      const CompactVariant c2 = v2;
+
+      ASSERT_EQ( v1.compare(v2), c1.compare(c2) ) << "i=" << i << " j=" << j;
+      ASSERT_EQ( v1 == v2, c1 == c2 );
+      ASSERT_EQ( v1 <  v2, c1 <  c2 );
+
+      Variant        vr;
+      CompactVariant cr;
+
+      vr = v1 + v2; cr = c1 + c2;
+      ASSERT_EQ( vr.getFormat(), cr.getFormat() ) << "i=" << i << " j=" << j;
+      ASSERT_EQ( vr.getString(), cr.getString() ) << "i=" << i << " j=" << j;
+
+      vr = v1 - v2; cr = c1 - c2;
+      ASSERT_EQ( vr.getFormat(), cr.getFormat() ) << "i=" << i << " j=" << j;
+      ASSERT_EQ( vr.getString(), cr.getString() ) << "i=" << i << " j=" << j;
+
+      vr = v1 * v2; cr = c1 * c2;
+      ASSERT_EQ( vr.getFormat(), cr.getFormat() ) << "i=" << i << " j=" << j;
+      ASSERT_EQ( vr.getString(), cr.getString() ) << "i=" << i << " j=" << j;
+
+      vr = v1 / v2; cr = c1 / c2;
+      ASSERT_EQ( vr.getFormat(), cr.getFormat() ) << "i=" << i << " j=" << j;
+      ASSERT_EQ( vr.getString(), cr.getString() ) << "i=" << i << " j=" << j;
+    }
+  }
+
+  Variant::setDivisionByZeroPolicy(policy);
+
+  //booleans are processed as integers
+  {
+    Variant v = (uint8)5;
+    CompactVariant c = (uint8)5;
+    v += true;
+    c += true;
+    ASSERT_EQ( v.getFormat(), c.getFormat() );
+    ASSERT_EQ( v.getString(), c.getString() );
+  }
+
+  //integer literals are not processed as booleans
+  {
+    Variant v = (uint8)10;
+    CompactVariant c = (uint8)10;
+    ASSERT_EQ( (v + 5).getString(), (c + 5).getString() );
+    ASSERT_EQ( (v * 3).getString(), (c * 3).getString() );
+    ASSERT_EQ( (v - 4).getFormat(), (c - 4).getFormat() );
+    ASSERT_EQ( (v / 2.5).getString(), (c / 2.5).getString() );
+    ASSERT_EQ( 15, (c + 5).getSInt32() );
+    ASSERT_EQ( 30, (c * 3).getSInt32() );
+    c += 7;
+    ASSERT_EQ( 17, c.getSInt32() );
+    c -= 7;
+    c *= 2;
+    ASSERT_EQ( 20, c.getSInt32() );
+  }
+
+  //increment and decrement
+  {
+    CompactVariant c = (uint8)255;
+    c++;
+    ASSERT_EQ( Variant::UINT16, c.getFormat() );
+    ASSERT_EQ( 256, c.getUInt16() );
+    --c;
+    ASSERT_EQ( 255, c.getUInt16() );
+  }
+
+  //self concatenation
+  {
+    CompactVariant c = "abc";
+    c += c;
+    c += c;
+    ASSERT_EQ( Str("abcabcabcabc"), c.getString() );
+  }
+}
+
+TEST_F(TestCompactVariant, testCopyAndMove)
+{
+  CompactVariant c1 = "a string value which is longer than the inline capacity of Variant";
+  CompactVariant c2 = c1;
+  ASSERT_TRUE( c1 == c2 );
+
+  //self assignment
+  c2 = c2;
+  ASSERT_TRUE( c1 == c2 );
+
+  CompactVariant c3 = std::move(c2);
+  ASSERT_TRUE( c1 == c3 );
+  ASSERT_EQ( Variant::UINT8, c2.getFormat() );
+
+  c2 = 3.5;
+  swap(c2, c3);
+  ASSERT_EQ( Variant::FLOAT64, c3.getFormat() );
+  ASSERT_TRUE( c1 == c2 );
+
+  //containers
+  std::vector<CompactVariant> values;
+  for(int i=0; i<1000; i++)
+  {
+    if (i%2 == 0)
+      values.push_back( CompactVariant(i) );
+    else
+      values.push_back( CompactVariant(Variant(i).getString()) );
+  }
+  for(int i=0; i<1000; i++)
+  {
+    ASSERT_EQ( i, values[i].getSInt32() );
+  }
+}
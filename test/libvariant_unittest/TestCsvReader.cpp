@@ -0,0 +1,243 @@
+/**********************************************************************************
+ * MIT License
+ * 
+ * Copyright (c) 2018 Antoine Beauchamp
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+#include "TestCsvReader.h"
+#include "libvariant/csv_reader.h"
+#include <string>
+#include <vector>
+
+using namespace libVariant;
+
+void TestCsvReader::SetUp()
+{
+}
+
+void TestCsvReader::TearDown()
+{
+}
+
+static Variant simplified(const char * iValue)
+{
+  Variant value;
+  value.setString(iValue);
+  value.simplify();
+  return value;
+}
+
+static void assertIdentical(const Variant & iExpected, const Variant & iActual)
+{
+  ASSERT_EQ( iExpected.getFormat(), iActual.getFormat() );
+  ASSERT_EQ( std::string(iExpected.getString().c_str()), std::string(iActual.getString().c_str()) );
+}
+
+static void assertIdentical(const std::vector<VariantArray> & iExpected, const std::vector<VariantArray> & iActual)
+{
+  ASSERT_EQ( iExpected.size(), iActual.size() );
+  for(size_t i=0; i<iExpected.size(); i++)
+  {
+    ASSERT_EQ( iExpected[i].size(), iActual[i].size() );
+    for(size_t j=0; j<iExpected[i].size(); j++)
+    {
+      ASSERT_NO_FATAL_FAILURE( assertIdentical(iExpected[i].get(j), iActual[i].get(j)) );
+    }
+  }
+}
+
+static size_t read(CsvReader & iReader, const std::string & iText, bool iFinal, std::vector<VariantArray> & ioColumns)
+{
+  static ThreadPool pool(1);
+  return iReader.read(iText.c_str(), iText.size(), iFinal, ioColumns, pool);
+}
+
+TEST_F(TestCsvReader, testTypes)
+{
+  static const char * FIELDS[] = {"1", "-5", "300", "-40000", "4000000000", "18446744073709551615", "3.5", "0.1", "1e+300", "true", "FALSE", "foo", "007", " 2", "", "-0"};
+  static const size_t NUM_FIELDS = sizeof(FIELDS)/sizeof(FIELDS[0]);
+
+  std::string text;
+  for(size_t i=0; i<NUM_FIELDS; i++)
+  {
+    text += (i > 0 ? "," : "");
+    text += FIELDS[i];
+  }
+  text += "\n";
+
+  CsvReader reader;
+  std::vector<VariantArray> columns;
+  ASSERT_EQ( text.size(), read(reader, text, false, columns) );
+  ASSERT_FALSE( reader.hasError() );
+  ASSERT_EQ( NUM_FIELDS, columns.size() );
+  for(size_t i=0; i<NUM_FIELDS; i++)
+  {
+    ASSERT_EQ( 1, columns[i].size() );
+    ASSERT_NO_FATAL_FAILURE( assertIdentical(simplified(FIELDS[i]), columns[i].get(0)) );
+  }
+}
+
+TEST_F(TestCsvReader, testQuotedFields)
+{
+  std::string text = "\"a,b\",\"say \"\"hi\"\"\",\"12\"\r\n"
+                     "\"two\nlines\",\"\",x\r\n"
+                     "\r\n"
+                     "\n"
+                     "last,\"\"\"\",3.25";
+
+  CsvReader reader;
+  std::vector<VariantArray> columns;
+  ASSERT_EQ( text.size(), read(reader, text, true, columns) );
+  ASSERT_FALSE( reader.hasError() );
+  ASSERT_EQ( 3, columns.size() );
+  ASSERT_EQ( 3, columns[0].size() );
+  ASSERT_NO_FATAL_FAILURE( assertIdentical(simplified("a,b"), columns[0].get(0)) );
+  ASSERT_NO_FATAL_FAILURE( assertIdentical(simplified("say \"hi\""), columns[1].get(0)) );
+  ASSERT_NO_FATAL_FAILURE( assertIdentical(simplified("12"), columns[2].get(0)) );
+  ASSERT_NO_FATAL_FAILURE( assertIdentical(simplified("two\nlines"), columns[0].get(1)) );
+  ASSERT_NO_FATAL_FAILURE( assertIdentical(simplified(""), columns[1].get(1)) );
+  ASSERT_NO_FATAL_FAILURE( assertIdentical(simplified("x"), columns[2].get(1)) );
+  ASSERT_NO_FATAL_FAILURE( assertIdentical(simplified("last"), columns[0].get(2)) );
+  ASSERT_NO_FATAL_FAILURE( assertIdentical(simplified("\""), columns[1].get(2)) );
+  ASSERT_NO_FATAL_FAILURE( assertIdentical(simplified("3.25"), columns[2].get(2)) );
+
+  //tab separated values
+  CsvReader tsv('\t');
+  columns.clear();
+  text = "a\tb,c\t1\n";
+  ASSERT_EQ( text.size(), read(tsv, text, true, columns) );
+  ASSERT_EQ( 3, columns.size() );
+  ASSERT_NO_FATAL_FAILURE( assertIdentical(simplified("b,c"), columns[1].get(0)) );
+}
+
+TEST_F(TestCsvReader, testStreaming)
+{
+  std::string text = "id,name,price\n"
+                     "1,\"apple, red\",1.5\r\n"
+                     "2,\"pear\"\"s\",0.25\n"
+                     "3,\"multi\r\nline\",100\n"
+                     "4,kiwi,-7";
+
+  CsvReader reference(',', true);
+  std::vector<VariantArray> expected;
+  ASSERT_EQ( text.size(), read(reference, text, true, expected) );
+  ASSERT_EQ( 3, reference.getColumnNames().size() );
+  ASSERT_EQ( std::string("name"), reference.getColumnNames()[1].c_str() );
+  ASSERT_EQ( 3, expected.size() );
+  ASSERT_EQ( 4, expected[0].size() );
+
+  //split the input at every position
+  for(size_t split=0; split<=text.size(); split++)
+  {
+    CsvReader reader(',', true);
+    std::vector<VariantArray> columns;
+    std::string first = text.substr(0, split);
+    size_t consumed = read(reader, first, false, columns);
+    ASSERT_FALSE( reader.hasError() );
+    ASSERT_LE( consumed, split );
+    std::string remaining = text.substr(consumed);
+    ASSERT_EQ( remaining.size(), read(reader, remaining, true, columns) );
+    ASSERT_FALSE( reader.hasError() );
+    ASSERT_EQ( 3, reader.getColumnNames().size() );
+    ASSERT_NO_FATAL_FAILURE( assertIdentical(expected, columns) );
+  }
+}
+
+TEST_F(TestCsvReader, testInvalidRecords)
+{
+  static const char * TEXTS[] = {
+    "1,2\n3\n",         //missing field
+    "1,2\n3,4,5\n",     //extra field
+    "1,2\na\"b,4\n",    //quote in an unquoted field
+    "1,2\n\"a\"b,4\n",  //characters after a quoted field
+    "1,2\n\"a,4\n",     //unterminated quoted field
+  };
+  static const size_t NUM_TEXTS = sizeof(TEXTS)/sizeof(TEXTS[0]);
+
+  for(size_t i=0; i<NUM_TEXTS; i++)
+  {
+    CsvReader reader;
+    std::vector<VariantArray> columns;
+    ASSERT_EQ( 4, read(reader, TEXTS[i], true, columns) );
+    ASSERT_TRUE( reader.hasError() );
+    ASSERT_EQ( 2, columns.size() );
+    ASSERT_EQ( 1, columns[0].size() );
+    ASSERT_EQ( 1, columns[1].size() );
+  }
+
+  //the number of fields of existing columns is expected
+  CsvReader reader;
+  std::vector<VariantArray> columns(3);
+  ASSERT_EQ( 0, read(reader, "1,2\n", true, columns) );
+  ASSERT_TRUE( reader.hasError() );
+  ASSERT_EQ( 6, read(reader, "1,2,3\n", true, columns) );
+  ASSERT_FALSE( reader.hasError() );
+}
+
+TEST_F(TestCsvReader, testParallel)
+{
+  //records spanning multiple chunks and quoted line endings at chunk boundaries
+  std::string text;
+  size_t numRecords = 0;
+  while(text.size() < 3*CsvReader::CHUNK_SIZE + 1000)
+  {
+    char record[256];
+    if (numRecords % 1000 == 999)
+    {
+      text += "\"";
+      text.append(CsvReader::CHUNK_SIZE / 2, '\n');
+      text += "\",x,1\n";
+    }
+    else
+    {
+      snprintf(record, sizeof(record), "%u,\"line\n%u\",%u.5\n", static_cast<unsigned int>(numRecords), static_cast<unsigned int>(numRecords), static_cast<unsigned int>(numRecords % 7));
+      text += record;
+    }
+    numRecords++;
+  }
+
+  ThreadPool serialPool(1);
+  ThreadPool parallelPool(4);
+  for(int final=0; final<=1; final++)
+  {
+    std::string input = (final ? text + "last,\"\",0" : text + "last,\"\"");
+
+    CsvReader serialReader;
+    std::vector<VariantArray> expected;
+    size_t expectedSize = serialReader.read(input.c_str(), input.size(), (final == 1), expected, serialPool);
+    ASSERT_FALSE( serialReader.hasError() );
+    ASSERT_EQ( (final ? input.size() : text.size()), expectedSize );
+    ASSERT_EQ( numRecords + final, expected[0].size() );
+
+    CsvReader parallelReader;
+    std::vector<VariantArray> columns;
+    ASSERT_EQ( expectedSize, parallelReader.read(input.c_str(), input.size(), (final == 1), columns, parallelPool) );
+    ASSERT_FALSE( parallelReader.hasError() );
+    ASSERT_NO_FATAL_FAILURE( assertIdentical(expected, columns) );
+  }
+
+  //an invalid record in a later part
+  std::string invalid = text + "1,2\n" + text;
+  CsvReader reader;
+  std::vector<VariantArray> columns;
+  ASSERT_EQ( text.size(), reader.read(invalid.c_str(), invalid.size(), true, columns, parallelPool) );
+  ASSERT_TRUE( reader.hasError() );
+  ASSERT_EQ( numRecords, columns[0].size() );
+}
@@ -0,0 +1,206 @@
+/**********************************************************************************
+ * MIT License
+ * 
+ * Copyright (c) 2018 Antoine Beauchamp
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+#include "TestCsvWriter.h"
+#include "libvariant/csv_writer.h"
+#include "libvariant/csv_reader.h"
+#include <limits>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace libVariant;
+
+void TestCsvWriter::SetUp()
+{
+}
+
+void TestCsvWriter::TearDown()
+{
+  Variant::setFloatFormattingPolicy(Variant::FIXED_PRECISION);
+}
+
+static std::vector<Variant> createNumbers()
+{
+  std::vector<Variant> values;
+  values.push_back(Variant(true));
+  values.push_back(Variant(false));
+  values.push_back(Variant(std::numeric_limits<uint8>::max()));
+  values.push_back(Variant(std::numeric_limits<uint16>::max()));
+  values.push_back(Variant(std::numeric_limits<uint32>::max()));
+  values.push_back(Variant(std::numeric_limits<uint64>::max()));
+  values.push_back(Variant(std::numeric_limits<sint8>::min()));
+  values.push_back(Variant(std::numeric_limits<sint16>::min()));
+  values.push_back(Variant(std::numeric_limits<sint32>::min()));
+  values.push_back(Variant(std::numeric_limits<sint64>::min()));
+  values.push_back(Variant(-0.0f));
+  values.push_back(Variant(5.6f));
+  values.push_back(Variant(1.0/3.0));
+  values.push_back(Variant(-1.5e-300));
+  values.push_back(Variant(std::numeric_limits<float64>::infinity()));
+  values.push_back(Variant(std::numeric_limits<float64>::quiet_NaN()));
+  return values;
+}
+
+TEST_F(TestCsvWriter, testFormatting)
+{
+  std::vector<Variant> values = createNumbers();
+  for(int policy=0; policy<2; policy++)
+  {
+    Variant::setFloatFormattingPolicy(policy == 0 ? Variant::FIXED_PRECISION : Variant::SHORTEST_ROUND_TRIP);
+
+    //numbers are formatted like Variant::getString()
+    std::string expected;
+    for(size_t i=0; i<values.size(); i++)
+    {
+      expected += (i > 0 ? "," : "");
+      expected += values[i].getString().c_str();
+    }
+    expected += "\n";
+
+    std::ostringstream stream;
+    {
+      CsvWriter writer(stream);
+      for(size_t i=0; i<values.size(); i++)
+        writer.write(values[i]);
+      writer.endRecord();
+    }
+    ASSERT_EQ( expected, stream.str() );
+  }
+}
+
+TEST_F(TestCsvWriter, testQuoting)
+{
+  std::ostringstream stream;
+  CsvWriter writer(stream);
+  writer.write(Variant("plain text"));
+  writer.write(Variant("a,b"));
+  writer.write(Variant("say \"hi\""));
+  writer.write(Variant("two\nlines"));
+  writer.write(Variant("cr\r"));
+  writer.write(Variant(""));
+  writer.endRecord();
+  writer.write(Variant(1));
+  writer.endRecord();
+  ASSERT_TRUE( writer.flush() );
+  ASSERT_EQ( std::string("plain text,\"a,b\",\"say \"\"hi\"\"\",\"two\nlines\",\"cr\r\",\"\"\n1\n"), stream.str() );
+
+  //tab separated values
+  std::ostringstream tsvStream;
+  CsvWriter tsv(tsvStream, '\t');
+  tsv.write(Variant("a,b"));
+  tsv.write(Variant("a\tb"));
+  tsv.endRecord();
+  ASSERT_TRUE( tsv.flush() );
+  ASSERT_EQ( std::string("a,b\t\"a\tb\"\n"), tsvStream.str() );
+}
+
+TEST_F(TestCsvWriter, testRoundTrip)
+{
+  std::string text = "id,name,price,valid\n"
+                     "1,\"apple, red\",1.5,true\n"
+                     "-300,\"pear \"\"williams\"\"\",0.25,false\n"
+                     "70000,\"multi\nline\",1e+100,true\n"
+                     "18446744073709551615,kiwi,-7,false\n";
+
+  CsvReader reader;
+  ThreadPool pool(1);
+  std::vector<VariantArray> columns;
+  ASSERT_EQ( text.size(), reader.read(text.c_str(), text.size(), true, columns, pool) );
+  ASSERT_FALSE( reader.hasError() );
+
+  std::ostringstream stream;
+  {
+    CsvWriter writer(stream);
+    writer.writeColumns(columns);
+  }
+  ASSERT_EQ( text, stream.str() );
+}
+
+TEST_F(TestCsvWriter, testEmptyStringRoundTrip)
+{
+  //empty strings of a single column are not written as empty lines
+  VariantArray values;
+  values.push_back(Variant("a"));
+  values.push_back(Variant(""));
+  values.push_back(Variant("b"));
+  std::vector<VariantArray> columns(1, values);
+
+  std::ostringstream stream;
+  {
+    CsvWriter writer(stream);
+    writer.writeColumns(columns);
+  }
+  ASSERT_EQ( std::string("a\n\"\"\nb\n"), stream.str() );
+
+  CsvReader reader;
+  ThreadPool pool(1);
+  std::vector<VariantArray> readColumns;
+  std::string text = stream.str();
+  ASSERT_EQ( text.size(), reader.read(text.c_str(), text.size(), false, readColumns, pool) );
+  ASSERT_FALSE( reader.hasError() );
+  ASSERT_EQ( 1u, readColumns.size() );
+  ASSERT_EQ( values.size(), readColumns[0].size() );
+}
+
+TEST_F(TestCsvWriter, testLargeOutput)
+{
+  //fields larger than the buffer and fields across the end of the buffer
+  std::string large(CsvWriter::BUFFER_SIZE * 2 + 17, 'x');
+  std::string largeQuoted(CsvWriter::BUFFER_SIZE + 3, '"');
+
+  VariantArray values;
+  std::string expected;
+  for(size_t i=0; i<100000; i++)
+  {
+    values.push_back(Variant(static_cast<uint32>(i * 2654435761u)));
+    values.push_back(Variant(i % 3 == 0 ? "a,b" : "text"));
+  }
+  values.push_back(large.c_str(), large.size());
+  values.push_back(largeQuoted.c_str(), largeQuoted.size());
+  for(size_t i=0; i<values.size(); i++)
+  {
+    std::string str = values.get(i).getString().c_str();
+    if (i + 1 == values.size() || str == "a,b")
+    {
+      expected += "\"";
+      for(size_t j=0; j<str.size(); j++)
+        expected += (str[j] == '"' ? "\"\"" : std::string(1, str[j]));
+      expected += "\"";
+    }
+    else
+      expected += str;
+    expected += "\n";
+  }
+
+  std::ostringstream stream;
+  CsvWriter writer(stream);
+  for(size_t i=0; i<values.size(); i++)
+  {
+    writer.write(values, i);
+    writer.endRecord();
+  }
+  ASSERT_TRUE( writer.flush() );
+  ASSERT_EQ( expected.size(), stream.str().size() );
+  ASSERT_TRUE( expected == stream.str() );
+}
@@ -0,0 +1,308 @@
+/**********************************************************************************
+ * MIT License
+ * 
+ * Copyright (c) 2018 Antoine Beauchamp
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+#include "TestJson.h"
+#include "libvariant/json.h"
+#include <limits>
+#include <clocale> //setlocale
+#include <sstream>
+#include <string>
+#include <string.h>
+
+using namespace libVariant;
+
+void TestJson::SetUp()
+{
+}
+
+void TestJson::TearDown()
+{
+}
+
+static JsonValue readDocument(const std::string & iText)
+{
+  JsonReader reader;
+  JsonValue value;
+  bool success = reader.read(iText.c_str(), iText.size(), value);
+  EXPECT_TRUE( success ) << iText;
+  return value;
+}
+
+static std::string writeDocument(const JsonValue & iValue)
+{
+  std::ostringstream stream;
+  JsonWriter writer(stream);
+  writer.write(iValue);
+  writer.flush();
+  return stream.str();
+}
+
+TEST_F(TestJson, testScalars)
+{
+  struct Expected
+  {
+    const char * text;
+    Variant::VariantFormat format;
+    const char * value;
+    float64 number;
+  };
+  static const Expected EXPECTED[] = {
+    {"true",                  Variant::BOOL,    "true", 0.0},
+    {"false",                 Variant::BOOL,    "false", 0.0},
+    {"0",                     Variant::SINT8,   "0", 0.0},
+    {"127",                   Variant::SINT8,   "127", 0.0},
+    {"200",                   Variant::UINT8,   "200", 0.0},
+    {"-128",                  Variant::SINT8,   "-128", 0.0},
+    {"-129",                  Variant::SINT16,  "-129", 0.0},
+    {"40000",                 Variant::UINT16,  "40000", 0.0},
+    {"-40000",                Variant::SINT32,  "-40000", 0.0},
+    {"4000000000",            Variant::UINT32,  "4000000000", 0.0},
+    {"-9223372036854775808",  Variant::SINT64,  "-9223372036854775808", 0.0},
+    {"18446744073709551615",  Variant::UINT64,  "18446744073709551615", 0.0},
+    {"18446744073709551616",  Variant::FLOAT64, NULL, 18446744073709551616.0},
+    {"-0",                    Variant::FLOAT64, NULL, -0.0},
+    {"1.5",                   Variant::FLOAT64, NULL, 1.5},
+    {"2e3",                   Variant::FLOAT64, NULL, 2000.0},
+    {"-1.25E-2",              Variant::FLOAT64, NULL, -0.0125},
+    {"1e999",                 Variant::FLOAT64, NULL, std::numeric_limits<float64>::max()},
+    {"\"text\"",              Variant::STRING,  "text", 0.0},
+    {"\"12\"",                Variant::STRING,  "12", 0.0},
+  };
+  static const size_t NUM_EXPECTED = sizeof(EXPECTED)/sizeof(EXPECTED[0]);
+
+  for(size_t i=0; i<NUM_EXPECTED; i++)
+  {
+    JsonValue value = readDocument(EXPECTED[i].text);
+    ASSERT_TRUE( value.isScalar() ) << EXPECTED[i].text;
+    ASSERT_EQ( EXPECTED[i].format, value.getValue().getFormat() ) << EXPECTED[i].text;
+    if (EXPECTED[i].format == Variant::FLOAT64)
+    {
+      ASSERT_EQ( EXPECTED[i].number, value.getValue().getFloat64() ) << EXPECTED[i].text;
+    }
+    else
+    {
+      ASSERT_STREQ( EXPECTED[i].value, value.getValue().getString().c_str() ) << EXPECTED[i].text;
+    }
+  }
+
+  ASSERT_TRUE( readDocument(" null ").isNull() );
+}
+
+TEST_F(TestJson, testNested)
+{
+  std::string text = " { \"name\" : \"libVariant\", \"tags\" : [ 1, 2.5, \"three\", [ ], { } ],\n"
+                     "   \"nested\" : { \"value\" : null, \"ok\" : true }, \"name\" : \"duplicate\" } ";
+  JsonValue document = readDocument(text);
+  ASSERT_TRUE( document.isObject() );
+  ASSERT_EQ( 4, document.size() );
+  ASSERT_STREQ( "tags", document.getName(1).getString().c_str() );
+
+  const JsonValue * name = document.find("name");
+  ASSERT_TRUE( name != NULL );
+  ASSERT_STREQ( "libVariant", name->getValue().getString().c_str() );
+  ASSERT_TRUE( document.find("missing") == NULL );
+
+  const JsonValue * tags = document.find("tags");
+  ASSERT_TRUE( tags != NULL && tags->isArray() );
+  ASSERT_EQ( 5, tags->size() );
+  ASSERT_EQ( Variant::SINT8, (*tags)[0].getValue().getFormat() );
+  ASSERT_EQ( 2.5, (*tags)[1].getValue().getFloat64() );
+  ASSERT_STREQ( "three", (*tags)[2].getValue().getString().c_str() );
+  ASSERT_TRUE( (*tags)[3].isArray() );
+  ASSERT_EQ( 0, (*tags)[3].size() );
+  ASSERT_TRUE( (*tags)[4].isObject() );
+
+  const JsonValue * nested = document.find("nested");
+  ASSERT_TRUE( nested != NULL && nested->isObject() );
+  ASSERT_TRUE( nested->find("value")->isNull() );
+  ASSERT_TRUE( nested->find("ok")->getValue().getBool() );
+
+  //documents are written without whitespace
+  ASSERT_EQ( std::string("{\"name\":\"libVariant\",\"tags\":[1,2.5,\"three\",[],{}],\"nested\":{\"value\":null,\"ok\":true},\"name\":\"duplicate\"}"), writeDocument(document) );
+
+  //deep nesting is limited
+  std::string deep(JsonReader::MAX_DEPTH, '[');
+  deep.append(JsonReader::MAX_DEPTH, ']');
+  ASSERT_TRUE( readDocument(deep).isArray() );
+  deep = "[" + deep + "]";
+  JsonReader reader;
+  JsonValue value;
+  ASSERT_FALSE( reader.read(deep.c_str(), deep.size(), value) );
+  ASSERT_EQ( JsonReader::MAX_DEPTH, reader.getErrorPosition() );
+}
+
+TEST_F(TestJson, testStrings)
+{
+  //escape sequences, multi-byte characters and strings longer than a word
+  std::string text = "[\"a\\\"b\\\\c\\/d\\b\\f\\n\\r\\t\", \"\\u00e9\\u20AC\\ud83d\\ude00\", \"caf\xc3\xa9 au lait, sans sucre\", \"x\\u0000y\"]";
+  JsonValue document = readDocument(text);
+  ASSERT_EQ( 4, document.size() );
+  ASSERT_STREQ( "a\"b\\c/d\b\f\n\r\t", document[0].getValue().getString().c_str() );
+  ASSERT_STREQ( "\xc3\xa9\xe2\x82\xac\xf0\x9f\x98\x80", document[1].getValue().getString().c_str() );
+  ASSERT_STREQ( "caf\xc3\xa9 au lait, sans sucre", document[2].getValue().getString().c_str() );
+  char buffer[8];
+  ASSERT_EQ( 3, document[3].getValue().getString(buffer, sizeof(buffer)) );
+  ASSERT_EQ( 0, memcmp(buffer, "x\0y", 3) );
+
+  //written strings are escaped
+  ASSERT_EQ( std::string("[\"a\\\"b\\\\c/d\\b\\f\\n\\r\\t\",\"\xc3\xa9\xe2\x82\xac\xf0\x9f\x98\x80\",\"caf\xc3\xa9 au lait, sans sucre\",\"x\\u0000y\"]"), writeDocument(document) );
+}
+
+TEST_F(TestJson, testZeroCopy)
+{
+  std::string text = "{\"plain\":\"a string without escape sequences\",\"escaped\":\"tab\\there\"}";
+  JsonReader reader;
+  JsonValue document;
+  ASSERT_TRUE( reader.readView(text.c_str(), text.size(), document) );
+
+  //names and strings without escape sequences reference the buffer
+  ASSERT_TRUE( document.getName(0).isStringView() );
+  const Variant & plain = document.find("plain")->getValue();
+  ASSERT_TRUE( plain.isStringView() );
+  ASSERT_STREQ( "a string without escape sequences", plain.getString().c_str() );
+  const Variant & escaped = document.find("escaped")->getValue();
+  ASSERT_FALSE( escaped.isStringView() );
+  ASSERT_STREQ( "tab\there", escaped.getString().c_str() );
+
+  //copies are independent of the buffer once materialized
+  JsonValue copy = document;
+  copy.materialize();
+  ASSERT_FALSE( copy.getName(0).isStringView() );
+  ASSERT_FALSE( copy.find("plain")->getValue().isStringView() );
+  text.assign(text.size(), '#');
+  ASSERT_STREQ( "a string without escape sequences", copy.find("plain")->getValue().getString().c_str() );
+
+  //read() copies all strings
+  text = "[\"value\"]";
+  ASSERT_TRUE( reader.read(text.c_str(), text.size(), document) );
+  ASSERT_FALSE( document[0].getValue().isStringView() );
+}
+
+TEST_F(TestJson, testWriter)
+{
+  JsonValue document(JsonValue::JSON_ARRAY);
+  document.append(Variant(true));
+  document.append(Variant(std::numeric_limits<uint64>::max()));
+  document.append(Variant(std::numeric_limits<sint64>::min()));
+  document.append(Variant(1.0));
+  document.append(Variant(-2.0f));
+  document.append(Variant(0.1));
+  document.append(Variant(5.6f));
+  document.append(Variant(1e300));
+  document.append(Variant(std::numeric_limits<float64>::quiet_NaN()));
+  document.append(Variant(std::numeric_limits<float64>::infinity()));
+  document.append(JsonValue());
+  JsonValue & object = document.append(JsonValue(JsonValue::JSON_OBJECT));
+  object.append("key", Variant("value"));
+  object.append("control", Variant("\x01\x1f"));
+
+  std::string text = writeDocument(document);
+  ASSERT_EQ( std::string("[true,18446744073709551615,-9223372036854775808,1.0,-2.0,0.1,5.6,1e+300,null,null,null,{\"key\":\"value\",\"control\":\"\\u0001\\u001f\"}]"), text );
+
+  //floating point values are read back as identical FLOAT64 values
+  JsonValue copy = readDocument(text);
+  ASSERT_EQ( document.size(), copy.size() );
+  ASSERT_EQ( Variant::FLOAT64, copy[3].getValue().getFormat() );
+  ASSERT_EQ( 0.1, copy[5].getValue().getFloat64() );
+  ASSERT_EQ( 1e300, copy[7].getValue().getFloat64() );
+  ASSERT_EQ( text, writeDocument(copy) );
+
+  //scalar documents and output larger than the buffer
+  std::ostringstream stream;
+  {
+    JsonWriter writer(stream);
+    writer.write(Variant(std::string(JsonWriter::BUFFER_SIZE + 10, '"').c_str()));
+  }
+  ASSERT_EQ( 2 * (JsonWriter::BUFFER_SIZE + 10) + 2, stream.str().size() );
+}
+
+TEST_F(TestJson, testLocale)
+{
+  //numbers use a '.' decimal point whatever the decimal point of the current C locale is
+  static const char * locales[] = {"de_DE.UTF-8", "fr_FR.UTF-8", "de_DE", "fr_FR", "German", "French"};
+  std::string previousLocale = setlocale(LC_NUMERIC, NULL);
+  bool found = false;
+  for(size_t i=0; i<sizeof(locales)/sizeof(locales[0]) && !found; i++)
+  {
+    found = (setlocale(LC_NUMERIC, locales[i]) != NULL);
+  }
+  if (!found)
+    return; //no locale with a ',' decimal point is installed
+
+  JsonReader reader;
+  JsonValue value;
+  static const char * TEXT = "[1.5,-0.25]";
+  bool success = reader.read(TEXT, strlen(TEXT), value);
+  std::string text = writeDocument(value);
+  setlocale(LC_NUMERIC, previousLocale.c_str());
+
+  ASSERT_TRUE( success );
+  ASSERT_EQ( 1.5, value[0].getValue().getFloat64() );
+  ASSERT_EQ( -0.25, value[1].getValue().getFloat64() );
+  ASSERT_EQ( std::string(TEXT), text );
+}
+
+TEST_F(TestJson, testInvalidDocuments)
+{
+  struct Invalid
+  {
+    const char * text;
+    size_t errorPosition;
+  };
+  static const Invalid INVALID[] = {
+    {"", 0},
+    {"   ", 3},
+    {"[1,]", 3},
+    {"[1 2]", 3},
+    {"{\"a\" 1}", 5},
+    {"{\"a\":1,}", 7},
+    {"{a:1}", 1},
+    {"[1", 2},
+    {"tru", 3},
+    {"nul!", 3},
+    {"01", 1},
+    {"-", 1},
+    {"1.", 2},
+    {"1e+", 3},
+    {".5", 0},
+    {"+1", 0},
+    {"\"abc", 4},
+    {"\"a\tb\"", 2},
+    {"\"\\x\"", 2},
+    {"\"\\u12G4\"", 5},
+    {"\"\\udc00\"", 6},
+    {"\"\\ud800x\"", 7},
+    {"[] []", 3},
+    {"{\"a\":[}", 6},
+  };
+  static const size_t NUM_INVALID = sizeof(INVALID)/sizeof(INVALID[0]);
+
+  for(size_t i=0; i<NUM_INVALID; i++)
+  {
+    JsonReader reader;
+    JsonValue value(JsonValue::JSON_ARRAY);
+    ASSERT_FALSE( reader.read(INVALID[i].text, strlen(INVALID[i].text), value) ) << INVALID[i].text;
+    ASSERT_EQ( INVALID[i].errorPosition, reader.getErrorPosition() ) << INVALID[i].text;
+    ASSERT_TRUE( value.isNull() );
+  }
+}
@@ -0,0 +1,259 @@
+/**********************************************************************************
+ * MIT License
+ * 
+ * Copyright (c) 2018 Antoine Beauchamp
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+#include "TestMappedVariantArray.h"
+#include "libvariant/mapped_variant_array.h"
+#include <limits>
+#include <stdio.h>
+#include <string.h>
+
+using namespace libVariant;
+
+static const char * FILE_PATH = "TestMappedVariantArray.bin";
+
+void TestMappedVariantArray::SetUp()
+{
+}
+
+void TestMappedVariantArray::TearDown()
+{
+  remove(FILE_PATH);
+}
+
+static void fillArray(VariantArray & oValues)
+{
+  oValues.push_back(Variant(true));
+  oValues.push_back(Variant(std::numeric_limits<uint8>::max()));
+  oValues.push_back(Variant(std::numeric_limits<uint16>::max()));
+  oValues.push_back(Variant(std::numeric_limits<uint32>::max()));
+  oValues.push_back(Variant(std::numeric_limits<uint64>::max()));
+  oValues.push_back(Variant(std::numeric_limits<sint8>::min()));
+  oValues.push_back(Variant(std::numeric_limits<sint16>::min()));
+  oValues.push_back(Variant(std::numeric_limits<sint32>::min()));
+  oValues.push_back(Variant(std::numeric_limits<sint64>::min()));
+  oValues.push_back(Variant(3.14159f));
+  oValues.push_back(Variant(1.0/3.0));
+  oValues.push_back(Variant(""));
+  oValues.push_back(Variant("foo"));
+  oValues.push_back(Variant("a long string which is not stored inline by the Variant class"));
+  oValues.push_back("a\0b", 3);
+}
+
+/// <summary>
+/// Overwrites the bytes of the file at the given offset.
+/// </summary>
+static void corruptFile(size_t iOffset, const void * iBytes, size_t iSize)
+{
+  FILE * f = fopen(FILE_PATH, "r+b");
+  ASSERT_TRUE( f != NULL );
+  fseek(f, static_cast<long>(iOffset), SEEK_SET);
+  fwrite(iBytes, 1, iSize, f);
+  fclose(f);
+}
+
+/// <summary>
+/// Reads a section offset of the header of the file. See FileHeader in MappedVariantArray.cpp.
+/// </summary>
+static uint64 readHeaderOffset(size_t iOffset)
+{
+  uint64 value = 0;
+  FILE * f = fopen(FILE_PATH, "rb");
+  if (f == NULL)
+    return 0;
+  fseek(f, static_cast<long>(iOffset), SEEK_SET);
+  if (fread(&value, sizeof(value), 1, f) != 1)
+    value = 0;
+  fclose(f);
+  return value;
+}
+
+TEST_F(TestMappedVariantArray, testRoundTrip)
+{
+  VariantArray values;
+  fillArray(values);
+  ASSERT_TRUE( MappedVariantArray::save(values, FILE_PATH) );
+
+  MappedVariantArray mapped;
+  ASSERT_FALSE( mapped.isOpen() );
+  ASSERT_TRUE( mapped.open(FILE_PATH) );
+  ASSERT_TRUE( mapped.isOpen() );
+  ASSERT_EQ( values.size(), mapped.size() );
+  for(size_t i=0; i<values.size(); i++)
+  {
+    ASSERT_EQ( values.getFormat(i), mapped.getFormat(i) );
+    Variant expected = values.get(i);
+    Variant view = mapped.getView(i);
+    Variant copy = mapped.get(i);
+    ASSERT_EQ( expected.getFormat(), view.getFormat() );
+    ASSERT_EQ( expected.getFormat(), copy.getFormat() );
+    ASSERT_EQ( 0, expected.compare(view) );
+    ASSERT_EQ( 0, expected.compare(copy) );
+    ASSERT_FALSE( copy.isStringView() );
+    if (values.getFormat(i) != Variant::STRING)
+    {
+      ASSERT_EQ( 0, memcmp(&values.getValues()[i], &mapped.getValues()[i], sizeof(Variant::VariantUnion)) );
+    }
+  }
+
+  //strings are served from the mapped memory, including embedded null characters
+  size_t length = 0;
+  const char * buffer = mapped.getStringBuffer(values.size() - 1, length);
+  ASSERT_EQ( 3, length );
+  ASSERT_EQ( 0, memcmp(buffer, "a\0b", 3) );
+  Variant view = mapped.getView(values.size() - 1);
+  ASSERT_TRUE( view.isStringView() );
+
+  mapped.close();
+  ASSERT_FALSE( mapped.isOpen() );
+  ASSERT_EQ( 0, mapped.size() );
+}
+
+TEST_F(TestMappedVariantArray, testOverwrittenStrings)
+{
+  VariantArray values;
+  fillArray(values);
+  for(size_t count=0; count<10; count++)
+  {
+    for(size_t i=0; i<values.size(); i++)
+      values.set(i, Variant("some string value which replaces the previous one"));
+  }
+  values.set(0, Variant("bar"));
+  values.set(1, Variant(42));
+  ASSERT_TRUE( MappedVariantArray::save(values, FILE_PATH) );
+
+  MappedVariantArray mapped;
+  ASSERT_TRUE( mapped.open(FILE_PATH) );
+  ASSERT_EQ( values.size(), mapped.size() );
+  ASSERT_STREQ( "bar", mapped.get(0).getString().c_str() );
+  ASSERT_EQ( 42, mapped.get(1).getSInt32() );
+  for(size_t i=2; i<values.size(); i++)
+  {
+    ASSERT_STREQ( "some string value which replaces the previous one", mapped.getView(i).getString().c_str() );
+  }
+
+  //only the characters of the current values are saved
+  FILE * f = fopen(FILE_PATH, "rb");
+  ASSERT_TRUE( f != NULL );
+  fseek(f, 0, SEEK_END);
+  long fileSize = ftell(f);
+  fclose(f);
+  ASSERT_LT( fileSize, static_cast<long>(values.getStringsSize()) );
+}
+
+TEST_F(TestMappedVariantArray, testEmpty)
+{
+  VariantArray values;
+  ASSERT_TRUE( MappedVariantArray::save(values, FILE_PATH) );
+
+  MappedVariantArray mapped;
+  ASSERT_TRUE( mapped.open(FILE_PATH) );
+  ASSERT_TRUE( mapped.empty() );
+
+  //reopening a file closes the previous one
+  values.push_back(Variant(5));
+  ASSERT_TRUE( MappedVariantArray::save(values, FILE_PATH) );
+  ASSERT_TRUE( mapped.open(FILE_PATH) );
+  ASSERT_EQ( 1, mapped.size() );
+  ASSERT_EQ( 5, mapped.get(0).getSInt32() );
+}
+
+TEST_F(TestMappedVariantArray, testInvalidFiles)
+{
+  MappedVariantArray mapped;
+  ASSERT_FALSE( mapped.open(NULL) );
+  ASSERT_FALSE( mapped.open("this file does not exist.bin") );
+  ASSERT_FALSE( mapped.isOpen() );
+
+  //not a mapped array file
+  FILE * f = fopen(FILE_PATH, "wb");
+  ASSERT_TRUE( f != NULL );
+  static const char TEXT[] = "this is not a file written by MappedVariantArray::save() but it is long enough for a header";
+  fwrite(TEXT, 1, sizeof(TEXT), f);
+  fclose(f);
+  ASSERT_FALSE( mapped.open(FILE_PATH) );
+  ASSERT_FALSE( mapped.isOpen() );
+
+  //truncated file
+  VariantArray values;
+  fillArray(values);
+  ASSERT_TRUE( MappedVariantArray::save(values, FILE_PATH) );
+  f = fopen(FILE_PATH, "rb");
+  ASSERT_TRUE( f != NULL );
+  char buffer[4096];
+  size_t fileSize = fread(buffer, 1, sizeof(buffer), f);
+  fclose(f);
+  ASSERT_LT( fileSize, sizeof(buffer) );
+  f = fopen(FILE_PATH, "wb");
+  ASSERT_TRUE( f != NULL );
+  fwrite(buffer, 1, fileSize - 1, f);
+  fclose(f);
+  ASSERT_FALSE( mapped.open(FILE_PATH) );
+  ASSERT_FALSE( mapped.isOpen() );
+}
+
+TEST_F(TestMappedVariantArray, testCorruptedFiles)
+{
+  //offsets of the sections in the header: magic, version, byte order, size, formats, values, strings
+  static const size_t FORMATS_OFFSET = 24;
+  static const size_t VALUES_OFFSET = 32;
+  static const size_t STRINGS_OFFSET = 40;
+  static const size_t STRING_INDEX = 13; //the long string of fillArray()
+  static const size_t BOOL_INDEX = 0;
+
+  VariantArray values;
+  fillArray(values);
+  ASSERT_EQ( Variant::STRING, values.getFormat(STRING_INDEX) );
+  ASSERT_EQ( Variant::BOOL, values.getFormat(BOOL_INDEX) );
+  MappedVariantArray mapped;
+
+  //unknown format
+  ASSERT_TRUE( MappedVariantArray::save(values, FILE_PATH) );
+  const uint8 badFormat = 0xFF;
+  corruptFile(static_cast<size_t>(readHeaderOffset(FORMATS_OFFSET)) + STRING_INDEX, &badFormat, sizeof(badFormat));
+  ASSERT_FALSE( mapped.open(FILE_PATH) );
+  ASSERT_FALSE( mapped.isOpen() );
+
+  //invalid bool value
+  ASSERT_TRUE( MappedVariantArray::save(values, FILE_PATH) );
+  const uint8 badBool = 2;
+  corruptFile(static_cast<size_t>(readHeaderOffset(VALUES_OFFSET)) + BOOL_INDEX * sizeof(Variant::VariantUnion), &badBool, sizeof(badBool));
+  ASSERT_FALSE( mapped.open(FILE_PATH) );
+
+  //string offset out of the strings section
+  ASSERT_TRUE( MappedVariantArray::save(values, FILE_PATH) );
+  const uint64 badOffset = 0xFFFFFFFFFFFFFFF0ull;
+  corruptFile(static_cast<size_t>(readHeaderOffset(VALUES_OFFSET)) + STRING_INDEX * sizeof(Variant::VariantUnion), &badOffset, sizeof(badOffset));
+  ASSERT_FALSE( mapped.open(FILE_PATH) );
+
+  //string length out of the strings section
+  ASSERT_TRUE( MappedVariantArray::save(values, FILE_PATH) );
+  const uint32 badLength = 0xFFFFFFFF;
+  corruptFile(static_cast<size_t>(readHeaderOffset(STRINGS_OFFSET)), &badLength, sizeof(badLength));
+  ASSERT_FALSE( mapped.open(FILE_PATH) );
+  ASSERT_FALSE( mapped.isOpen() );
+
+  //the original file is valid
+  ASSERT_TRUE( MappedVariantArray::save(values, FILE_PATH) );
+  ASSERT_TRUE( mapped.open(FILE_PATH) );
+  ASSERT_EQ( values.size(), mapped.size() );
+}
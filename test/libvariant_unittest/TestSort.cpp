@@ -0,0 +1,223 @@
+/**********************************************************************************
+ * MIT License
+ * 
+ * Copyright (c) 2018 Antoine Beauchamp
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+#include "TestSort.h"
+#include "libvariant/sort.h"
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+using namespace libVariant;
+
+void TestSort::SetUp()
+{
+}
+
+void TestSort::TearDown()
+{
+}
+
+static uint64 nextRandom(uint64 & ioSeed)
+{
+  ioSeed = ioSeed * 6364136223846793005ull + 1442695040888963407ull;
+  return ioSeed >> 16;
+}
+
+static Variant createString(const char * iValue, size_t iLength)
+{
+  Variant value;
+  value.setString(Str(iValue, iLength));
+  return value;
+}
+
+static bool isVariantLess(const Variant & iValue1, const Variant & iValue2)
+{
+  return iValue1.compare(iValue2) < 0;
+}
+
+static void assertSameValues(const std::vector<Variant> & iExpected, const std::vector<Variant> & iActual)
+{
+  ASSERT_EQ( iExpected.size(), iActual.size() );
+  for(size_t i=0; i<iExpected.size(); i++)
+  {
+    ASSERT_EQ( iExpected[i].getFormat(), iActual[i].getFormat() ) << "at index " << i;
+    ASSERT_EQ( iExpected[i].getString(), iActual[i].getString() ) << "at index " << i;
+  }
+}
+
+TEST_F(TestSort, testMatchCompare)
+{
+  //values of the same kind are sorted like std::stable_sort() with Variant::compare()
+  uint64 seed = 0;
+  for(size_t kind=0; kind<5; kind++)
+  {
+    std::vector<Variant> values;
+    for(size_t i=0; i<5000; i++)
+    {
+      const uint64 random = nextRandom(seed);
+      switch(kind)
+      {
+      case 0: values.push_back(Variant(static_cast<sint64>(random * 0x10001ull))); break;
+      case 1: values.push_back(Variant(static_cast<uint64>(random % 1000))); break;
+      case 2: values.push_back(Variant((static_cast<sint64>(random % 2000001) - 1000000) / 64.0)); break;
+      case 3: values.push_back(Variant(static_cast<float32>(static_cast<sint32>(random % 2001) - 1000) / 8.0f)); break;
+      default:
+        {
+          //strings which are not numbers with common prefixes
+          char buffer[16];
+          const size_t length = 1 + random % 14;
+          for(size_t c=0; c<length; c++)
+            buffer[c] = "ab\xE9"[(random >> (c * 2)) % 3];
+          values.push_back(createString(buffer, length));
+        }
+        break;
+      };
+    }
+
+    std::vector<Variant> expected = values;
+    std::stable_sort(expected.begin(), expected.end(), isVariantLess);
+    Sort::sort(&values[0], values.size());
+    assertSameValues(expected, values);
+  }
+}
+
+TEST_F(TestSort, testNumbers)
+{
+  //numbers are sorted by value regardless of their format, including integers which are not exact float64 values
+  std::vector<Variant> expected;
+  expected.push_back(Variant(-std::numeric_limits<float64>::infinity()));
+  expected.push_back(Variant(std::numeric_limits<sint64>::min()));
+  expected.push_back(Variant(static_cast<sint64>(std::numeric_limits<sint64>::min() + 1)));
+  expected.push_back(Variant(static_cast<sint64>(-9007199254740993ll)));
+  expected.push_back(Variant(-9007199254740992.0));
+  expected.push_back(Variant(static_cast<sint32>(-1)));
+  expected.push_back(Variant(-0.5f));
+  expected.push_back(Variant(-0.0));
+  expected.push_back(Variant(0.25));
+  expected.push_back(Variant(true));
+  expected.push_back(Variant(static_cast<uint32>(2)));
+  expected.push_back(Variant(static_cast<uint16>(300)));
+  expected.push_back(Variant(9007199254740992.0));
+  expected.push_back(Variant(static_cast<uint64>(9007199254740993ull)));
+  expected.push_back(Variant(static_cast<sint64>(std::numeric_limits<sint64>::max() - 1)));
+  expected.push_back(Variant(std::numeric_limits<sint64>::max()));
+  expected.push_back(Variant(static_cast<uint64>(9223372036854775808ull)));
+  expected.push_back(Variant(static_cast<uint64>(std::numeric_limits<uint64>::max() - 1)));
+  expected.push_back(Variant(std::numeric_limits<uint64>::max()));
+  expected.push_back(Variant(1e300));
+  expected.push_back(Variant(std::numeric_limits<float64>::infinity()));
+  expected.push_back(Variant(std::numeric_limits<float64>::quiet_NaN()));
+
+  //sort all rotations of the values
+  for(size_t r=0; r<expected.size(); r++)
+  {
+    std::vector<Variant> values = expected;
+    std::rotate(values.begin(), values.begin() + r, values.end());
+    VariantArray array;
+    for(size_t i=0; i<values.size(); i++)
+      array.push_back(values[i]);
+
+    Sort::sort(&values[0], values.size());
+    assertSameValues(expected, values);
+
+    Sort::sort(array);
+    for(size_t i=0; i<values.size(); i++)
+      values[i] = array.get(i);
+    assertSameValues(expected, values);
+  }
+
+  for(size_t i=0; i+1<expected.size(); i++)
+  {
+    ASSERT_GT( 0, Sort::compare(expected[i], expected[i+1]) ) << "at index " << i;
+    ASSERT_LT( 0, Sort::compare(expected[i+1], expected[i]) ) << "at index " << i;
+  }
+
+  //equal values of different formats
+  ASSERT_EQ( 0, Sort::compare(Variant(false), Variant(-0.0)) );
+  ASSERT_EQ( 0, Sort::compare(Variant(static_cast<uint8>(0)), Variant(0.0f)) );
+  ASSERT_EQ( 0, Sort::compare(Variant(static_cast<uint64>(9007199254740992ull)), Variant(9007199254740992.0)) );
+  ASSERT_EQ( 0, Sort::compare(Variant(true), Variant("1")) );
+}
+
+TEST_F(TestSort, testMixedValues)
+{
+  //numbers, numeric strings, NaN, then other strings. Equal values keep their order.
+  std::vector<Variant> values;
+  values.push_back(Variant("foo"));
+  values.push_back(Variant("10"));
+  values.push_back(Variant(std::numeric_limits<float32>::quiet_NaN()));
+  values.push_back(Variant(static_cast<uint8>(9)));
+  values.push_back(Variant("abcdefghijY"));
+  values.push_back(Variant(10.0));
+  values.push_back(Variant(""));
+  values.push_back(Variant("abcdefghijX"));
+  values.push_back(Variant(-3));
+  values.push_back(Variant("abcdefghij"));
+  values.push_back(Variant("9.5"));
+  values.push_back(Variant(" 2"));
+
+  std::vector<Variant> expected;
+  expected.push_back(Variant(-3));
+  expected.push_back(Variant("")); //simplified to 0
+  expected.push_back(Variant(static_cast<uint8>(9)));
+  expected.push_back(Variant("9.5"));
+  expected.push_back(Variant("10"));
+  expected.push_back(Variant(10.0));
+  expected.push_back(Variant(std::numeric_limits<float32>::quiet_NaN()));
+  expected.push_back(Variant(" 2"));
+  expected.push_back(Variant("abcdefghij"));
+  expected.push_back(Variant("abcdefghijX"));
+  expected.push_back(Variant("abcdefghijY"));
+  expected.push_back(Variant("foo"));
+
+  std::vector<size_t> order;
+  Sort::getOrder(&values[0], values.size(), order);
+  ASSERT_EQ( values.size(), order.size() );
+  ASSERT_EQ( 8, order[0] );
+  ASSERT_EQ( 1, order[4] ); //"10" is before 10.0
+  ASSERT_EQ( 5, order[5] );
+
+  Sort::sort(&values[0], values.size());
+  assertSameValues(expected, values);
+
+  //strings with embedded null characters and the same first characters
+  static const char * buffers[] = {"a\0", "a", "a\0b", "a\0\0"};
+  static const size_t lengths[] = {2, 1, 3, 3};
+  std::vector<Variant> strings(4);
+  VariantArray array;
+  for(size_t i=0; i<strings.size(); i++)
+  {
+    strings[i].setStringView(buffers[i], lengths[i]);
+    array.push_back(buffers[i], lengths[i]);
+  }
+  std::vector<Variant> sorted = strings;
+  std::stable_sort(sorted.begin(), sorted.end(), isVariantLess);
+  Sort::sort(&strings[0], strings.size());
+  for(size_t i=0; i<strings.size(); i++)
+    ASSERT_EQ( 0, strings[i].compare(sorted[i]) ) << "at index " << i;
+  Sort::getOrder(array, order);
+  ASSERT_EQ( 1, order[0] );
+  ASSERT_EQ( 0, order[1] );
+  ASSERT_EQ( 3, order[2] );
+  ASSERT_EQ( 2, order[3] );
+}
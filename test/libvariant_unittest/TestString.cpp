@@ -0,0 +1,222 @@
+/**********************************************************************************
+ * MIT License
+ * 
+ * Copyright (c) 2018 Antoine Beauchamp
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+#include "TestString.h"
+#include "libvariant/variant_string.h"
+#include "libvariant/allocator.h"
+#include <string>
+#include <utility>
+#include <string.h>
+
+using namespace libVariant;
+
+void TestString::SetUp()
+{
+}
+
+void TestString::TearDown()
+{
+}
+
+TEST_F(TestString, testInlineAndHeapStorage)
+{
+  String empty;
+  ASSERT_EQ( 0, empty.size() );
+  ASSERT_STREQ( "", empty.c_str() );
+  ASSERT_GE( empty.capacity(), 15 );
+
+  //short strings do not allocate
+  String s = "hello";
+  ASSERT_EQ( 5, s.size() );
+  ASSERT_STREQ( "hello", s.c_str() );
+  ASSERT_EQ( empty.capacity(), s.capacity() );
+
+  //long strings
+  const char * value = "a string value which is longer than the inline storage";
+  String l = value;
+  ASSERT_EQ( strlen(value), l.size() );
+  ASSERT_STREQ( value, l.c_str() );
+  ASSERT_GE( l.capacity(), strlen(value) );
+
+  //NULL strings
+  String n = (const char *)NULL;
+  ASSERT_EQ( 0, n.size() );
+  n = "foo";
+  n = (const char *)NULL;
+  ASSERT_STREQ( "", n.c_str() );
+
+  //characters
+  String c("abcdef", 3);
+  ASSERT_STREQ( "abc", c.c_str() );
+  String z(std::string("a\0b", 3).c_str(), 3);
+  ASSERT_EQ( 3, z.size() );
+}
+
+TEST_F(TestString, testReserve)
+{
+  String s = "foo";
+  size_t initial = s.capacity();
+  s.reserve(5);
+  ASSERT_EQ( initial, s.capacity() );
+  s.reserve(1000);
+  ASSERT_GE( s.capacity(), 1000 );
+  ASSERT_STREQ( "foo", s.c_str() );
+
+  //no reallocation while the capacity is large enough
+  const char * buffer = s.c_str();
+  for(size_t i=0; i<900; i++)
+  {
+    s.append("x", 1);
+  }
+  ASSERT_EQ( buffer, s.c_str() );
+  ASSERT_EQ( 903, s.size() );
+}
+
+TEST_F(TestString, testAppend)
+{
+  std::string expected;
+  String s;
+  for(size_t i=0; i<100; i++)
+  {
+    s.append("0123456789", i%10);
+    expected.append("0123456789", i%10);
+    ASSERT_EQ( expected.size(), s.size() );
+    ASSERT_EQ( expected, s.c_str() );
+  }
+
+  //append to itself, from the inline storage to the heap
+  {
+    String a = "0123456789";
+    a.append(a);
+    ASSERT_STREQ( "01234567890123456789", a.c_str() );
+    a.append(a.c_str(), 5);
+    ASSERT_STREQ( "0123456789012345678901234", a.c_str() );
+    a.append(a.c_str() + 20);
+    ASSERT_STREQ( "012345678901234567890123401234", a.c_str() );
+  }
+
+  //assign a part of itself
+  {
+    String a = "a string value which is longer than the inline storage";
+    a = a.c_str() + 9;
+    ASSERT_STREQ( "value which is longer than the inline storage", a.c_str() );
+    a = a.c_str() + 38;
+    ASSERT_STREQ( "storage", a.c_str() );
+  }
+}
+
+TEST_F(TestString, testCopyMoveAndSwap)
+{
+  const char * longValue = "a string value which is longer than the inline storage";
+  String s = "short";
+  String l = longValue;
+
+  String copy1 = s;
+  String copy2 = l;
+  ASSERT_TRUE( copy1 == s );
+  ASSERT_TRUE( copy2 == l );
+
+  String moved1 = std::move(copy1);
+  String moved2 = std::move(copy2);
+  ASSERT_STREQ( "short", moved1.c_str() );
+  ASSERT_STREQ( longValue, moved2.c_str() );
+  ASSERT_EQ( 0, copy1.size() );
+  ASSERT_EQ( 0, copy2.size() );
+
+  moved1.swap(moved2);
+  ASSERT_STREQ( longValue, moved1.c_str() );
+  ASSERT_STREQ( "short", moved2.c_str() );
+  swap(moved1, moved2);
+  ASSERT_STREQ( "short", moved1.c_str() );
+  ASSERT_STREQ( longValue, moved2.c_str() );
+
+  moved1 = std::move(moved2);
+  ASSERT_STREQ( longValue, moved1.c_str() );
+  ASSERT_EQ( 0, moved2.size() );
+  moved2 = moved1;
+  ASSERT_TRUE( moved1 == moved2 );
+  ASSERT_FALSE( moved1 < moved2 );
+  ASSERT_TRUE( String("abc") < String("abd") );
+  ASSERT_TRUE( String("abc") < String("abcd") );
+}
+
+/// <summary>
+/// An allocator which counts the allocations and deallocations.
+/// </summary>
+class StringCountingAllocator : public Allocator
+{
+public:
+  StringCountingAllocator() : allocations(0), deallocations(0) {}
+
+  virtual void * allocate(size_t iSize)
+  {
+    allocations++;
+    return Allocator::getDefault().allocate(iSize);
+  }
+
+  virtual void deallocate(void * iBuffer, size_t iSize)
+  {
+    deallocations++;
+    Allocator::getDefault().deallocate(iBuffer, iSize);
+  }
+
+  size_t allocations;
+  size_t deallocations;
+};
+
+TEST_F(TestString, testAllocator)
+{
+  static const char * LONG_STRING = "a string value which is longer than the inline storage";
+  StringCountingAllocator counter;
+  {
+    AllocatorScope scope(counter);
+
+    //short strings are stored inline
+    String s = "short";
+    ASSERT_EQ( 0, counter.allocations );
+
+    s.append(LONG_STRING);
+    ASSERT_EQ( 1, counter.allocations );
+    String copy = s;
+    ASSERT_EQ( 2, counter.allocations );
+
+    //moves do not allocate
+    String moved = std::move(copy);
+    ASSERT_EQ( 2, counter.allocations );
+  }
+  ASSERT_EQ( 2, counter.deallocations );
+
+  //memory is released by the allocator which allocated it
+  {
+    String s;
+    {
+      AllocatorScope scope(counter);
+      s = LONG_STRING;
+    }
+    ASSERT_EQ( 3, counter.allocations );
+    s.append(LONG_STRING); //grows with the default allocator
+    ASSERT_EQ( 3, counter.allocations );
+    ASSERT_EQ( 3, counter.deallocations );
+  }
+  ASSERT_EQ( 3, counter.deallocations );
+}
@@ -26,6 +26,11 @@
 #include "TestStringEncoder.h"
 #include "StringEncoder.h"
 
+#include <sstream>
+#include <cstdlib> //strtod, rand
+#include <cstdio> //sprintf
+#include <clocale> //setlocale
+
 using namespace libVariant;
 
 typedef std::vector<float> FloatList;
@@ -99,3 +104,208 @@ TEST_F(TestStringEncoder, testFloatDecoding)
     ASSERT_EQ(fExpected, fActual);
   }
 }
+
+template <typename T>
+std::string toStringStream(const T & value, int precision)
+{
+  std::stringstream out;
+  if (precision > 0)
+    out.precision(precision);
+  out << value;
+  return out.str();
+}
+
+template <typename T>
+void assertToChars(const T & value, const std::string & expected)
+{
+  char buffer[StringEncoder::MAX_CHARS_SIZE];
+  size_t length = StringEncoder::toChars(buffer, sizeof(buffer), value);
+  ASSERT_EQ(expected.size(), length);
+  ASSERT_EQ(expected, std::string(buffer));
+}
+
+TEST_F(TestStringEncoder, testToChars)
+{
+  //integers must be identical to std::stringstream
+  static const libVariant::uint64 unsignedValues[] = { 0, 1, 9, 10, 99, 100, 101, 127, 128, 255, 256, 999, 1000, 32767, 65535, 65536, 1234567890, 4294967295ull, 4294967296ull, 9223372036854775807ull, 9223372036854775808ull, 18446744073709551615ull };
+  for(size_t i=0; i<sizeof(unsignedValues)/sizeof(unsignedValues[0]); i++)
+  {
+    libVariant::uint64 u = unsignedValues[i];
+    libVariant::sint64 s = static_cast<libVariant::sint64>(u);
+    ASSERT_NO_FATAL_FAILURE( assertToChars(u, toStringStream(u, 0)) );
+    ASSERT_NO_FATAL_FAILURE( assertToChars(s, toStringStream(s, 0)) );
+    ASSERT_NO_FATAL_FAILURE( assertToChars(static_cast<libVariant::sint64>(0 - u), toStringStream(static_cast<libVariant::sint64>(0 - u), 0)) );
+    ASSERT_EQ(toStringStream(u, 0), StringEncoder::toString(u));
+    ASSERT_EQ(toStringStream(s, 0), StringEncoder::toString(s));
+    ASSERT_NO_FATAL_FAILURE( assertToChars(static_cast<libVariant::uint32>(u), toStringStream(static_cast<libVariant::uint32>(u), 0)) );
+    ASSERT_NO_FATAL_FAILURE( assertToChars(static_cast<libVariant::sint32>(u), toStringStream(static_cast<libVariant::sint32>(u), 0)) );
+    ASSERT_NO_FATAL_FAILURE( assertToChars(static_cast<libVariant::uint16>(u), toStringStream(static_cast<libVariant::uint16>(u), 0)) );
+    ASSERT_NO_FATAL_FAILURE( assertToChars(static_cast<libVariant::sint16>(u), toStringStream(static_cast<libVariant::sint16>(u), 0)) );
+    ASSERT_NO_FATAL_FAILURE( assertToChars(static_cast<libVariant::uint8 >(u), toStringStream(static_cast<int>(static_cast<libVariant::uint8>(u)), 0)) );
+    ASSERT_NO_FATAL_FAILURE( assertToChars(static_cast<libVariant::sint8 >(u), toStringStream(static_cast<int>(static_cast<libVariant::sint8>(u)), 0)) );
+  }
+
+  //floating points must be identical to std::stringstream using the same precision
+  static const double floatValues[] = { 0.0, -0.0, 1.0, -1.0, 0.1, 0.5, 3.14159265358979, 123.1234567, 1e20, 1.5e-5, 1e-45, 16777217.0, 123456789.0, FLT_MAX, FLT_MIN, DBL_MAX, DBL_MIN, 4.9e-324 };
+  for(size_t i=0; i<sizeof(floatValues)/sizeof(floatValues[0]); i++)
+  {
+    double d = floatValues[i];
+    float f = static_cast<float>(d);
+    ASSERT_NO_FATAL_FAILURE( assertToChars(f, toStringStream(f, FLT_DIG+2)) );
+    ASSERT_NO_FATAL_FAILURE( assertToChars(-f, toStringStream(-f, FLT_DIG+2)) );
+    ASSERT_NO_FATAL_FAILURE( assertToChars(d, toStringStream(d, DBL_DIG)) );
+    ASSERT_NO_FATAL_FAILURE( assertToChars(-d, toStringStream(-d, DBL_DIG)) );
+    ASSERT_EQ(toStringStream(f, FLT_DIG+2), StringEncoder::toString(f));
+    ASSERT_EQ(toStringStream(d, DBL_DIG), StringEncoder::toString(d));
+  }
+
+  ASSERT_NO_FATAL_FAILURE( assertToChars(true, "true") );
+  ASSERT_NO_FATAL_FAILURE( assertToChars(false, "false") );
+}
+
+TEST_F(TestStringEncoder, testToCharsTruncation)
+{
+  char buffer[4] = { 'x', 'x', 'x', 'x' };
+
+  //too small
+  ASSERT_EQ(5u, StringEncoder::toChars(buffer, sizeof(buffer), static_cast<libVariant::sint32>(-1234)));
+  ASSERT_EQ(std::string("-12"), buffer);
+  ASSERT_EQ(5u, StringEncoder::toChars(buffer, sizeof(buffer), false));
+  ASSERT_EQ(std::string("fal"), buffer);
+  ASSERT_EQ(7u, StringEncoder::toChars(buffer, sizeof(buffer), 0.03125f));
+  ASSERT_EQ(std::string("0.0"), buffer);
+
+  //no buffer at all
+  ASSERT_EQ(3u, StringEncoder::toChars(NULL, 0, static_cast<libVariant::uint16>(123)));
+}
+
+TEST_F(TestStringEncoder, testToCharsLocale)
+{
+  //values are printed with a '.' decimal point whatever the decimal point of the current C locale is
+  static const char * locales[] = {"de_DE.UTF-8", "fr_FR.UTF-8", "de_DE", "fr_FR", "German", "French"};
+  std::string previousLocale = setlocale(LC_NUMERIC, NULL);
+  bool found = false;
+  for(size_t i=0; i<sizeof(locales)/sizeof(locales[0]) && !found; i++)
+  {
+    found = (setlocale(LC_NUMERIC, locales[i]) != NULL);
+  }
+  if (!found)
+    return; //no locale with a ',' decimal point is installed
+
+  char float32Buffer[StringEncoder::MAX_CHARS_SIZE];
+  char float64Buffer[StringEncoder::MAX_CHARS_SIZE];
+  StringEncoder::toChars(float32Buffer, sizeof(float32Buffer), 3.5f);
+  StringEncoder::toChars(float64Buffer, sizeof(float64Buffer), -0.25);
+  setlocale(LC_NUMERIC, previousLocale.c_str());
+
+  ASSERT_EQ(std::string("3.5"), float32Buffer);
+  ASSERT_EQ(std::string("-0.25"), float64Buffer);
+}
+
+TEST_F(TestStringEncoder, testShortestChars)
+{
+  struct Float64Value { double value; const char * expected; };
+  static const Float64Value float64Values[] = {
+    { 0.0, "0" }, { -0.0, "-0" }, { 1.0, "1" }, { 100.0, "100" }, { 0.1, "0.1" }, { 0.1+0.2, "0.30000000000000004" }, { -1.5, "-1.5" },
+    { 0.0001, "0.0001" }, { 0.00001, "1e-05" }, { 1e15, "1e+15" }, { 123456789012345.6, "123456789012345.6" }, { 1e21, "1e+21" },
+    { 9007199254740992.0, "9007199254740992" }, { 4.9406564584124654e-324, "5e-324" }, { DBL_MAX, "1.7976931348623157e+308" },
+    { 28.932178932178932, "28.93217893217893" }, { 5e-324 * 3, "1.5e-323" }, { 9.5e-5, "9.5e-05" },
+  };
+  for(size_t i=0; i<sizeof(float64Values)/sizeof(float64Values[0]); i++)
+  {
+    char buffer[StringEncoder::MAX_CHARS_SIZE];
+    size_t length = StringEncoder::toShortestChars(buffer, sizeof(buffer), float64Values[i].value);
+    ASSERT_EQ(std::string(float64Values[i].expected), buffer);
+    ASSERT_EQ(strlen(buffer), length);
+  }
+
+  struct Float32Value { float value; const char * expected; };
+  static const Float32Value float32Values[] = {
+    { 0.0f, "0" }, { 0.1f, "0.1" }, { 0.3f, "0.3" }, { 16777216.0f, "16777216" }, { 1e8f, "1e+08" }, { 123456789.0f, "1.2345679e+08" },
+    { 1e-5f, "1e-05" }, { 1.17549435e-38f, "1.1754944e-38" }, { 1.4e-45f, "1e-45" }, { FLT_MAX, "3.4028235e+38" },
+  };
+  for(size_t i=0; i<sizeof(float32Values)/sizeof(float32Values[0]); i++)
+  {
+    char buffer[StringEncoder::MAX_CHARS_SIZE];
+    size_t length = StringEncoder::toShortestChars(buffer, sizeof(buffer), float32Values[i].value);
+    ASSERT_EQ(std::string(float32Values[i].expected), buffer);
+    ASSERT_EQ(strlen(buffer), length);
+  }
+}
+
+/// <summary>
+/// Returns the number of significant digits of a printed floating point value.
+/// </summary>
+static size_t countSignificantDigits(const char * iValue)
+{
+  std::string digits;
+  for(const char * c = iValue; *c != '\0' && *c != 'e'; c++)
+  {
+    if (*c >= '0' && *c <= '9' && (*c != '0' || !digits.empty()))
+      digits += *c;
+  }
+  while (digits.size() > 1 && digits[digits.size() - 1] == '0')
+    digits.erase(digits.size() - 1);
+  return digits.size();
+}
+
+/// <summary>
+/// Returns the smallest precision of "%.*g" which parses back to the given value.
+/// Some values have even shorter representations which are not the correctly rounded ones.
+/// </summary>
+static int getRoundTripPrecision(double iValue)
+{
+  char buffer[64];
+  for(int precision = 1; precision < 17; precision++)
+  {
+    sprintf(buffer, "%.*g", precision, iValue);
+    if (strtod(buffer, NULL) == iValue)
+      return precision;
+  }
+  return 17;
+}
+
+static int getRoundTripPrecision(float iValue)
+{
+  char buffer[64];
+  for(int precision = 1; precision < 9; precision++)
+  {
+    sprintf(buffer, "%.*g", precision, iValue);
+    if (strtof(buffer, NULL) == iValue)
+      return precision;
+  }
+  return 9;
+}
+
+TEST_F(TestStringEncoder, testShortestCharsRoundTrip)
+{
+  srand(0);
+  for(size_t i=0; i<100000; i++)
+  {
+    //random bits
+    libVariant::uint64 bits = 0;
+    for(size_t j=0; j<4; j++)
+      bits = (bits << 16) ^ static_cast<libVariant::uint64>(rand() & 0xFFFF);
+
+    double d;
+    memcpy(&d, &bits, sizeof(d));
+    if (d == d && d <= DBL_MAX && d >= -DBL_MAX)
+    {
+      char buffer[StringEncoder::MAX_CHARS_SIZE];
+      StringEncoder::toShortestChars(buffer, sizeof(buffer), d);
+      ASSERT_EQ(d, strtod(buffer, NULL)) << "buffer=" << buffer;
+      ASSERT_LE(countSignificantDigits(buffer), static_cast<size_t>(getRoundTripPrecision(d))) << "buffer=" << buffer;
+    }
+
+    float f;
+    libVariant::uint32 fbits = static_cast<libVariant::uint32>(bits);
+    memcpy(&f, &fbits, sizeof(f));
+    if (f == f && f <= FLT_MAX && f >= -FLT_MAX)
+    {
+      char buffer[StringEncoder::MAX_CHARS_SIZE];
+      StringEncoder::toShortestChars(buffer, sizeof(buffer), f);
+      ASSERT_EQ(f, strtof(buffer, NULL)) << "buffer=" << buffer;
+      ASSERT_LE(countSignificantDigits(buffer), static_cast<size_t>(getRoundTripPrecision(f))) << "buffer=" << buffer;
+    }
+  }
+}
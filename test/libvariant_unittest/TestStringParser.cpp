@@ -0,0 +1,241 @@
+/**********************************************************************************
+ * MIT License
+ * 
+ * Copyright (c) 2018 Antoine Beauchamp
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+
+
+#include "TestStringParser.h"
+#include "libvariant/variant.h"
+#include "StringEncoder.h"
+#include "StringParser.h"
+
+#include <algorithm> //std::transform
+#include <cstdlib> //rand
+#include <clocale> //setlocale
+
+using namespace libVariant;
+
+namespace TestStringParserUtils
+{
+  //Reference implementation: parses a string with StringEncoder and converts the value back to string.
+  template <typename T>
+  void referenceParse(const std::string & iValue, T & oParsedValue, bool & oParseSucess)
+  {
+    oParsedValue = StringEncoder::parse<T>( iValue );
+    std::string parsedStr = StringEncoder::toString( oParsedValue );
+    oParseSucess = (parsedStr.substr(0, iValue.size()) == iValue);
+  }
+
+  void referenceParse(const std::string & iValue, StringParser & p)
+  {
+    std::string uppercaseValue = iValue;
+    std::transform(uppercaseValue.begin(), uppercaseValue.end(), uppercaseValue.begin(), ::toupper);
+    p.is_Boolean = (uppercaseValue == "TRUE" || uppercaseValue == "FALSE");
+    p.parsed_boolean = (uppercaseValue == "TRUE");
+
+    referenceParse(iValue, p.parsed_uint8  , p.is_UInt8  );
+    referenceParse(iValue, p.parsed_sint8  , p.is_SInt8  );
+    referenceParse(iValue, p.parsed_uint16 , p.is_UInt16 );
+    referenceParse(iValue, p.parsed_sint16 , p.is_SInt16 );
+    referenceParse(iValue, p.parsed_uint32 , p.is_UInt32 );
+    referenceParse(iValue, p.parsed_sint32 , p.is_SInt32 );
+    referenceParse(iValue, p.parsed_uint64 , p.is_UInt64 );
+    referenceParse(iValue, p.parsed_sint64 , p.is_SInt64 );
+    referenceParse(iValue, p.parsed_float32, p.is_Float32);
+    referenceParse(iValue, p.parsed_float64, p.is_Float64);
+  }
+
+  //Compares the parsed values of the types that were succesfully parsed
+  void assertSameParsing(const std::string & iValue)
+  {
+    StringParser expected;
+    referenceParse(iValue, expected);
+
+    StringParser actual;
+    actual.parse(iValue.c_str());
+
+    ASSERT_EQ(expected.is_Boolean, actual.is_Boolean) << "value=\"" << iValue << "\"";
+    ASSERT_EQ(expected.is_UInt8  , actual.is_UInt8  ) << "value=\"" << iValue << "\"";
+    ASSERT_EQ(expected.is_UInt16 , actual.is_UInt16 ) << "value=\"" << iValue << "\"";
+    ASSERT_EQ(expected.is_UInt32 , actual.is_UInt32 ) << "value=\"" << iValue << "\"";
+    ASSERT_EQ(expected.is_UInt64 , actual.is_UInt64 ) << "value=\"" << iValue << "\"";
+    ASSERT_EQ(expected.is_SInt8  , actual.is_SInt8  ) << "value=\"" << iValue << "\"";
+    ASSERT_EQ(expected.is_SInt16 , actual.is_SInt16 ) << "value=\"" << iValue << "\"";
+    ASSERT_EQ(expected.is_SInt32 , actual.is_SInt32 ) << "value=\"" << iValue << "\"";
+    ASSERT_EQ(expected.is_SInt64 , actual.is_SInt64 ) << "value=\"" << iValue << "\"";
+    ASSERT_EQ(expected.is_Float32, actual.is_Float32) << "value=\"" << iValue << "\"";
+    ASSERT_EQ(expected.is_Float64, actual.is_Float64) << "value=\"" << iValue << "\"";
+
+    if (expected.is_Boolean)
+    {
+      ASSERT_EQ(expected.parsed_boolean, actual.parsed_boolean) << "value=\"" << iValue << "\"";
+    }
+    if (expected.is_UInt8  )
+    {
+      ASSERT_EQ(expected.parsed_uint8  , actual.parsed_uint8  ) << "value=\"" << iValue << "\"";
+    }
+    if (expected.is_UInt16 )
+    {
+      ASSERT_EQ(expected.parsed_uint16 , actual.parsed_uint16 ) << "value=\"" << iValue << "\"";
+    }
+    if (expected.is_UInt32 )
+    {
+      ASSERT_EQ(expected.parsed_uint32 , actual.parsed_uint32 ) << "value=\"" << iValue << "\"";
+    }
+    if (expected.is_UInt64 )
+    {
+      ASSERT_EQ(expected.parsed_uint64 , actual.parsed_uint64 ) << "value=\"" << iValue << "\"";
+    }
+    if (expected.is_SInt8  )
+    {
+      ASSERT_EQ(expected.parsed_sint8  , actual.parsed_sint8  ) << "value=\"" << iValue << "\"";
+    }
+    if (expected.is_SInt16 )
+    {
+      ASSERT_EQ(expected.parsed_sint16 , actual.parsed_sint16 ) << "value=\"" << iValue << "\"";
+    }
+    if (expected.is_SInt32 )
+    {
+      ASSERT_EQ(expected.parsed_sint32 , actual.parsed_sint32 ) << "value=\"" << iValue << "\"";
+    }
+    if (expected.is_SInt64 )
+    {
+      ASSERT_EQ(expected.parsed_sint64 , actual.parsed_sint64 ) << "value=\"" << iValue << "\"";
+    }
+    if (expected.is_Float32)
+    {
+      ASSERT_EQ(expected.parsed_float32, actual.parsed_float32) << "value=\"" << iValue << "\"";
+    }
+    if (expected.is_Float64)
+    {
+      ASSERT_EQ(expected.parsed_float64, actual.parsed_float64) << "value=\"" << iValue << "\"";
+    }
+  }
+} // End namespace
+
+void TestStringParser::SetUp()
+{
+}
+
+void TestStringParser::TearDown()
+{
+}
+
+TEST_F(TestStringParser, testKnownValues)
+{
+  static const char * values[] = {
+    "", "0", "-0", "1", "-1", "007", "-007", "00", "+5", " 5", "5 ", "-", "+", ".", "-.", "e", "abc", "5abc",
+    "true", "false", "TRUE", "False", "tRuE", "truee", "t", "yes",
+    "127", "128", "-128", "-129", "255", "256", "-255",
+    "32767", "32768", "-32768", "-32769", "65535", "65536",
+    "2147483647", "2147483648", "-2147483648", "-2147483649", "4294967295", "4294967296",
+    "9223372036854775807", "9223372036854775808", "-9223372036854775808", "-9223372036854775809",
+    "18446744073709551615", "18446744073709551616", "99999999999999999999", "-99999999999999999999",
+    "16777216", "16777217", "-16777217", "99999999", "100000000", "123456789",
+    "999999999999999", "1000000000000000", "9007199254740993",
+    "1.0", "1.5", "-1.5", "0.1", "-0.1", "3.14", "3.140", "0.5", ".5", "5.", "1.", "1.2.3", "1..2", "--1", "1-2",
+    "0.416666666666667", "0.41666666666666702", "0.41666667", "123.12346", "123.123456789", "0.12312346", "123123.45",
+    "1e5", "1e+05", "1e+20", "1e+30", "1e+39", "-1e+20", "1e-05", "1e-5", "1.5e-05", "1.5e-5", "1e", "1e+", "1e-", "1.5e+2",
+    "3.4028235e+38", "3.4028236e+38", "3.5e+38", "1.7976931348623157e+308", "1.79769313486232e+308", "-1.79769313486232e+308", "1e+309", "3.40282357e+38", "-3.4028236e+38",
+    "1.4e-45", "1.40129846e-45", "4.94065645841247e-324", "1e-400",
+    "0.000015", "0.0001", "0.00001", "1.17549435e-38", "2.2250738585072e-308",
+    "0.30000000000000004", "-0.30000000000000004", "0.30000000000000005", "1.2345678901234568e+17", "2.2250738585072014e-308", "5e-324", "1.1754944e-38",
+    "1.7976931348623157e+308", "9007199254740993", "1234567890123456", "1.0000001", "0.33333334", "0.333333343", "5.6", "5.5999999",
+    "inf", "-inf", "INF", "nan", "NaN", "infinity", "0x10", "0x1p3", "1,5", "1_000",
+  };
+  static const size_t numValues = sizeof(values)/sizeof(values[0]);
+
+  //the results do not depend on the float formatting policy
+  for(size_t policy=0; policy<2; policy++)
+  {
+    Variant::setFloatFormattingPolicy(policy == 0 ? Variant::FIXED_PRECISION : Variant::SHORTEST_ROUND_TRIP);
+    for(size_t i=0; i<numValues; i++)
+    {
+      ASSERT_NO_FATAL_FAILURE( TestStringParserUtils::assertSameParsing(values[i]) ) << "policy=" << policy;
+    }
+  }
+  Variant::setFloatFormattingPolicy(Variant::FIXED_PRECISION);
+}
+
+TEST_F(TestStringParser, testRandomValues)
+{
+  static const char alphabet[] = "0123456789-+.e";
+  static const size_t alphabetLength = sizeof(alphabet) - 1;
+
+  srand(0);
+  for(size_t i=0; i<20000; i++)
+  {
+    std::string value;
+    size_t length = rand() % 12;
+    for(size_t j=0; j<length; j++)
+    {
+      //favor digits
+      if (rand() % 3 == 0)
+        value += alphabet[rand() % alphabetLength];
+      else
+        value += alphabet[rand() % 10];
+    }
+    ASSERT_NO_FATAL_FAILURE( TestStringParserUtils::assertSameParsing(value) );
+  }
+}
+
+TEST_F(TestStringParser, testLength)
+{
+  //characters past the given length must be ignored
+  StringParser p;
+  p.parse("255.5", 3);
+  ASSERT_TRUE(p.is_UInt8);
+  ASSERT_EQ(255, p.parsed_uint8);
+  ASSERT_FALSE(p.is_SInt8);
+
+  StringParser q;
+  q.parse("trueblue", 4);
+  ASSERT_TRUE(q.is_Boolean);
+  ASSERT_TRUE(q.parsed_boolean);
+}
+
+TEST_F(TestStringParser, testLocale)
+{
+  //values are parsed with a '.' decimal point whatever the decimal point of the current C locale is
+  static const char * locales[] = {"de_DE.UTF-8", "fr_FR.UTF-8", "de_DE", "fr_FR", "German", "French"};
+  std::string previousLocale = setlocale(LC_NUMERIC, NULL);
+  bool found = false;
+  for(size_t i=0; i<sizeof(locales)/sizeof(locales[0]) && !found; i++)
+  {
+    found = (setlocale(LC_NUMERIC, locales[i]) != NULL);
+  }
+  if (!found)
+    return; //no locale with a ',' decimal point is installed
+
+  StringParser p;
+  p.parse("3.5", 3);
+  StringParser q;
+  q.parse("0.1", 3);
+  setlocale(LC_NUMERIC, previousLocale.c_str());
+
+  ASSERT_TRUE(p.is_Float32);
+  ASSERT_EQ(3.5f, p.parsed_float32);
+  ASSERT_TRUE(p.is_Float64);
+  ASSERT_EQ(3.5, p.parsed_float64);
+  ASSERT_TRUE(q.is_Float64);
+  ASSERT_EQ(0.1, q.parsed_float64);
+}
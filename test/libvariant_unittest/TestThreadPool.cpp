@@ -0,0 +1,102 @@
+/**********************************************************************************
+ * MIT License
+ * 
+ * Copyright (c) 2018 Antoine Beauchamp
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+#include "TestThreadPool.h"
+#include "libvariant/thread_pool.h"
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+using namespace libVariant;
+
+void TestThreadPool::SetUp()
+{
+}
+
+void TestThreadPool::TearDown()
+{
+}
+
+TEST_F(TestThreadPool, testParallelFor)
+{
+  static const size_t numThreads[] = {1, 2, 4, 0};
+  for(size_t t=0; t<sizeof(numThreads)/sizeof(numThreads[0]); t++)
+  {
+    ThreadPool pool(numThreads[t]);
+    ASSERT_TRUE( pool.getNumThreads() >= 1 );
+    if (numThreads[t] > 0)
+    {
+      ASSERT_EQ( numThreads[t], pool.getNumThreads() );
+    }
+
+    //each task is processed once
+    for(size_t loop=0; loop<20; loop++)
+    {
+      const size_t count = loop * 37;
+      std::vector<std::atomic<int> > calls(count);
+      for(size_t i=0; i<count; i++)
+        calls[i] = 0;
+      pool.parallelFor(count, [&](size_t iIndex) { calls[iIndex]++; });
+      for(size_t i=0; i<count; i++)
+        ASSERT_EQ( 1, calls[i].load() ) << "threads=" << numThreads[t] << " count=" << count << " index=" << i;
+    }
+  }
+}
+
+TEST_F(TestThreadPool, testExceptions)
+{
+  ThreadPool pool(4);
+  std::atomic<size_t> calls(0);
+  bool thrown = false;
+  try
+  {
+    pool.parallelFor(100, [&](size_t iIndex)
+    {
+      calls++;
+      if (iIndex % 10 == 3)
+        throw std::runtime_error("task failed");
+    });
+  }
+  catch(const std::runtime_error &)
+  {
+    thrown = true;
+  }
+  ASSERT_TRUE( thrown );
+  ASSERT_EQ( 100, calls.load() );
+
+  //the pool is still usable
+  calls = 0;
+  pool.parallelFor(100, [&](size_t /*iIndex*/) { calls++; });
+  ASSERT_EQ( 100, calls.load() );
+}
+
+TEST_F(TestThreadPool, testNestedLoops)
+{
+  ThreadPool pool(3);
+  std::atomic<size_t> calls(0);
+  pool.parallelFor(10, [&](size_t /*iIndex*/)
+  {
+    pool.parallelFor(10, [&](size_t /*iIndex*/) { calls++; });
+  });
+  ASSERT_EQ( 100, calls.load() );
+}
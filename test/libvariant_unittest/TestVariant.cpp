@@ -26,11 +26,16 @@
 #include <string>
 #include <vector>
 #include <algorithm>
+#include <utility>
+#include <thread>
+#include <unordered_map>
 #include <stdlib.h>     /* srand, rand */
+#include <string.h>     /* strlen, strncmp */
 #include <time.h>       /* time */
 
 #include "libvariant/config.h"
 #include "libvariant/variant.h"
+#include "libvariant/compact_variant.h"
 
 #include "gtesthelper.h"
 #include "TestVariant.h"
@@ -1529,6 +1534,232 @@ TEST_F(TestVariant, testCopyCtor)
   }
 }
 
+TEST_F(TestVariant, testShortStringOptimization)
+{
+  //build strings of all lengths around the inline capacity
+  for(size_t length = 0; length <= 40; length++)
+  {
+    Str expected;
+    for(size_t i=0; i<length; i++)
+    {
+      char c[] = {(char)('a' + (i%26)), '\0'};
+      expected.append(c);
+    }
+
+    Variant v1(expected);
+    ASSERT_EQ( Variant::STRING, v1.getFormat() );
+    ASSERT_EQ( expected, v1.getString() );
+
+    //copy ctor and assign operator
+    Variant v2(v1);
+    ASSERT_EQ( expected, v2.getString() );
+    Variant v3 = (uint8)5;
+    v3 = v1;
+    ASSERT_EQ( expected, v3.getString() );
+    ASSERT_TRUE( v1 == v3 );
+
+    //self assignment
+    v3 = v3;
+    ASSERT_EQ( expected, v3.getString() );
+
+    //string concatenation from inline to heap
+    Variant v4(expected);
+    v4 += Variant("0123456789");
+    Str expectedConcat = expected;
+    expectedConcat.append("0123456789");
+    ASSERT_EQ( expectedConcat, v4.getString() );
+
+    //back to a short string
+    v4 = "foo";
+    ASSERT_EQ( Str("foo"), v4.getString() );
+  }
+
+  //self concatenation
+  {
+    Variant v("abcdef");
+    v += v;
+    ASSERT_EQ( Str("abcdefabcdef"), v.getString() );
+    v += v;
+    ASSERT_EQ( Str("abcdefabcdefabcdefabcdef"), v.getString() );
+  }
+
+  //inline strings are still simplified
+  {
+    Variant v("1234");
+    ASSERT_TRUE( v.simplify() );
+    ASSERT_EQ( Variant::SINT16, v.getFormat() );
+    ASSERT_EQ( 1234, v.getSInt16() );
+  }
+}
+
+TEST_F(TestVariant, testMoveSemantics)
+{
+  static const char * LONG_STRING = "this string is too long to be stored inline";
+
+  //move ctor
+  {
+    Variant v1(LONG_STRING);
+    Variant v2(std::move(v1));
+    ASSERT_EQ( Variant::STRING, v2.getFormat() );
+    ASSERT_EQ( Str(LONG_STRING), v2.getString() );
+
+    //moved-from Variant is left as a default constructed Variant
+    ASSERT_TRUE( v1 == Variant() );
+    ASSERT_EQ( Variant().getFormat(), v1.getFormat() );
+
+    //moved-from Variant can be reused
+    v1 = "foo";
+    ASSERT_EQ( Str("foo"), v1.getString() );
+  }
+
+  //move assignment
+  {
+    Variant v1("short");
+    Variant v2(LONG_STRING);
+    v1 = std::move(v2);
+    ASSERT_EQ( Str(LONG_STRING), v1.getString() );
+    ASSERT_TRUE( v2 == Variant() );
+
+    Variant v3 = (sint32)-5;
+    v1 = std::move(v3);
+    ASSERT_EQ( Variant::SINT32, v1.getFormat() );
+    ASSERT_EQ( -5, v1.getSInt32() );
+
+    //self move assignment
+    Variant & alias = v1;
+    v1 = std::move(alias);
+    ASSERT_EQ( -5, v1.getSInt32() );
+  }
+
+  //swap
+  {
+    Variant v1("short");
+    Variant v2(LONG_STRING);
+    Variant v3 = 3.5;
+    v1.swap(v2);
+    ASSERT_EQ( Str(LONG_STRING), v1.getString() );
+    ASSERT_EQ( Str("short"), v2.getString() );
+    std::swap(v1, v3);
+    ASSERT_EQ( Variant::FLOAT64, v1.getFormat() );
+    ASSERT_EQ( 3.5, v1.getFloat64() );
+    ASSERT_EQ( Str(LONG_STRING), v3.getString() );
+    swap(v2, v3);
+    ASSERT_EQ( Str(LONG_STRING), v2.getString() );
+    ASSERT_EQ( Str("short"), v3.getString() );
+  }
+
+  //containers
+  {
+    std::vector<Variant> values;
+    for(int i=0; i<100; i++)
+    {
+      Variant v(LONG_STRING);
+      v += Variant(i);
+      values.push_back(std::move(v));
+    }
+    for(int i=0; i<100; i++)
+    {
+      Variant expected(LONG_STRING);
+      expected += Variant(i);
+      ASSERT_TRUE( expected == values[i] );
+    }
+  }
+
+  //string class
+  {
+    Str s1(LONG_STRING);
+    Str s2(std::move(s1));
+    ASSERT_EQ( Str(LONG_STRING), s2 );
+    s1 = "foo";
+    ASSERT_EQ( Str("foo"), s1 );
+    s1 = std::move(s2);
+    ASSERT_EQ( Str(LONG_STRING), s1 );
+    s1.swap(s2);
+    ASSERT_EQ( Str(LONG_STRING), s2 );
+    s2.append("!");
+    ASSERT_EQ( strlen(LONG_STRING) + 1, s2.size() );
+    ASSERT_TRUE( Str("abc") < Str("abd") );
+    ASSERT_TRUE( Str("abc") < Str("abcd") );
+    ASSERT_TRUE( Str("abcd") > Str("abc") );
+    ASSERT_TRUE( Str("") <= Str("") );
+  }
+}
+
+TEST_F(TestVariant, testSimplifiedStringCache)
+{
+  //strings of all storage kinds: short inline, long inline and heap
+  static const char * values[] = {"true", "-12", "12345678", "123456789012345", "-9223372036854775808", "18446744073709551615", "3.5", "foo", "a string which is not a number"};
+  static const size_t numValues = sizeof(values)/sizeof(values[0]);
+
+  for(size_t i=0; i<numValues; i++)
+  {
+    const Variant v(values[i]);
+
+    //expected results are computed on a copy
+    Variant expected(values[i]);
+    bool simplifiable = expected.simplify();
+
+    //repeated comparisons use the cached value
+    for(int j=0; j<3; j++)
+    {
+      ASSERT_TRUE( expected == v ) << values[i];
+      if (simplifiable)
+      {
+        ASSERT_EQ( 0, v.compare(expected) ) << values[i];
+      }
+      ASSERT_EQ( v.getBool(), Variant(values[i]).getBool() ) << values[i];
+    }
+
+    //copies share the cached value
+    Variant copy(v);
+    ASSERT_TRUE( copy == v );
+    ASSERT_EQ( copy.simplify(), simplifiable );
+    ASSERT_EQ( expected.getFormat(), copy.getFormat() );
+    ASSERT_TRUE( expected == copy );
+  }
+
+  //the cache is invalidated on mutation
+  {
+    Variant v("12");
+    ASSERT_TRUE( v == (sint32)12 );
+    v += "3";
+    ASSERT_TRUE( v == (sint32)123 );
+    ASSERT_FALSE( v == (sint32)12 );
+    v = "1234567890123456789";
+    ASSERT_TRUE( v == (sint64)1234567890123456789ll );
+    v += "0";
+    ASSERT_TRUE( v == (uint64)12345678901234567890ull );
+    v = "foo";
+    ASSERT_TRUE( v > (sint32)12 );
+    v = "true";
+    ASSERT_TRUE( v.getBool() );
+    v = "false";
+    ASSERT_FALSE( v.getBool() );
+  }
+
+  //concurrent readers of the same instance
+  {
+    const Variant v("123456");
+    bool results[4] = {false, false, false, false};
+    std::vector<std::thread> threads;
+    for(size_t i=0; i<4; i++)
+    {
+      bool * result = &results[i];
+      threads.push_back(std::thread([&v, result]()
+      {
+        bool success = true;
+        for(int j=0; j<1000; j++)
+          success = success && (v == (sint32)123456);
+        *result = success;
+      }));
+    }
+    for(size_t i=0; i<threads.size(); i++)
+      threads[i].join();
+    for(size_t i=0; i<4; i++)
+      ASSERT_TRUE( results[i] );
+  }
+}
+
 TEST_F(TestVariant, testSimplify)
 {
   //simplify a string to bool
@@ -1885,6 +2116,93 @@ TEST_F(TestVariant, testFloat2StringConversion)
   }
 }
 
+TEST_F(TestVariant, testGetStringBuffer)
+{
+  static const char * LONG_STRING = "this string is too long to be stored inline";
+
+  Variant values[] = {
+    Variant(true), Variant(false),
+    Variant((uint8)255), Variant((sint8)-128), Variant((uint16)65535), Variant((sint16)-32768),
+    Variant((uint32)4294967295u), Variant((sint32)-2147483647), Variant((uint64)18446744073709551615ull), Variant((sint64)(-9223372036854775807ll - 1)),
+    Variant((float32)-1.17549435e-38f), Variant((float64)-2.2250738585072e-308),
+    Variant(""), Variant("foo"), Variant(LONG_STRING),
+  };
+  static const size_t numValues = sizeof(values)/sizeof(values[0]);
+
+  for(size_t i=0; i<numValues; i++)
+  {
+    const Variant & v = values[i];
+    Str expected = v.getString();
+
+    char buffer[Variant::NATIVE_STRING_BUFFER_SIZE];
+    size_t length = v.getString(buffer, sizeof(buffer));
+    ASSERT_EQ(strlen(expected.c_str()), length);
+    if (v.getFormat() != Variant::STRING)
+    {
+      ASSERT_LT(length, sizeof(buffer));
+    }
+    ASSERT_EQ(0, strncmp(expected.c_str(), buffer, sizeof(buffer) - 1));
+
+    CompactVariant c(v);
+    char compactBuffer[Variant::NATIVE_STRING_BUFFER_SIZE];
+    ASSERT_EQ(length, c.getString(compactBuffer, sizeof(compactBuffer)));
+    ASSERT_STREQ(buffer, compactBuffer);
+  }
+
+  //truncated
+  {
+    char buffer[4];
+    ASSERT_EQ(strlen(LONG_STRING), Variant(LONG_STRING).getString(buffer, sizeof(buffer)));
+    ASSERT_STREQ("thi", buffer);
+    ASSERT_EQ(6u, Variant((sint32)-12345).getString(buffer, sizeof(buffer)));
+    ASSERT_STREQ("-12", buffer);
+    ASSERT_EQ(4u, Variant(true).getString(NULL, 0));
+  }
+}
+
+TEST_F(TestVariant, testFloatFormattingPolicy)
+{
+  ASSERT_EQ(Variant::FIXED_PRECISION, Variant::getFloatFormattingPolicy());
+  ASSERT_TRUE(Variant((float64)(0.1+0.2)).getString() == "0.3");
+  ASSERT_TRUE(Variant((float32)0.1f).getString() == "0.1");
+
+  //a value printed with fewer digits than its string is not simplified
+  {
+    Variant v("0.30000000000000004");
+    ASSERT_FALSE(v.simplify());
+    ASSERT_TRUE(v.getString() == "0.30000000000000004");
+  }
+
+  Variant::setFloatFormattingPolicy(Variant::SHORTEST_ROUND_TRIP);
+  ASSERT_TRUE(Variant((float64)(0.1+0.2)).getString() == "0.30000000000000004");
+  ASSERT_TRUE(Variant((float64)0.1).getString() == "0.1");
+  ASSERT_TRUE(Variant((float32)0.1f).getString() == "0.1");
+  ASSERT_TRUE(Variant((float32)123456789.0f).getString() == "1.2345679e+08");
+  ASSERT_TRUE(CompactVariant((float64)(0.1+0.2)).getString() == "0.30000000000000004");
+
+  //the string value converts back to the identical value
+  static const float64 values[] = { 0.1+0.2, 1.0/3.0, 2.0/3.0, 123456.789e100, -9.87654321e-200 };
+  for(size_t i=0; i<sizeof(values)/sizeof(values[0]); i++)
+  {
+    Variant v(Variant(values[i]).getString());
+    ASSERT_EQ(values[i], v.getFloat64()) << v.getString().c_str();
+  }
+
+  //simplified string values do not depend on the policy. Equal values keep the same hash.
+  {
+    Variant::setFloatFormattingPolicy(Variant::FIXED_PRECISION);
+    Variant cached("0.30000000000000004");
+    size_t hash = cached.hash();
+    Variant::setFloatFormattingPolicy(Variant::SHORTEST_ROUND_TRIP);
+    Variant fresh("0.30000000000000004");
+    ASSERT_TRUE(cached == fresh);
+    ASSERT_EQ(hash, cached.hash());
+    ASSERT_EQ(hash, fresh.hash());
+    ASSERT_FALSE(Variant("0.30000000000000004").simplify());
+  }
+  Variant::setFloatFormattingPolicy(Variant::FIXED_PRECISION);
+}
+
 TEST_F(TestVariant, testOperatorStringPlusIntegerSimplified)
 {
   Variant v = "5"; // "5" can be simplified
@@ -3310,19 +3628,24 @@ TEST_F(TestVariant, testVariantMemoryFootprint)
   ASSERT_EQ( sizeof(sint64 ), sizeof(Variant::VariantUnion) );  //always 8 bytes
 
   size_t variant_size = sizeof(Variant);
+  size_t compact_variant_size = sizeof(CompactVariant);
 
   //validate process architechture
   if (isProcess64Bit())
   {
     ASSERT_EQ( sizeof(void*), 8);
+    ASSERT_EQ( 16, compact_variant_size ); //no vptr: internal format (padded to 8 bytes) and VariantUnion
   }
   else
   {
     ASSERT_EQ( sizeof(void*), 4);
+    ASSERT_LE( compact_variant_size, 16 );
   }
+  ASSERT_LT( compact_variant_size, variant_size );
 
   //output memory footprint on console
   std::cout << "Variant class is " << variant_size << " bytes per instance in " << getProcessArchitecture() << " bit processes running on " << getOperatingSystemName() << " " << getOperatingSystemArchitecture() << " bit platform." << std::endl;
+  std::cout << "CompactVariant class is " << compact_variant_size << " bytes per instance." << std::endl;
 }
 
 bool isVariantMatchesExpectedFormat(Variant v, const Variant::VariantFormat & iExpectedFormat)
@@ -3394,3 +3717,484 @@ TEST_F(TestVariant, testImplicitConversions)
   }
 
 }
+
+TEST_F(TestVariant, testStringView)
+{
+  //borrowed characters are not null terminated
+  static const char buffer[] = "1234;hello;-5.25;the quick brown fox jumps over the lazy dog";
+
+  //numeric view
+  {
+    Variant v;
+    v.setStringView(&buffer[0], 4);
+    ASSERT_EQ(Variant::STRING, v.getFormat());
+    ASSERT_TRUE( v.isStringView() );
+    ASSERT_EQ( Str("1234"), v.getString() );
+    ASSERT_EQ( 1234, v.getSInt32() );
+    ASSERT_EQ( 1234.0, v.getFloat64() );
+    ASSERT_TRUE( v.getBool() );
+    ASSERT_TRUE( v == 1234 );
+    ASSERT_TRUE( v == "1234" );
+    ASSERT_TRUE( v < "12345" );
+    ASSERT_FALSE( v.isPositive() ); //strings are neither positive or negative
+
+    char tmp[Variant::NATIVE_STRING_BUFFER_SIZE];
+    ASSERT_EQ( 4, v.getString(tmp, sizeof(tmp)) );
+    ASSERT_EQ( std::string("1234"), tmp );
+
+    //same simplified format as an owned string
+    Variant owned = "1234";
+    ASSERT_TRUE( owned.simplify() );
+    ASSERT_TRUE( v.simplify() );
+    ASSERT_EQ(owned.getFormat(), v.getFormat());
+    ASSERT_FALSE( v.isStringView() );
+    ASSERT_EQ( 1234, v.getSInt32() );
+  }
+
+  //float view
+  {
+    Variant v;
+    v.setStringView(&buffer[11], 5);
+    ASSERT_EQ( Str("-5.25"), v.getString() );
+    ASSERT_EQ( -5.25, v.getFloat64() );
+    ASSERT_EQ( -5.25f, v.getFloat32() );
+    ASSERT_FALSE( v.isNegative() );
+  }
+
+  //copies reference the same characters
+  {
+    Variant v;
+    v.setStringView(&buffer[5], 5);
+    Variant copy = v;
+    ASSERT_TRUE( copy.isStringView() );
+    ASSERT_EQ( Str("hello"), copy.getString() );
+    ASSERT_TRUE( copy == v );
+    ASSERT_EQ( 0, copy.compare(Variant("hello")) );
+  }
+
+  //modifying the string value copies the characters
+  {
+    Variant v;
+    v.setStringView(&buffer[5], 5);
+    v += " world";
+    ASSERT_FALSE( v.isStringView() );
+    ASSERT_EQ( Str("hello world"), v.getString() );
+
+    Variant big;
+    big.setStringView(&buffer[17], strlen(&buffer[17]));
+    big += "!";
+    ASSERT_FALSE( big.isStringView() );
+    ASSERT_EQ( Str("the quick brown fox jumps over the lazy dog!"), big.getString() );
+  }
+
+  //materialize
+  {
+    char local[] = "temporary value which is longer than the inline storage";
+    Variant shortValue;
+    Variant longValue;
+    shortValue.setStringView(local, 9);
+    longValue.setStringView(local, strlen(local));
+    shortValue.materialize();
+    longValue.materialize();
+    memset(local, 'x', strlen(local));
+    ASSERT_FALSE( shortValue.isStringView() );
+    ASSERT_FALSE( longValue.isStringView() );
+    ASSERT_EQ( Str("temporary"), shortValue.getString() );
+    ASSERT_EQ( Str("temporary value which is longer than the inline storage"), longValue.getString() );
+
+    //not a view
+    Variant number = 5;
+    number.materialize();
+    ASSERT_EQ( Variant::SINT32, number.getFormat() );
+  }
+
+  //empty and NULL views
+  {
+    Variant v;
+    v.setStringView(NULL, 10);
+    ASSERT_TRUE( v.isStringView() );
+    ASSERT_EQ( Str(""), v.getString() );
+    ASSERT_EQ( 0, v.getUInt32() );
+  }
+
+  //assigning a new value releases the view
+  {
+    Variant v;
+    v.setStringView(&buffer[5], 5);
+    v = "foo";
+    ASSERT_FALSE( v.isStringView() );
+    ASSERT_EQ( Str("foo"), v.getString() );
+  }
+
+  //CompactVariant owns a copy of the characters
+  {
+    char local[] = "compact";
+    Variant v;
+    v.setStringView(local, 7);
+    CompactVariant c(v);
+    local[0] = 'x';
+    ASSERT_EQ( Str("compact"), c.getString() );
+  }
+}
+
+TEST_F(TestVariant, testOperatorFormatPairs)
+{
+  static const Variant::VariantFormat formats[] = {
+    Variant::UINT8, Variant::SINT8, Variant::UINT16, Variant::SINT16, Variant::UINT32, Variant::SINT32,
+    Variant::UINT64, Variant::SINT64, Variant::FLOAT32, Variant::FLOAT64, Variant::STRING,
+  };
+  static const size_t numFormats = sizeof(formats)/sizeof(formats[0]);
+
+  for(size_t i=0; i<numFormats; i++)
+  {
+    for(size_t j=0; j<numFormats; j++)
+    {
+      Variant a = 7;
+      Variant b = 2;
+      a.promote(formats[i]);
+      b.promote(formats[j]);
+
+      Variant plus = a;
+      plus += b;
+      Variant minus = a;
+      minus -= b;
+      Variant multiply = a;
+      multiply *= b;
+      Variant divide = a;
+      divide /= b;
+
+      if (formats[i] == Variant::STRING && formats[j] == Variant::STRING)
+      {
+        ASSERT_EQ( Str("72"), plus.getString() );
+        ASSERT_EQ( Str("7"), minus.getString() );
+        continue;
+      }
+
+      ASSERT_EQ( 9.0, plus.getFloat64() ) << "formats " << i << " and " << j;
+      ASSERT_EQ( 5.0, minus.getFloat64() ) << "formats " << i << " and " << j;
+      ASSERT_EQ( 14.0, multiply.getFloat64() ) << "formats " << i << " and " << j;
+      ASSERT_EQ( 3.5, divide.getFloat64() ) << "formats " << i << " and " << j;
+    }
+  }
+}
+
+struct FormatNameVisitor
+{
+  std::string operator()(const bool     & /*iValue*/) const { return "bool"; }
+  std::string operator()(const uint8    & /*iValue*/) const { return "uint8"; }
+  std::string operator()(const uint16   & /*iValue*/) const { return "uint16"; }
+  std::string operator()(const uint32   & /*iValue*/) const { return "uint32"; }
+  std::string operator()(const uint64   & /*iValue*/) const { return "uint64"; }
+  std::string operator()(const sint8    & /*iValue*/) const { return "sint8"; }
+  std::string operator()(const sint16   & /*iValue*/) const { return "sint16"; }
+  std::string operator()(const sint32   & /*iValue*/) const { return "sint32"; }
+  std::string operator()(const sint64   & /*iValue*/) const { return "sint64"; }
+  std::string operator()(const float32  & /*iValue*/) const { return "float32"; }
+  std::string operator()(const float64  & /*iValue*/) const { return "float64"; }
+  std::string operator()(const Variant::StringView & iValue) const { return std::string(iValue.buffer, iValue.length); }
+};
+
+struct SumVisitor
+{
+  float64 sum;
+  template <typename T>
+  void operator()(const T & iValue) { sum += static_cast<float64>(iValue); }
+  void operator()(const Variant::StringView & /*iValue*/) {}
+};
+
+TEST_F(TestVariant, testTemplateAccessors)
+{
+  //get<T>() returns the same values as the getters
+  std::vector<Variant> values;
+  values.push_back(true);
+  values.push_back((uint8)200);
+  values.push_back((sint8)-100);
+  values.push_back((uint16)60000);
+  values.push_back((sint16)-30000);
+  values.push_back((uint32)4000000000u);
+  values.push_back((sint32)-2000000000);
+  values.push_back((uint64)18000000000000000000ull);
+  values.push_back((sint64)-9000000000000000000ll);
+  values.push_back(5.5f);
+  values.push_back(-1234.25);
+  values.push_back("42");
+  values.push_back("-7.75");
+  values.push_back("true");
+  values.push_back("foo");
+  for(size_t i=0; i<values.size(); i++)
+  {
+    const Variant & v = values[i];
+    ASSERT_EQ( v.getBool   (), v.get<bool   >() ) << "value " << i;
+    ASSERT_EQ( v.getUInt8  (), v.get<uint8  >() ) << "value " << i;
+    ASSERT_EQ( v.getUInt16 (), v.get<uint16 >() ) << "value " << i;
+    ASSERT_EQ( v.getUInt32 (), v.get<uint32 >() ) << "value " << i;
+    ASSERT_EQ( v.getUInt64 (), v.get<uint64 >() ) << "value " << i;
+    ASSERT_EQ( v.getSInt8  (), v.get<sint8  >() ) << "value " << i;
+    ASSERT_EQ( v.getSInt16 (), v.get<sint16 >() ) << "value " << i;
+    ASSERT_EQ( v.getSInt32 (), v.get<sint32 >() ) << "value " << i;
+    ASSERT_EQ( v.getSInt64 (), v.get<sint64 >() ) << "value " << i;
+    ASSERT_EQ( v.getFloat32(), v.get<float32>() ) << "value " << i;
+    ASSERT_EQ( v.getFloat64(), v.get<float64>() ) << "value " << i;
+    ASSERT_EQ( v.getString (), v.get<Str    >() ) << "value " << i;
+  }
+
+  //set<T>() selects the same format as the setters
+  {
+    Variant v = "a string value which is longer than the inline storage";
+    v.set<uint16>(1234);
+    ASSERT_EQ( Variant::UINT16, v.getFormat() );
+    ASSERT_EQ( 1234, v.get<uint16>() );
+
+    v.set<sint8>(-5);
+    ASSERT_EQ( Variant::SINT8, v.getFormat() );
+    ASSERT_EQ( -5, v.get<sint64>() );
+    ASSERT_TRUE( v == -5 );
+
+    v.set<float32>(2.5f);
+    ASSERT_EQ( Variant::FLOAT32, v.getFormat() );
+    ASSERT_EQ( 2.5, v.get<float64>() );
+
+    v.set<CStr>("foo");
+    ASSERT_EQ( Variant::STRING, v.getFormat() );
+    ASSERT_EQ( Str("foo"), v.get<Str>() );
+
+    v.set<bool>(true);
+    ASSERT_EQ( Variant::BOOL, v.getFormat() );
+    ASSERT_TRUE( v.get<bool>() );
+
+    v.set<Str>(Str("bar"));
+    ASSERT_EQ( Str("bar"), v.getString() );
+  }
+
+  //visit() calls the visitor with the native type
+  {
+    FormatNameVisitor visitor;
+    ASSERT_EQ( std::string("bool"   ), Variant(true          ).visit(visitor) );
+    ASSERT_EQ( std::string("uint8"  ), Variant((uint8  )1    ).visit(visitor) );
+    ASSERT_EQ( std::string("uint16" ), Variant((uint16 )1    ).visit(visitor) );
+    ASSERT_EQ( std::string("uint32" ), Variant((uint32 )1    ).visit(visitor) );
+    ASSERT_EQ( std::string("uint64" ), Variant((uint64 )1    ).visit(visitor) );
+    ASSERT_EQ( std::string("sint8"  ), Variant((sint8  )1    ).visit(visitor) );
+    ASSERT_EQ( std::string("sint16" ), Variant((sint16 )1    ).visit(visitor) );
+    ASSERT_EQ( std::string("sint32" ), Variant((sint32 )1    ).visit(visitor) );
+    ASSERT_EQ( std::string("sint64" ), Variant((sint64 )1    ).visit(visitor) );
+    ASSERT_EQ( std::string("float32"), Variant((float32)1    ).visit(visitor) );
+    ASSERT_EQ( std::string("float64"), Variant((float64)1    ).visit(visitor) );
+    ASSERT_EQ( std::string("hello"  ), Variant("hello"       ).visit(visitor) );
+
+    //string views are not null terminated
+    Variant view;
+    view.setStringView("hello world", 5);
+    ASSERT_EQ( std::string("hello"), view.visit(visitor) );
+  }
+  {
+    SumVisitor visitor;
+    visitor.sum = 0.0;
+    for(size_t i=0; i<values.size(); i++)
+    {
+      values[i].visit(visitor);
+    }
+    float64 expected = 0.0;
+    for(size_t i=0; i<values.size(); i++)
+    {
+      if (values[i].getFormat() != Variant::STRING)
+        expected += values[i].getFloat64();
+    }
+    ASSERT_EQ( expected, visitor.sum );
+  }
+}
+
+TEST_F(TestVariant, testSharedStrings)
+{
+  const Str value = "a string value which is longer than the inline storage";
+  struct Helper
+  {
+    static Str concat(const Str & iValue1, const Str & iValue2)
+    {
+      Str tmp = iValue1;
+      tmp.append(iValue2);
+      return tmp;
+    }
+  };
+
+  //copies are independent
+  {
+    Variant original = value;
+    Variant copy1 = original;
+    Variant copy2;
+    copy2 = copy1;
+    copy1 += "!";
+    ASSERT_EQ( value, original.getString() );
+    ASSERT_EQ( Helper::concat(value, "!"), copy1.getString() );
+    ASSERT_EQ( value, copy2.getString() );
+
+    //the last owner modifies the string
+    copy2 += "?";
+    original += "#";
+    ASSERT_EQ( Helper::concat(value, "?"), copy2.getString() );
+    ASSERT_EQ( Helper::concat(value, "#"), original.getString() );
+    ASSERT_EQ( Helper::concat(value, "!"), copy1.getString() );
+  }
+
+  //append to itself
+  {
+    Variant v = value;
+    Variant copy = v;
+    v += v;
+    ASSERT_EQ( Helper::concat(value, value), v.getString() );
+    ASSERT_EQ( value, copy.getString() );
+    copy += copy;
+    ASSERT_EQ( Helper::concat(value, value), copy.getString() );
+  }
+
+  //assign to each other
+  {
+    Variant a = value;
+    Variant b = a;
+    a = b;
+    b = a;
+    a = "short";
+    ASSERT_EQ( Str("short"), a.getString() );
+    ASSERT_EQ( value, b.getString() );
+    b = 5;
+    ASSERT_EQ( 5, b.getSInt32() );
+  }
+
+  //assign a value from a shared string
+  {
+    Variant a = value;
+    Variant b = a;
+    a = a.getString().append("1");
+    ASSERT_EQ( Helper::concat(value, "1"), a.getString() );
+    ASSERT_EQ( value, b.getString() );
+  }
+
+  //simplified values are kept by copies
+  {
+    Variant a = "123456789012345678";
+    ASSERT_EQ( 123456789012345678ull, a.getUInt64() );
+    Variant b = a;
+    ASSERT_TRUE( b == (uint64)123456789012345678ull );
+    ASSERT_TRUE( b.simplify() );
+    ASSERT_EQ( Str("123456789012345678"), a.getString() );
+  }
+
+  //CompactVariant
+  {
+    Variant a = value;
+    Variant b = a;
+    CompactVariant c = a;
+    c += CompactVariant("!");
+    ASSERT_EQ( value, a.getString() );
+    ASSERT_EQ( value, b.getString() );
+    ASSERT_EQ( Helper::concat(value, "!"), c.getString() );
+  }
+
+  //copies of the same Variant across threads
+  {
+    const Variant shared = value;
+    static const size_t numThreads = 4;
+    std::vector<std::thread> threads;
+    std::vector<Str> results(numThreads);
+    for(size_t i=0; i<numThreads; i++)
+    {
+      threads.push_back(std::thread([&shared, &results, i]()
+      {
+        for(size_t j=0; j<1000; j++)
+        {
+          Variant copy = shared;
+          Variant other = copy;
+          other += "x";
+          results[i] = copy.getString();
+        }
+      }));
+    }
+    for(size_t i=0; i<threads.size(); i++)
+    {
+      threads[i].join();
+    }
+    for(size_t i=0; i<numThreads; i++)
+    {
+      ASSERT_EQ( value, results[i] );
+    }
+    ASSERT_EQ( value, shared.getString() );
+  }
+}
+
+TEST_F(TestVariant, testHash)
+{
+  //numeric values are hashed by value
+  const Variant five = (uint8)5;
+  ASSERT_EQ( five.hash(), Variant((sint8  )5).hash() );
+  ASSERT_EQ( five.hash(), Variant((uint16 )5).hash() );
+  ASSERT_EQ( five.hash(), Variant((sint32 )5).hash() );
+  ASSERT_EQ( five.hash(), Variant((uint64 )5).hash() );
+  ASSERT_EQ( five.hash(), Variant((sint64 )5).hash() );
+  ASSERT_EQ( five.hash(), Variant((float32)5.0f).hash() );
+  ASSERT_EQ( five.hash(), Variant((float64)5.0).hash() );
+  ASSERT_EQ( five.hash(), Variant("5").hash() );
+  ASSERT_EQ( Variant(true).hash(), Variant((uint32)1).hash() );
+  ASSERT_EQ( Variant(true).hash(), Variant("true").hash() );
+  ASSERT_EQ( Variant(0.0).hash(), Variant(-0.0).hash() );
+  ASSERT_EQ( Variant(1.5f).hash(), Variant(1.5).hash() );
+  ASSERT_EQ( Variant(1.5).hash(), Variant("1.5").hash() );
+  ASSERT_EQ( Variant((sint64)-3).hash(), Variant(-3.0f).hash() );
+  ASSERT_NE( five.hash(), Variant((uint8)6).hash() );
+  ASSERT_NE( Variant("foo").hash(), Variant("bar").hash() );
+
+  //string views and shared strings are hashed like owned strings
+  static const char * LONG_STRING = "a string value which is longer than the inline storage";
+  Variant view;
+  view.setStringView(LONG_STRING, strlen(LONG_STRING));
+  Variant shared = view;
+  shared.materialize();
+  ASSERT_EQ( Variant(LONG_STRING).hash(), view.hash() );
+  ASSERT_EQ( Variant(LONG_STRING).hash(), shared.hash() );
+
+  //equal values must have the same hash
+  std::vector<Variant> values;
+  static const char * strings[] = {"0", "1", "-1", "true", "false", "5", "5.0", "05", "1.5", "-2.25", "255", "65536", "1e3", "foo", "", " 5", LONG_STRING};
+  for(size_t i=0; i<sizeof(strings)/sizeof(strings[0]); i++)
+    values.push_back(Variant(strings[i]));
+  static const float64 numbers[] = {0.0, -0.0, 1.0, -1.0, 5.0, 1.5, -2.25, 255.0, 65536.0, 1000.0, 0.1};
+  for(size_t i=0; i<sizeof(numbers)/sizeof(numbers[0]); i++)
+  {
+    Variant v = numbers[i];
+    for(int f=Variant::BOOL; f<=Variant::FLOAT64; f++)
+    {
+      //only keep the formats which can represent the number exactly
+      Variant tmp = v;
+      tmp.promote(static_cast<Variant::VariantFormat>(f));
+      if (tmp.getFloat64() == numbers[i])
+        values.push_back(tmp);
+    }
+  }
+  for(size_t i=0; i<values.size(); i++)
+  {
+    for(size_t j=0; j<values.size(); j++)
+    {
+      if (values[i] == values[j])
+      {
+        ASSERT_EQ( values[i].hash(), values[j].hash() ) << values[i].getString().c_str() << " and " << values[j].getString().c_str();
+      }
+    }
+  }
+
+  //unordered containers
+  std::unordered_map<Variant, int> map;
+  map[Variant((uint8)5)] = 5;
+  map[Variant("foo")] = 6;
+  map[Variant(1.5)] = 7;
+  ASSERT_EQ( 3, map.size() );
+  ASSERT_EQ( 5, map[Variant((sint64)5)] );
+  ASSERT_EQ( 5, map[Variant("5")] );
+  ASSERT_EQ( 6, map[Variant("foo")] );
+  ASSERT_EQ( 7, map[Variant(1.5f)] );
+  ASSERT_EQ( 3, map.size() );
+
+  std::unordered_map<CompactVariant, int> compactMap;
+  compactMap[CompactVariant((uint8)5)] = 5;
+  ASSERT_EQ( 5, compactMap[CompactVariant(5.0)] );
+  ASSERT_EQ( 5, compactMap[CompactVariant("5")] );
+  ASSERT_EQ( Variant("foo").hash(), CompactVariant("foo").hash() );
+}
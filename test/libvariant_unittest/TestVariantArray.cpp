@@ -0,0 +1,510 @@
+/**********************************************************************************
+ * MIT License
+ * 
+ * Copyright (c) 2018 Antoine Beauchamp
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *********************************************************************************/
+#include "TestVariantArray.h"
+#include "libvariant/variant_array.h"
+#include <vector>
+#include <string.h>
+#include <limits>
+
+using namespace libVariant;
+
+void TestVariantArray::SetUp()
+{
+}
+
+void TestVariantArray::TearDown()
+{
+}
+
+static const char * LONG_STRING = "a string value which is longer than the inline storage";
+
+TEST_F(TestVariantArray, testPushBackAndGet)
+{
+  VariantArray values;
+  ASSERT_TRUE( values.empty() );
+
+  std::vector<Variant> expected;
+  expected.push_back(true);
+  expected.push_back((uint8)200);
+  expected.push_back((sint8)-100);
+  expected.push_back((uint16)60000);
+  expected.push_back((sint16)-30000);
+  expected.push_back((uint32)4000000000u);
+  expected.push_back((sint32)-2000000000);
+  expected.push_back((uint64)18000000000000000000ull);
+  expected.push_back((sint64)-9000000000000000000ll);
+  expected.push_back(1.5f);
+  expected.push_back(-2.25);
+  expected.push_back("foo");
+  expected.push_back("");
+  expected.push_back(LONG_STRING);
+  for(size_t i=0; i<expected.size(); i++)
+    values.push_back(expected[i]);
+  values.push_back("bar");
+  values.push_back(Str("baz"));
+  values.push_back("a\0b", 3);
+
+  ASSERT_EQ( expected.size() + 3, values.size() );
+  for(size_t i=0; i<expected.size(); i++)
+  {
+    ASSERT_EQ( expected[i].getFormat(), values.getFormat(i) );
+    ASSERT_EQ( expected[i].getFormat(), values[i].getFormat() );
+    ASSERT_EQ( expected[i].getString(), values[i].getString() );
+    ASSERT_TRUE( values[i] == expected[i] );
+    ASSERT_TRUE( values.get(i) == expected[i] );
+    ASSERT_EQ( expected[i].hash(), values[i].hash() );
+  }
+  ASSERT_EQ( Str("bar"), values[expected.size()].getString() );
+  ASSERT_EQ( Str("baz"), values[expected.size()+1].getString() );
+
+  size_t length = 0;
+  const char * buffer = values.getStringBuffer(expected.size()+2, length);
+  ASSERT_EQ( 3, length );
+  ASSERT_EQ( 0, memcmp(buffer, "a\0b", 3) );
+
+  //get() returns a Variant which owns its string value
+  Variant copy = values.get(13);
+  ASSERT_FALSE( copy.isStringView() );
+  ASSERT_TRUE( values.getView(13).isStringView() );
+  values.clear();
+  ASSERT_EQ( Str(LONG_STRING), copy.getString() );
+}
+
+TEST_F(TestVariantArray, testReferences)
+{
+  VariantArray values(3);
+  ASSERT_EQ( 3, values.size() );
+  ASSERT_EQ( Variant::UINT8, values[0].getFormat() );
+  ASSERT_TRUE( values[0] == Variant(0) );
+
+  values[0] = Variant((uint16)1234);
+  values[1] = Variant("5678");
+  values[2] = Variant(LONG_STRING);
+
+  //conversions
+  ASSERT_EQ( 1234, values[0].getUInt16() );
+  ASSERT_EQ( 5678, values[1].getUInt32() );
+  ASSERT_EQ( 5678, values[1].get<sint64>() );
+  ASSERT_EQ( 1234.0, values[0].getFloat64() );
+  ASSERT_TRUE( values[0].getBool() );
+
+  //comparisons
+  ASSERT_TRUE( values[0] < values[1] );
+  ASSERT_TRUE( values[1] > values[0] );
+  ASSERT_TRUE( values[1] == Variant(5678) );
+  ASSERT_TRUE( values[1] < values[2] );
+  ASSERT_EQ( 0, values[0].compare(Variant("1234")) );
+
+  //references assign the value
+  values[0] = values[2];
+  ASSERT_EQ( Variant::STRING, values[0].getFormat() );
+  ASSERT_EQ( Str(LONG_STRING), values[0].getString() );
+  values[2] = Variant(3.5);
+  ASSERT_EQ( Str(LONG_STRING), values[0].getString() );
+  ASSERT_EQ( 3.5, values[2].getFloat64() );
+
+  const VariantArray & constValues = values;
+  Variant v = constValues[1];
+  ASSERT_EQ( Str("5678"), v.getString() );
+
+  //assign a string from the array itself
+  for(size_t i=0; i<100; i++)
+  {
+    size_t length = 0;
+    const char * buffer = values.getStringBuffer(0, length);
+    values.set(1, buffer, length);
+  }
+  ASSERT_EQ( Str(LONG_STRING), values[1].getString() );
+}
+
+TEST_F(TestVariantArray, testLayout)
+{
+  VariantArray values;
+  values.reserve(1000, 1000);
+  for(uint32 i=0; i<1000; i++)
+    values.push_back(Variant(i));
+
+  Variant::VariantFormat format;
+  ASSERT_TRUE( values.isHomogeneous(format) );
+  values.push_back("foo");
+  ASSERT_FALSE( values.isHomogeneous(format) );
+  values.resize(256);
+  ASSERT_TRUE( values.isHomogeneous(format) );
+  ASSERT_EQ( Variant::UINT32, format );
+
+  //dense columns
+  const uint8 * formats = values.getFormats();
+  const Variant::VariantUnion * payloads = values.getValues();
+  for(uint32 i=0; i<values.size(); i++)
+  {
+    ASSERT_EQ( Variant::UINT32, formats[i] );
+    ASSERT_EQ( i, payloads[i].as_uint32 );
+  }
+
+  //overwritten strings are released by compact()
+  values.set(0, Variant(LONG_STRING));
+  values.set(0, Variant("foo"));
+  values.set(1, Variant("bar"));
+  size_t size = values.getStringsSize();
+  values.compact();
+  ASSERT_LT( values.getStringsSize(), size );
+  ASSERT_EQ( Str("foo"), values[0].getString() );
+  ASSERT_EQ( Str("bar"), values[1].getString() );
+  ASSERT_EQ( 2, values[2].getUInt32() );
+
+  VariantArray copy = values;
+  VariantArray other;
+  swap(copy, other);
+  ASSERT_EQ( 0, copy.size() );
+  ASSERT_EQ( values.size(), other.size() );
+  ASSERT_TRUE( other[0] == values[0] );
+
+  //reordered values keep their strings
+  std::vector<size_t> order;
+  for(size_t i=0; i<values.size(); i++)
+    order.push_back(values.size() - 1 - i);
+  values.reorder(order);
+  ASSERT_EQ( Str("foo"), values[values.size() - 1].getString() );
+  ASSERT_EQ( Str("bar"), values[values.size() - 2].getString() );
+  ASSERT_EQ( 255, values[0].getUInt32() );
+}
+
+static const Variant::VariantFormat ALL_FORMATS[] = {
+  Variant::BOOL, Variant::UINT8, Variant::SINT8, Variant::UINT16, Variant::SINT16, Variant::UINT32, Variant::SINT32,
+  Variant::UINT64, Variant::SINT64, Variant::FLOAT32, Variant::FLOAT64, Variant::STRING,
+};
+static const size_t NUM_FORMATS = sizeof(ALL_FORMATS)/sizeof(ALL_FORMATS[0]);
+
+/// <summary>
+/// Builds a column of the given format from the given seed values.
+/// </summary>
+static VariantArray createColumn(Variant::VariantFormat iFormat, const float64 * iSeeds, size_t iNumSeeds, size_t iSize, bool iNonZero)
+{
+  VariantArray column;
+  for(size_t i=0; i<iSize; i++)
+  {
+    Variant v = iSeeds[i%iNumSeeds];
+    v.promote(iFormat);
+    if (iNonZero && v == 0)
+    {
+      v = 1;
+      v.promote(iFormat);
+    }
+    column.push_back(v);
+  }
+  return column;
+}
+
+static void applyOperator(Variant::MATH_OPERATOR iOperator, Variant & ioValue, const Variant & iOperand)
+{
+  switch(iOperator)
+  {
+  case Variant::PLUS_EQUAL:     ioValue += iOperand; break;
+  case Variant::MINUS_EQUAL:    ioValue -= iOperand; break;
+  case Variant::MULTIPLY_EQUAL: ioValue *= iOperand; break;
+  case Variant::DIVIDE_EQUAL:   ioValue /= iOperand; break;
+  };
+}
+
+static void applyOperator(Variant::MATH_OPERATOR iOperator, VariantArray & ioValues, const VariantArray & iOperands)
+{
+  switch(iOperator)
+  {
+  case Variant::PLUS_EQUAL:     ioValues += iOperands; break;
+  case Variant::MINUS_EQUAL:    ioValues -= iOperands; break;
+  case Variant::MULTIPLY_EQUAL: ioValues *= iOperands; break;
+  case Variant::DIVIDE_EQUAL:   ioValues /= iOperands; break;
+  };
+}
+
+static void applyOperator(Variant::MATH_OPERATOR iOperator, VariantArray & ioValues, const Variant & iOperand)
+{
+  switch(iOperator)
+  {
+  case Variant::PLUS_EQUAL:     ioValues += iOperand; break;
+  case Variant::MINUS_EQUAL:    ioValues -= iOperand; break;
+  case Variant::MULTIPLY_EQUAL: ioValues *= iOperand; break;
+  case Variant::DIVIDE_EQUAL:   ioValues /= iOperand; break;
+  };
+}
+
+TEST_F(TestVariantArray, testOperatorsMatchVariant)
+{
+  static const float64 leftSeeds[] = {0, 1, 7, 100, 127, 200, 255, 300, 40000, 70000, 5e9, -1, -3, -200, -40000, 1.5, -2.25, 1e12};
+  static const float64 rightSeeds[] = {1, 2, 3, 7, 100, 255, 300, 70000, -1, -2, -7, 0.5, 2.5};
+  static const size_t numLeftSeeds = sizeof(leftSeeds)/sizeof(leftSeeds[0]);
+  static const size_t numRightSeeds = sizeof(rightSeeds)/sizeof(rightSeeds[0]);
+  static const size_t size = 1000; //larger than the blocks of the mixed floating point kernel
+
+  for(int op=Variant::PLUS_EQUAL; op<=Variant::DIVIDE_EQUAL; op++)
+  {
+    Variant::MATH_OPERATOR mathOperator = static_cast<Variant::MATH_OPERATOR>(op);
+    for(size_t i=0; i<NUM_FORMATS; i++)
+    {
+      const VariantArray left = createColumn(ALL_FORMATS[i], leftSeeds, numLeftSeeds, size, false);
+      for(size_t j=0; j<NUM_FORMATS; j++)
+      {
+        //integer division by zero is not allowed with the default policy
+        const VariantArray right = createColumn(ALL_FORMATS[j], rightSeeds, numRightSeeds, size, true);
+
+        VariantArray columnResult = left;
+        applyOperator(mathOperator, columnResult, right);
+        VariantArray scalarResult = left;
+        applyOperator(mathOperator, scalarResult, right.get(3));
+        ASSERT_EQ( size, columnResult.size() );
+
+        for(size_t k=0; k<size; k++)
+        {
+          Variant expected = left.get(k);
+          applyOperator(mathOperator, expected, right.get(k));
+          ASSERT_EQ( expected.getFormat(), columnResult.getFormat(k) ) << "operator " << op << " formats " << i << " and " << j << " at " << k;
+          ASSERT_EQ( expected.getString(), columnResult[k].getString() ) << "operator " << op << " formats " << i << " and " << j << " at " << k;
+
+          expected = left.get(k);
+          applyOperator(mathOperator, expected, right.get(3));
+          ASSERT_EQ( expected.getFormat(), scalarResult.getFormat(k) ) << "operator " << op << " formats " << i << " and " << j << " at " << k;
+          ASSERT_EQ( expected.getString(), scalarResult[k].getString() ) << "operator " << op << " formats " << i << " and " << j << " at " << k;
+        }
+      }
+    }
+  }
+}
+
+TEST_F(TestVariantArray, testOperatorsMixedColumns)
+{
+  VariantArray values;
+  values.push_back(Variant((uint8)200));
+  values.push_back(Variant(1.5f));
+  values.push_back("12");
+  values.push_back("foo");
+  values.push_back(Variant((sint16)-5));
+
+  VariantArray operands;
+  operands.push_back(Variant((uint8)100));
+  operands.push_back(Variant(2.0));
+  operands.push_back(Variant((uint32)3));
+  operands.push_back("bar");
+  operands.push_back("7");
+
+  VariantArray sum = values;
+  sum += operands;
+  ASSERT_EQ( Variant::UINT16, sum.getFormat(0) );
+  ASSERT_TRUE( sum[0] == Variant(300) );
+  ASSERT_TRUE( sum[1] == Variant(3.5) );
+  ASSERT_TRUE( sum[2] == Variant(15) );
+  ASSERT_EQ( Str("foobar"), sum[3].getString() );
+  ASSERT_TRUE( sum[4] == Variant(2) );
+
+  //adding an array to itself
+  VariantArray twice = values;
+  twice += twice;
+  ASSERT_TRUE( twice[0] == Variant(400) );
+  ASSERT_EQ( Str("foofoo"), twice[3].getString() );
+
+  //undefined string operators leave the values unmodified without using more memory
+  VariantArray strings;
+  strings.push_back("foo");
+  strings.push_back("bar");
+  size_t stringsSize = strings.getStringsSize();
+  strings *= Variant("baz");
+  ASSERT_EQ( Str("foo"), strings[0].getString() );
+  ASSERT_EQ( stringsSize, strings.getStringsSize() );
+
+  //division by zero
+  Variant::DivisionByZeroPolicy policy = Variant::getDivisionByZeroPolicy();
+  Variant::setDivisionByZeroPolicy(Variant::IGNORE);
+  VariantArray integers;
+  integers.push_back(Variant(10));
+  integers.push_back(Variant(7));
+  integers /= Variant(0);
+  ASSERT_TRUE( integers[0] == Variant(10) );
+  VariantArray floats;
+  floats.push_back(Variant(10.0));
+  floats /= Variant(0.0);
+  ASSERT_TRUE( floats[0] == Variant(10.0) );
+  Variant::setDivisionByZeroPolicy(policy);
+}
+
+TEST_F(TestVariantArray, testOperatorsMixedFormats)
+{
+  //columns of numbers of different formats processed together
+  static const Variant::VariantFormat leftFormats[] = {Variant::UINT8, Variant::UINT32, Variant::BOOL, Variant::UINT64, Variant::SINT8, Variant::SINT32, Variant::SINT16, Variant::FLOAT32, Variant::FLOAT64};
+  static const Variant::MATH_OPERATOR operators[] = {Variant::PLUS_EQUAL, Variant::MINUS_EQUAL, Variant::MULTIPLY_EQUAL, Variant::DIVIDE_EQUAL};
+  static const size_t size = 600;
+
+  //each range of formats selects a different kernel
+  static const size_t ranges[][2] = { {0, 4}, {4, 7}, {0, 7}, {7, 9}, {8, 9}, {0, 9} };
+  static const size_t numRanges = sizeof(ranges)/sizeof(ranges[0]);
+
+  for(size_t op=0; op<sizeof(operators)/sizeof(operators[0]); op++)
+  {
+    for(size_t l=0; l<numRanges; l++)
+    {
+      for(size_t r=0; r<numRanges; r++)
+      {
+        VariantArray left;
+        VariantArray right;
+        for(size_t i=0; i<size; i++)
+        {
+          Variant leftValue(static_cast<uint32>(i*37 % 300));
+          leftValue.promote(leftFormats[ranges[l][0] + i % (ranges[l][1] - ranges[l][0])]);
+          left.push_back(leftValue);
+
+          Variant rightValue(static_cast<uint32>(1 + i*11 % 90));
+          rightValue.promote(leftFormats[ranges[r][0] + (i/3) % (ranges[r][1] - ranges[r][0])]);
+          right.push_back(rightValue);
+        }
+
+        VariantArray expected = left;
+        for(size_t i=0; i<size; i++)
+        {
+          Variant value = expected.get(i);
+          applyOperator(operators[op], value, right.get(i));
+          expected.set(i, value);
+        }
+
+        applyOperator(operators[op], left, right);
+        for(size_t i=0; i<size; i++)
+        {
+          ASSERT_EQ( expected.getFormat(i), left.getFormat(i) ) << "operator=" << op << " left=" << l << " right=" << r << " index=" << i;
+          ASSERT_EQ( expected[i].getString(), left[i].getString() ) << "operator=" << op << " left=" << l << " right=" << r << " index=" << i;
+        }
+      }
+    }
+  }
+}
+
+static bool isMatching(VariantArray::COMPARE_OPERATOR iOperator, const Variant & iLeft, const Variant & iRight)
+{
+  switch(iOperator)
+  {
+  case VariantArray::EQUAL:
+    return iLeft == iRight;
+  case VariantArray::NOT_EQUAL:
+    return iLeft != iRight;
+  case VariantArray::LESS:
+    return iLeft < iRight;
+  case VariantArray::LESS_EQUAL:
+    return iLeft <= iRight;
+  case VariantArray::GREATER:
+    return iLeft > iRight;
+  case VariantArray::GREATER_EQUAL:
+  default:
+    return iLeft >= iRight;
+  };
+}
+
+static const VariantArray::COMPARE_OPERATOR ALL_COMPARE_OPERATORS[] = {
+  VariantArray::EQUAL, VariantArray::NOT_EQUAL, VariantArray::LESS, VariantArray::LESS_EQUAL, VariantArray::GREATER, VariantArray::GREATER_EQUAL,
+};
+static const size_t NUM_COMPARE_OPERATORS = sizeof(ALL_COMPARE_OPERATORS)/sizeof(ALL_COMPARE_OPERATORS[0]);
+
+TEST_F(TestVariantArray, testSelectMatchVariant)
+{
+  //values of all formats, including values which are compared with surprising results
+  VariantArray samples;
+  samples.push_back(Variant(true));
+  samples.push_back(Variant(false));
+  samples.push_back(Variant((uint8)200));
+  samples.push_back(Variant((uint16)5));
+  samples.push_back(Variant((uint32)4000000000u));
+  samples.push_back(Variant((uint64)18000000000000000000ull));
+  samples.push_back(Variant((sint8)-1));
+  samples.push_back(Variant((sint16)5));
+  samples.push_back(Variant((sint32)-70000));
+  samples.push_back(Variant((sint64)-5000000000ll));
+  samples.push_back(Variant(1.5f));
+  samples.push_back(Variant(-0.0f));
+  samples.push_back(Variant(5.0));
+  samples.push_back(Variant(std::numeric_limits<float64>::quiet_NaN()));
+  samples.push_back("5");
+  samples.push_back("-1");
+  samples.push_back("foo");
+  samples.push_back("1.5");
+  samples.push_back("");
+
+  //runs of the same formats and alternating formats, on more than one block of values
+  static const size_t size = 700;
+  VariantArray left;
+  VariantArray right;
+  for(size_t i=0; i<size; i++)
+  {
+    left.push_back(samples.get(i < 300 ? (i / 16) % samples.size() : i % samples.size()));
+    right.push_back(samples.get(i < 300 ? (i / 7) % samples.size() : (i * 5) % samples.size()));
+  }
+
+  for(size_t op=0; op<NUM_COMPARE_OPERATORS; op++)
+  {
+    const VariantArray::COMPARE_OPERATOR compareOperator = ALL_COMPARE_OPERATORS[op];
+
+    //with another array
+    VariantArray::Bitmap selection;
+    left.select(compareOperator, right, selection);
+    ASSERT_EQ( (size + 63) / 64, selection.size() );
+    size_t count = 0;
+    for(size_t i=0; i<size; i++)
+    {
+      bool expected = isMatching(compareOperator, left.get(i), right.get(i));
+      ASSERT_EQ( expected, VariantArray::isSelected(selection, i) ) << "operator=" << op << " index=" << i << " left=" << left[i].getString().c_str() << " right=" << right[i].getString().c_str();
+      count += (expected ? 1 : 0);
+    }
+    ASSERT_EQ( count, VariantArray::countSelected(selection) );
+
+    //with a single value
+    for(size_t s=0; s<samples.size(); s++)
+    {
+      const Variant value = samples.get(s);
+      left.select(compareOperator, value, selection);
+      for(size_t i=0; i<size; i++)
+      {
+        bool expected = isMatching(compareOperator, left.get(i), value);
+        ASSERT_EQ( expected, VariantArray::isSelected(selection, i) ) << "operator=" << op << " index=" << i << " left=" << left[i].getString().c_str() << " value=" << value.getString().c_str();
+      }
+    }
+  }
+}
+
+TEST_F(TestVariantArray, testSelectBitmap)
+{
+  VariantArray values;
+  for(int i=0; i<100; i++)
+    values.push_back(Variant(i));
+
+  VariantArray::Bitmap selection;
+  values.select(VariantArray::GREATER_EQUAL, Variant(30), selection);
+  ASSERT_EQ( 2, selection.size() );
+  ASSERT_EQ( 0xFFFFFFFFC0000000ull, selection[0] );
+  ASSERT_EQ( 0x0000000FFFFFFFFFull, selection[1] ); //unused bits are cleared
+  ASSERT_EQ( 70, VariantArray::countSelected(selection) );
+
+  //a numeric string argument is compared as a number
+  values.select(VariantArray::LESS, Variant("10"), selection);
+  ASSERT_EQ( 10, VariantArray::countSelected(selection) );
+
+  //empty arrays
+  VariantArray empty;
+  empty.select(VariantArray::EQUAL, Variant(0), selection);
+  ASSERT_TRUE( selection.empty() );
+  ASSERT_EQ( 0, VariantArray::countSelected(selection) );
+}